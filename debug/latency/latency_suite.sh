@@ -0,0 +1,241 @@
+#!/bin/bash
+#measure the join, leave and zapping latencies of receivers behind the mcproxy
+#the sender, the proxy and each receiver run in their own network namespace connected by veth pairs
+#start it with root previleges
+
+MCPROXY=../../mcproxy/mcproxy
+TESTER=../../mcproxy/tester
+RECEIVERS=4
+GROUP_COUNT=8
+CHANGES=10
+SEND_INTERVAL=1 #milliseconds
+DWELL_TIME=1000 #milliseconds
+LEAVE_WAIT=5000 #milliseconds
+TIMEOUT=5000 #milliseconds
+PROTOCOL=IGMPv3
+GROUP=239.1.1.1
+EXTRA_CONFIG=
+OUTPUT=latency_results
+
+PREFIX=mcl
+SENDER_PIDS=
+MCPROXY_PID=
+
+usage() {
+    echo "##-- $0 measures the channel change latencies through the mcproxy --##"
+    echo "Usage: $0 [-h | help]"
+    echo "Usage: $0 [-m <mcproxy>] [-t <tester>] [-r <receivers>] [-g <groups>] [-n <changes>] [-i <send interval ms>]"
+    echo "          [-d <dwell time ms>] [-w <leave wait ms>] [-p IGMPv2 | IGMPv3] [-c <extra config>] [-o <output dir>]"
+    echo ""
+    echo "The extra config file is appended to the proxy configuration, its rule bindings refer to the"
+    echo "proxy instance \"latency\" with the upstream up0 and the downstreams dn0 .. dn<receivers - 1>, e.g.:"
+    echo "    pinstance latency upstream * out timer leaveholddown 5000;"
+    echo ""
+    echo "The result is printed as JSON and saved to <output dir>/result.json, the latencies of each"
+    echo "receiver are kept in <output dir>/join_leave_<n>.txt and <output dir>/zap_<n>.txt."
+}
+
+cleanup() {
+    for pid in $SENDER_PIDS $MCPROXY_PID; do
+        kill $pid 2>/dev/null
+    done
+    wait 2>/dev/null
+
+    ip netns del $PREFIX-src 2>/dev/null
+    ip netns del $PREFIX-proxy 2>/dev/null
+    for (( i=0; i<$RECEIVERS; i++ )); do
+        ip netns del $PREFIX-rcv$i 2>/dev/null
+    done
+}
+
+create_network() {
+    cleanup
+
+    ip netns add $PREFIX-src
+    ip netns add $PREFIX-proxy
+    ip netns exec $PREFIX-src ip link set lo up
+    ip netns exec $PREFIX-proxy ip link set lo up
+    ip netns exec $PREFIX-proxy sysctl -qw net.ipv4.conf.all.rp_filter=0
+
+    #sender ==> upstream
+    ip link add src0 type veth peer name up0
+    ip link set src0 netns $PREFIX-src
+    ip link set up0 netns $PREFIX-proxy
+    ip netns exec $PREFIX-src ip addr add 10.100.0.1/24 dev src0
+    ip netns exec $PREFIX-src ip link set src0 up
+    ip netns exec $PREFIX-proxy ip addr add 10.100.0.2/24 dev up0
+    ip netns exec $PREFIX-proxy ip link set up0 up
+
+    #downstreams ==> receivers
+    for (( i=0; i<$RECEIVERS; i++ )); do
+        ip netns add $PREFIX-rcv$i
+        ip netns exec $PREFIX-rcv$i ip link set lo up
+        ip link add dn$i type veth peer name rcv$i
+        ip link set dn$i netns $PREFIX-proxy
+        ip link set rcv$i netns $PREFIX-rcv$i
+        ip netns exec $PREFIX-proxy sysctl -qw net.ipv4.conf.dn$i.rp_filter=0
+        ip netns exec $PREFIX-proxy ip addr add 10.101.$i.1/24 dev dn$i
+        ip netns exec $PREFIX-proxy ip link set dn$i up
+        ip netns exec $PREFIX-rcv$i ip addr add 10.101.$i.2/24 dev rcv$i
+        ip netns exec $PREFIX-rcv$i ip link set rcv$i up
+        if [ "$PROTOCOL" = "IGMPv2" ]; then
+            ip netns exec $PREFIX-rcv$i sysctl -qw net.ipv4.conf.rcv$i.force_igmp_version=2
+        else
+            ip netns exec $PREFIX-rcv$i sysctl -qw net.ipv4.conf.rcv$i.force_igmp_version=3
+        fi
+    done
+}
+
+create_config() {
+    local downstreams=""
+    for (( i=0; i<$RECEIVERS; i++ )); do
+        downstreams="$downstreams dn$i"
+    done
+
+    echo "protocol $PROTOCOL;" > $OUTPUT/proxy.conf
+    echo "pinstance latency: up0 ==>$downstreams;" >> $OUTPUT/proxy.conf
+    if [ "$EXTRA_CONFIG" ]; then
+        cat $EXTRA_CONFIG >> $OUTPUT/proxy.conf
+    fi
+
+    : > $OUTPUT/tester.ini
+    local ip=(${GROUP//./ })
+    for (( g=0; g<$GROUP_COUNT; g++ )); do
+        cat >> $OUTPUT/tester.ini << EOF
+[send_$g]
+action=send
+interface=src0
+group=${ip[0]}.${ip[1]}.${ip[2]}.$((${ip[3]} + $g))
+include_time_stamp=true
+max_count=0
+send_interval=$SEND_INTERVAL
+print_status_msg=false
+ttl=10
+port=1234
+
+EOF
+    done
+
+    for (( i=0; i<$RECEIVERS; i++ )); do
+        for mode in join_leave zap; do
+            cat >> $OUTPUT/tester.ini << EOF
+[${mode}_$i]
+action=zap
+zap_mode=$mode
+interface=rcv$i
+group=$GROUP
+group_count=$GROUP_COUNT
+max_count=$CHANGES
+dwell_time=$DWELL_TIME
+leave_wait=$LEAVE_WAIT
+timeout=$TIMEOUT
+seed=$(($i + 1))
+save_to_file=true
+file_name=$OUTPUT/${mode}_$i.txt
+file_operation_mode=override
+
+EOF
+        done
+    done
+}
+
+#run the receivers of a phase in parallel
+run_phase() {
+    local pids=""
+    for (( i=0; i<$RECEIVERS; i++ )); do
+        ip netns exec $PREFIX-rcv$i $TESTER $1_$i -i $OUTPUT/tester.ini > $OUTPUT/$1_$i.log 2>&1 &
+        pids="$pids $!"
+    done
+    wait $pids
+}
+
+#print the latency percentiles of kind (join, leave, zap) as JSON object
+summarize() {
+    local kind=$1
+    shift
+    local timeouts=$(cat "$@" | grep -c "^$kind .* timeout$")
+    cat "$@" | awk -v kind=$kind '$1 == kind && $3 != "timeout" {print $3}' | sort -n | awk -v timeouts=$timeouts '
+        function percentile(p,    rank) {
+            rank = int(p * n)
+            if (rank < p * n) {
+                rank++
+            }
+            if (rank < 1) {
+                rank = 1
+            }
+            return v[rank] / 1000.0
+        }
+        { v[++n] = $1 }
+        END {
+            if (n == 0) {
+                printf("{\"count\": 0, \"timeouts\": %d}", timeouts)
+            } else {
+                printf("{\"count\": %d, \"timeouts\": %d, \"p50_ms\": %.3f, \"p99_ms\": %.3f, \"p999_ms\": %.3f, \"max_ms\": %.3f}", n, timeouts, percentile(0.5), percentile(0.99), percentile(0.999), v[n] / 1000.0)
+            }
+        }'
+}
+
+if [ "$1" = "-h" ] || [ "$1" = "help" ]; then
+    usage
+    exit 0
+fi
+
+while getopts "m:t:r:g:n:i:d:w:p:c:o:" opt; do
+    case $opt in
+    m) MCPROXY=$OPTARG ;;
+    t) TESTER=$OPTARG ;;
+    r) RECEIVERS=$OPTARG ;;
+    g) GROUP_COUNT=$OPTARG ;;
+    n) CHANGES=$OPTARG ;;
+    i) SEND_INTERVAL=$OPTARG ;;
+    d) DWELL_TIME=$OPTARG ;;
+    w) LEAVE_WAIT=$OPTARG ;;
+    p) PROTOCOL=$OPTARG ;;
+    c) EXTRA_CONFIG=$OPTARG ;;
+    o) OUTPUT=$OPTARG ;;
+    *) echo "$0: Wrong or missing arguments. See -h for more details."; exit 1 ;;
+    esac
+done
+
+if [ "$(id -u)" != "0" ]; then
+    echo "$0: root previleges required"
+    exit 1
+fi
+
+if [ ! -x "$MCPROXY" ] || [ ! -x "$TESTER" ]; then
+    echo "$0: mcproxy ($MCPROXY) or tester ($TESTER) not found, see -h for more details."
+    exit 1
+fi
+
+MCPROXY=$(readlink -f $MCPROXY)
+TESTER=$(readlink -f $TESTER)
+mkdir -p $OUTPUT
+OUTPUT=$(readlink -f $OUTPUT)
+
+trap cleanup EXIT
+create_network
+create_config
+
+echo "start mcproxy with $RECEIVERS downstreams"
+ip netns exec $PREFIX-proxy $MCPROXY -f $OUTPUT/proxy.conf > $OUTPUT/mcproxy.log 2>&1 &
+MCPROXY_PID=$!
+sleep 2
+
+echo "start $GROUP_COUNT senders"
+for (( g=0; g<$GROUP_COUNT; g++ )); do
+    ip netns exec $PREFIX-src $TESTER send_$g -i $OUTPUT/tester.ini > /dev/null 2>&1 &
+    SENDER_PIDS="$SENDER_PIDS $!"
+done
+sleep 1
+
+echo "join and leave $CHANGES times per receiver"
+run_phase join_leave
+
+echo "zap $CHANGES times per receiver"
+run_phase zap
+
+FILES="$OUTPUT/join_leave_*.txt $OUTPUT/zap_*.txt"
+cat > $OUTPUT/result.json << EOF
+{"protocol": "$PROTOCOL", "receivers": $RECEIVERS, "groups": $GROUP_COUNT, "changes": $CHANGES, "send_interval_ms": $SEND_INTERVAL, "join": $(summarize join $FILES), "leave": $(summarize leave $FILES), "zap": $(summarize zap $FILES)}
+EOF
+cat $OUTPUT/result.json
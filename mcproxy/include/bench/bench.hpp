@@ -0,0 +1,143 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "include/utils/addr_storage.hpp"
+#include "include/proxy/def.hpp"
+
+#include <memory>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+#include <sys/socket.h>
+
+#define BENCH_DEFAULT_GROUP_COUNT 1000
+#define BENCH_DEFAULT_SOURCE_COUNT 0
+#define BENCH_DEFAULT_LEAVE_SHARE 20 //percent
+#define BENCH_DEFAULT_RECORD_COUNT 100000
+
+class proxy_instance;
+class interfaces;
+class mfc_simulator;
+class timing;
+class virtual_clock;
+struct proxy_msg;
+struct group_record_msg;
+struct source;
+
+/**
+ * @brief Drives a synthetic stream of group records straight into the message handling of a proxy instance
+ * and reports the throughput, the latency percentiles of a record and the memory per group. Alternatively
+ * it replays a capture of a running proxy (see capture_file) against a simulated kernel.
+ */
+class bench
+{
+private:
+    std::string m_upstream;
+    std::string m_downstream;
+    group_mem_protocol m_group_mem_protocol;
+
+    unsigned int m_group_count;
+    unsigned int m_source_count; //source list size of a record, 0 = any source multicast
+    unsigned int m_leave_share;
+    unsigned long m_record_count;
+    std::default_random_engine m_random_engine;
+
+    //the forwarding rules are set in the simulator instead of the kernel and nothing is sent (no sockets)
+    bool m_simulated_kernel;
+
+    //protocol time of the record stream in a discrete event simulation, 0 = real time
+    unsigned int m_simulated_time; //sec
+    unsigned long m_timer_events;
+
+    //simulation only, the sources keep sending a packet per second
+    bool m_continuous_traffic;
+    unsigned long m_source_checks;
+
+    //group addresses and source lists of all groups
+    std::vector<addr_storage> m_gaddrs;
+    std::vector<source_list<source>> m_slists;
+
+    //replay of a capture file, empty = synthetic record stream
+    std::string m_capture_path;
+    std::string m_instance_name; //empty = first proxy instance of the capture
+    bool m_max_speed; //else at the original speed
+
+    //processing time of each record
+    std::vector<std::chrono::nanoseconds> m_latencies;
+
+    //fail if the records of the steady state allocate heap memory, the first half of the stream warms up
+    //the object pools and the second half is the steady state
+    bool m_check_allocations;
+
+    void help();
+    void run();
+    void replay();
+
+    //map the captured virtual interface of an upcall or the arrival interface of an MLD packet to the local if_index
+    void rewrite_packet(const interfaces& ifs, unsigned int if_index, unsigned char* data, size_t size, struct msghdr* msg) const;
+
+    //hash of the group memberships of all downstreams without their timers
+    uint64_t get_membership_digest(proxy_instance& pr_i, unsigned int& group_count) const;
+
+    //process a record and all messages it caused (timers), return the processing time of the record
+    std::chrono::nanoseconds process_record(proxy_instance& pr_i, const std::shared_ptr<group_record_msg>& msg);
+
+    //process all pending messages of the job queue (timers, received records), return the number of messages
+    unsigned long process_pending_msgs(proxy_instance& pr_i);
+
+    //simulation only, process all timer events up to the virtual time until
+    void advance(proxy_instance& pr_i, timing& t, virtual_clock& vclock, const std::chrono::milliseconds& duration);
+
+    std::shared_ptr<group_record_msg> get_record(unsigned int if_index, unsigned int group, bool join, bool state_change) const;
+    void init_groups();
+
+    //send a packet of each group to the upstream of the simulator, the upcalls create the forwarding rules
+    void send_traffic(proxy_instance& pr_i, mfc_simulator& ms, unsigned int upstream_if_index);
+
+    //simulation only, send a packet of each group for each second up to the virtual time, next_second is the
+    //virtual time of the next packets
+    void send_continuous_traffic(proxy_instance& pr_i, mfc_simulator& ms, unsigned int upstream_if_index, const virtual_clock& vclock, std::chrono::steady_clock::time_point& next_second);
+
+    //the source of the traffic of a group
+    addr_storage get_traffic_saddr(unsigned int group) const;
+
+    //allocated heap memory in bytes
+    static size_t get_heap_size();
+
+    //throughput and latency percentiles of the processed records or packets
+    void print_latencies(const std::string& unit, const std::chrono::nanoseconds& duration);
+    void print_results(const std::chrono::nanoseconds& duration, size_t heap_per_group);
+
+    //the reports and queries counted by the null_sender of the simulation
+    void print_sent_packets(proxy_instance& pr_i) const;
+
+public:
+    bench(int arg_count, char* args[]);
+};
+
+#endif // BENCH_HPP
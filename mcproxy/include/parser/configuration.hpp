@@ -50,16 +50,33 @@ private:
     std::vector<std::pair<unsigned int, std::string>> separate_commands(std::string&& script_file);
 
     void run_parser();
-    void initalize_interfaces();
+
+    void add_interfaces(interfaces& ifs, const instance_definition& inst) const;
+
+    //checks the interfaces of all proxy instances on separate interfaces objects
+    void check_interfaces() const;
 
     std::map<std::string, std::shared_ptr<interfaces>> m_interfaces_map;
 
 public:
-    configuration(const std::string& path, bool reset_reverse_path_filter);
+    /**
+     * @param path Path of the configuration file.
+     * @param reset_reverse_path_filter Reset the reverse path filter of all used interfaces.
+     * @param running_configuration If set (configuration reload) the interfaces are only checked, the
+     *        running interfaces are not changed before initalize_interfaces() is called.
+     */
+    configuration(const std::string& path, bool reset_reverse_path_filter, const configuration* running_configuration = nullptr);
+
+    /**
+     * @brief Add the interfaces of the proxy instances. The interfaces of proxy instances which are
+     *        already defined in the running configuration are taken over, to keep their virtual interface indexes.
+     */
+    void initalize_interfaces(const configuration* running_configuration);
 
-    const std::shared_ptr<const interfaces> get_interfaces_for_pinstance(const std::string& instance_name) const;
+    const std::shared_ptr<interfaces> get_interfaces_for_pinstance(const std::string& instance_name) const;
     group_mem_protocol get_group_mem_protocol() const;
     const inst_def_set& get_inst_def_set() const;
+    const std::shared_ptr<global_table_set>& get_global_table_set() const;
 
     std::string to_string() const;
 
@@ -122,7 +122,7 @@ public:
 };
 
 enum rb_type {
-    RBT_FILTER, RBT_RULE_MATCHING, RBT_TIMER_VALUE
+    RBT_FILTER, RBT_RULE_MATCHING, RBT_TIMER_VALUE, RBT_PREJOIN
 };
 
 enum rb_interface_type {
@@ -138,9 +138,16 @@ enum rb_filter_type {
 };
 
 enum rb_rule_matching_type {
-    RMT_ALL, RMT_FIRST, RMT_MUTEX, RMT_UNDEFINED
+    RMT_ALL, RMT_FIRST, RMT_MUTEX, RMT_HASH, RMT_UNDEFINED
 };
 
+enum rb_timer_value_type {
+    TVT_REPORT_COALESCING, TVT_GENERAL_QUERY_PHASE, TVT_GENERAL_QUERY_JITTER, TVT_EXPLICIT_TRACKING, TVT_LEAVE_HOLD_DOWN, TVT_UNDEFINED
+};
+
+std::string get_rb_timer_value_type_name(rb_timer_value_type timer_value_type);
+rb_timer_value_type get_rb_timer_value_type(const std::string& timer_value_name);
+
 class rule_binding
 {
 private:
@@ -158,12 +165,24 @@ private:
     rb_rule_matching_type m_rule_matching_type;
     std::chrono::milliseconds m_timeout;
 
+    //RBT_TIMER_VALUE
+    rb_timer_value_type m_timer_value_type;
+    std::chrono::milliseconds m_timer_value;
+
+    //RBT_PREJOIN
+    std::list<std::pair<addr_storage, addr_storage>> m_prejoins; //group, source (undefined for any source)
+    unsigned int m_predictive_groups;
+
     std::string to_string_table_filter() const;
     std::string to_string_rule_matching() const;
+    std::string to_string_timer_value() const;
+    std::string to_string_prejoin() const;
 
 public:
     rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_filter_type filter_type, std::unique_ptr<table> filter_table);
     rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_rule_matching_type rule_matching_type, const std::chrono::milliseconds& timeout);
+    rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_timer_value_type timer_value_type, const std::chrono::milliseconds& timer_value);
+    rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, std::list<std::pair<addr_storage, addr_storage>>&& prejoins, unsigned int predictive_groups);
 
     rb_type get_rule_binding_type() const;
     const std::string& get_instance_name() const;
@@ -180,6 +199,14 @@ public:
     rb_rule_matching_type get_rule_matching_type() const;
     std::chrono::milliseconds get_timeout() const;
 
+    //RBT_TIMER_VALUE
+    rb_timer_value_type get_timer_value_type() const;
+    std::chrono::milliseconds get_timer_value() const;
+
+    //RBT_PREJOIN
+    const std::list<std::pair<addr_storage, addr_storage>>& get_prejoins() const;
+    unsigned int get_predictive_groups() const;
+
     std::string to_string() const;
 };
 
@@ -45,6 +45,7 @@ private:
     int m_current_line;
 
     void get_next_token();
+    void get_next_context_token();
 
     std::unique_ptr<rule_box> parse_rule(const std::shared_ptr<const global_table_set>& gts, group_mem_protocol gmp);
     std::unique_ptr<addr_match> parse_rule_part(group_mem_protocol gmp);
@@ -55,6 +56,8 @@ private:
     void parse_interface_table_binding(std::string&& instance_name, rb_interface_type interface_type, std::string&& if_name, rb_interface_direction filter_direction, const std::shared_ptr<const global_table_set>& gts, group_mem_protocol gmp, const inst_def_set& ids);
 
     void parse_interface_rule_match_binding(std::string&& instance_name, rb_interface_type interface_type, std::string&& if_name, rb_interface_direction filter_direction, const inst_def_set& ids);
+    void parse_interface_timer_value_binding(std::string&& instance_name, rb_interface_type interface_type, std::string&& if_name, rb_interface_direction filter_direction, const inst_def_set& ids);
+    void parse_interface_prejoin_binding(std::string&& instance_name, rb_interface_type interface_type, std::string&& if_name, rb_interface_direction filter_direction, group_mem_protocol gmp, const inst_def_set& ids);
 
 public:
     parser(unsigned int current_line, const std::string& cmd);
@@ -48,7 +48,10 @@ enum token_type {
     TT_ALL,
     TT_FIRST,
     TT_MUTEX,
+    TT_HASH,
     TT_DISABLE,
+    TT_TIMER,
+    TT_PREJOIN,
     //TT_PATH, //@path@
     TT_LEFT_BRACE, //"{"
     TT_RIGHT_BRACE, //"}"
@@ -0,0 +1,125 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_receiver Receiver
+ * @{
+ */
+
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include "include/proxy/def.hpp"
+
+#include <string>
+#include <list>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <fstream>
+
+#include <sys/socket.h>
+
+//first bytes of a capture file
+#define CAPTURE_MAGIC "MCPC"
+#define CAPTURE_VERSION 1
+
+//the buffered records are written at least this often
+#define CAPTURE_FLUSH_INTERVAL 1000 //msec
+
+enum capture_record_type {CRT_INTERFACE = 1, CRT_PACKET = 2};
+
+/**
+ * @brief An upstream or downstream of a proxy instance, the packets refer to it by the interface index.
+ */
+struct capture_interface {
+    std::chrono::nanoseconds time_stamp; //since the start of the capture
+    std::string instance_name;
+    group_mem_protocol protocol;
+    std::string if_name;
+    unsigned int if_index;
+    int vif;
+    bool upstream;
+    unsigned int upstream_priority;
+};
+
+/**
+ * @brief A received group membership message or kernel upcall as passed to receiver::analyse_packet().
+ */
+struct capture_packet {
+    std::chrono::nanoseconds time_stamp; //since the start of the capture
+    unsigned int if_index; //0 if unknown
+    std::string name; //sender address (msg_name)
+    std::string control; //ancillary data (msg_control)
+    std::string data; //packet or upcall
+};
+
+/**
+ * @brief Records the raw group membership messages and kernel upcalls of the receivers to reproduce
+ * the real report mixes of a proxy (replayed by the bench).
+ *
+ * The file format is a compact binary encoding in host byte order: a header (magic, version, time stamp
+ * of the start) followed by records with a type and a time stamp, the interfaces of the proxy instances
+ * are recorded when they are added.
+ */
+class capture_file
+{
+private:
+    std::mutex m_lock;
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last_flush;
+
+    std::list<capture_interface> m_interfaces;
+    std::vector<capture_packet> m_packets;
+
+    std::chrono::nanoseconds get_time_stamp() const;
+    void write(const std::string& buf);
+
+public:
+    capture_file();
+    ~capture_file();
+
+    /**
+     * @brief Create the capture file path and start the recording.
+     */
+    bool open(const std::string& path);
+
+    void write_interface(const std::string& instance_name, group_mem_protocol protocol, unsigned int if_index, int vif, bool upstream, unsigned int upstream_priority);
+
+    /**
+     * @param if_index interface the message is received on, 0 if unknown
+     * @param info_size received bytes of the message
+     */
+    void write_packet(unsigned int if_index, const struct msghdr* msg, int info_size);
+
+    /**
+     * @brief Read all records of the capture file path.
+     */
+    bool load(const std::string& path);
+
+    const std::list<capture_interface>& get_interfaces() const;
+    const std::vector<capture_packet>& get_packets() const;
+};
+
+#endif // CAPTURE_HPP
+/** @} */
@@ -23,6 +23,8 @@
 #ifndef DEF_HPP
 #define DEF_HPP
 
+#include "include/utils/object_pool.hpp"
+
 #include <netinet/in.h>
 
 #include <map>
@@ -54,7 +56,8 @@ std::string time_to_string(const std::chrono::milliseconds& msec);
 //------------------------------------------------------------------------
 std::string indention(std::string str);
 //------------------------------------------------------------------------
-template<typename T> using source_list = std::set<T>;
+//source lists are copied and combined for each record, so their nodes are pooled
+template<typename T> using source_list = pooled_set<T>;
 
 //A+B means the union of set A and B
 template<typename T>
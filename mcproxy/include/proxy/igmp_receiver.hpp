@@ -50,12 +50,15 @@ private:
     int get_ctrl_min_size() override;
     int get_iov_min_size() override;
     void analyse_packet(struct msghdr* msg, int info_size) override;
+    unsigned int get_packet_if_index(struct msghdr* msg) override;
 
 public:
     /**
      * @brief Create an igmp_receiver.
      */
-    igmp_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock,const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode);
+    igmp_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock,const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode, const std::shared_ptr<receive_loop>& shared_receive_loop = nullptr);
+
+    virtual ~igmp_receiver();
 };
 
 #endif // IGMP_RECEIVER_HPP
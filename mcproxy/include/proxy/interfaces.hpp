@@ -30,6 +30,8 @@
 #include <map>
 #include <vector>
 #include <sstream>
+#include <mutex>
+#include <atomic>
 
 class addr_storage;
 
@@ -52,6 +54,12 @@ private:
     std::map<int, unsigned int> m_vif_if;
     std::map<unsigned int, int> m_if_vif;
 
+    //the interfaces can be changed by a configuration reload while the receivers read them
+    mutable std::mutex m_global_lock;
+
+    //incremented on each refresh, lets the users of the interface addresses invalidate their cached copies
+    std::atomic<unsigned int> m_refresh_count;
+
     int get_free_vif_number() const;
 
     //flags example: IFF_UP IFF_LOOPBACK IFF_POINTOPOINT IFF_RUNNING IFF_ALLMULTI
@@ -62,6 +70,7 @@ public:
     ~interfaces();
 
     bool refresh_network_interfaces();
+    unsigned int get_refresh_count() const;
 
     bool add_interface(const std::string& if_name);
     bool add_interface(unsigned int if_index);
@@ -33,6 +33,25 @@
 #include <map>
 #include <chrono>
 #include <memory>
+#include <vector>
+
+//compact address of a reporting host or a source of a host (explicit tracking), IPv4 addresses use the first word only
+using host_key = std::pair<uint64_t, uint64_t>;
+host_key get_host_key(const addr_storage& addr);
+
+/**
+ * @brief Membership state of one reporting host (explicit tracking).
+ */
+struct host_info {
+    host_info();
+
+    mc_filter filter_mode;
+    std::vector<host_key> slist; //sorted
+    timer_clock::time_point expiry;
+
+    //return true if the host wants to receive traffic of the source s
+    bool is_interested(const host_key& s) const;
+};
 
 struct gaddr_info {
     gaddr_info(group_mem_protocol compatibility_mode_variable);
@@ -42,7 +61,14 @@ struct gaddr_info {
     gaddr_info& operator=(gaddr_info && ) = default;
 
     mc_filter filter_mode;
-    std::shared_ptr<filter_timer_msg> shared_filter_timer;
+
+    //the filter timer and the source timers (include_requested_list) are deadlines, they share one
+    //wake-up at the earliest deadline which is armed again for the next deadline when it expires
+    timer_clock::time_point filter_timer;
+
+    //expiry and generation of the armed wake-up (group_timer_msg), a wake-up of another generation is outdated
+    timer_clock::time_point group_timer;
+    unsigned long group_timer_generation;
 
     group_mem_protocol compatibility_mode_variable; //RFC3810 - 8.3.2. In the Presence of MLDv1 Multicast Address Listeners
    
@@ -51,23 +77,69 @@ struct gaddr_info {
     //if comp_mode var is not the highest version the compability mode is activated
     std::shared_ptr<older_host_present_timer_msg> older_host_present_timer; 
 
-    std::shared_ptr<retransmit_group_timer_msg> group_retransmission_timer;
+    //query round of the next multicast address specific query retransmission
+    std::shared_ptr<query_round_timer_msg> group_retransmission_timer;
     int group_retransmission_count;
 
-    std::shared_ptr<retransmit_source_timer_msg> source_retransmission_timer; //runs as long as a source in include_requested_list has an retransmission timer greater than zero
+    //query round of the next multicast address and source specific query retransmission,
+    //set as long as a source in include_requested_list has an retransmission timer greater than zero
+    std::shared_ptr<query_round_timer_msg> source_retransmission_timer;
 
     source_list<source> include_requested_list;
     source_list<source> exclude_list;
 
+    //the reporting hosts and their state (explicit tracking), expired hosts are deleted on the next update
+    std::map<host_key, host_info> tracked_hosts;
+
+    //a host reported without an address (unspecified source), the tracked hosts are incomplete until this deadline
+    timer_clock::time_point untracked_host_timer;
+
+    //update the state of the host by a received record, the host state is valid until expiry
+    void track_host(const host_key& host, mcast_addr_record_type record_type, const source_list<source>& slist, const timer_clock::time_point& expiry);
+
+    //return true if a tracked host wants to receive traffic of the group, of the source s
+    bool has_tracked_interest() const;
+    bool has_tracked_interest(const source& s) const;
+
+    //returns the earliest deadline of the filter timer and the source timers
+    timer_clock::time_point get_next_deadline() const;
+
     bool is_in_backward_compatibility_mode() const;
     bool is_under_bakcward_compatibility_effects() const; 
     std::string to_string() const;
     friend std::ostream& operator<<(std::ostream& stream, const gaddr_info& g);
 };
 
-using gaddr_map = std::map<addr_storage, gaddr_info>;
+using gaddr_map = pooled_map<addr_storage, gaddr_info>;
 using gaddr_pair = std::pair<addr_storage, gaddr_info>;
 
+/**
+ * @brief Change of the membership state of a group on a downstream, reported by the querier to the routing.
+ * The new source list is (old source list - removed_sources) + added_sources, if the filter mode changes
+ * the whole old source list is removed and the whole new one is added.
+ */
+struct membership_delta {
+    membership_delta(mc_filter old_filter_mode, mc_filter new_filter_mode);
+
+    mc_filter old_filter_mode;
+    mc_filter new_filter_mode;
+    source_list<source> added_sources;
+    source_list<source> removed_sources;
+};
+
+/**
+ * @brief All pending retransmissions of multicast address (and source) specific queries of an interface
+ * share one timer per round instead of one timer per group.
+ */
+struct query_round {
+    std::shared_ptr<query_round_timer_msg> round_timer;
+    pooled_set<addr_storage> group_queries;
+    pooled_set<addr_storage> source_queries;
+
+    bool empty() const;
+    std::string to_string() const;
+};
+
 /**
  * @brief The Membership Database maintaines the membership records for one specific interface (RFC 4605)
  */
@@ -81,6 +153,9 @@ struct membership_db {
     std::shared_ptr<general_query_timer_msg> general_query_timer;
     int startup_query_count;
 
+    query_round current_query_round; //armed
+    query_round next_query_round; //armed when the current round expires
+
     group_mem_protocol querier_version_mode; 
     bool is_querier;
     gaddr_map group_info; //subscribed multicast group with their source lists
@@ -33,29 +33,36 @@
 #include "include/proxy/interfaces.hpp"
 #include "include/proxy/timers_values.hpp"
 #include "include/parser/interface.hpp"
+#include "include/proxy/snapshot.hpp"
+#include "include/proxy/timer_clock.hpp"
+#include "include/utils/object_pool.hpp"
 
 #include <iostream>
 #include <string>
 #include <map>
 #include <memory>
 #include <chrono>
+#include <future>
 
 struct proxy_msg {
     enum message_type {
         INIT_MSG,
         TEST_MSG,
         EXIT_MSG,
-        FILTER_TIMER_MSG,
-        SOURCE_TIMER_MSG,
+        GROUP_TIMER_MSG, //earliest deadline of the filter and source timers of a group
         NEW_SOURCE_MSG,
         NEW_SOURCE_TIMER_MSG,
-        RET_GROUP_TIMER_MSG, //retransmission group timer message
-        RET_SOURCE_TIMER_MSG,
+        QUERY_ROUND_TIMER_MSG, //retransmission round of multicast address (and source) specific queries
         OLDER_HOST_PRESENT_TIMER_MSG,
         GENERAL_QUERY_TIMER_MSG,
+        UPSTREAM_REPORT_TIMER_MSG,
+        LEAVE_HOLD_DOWN_TIMER_MSG, //end of the hold-down of an upstream leave
+        PREJOIN_TIMER_MSG, //recalculate the predicted prejoins
         CONFIG_MSG,
         GROUP_RECORD_MSG,
-        DEBUG_MSG
+        DEBUG_MSG,
+        SNAPSHOT_MSG, //collect the membership state for a warm restart
+        RESTORE_SNAPSHOT_MSG //take over the membership state of the last run
     };
 
     enum message_priority {
@@ -69,17 +76,20 @@ struct proxy_msg {
             {INIT_MSG,             "INIT_MSG"            },
             {TEST_MSG,             "TEST_MSG"            },
             {EXIT_MSG,             "EXIT_MSG"            },
-            {FILTER_TIMER_MSG,     "FILTER_TIMER_MSG"    },
-            {SOURCE_TIMER_MSG,     "SOURCE_TIMER_MSG"    },
+            {GROUP_TIMER_MSG,      "GROUP_TIMER_MSG"     },
             {NEW_SOURCE_MSG,       "NEW_SOURCE_MSG"      },
             {NEW_SOURCE_TIMER_MSG, "NEW_SOURCE_TIMER_MSG"},
-            {RET_GROUP_TIMER_MSG,  "RET_GROUP_TIMER_MSG" },
-            {RET_SOURCE_TIMER_MSG, "RET_SOURCE_TIMER_MSG"},
+            {QUERY_ROUND_TIMER_MSG,        "QUERY_ROUND_TIMER_MSG"       },
             {OLDER_HOST_PRESENT_TIMER_MSG, "OLDER_HOST_PRESENT_TIMER_MSG"},
             {GENERAL_QUERY_TIMER_MSG,      "GENERAL_QUERY_TIMER_MSG"     },
+            {UPSTREAM_REPORT_TIMER_MSG,    "UPSTREAM_REPORT_TIMER_MSG"   },
+            {LEAVE_HOLD_DOWN_TIMER_MSG,    "LEAVE_HOLD_DOWN_TIMER_MSG"   },
+            {PREJOIN_TIMER_MSG,    "PREJOIN_TIMER_MSG"   },
             {CONFIG_MSG,           "CONFIG_MSG"          },
             {GROUP_RECORD_MSG,     "GROUP_RECORD_MSG"    },
-            {DEBUG_MSG,            "DEBUG_MSG"           }
+            {DEBUG_MSG,            "DEBUG_MSG"           },
+            {SNAPSHOT_MSG,         "SNAPSHOT_MSG"        },
+            {RESTORE_SNAPSHOT_MSG, "RESTORE_SNAPSHOT_MSG"}
         };
         return name_map[mt];
     }
@@ -133,6 +143,16 @@ protected:
     message_priority m_prio;
 };
 
+/**
+ * @brief Create a message of a frequent type (group records, new sources, timers) in the object pool of its type,
+ * the message and its reference counter need no heap allocation.
+ */
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled_msg(Args&&... args)
+{
+    return std::allocate_shared<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
 struct comp_proxy_msg {
     bool operator()(const std::shared_ptr<proxy_msg>& l, const std::shared_ptr<proxy_msg>& r) const {
         return *l > *r;
@@ -166,7 +186,7 @@ struct timer_msg : public proxy_msg {
         : proxy_msg(type, SYSTEMIC)
         , m_if_index(if_index)
         , m_gaddr(gaddr)
-        , m_end_time(std::chrono::steady_clock::now() + duration) {
+        , m_end_time(timer_clock::now() + duration) {
         HC_LOG_TRACE("");
     }
 
@@ -179,80 +199,87 @@ struct timer_msg : public proxy_msg {
     }
 
     bool is_remaining_time_greater_than(std::chrono::milliseconds comp_time) {
-        return (std::chrono::steady_clock::now() + comp_time) <= m_end_time;
+        return (timer_clock::now() + comp_time) <= m_end_time;
+    }
+
+    std::chrono::milliseconds get_remaining_duration() {
+        return timer_clock::get_remaining_duration(m_end_time);
     }
 
     std::string get_remaining_time() {
-        using namespace std::chrono;
-        std::ostringstream s;
-        auto current_time = steady_clock::now();
-        auto time_span = m_end_time - current_time;
-        double seconds = time_span.count()  * steady_clock::period::num / steady_clock::period::den;
-        if (seconds >= 0) {
-            s << seconds << "sec";
-        } else {
-            s << "0sec";
-        }
-        return s.str();
+        return timer_clock::get_remaining_time(m_end_time);
+    }
+
+    const timer_clock::time_point& get_end_time() const {
+        return m_end_time;
     }
 
 private:
     unsigned int m_if_index;
     addr_storage m_gaddr;
-    std::chrono::time_point<std::chrono::steady_clock> m_end_time;
+    timer_clock::time_point m_end_time;
 };
 
-struct filter_timer_msg : public timer_msg {
-    filter_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(FILTER_TIMER_MSG, if_index, gaddr, duration), m_is_used_as_source_timer(false) {
+struct group_timer_msg : public timer_msg {
+    group_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration, unsigned long generation)
+        : timer_msg(GROUP_TIMER_MSG, if_index, gaddr, duration)
+        , m_generation(generation) {
         HC_LOG_TRACE("");
     }
 
-    bool is_used_as_source_timer() {
-        return m_is_used_as_source_timer;
-    }
-
-    void set_as_source_timer() {
-        m_is_used_as_source_timer = true;
+    unsigned long get_generation() {
+        return m_generation;
     }
 
 private:
-    bool m_is_used_as_source_timer;
+    unsigned long m_generation;
 };
 
-struct source_timer_msg : public timer_msg {
-    source_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(SOURCE_TIMER_MSG, if_index, gaddr, duration) {
+struct query_round_timer_msg : public timer_msg {
+    query_round_timer_msg(unsigned int if_index, std::chrono::milliseconds duration): timer_msg(QUERY_ROUND_TIMER_MSG, if_index, addr_storage(), duration) {
         HC_LOG_TRACE("");
     }
 };
 
-struct retransmit_group_timer_msg : public timer_msg {
-    retransmit_group_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(RET_GROUP_TIMER_MSG, if_index, gaddr, duration) {
+struct older_host_present_timer_msg : public timer_msg {
+    older_host_present_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(OLDER_HOST_PRESENT_TIMER_MSG, if_index, gaddr, duration) {
         HC_LOG_TRACE("");
     }
 };
 
-struct retransmit_source_timer_msg : public timer_msg {
-    retransmit_source_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(RET_SOURCE_TIMER_MSG, if_index, gaddr, duration) {
+struct general_query_timer_msg : public timer_msg {
+    general_query_timer_msg(unsigned int if_index, std::chrono::milliseconds duration): timer_msg(GENERAL_QUERY_TIMER_MSG, if_index, addr_storage(), duration) {
         HC_LOG_TRACE("");
     }
 };
 
-struct older_host_present_timer_msg : public timer_msg {
-    older_host_present_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(OLDER_HOST_PRESENT_TIMER_MSG, if_index, gaddr, duration) {
+struct upstream_report_timer_msg : public timer_msg {
+    upstream_report_timer_msg(unsigned int if_index, std::chrono::milliseconds duration): timer_msg(UPSTREAM_REPORT_TIMER_MSG, if_index, addr_storage(), duration) {
         HC_LOG_TRACE("");
     }
 };
 
-struct general_query_timer_msg : public timer_msg {
-    general_query_timer_msg(unsigned int if_index, std::chrono::milliseconds duration): timer_msg(GENERAL_QUERY_TIMER_MSG, if_index, addr_storage(), duration) {
+struct leave_hold_down_timer_msg : public timer_msg {
+    leave_hold_down_timer_msg(unsigned int if_index, const addr_storage& gaddr, std::chrono::milliseconds duration): timer_msg(LEAVE_HOLD_DOWN_TIMER_MSG, if_index, gaddr, duration) {
+        HC_LOG_TRACE("");
+    }
+};
+
+struct prejoin_timer_msg : public timer_msg {
+    prejoin_timer_msg(std::chrono::milliseconds duration): timer_msg(PREJOIN_TIMER_MSG, 0, addr_storage(), duration) {
         HC_LOG_TRACE("");
     }
 };
 
+struct source;
+
 struct new_source_timer_msg : public timer_msg {
-    new_source_timer_msg(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr, std::chrono::milliseconds duration)
+    new_source_timer_msg(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr, std::chrono::milliseconds duration, double packet_rate = 0)
         : timer_msg(NEW_SOURCE_TIMER_MSG, if_index, gaddr, duration)
-        , m_saddr(saddr)  {
+        , m_saddr(saddr)
+        , m_life_time(duration)
+        , m_packet_rate(packet_rate)
+        , m_source(nullptr) {
         HC_LOG_TRACE("");
     }
 
@@ -261,8 +288,31 @@ struct new_source_timer_msg : public timer_msg {
         return m_saddr;
     }
 
+    //the check interval of the source
+    const std::chrono::milliseconds& get_life_time() const {
+        return m_life_time;
+    }
+
+    //packets per second of the source during the previous check interval
+    double get_packet_rate() const {
+        return m_packet_rate;
+    }
+
+    //the source of the routing data checked by this timer (set by simple_routing_data),
+    //nullptr if the source is deleted or the timer is replaced
+    const source* get_source() const {
+        return m_source;
+    }
+
+    void set_source(const source* s) {
+        m_source = s;
+    }
+
 private:
     addr_storage m_saddr;
+    std::chrono::milliseconds m_life_time;
+    double m_packet_rate;
+    const source* m_source;
 };
 
 //------------------------------------------------------------------------
@@ -273,6 +323,38 @@ struct debug_msg : public proxy_msg {
     }
 };
 
+struct snapshot_msg : public proxy_msg {
+    snapshot_msg(): proxy_msg(SNAPSHOT_MSG, SYSTEMIC) {
+        HC_LOG_TRACE("");
+    }
+
+    std::future<snapshot_instance> get_future() {
+        return m_promise.get_future();
+    }
+
+    void set_snapshot_instance(snapshot_instance&& instance) {
+        m_promise.set_value(std::move(instance));
+    }
+
+private:
+    std::promise<snapshot_instance> m_promise;
+};
+
+struct restore_snapshot_msg : public proxy_msg {
+    restore_snapshot_msg(const snapshot_instance& instance)
+        : proxy_msg(RESTORE_SNAPSHOT_MSG, SYSTEMIC)
+        , m_instance(instance) {
+        HC_LOG_TRACE("");
+    }
+
+    const snapshot_instance& get_snapshot_instance() {
+        return m_instance;
+    }
+
+private:
+    snapshot_instance m_instance;
+};
+
 //------------------------------------------------------------------------
 
 struct source {
@@ -285,6 +367,7 @@ struct source {
 
     source(const addr_storage& saddr)
         : saddr(saddr)
+        , source_timer(timer_clock::not_running())
         , shared_source_timer(nullptr)
         , retransmission_count(-1) { /*not in a retransmission state*/
     }
@@ -292,8 +375,10 @@ struct source {
     std::string to_string() const {
         std::ostringstream s;
         s << saddr;
-        if ((shared_source_timer.get() != nullptr) && (retransmission_count >= 0)) {
-            s << "(" << shared_source_timer->get_remaining_time() << "," << retransmission_count << "x)";
+        if ((source_timer != timer_clock::not_running()) && (retransmission_count >= 0)) {
+            s << "(" << timer_clock::get_remaining_time(source_timer) << "," << retransmission_count << "x)";
+        } else if (source_timer != timer_clock::not_running()) {
+            s << "(" << timer_clock::get_remaining_time(source_timer) << ")";
         } else if (shared_source_timer.get() != nullptr) {
             s << "(" << shared_source_timer->get_remaining_time() << ")";
         } else if (retransmission_count >= 0) {
@@ -316,6 +401,11 @@ struct source {
     }
 
     addr_storage saddr;
+
+    //deadline of the source timer of a membership record (querier)
+    mutable timer_clock::time_point source_timer;
+
+    //timer of a source of the routing data (new source timer)
     mutable std::shared_ptr<timer_msg> shared_source_timer;
     mutable long retransmission_count;
 };
@@ -324,13 +414,15 @@ struct group_record_msg : public proxy_msg {
     //group_record_msg()
     //: group_record_msg(0, MODE_IS_INCLUDE, addr_storage(), source_list<source>(), IGMPv3) {}
 
-    group_record_msg(unsigned int if_index, mcast_addr_record_type record_type, const addr_storage& gaddr, source_list<source>&& slist, group_mem_protocol grp_mem_proto)
+    //host_addr is the address of the reporting host (explicit tracking), it is not set for generated records
+    group_record_msg(unsigned int if_index, mcast_addr_record_type record_type, const addr_storage& gaddr, source_list<source>&& slist, group_mem_protocol grp_mem_proto, const addr_storage& host_addr = addr_storage())
         : proxy_msg(GROUP_RECORD_MSG, LOSEABLE)
         , m_if_index(if_index)
         , m_record_type(record_type)
         , m_gaddr(gaddr)
-        , m_slist(slist)
-        , m_grp_mem_proto(grp_mem_proto){}
+        , m_slist(std::move(slist))
+        , m_grp_mem_proto(grp_mem_proto)
+        , m_host_addr(host_addr) {}
 
     friend std::ostream& operator<<(std::ostream& stream, const group_record_msg& r) {
         return stream << r.to_string();
@@ -344,6 +436,9 @@ struct group_record_msg : public proxy_msg {
         s << "group address: " << m_gaddr << std::endl;
         s << "source list: " << m_slist << std::endl;
         s << "report version: " << get_group_mem_protocol_name(m_grp_mem_proto);
+        if (m_host_addr.is_valid()) {
+            s << std::endl << "host address: " << m_host_addr;
+        }
         return s.str();
     }
 
@@ -367,12 +462,17 @@ struct group_record_msg : public proxy_msg {
         return m_grp_mem_proto;
     }
 
+    const addr_storage& get_host_addr() {
+        return m_host_addr;
+    }
+
 private:
     unsigned int m_if_index;
     mcast_addr_record_type m_record_type;
     addr_storage m_gaddr;
     source_list<source> m_slist;
     group_mem_protocol m_grp_mem_proto;
+    addr_storage m_host_addr;
 };
 
 struct new_source_msg : public proxy_msg {
@@ -409,7 +509,12 @@ struct config_msg : public proxy_msg {
         DEL_DOWNSTREAM,
         ADD_UPSTREAM,
         DEL_UPSTREAM,
-        SET_GLOBAL_RULE_BINDING
+        SET_GLOBAL_RULE_BINDING,
+        SET_DOWNSTREAM, //replace the rule bindings of a downstream (configuration reload)
+        SET_UPSTREAM, //replace the rule bindings and the priority of an upstream (configuration reload)
+        RESET_GLOBAL_RULE_BINDINGS, //restore the default global rule bindings (configuration reload)
+        REFRESH_ROUTING, //recalculate routes and upstream memberships after a configuration change
+        TAKEOVER_KERNEL_ROUTES //register the forwarding rules kept in the kernel table by a previous run
     };
 
     config_msg(config_instruction instruction, unsigned int if_index, unsigned int upstream_priority, const std::shared_ptr<interface>& interf)
@@ -419,7 +524,7 @@ struct config_msg : public proxy_msg {
         , m_upstream_priority(upstream_priority)
         , m_interface(interf)
         , m_tv(timers_values()) {
-        if (instruction != DEL_DOWNSTREAM && instruction != ADD_UPSTREAM && instruction != DEL_UPSTREAM) {
+        if (instruction != DEL_DOWNSTREAM && instruction != ADD_UPSTREAM && instruction != DEL_UPSTREAM && instruction != SET_UPSTREAM) {
             HC_LOG_ERROR("config_msg is incomplet, missing parameter timer_values");
             throw "config_msg is incomplet, missing parameter timer_values";
         }
@@ -441,6 +546,16 @@ struct config_msg : public proxy_msg {
         HC_LOG_TRACE("");
     }
 
+    config_msg(config_instruction instruction)
+        : proxy_msg(CONFIG_MSG, SYSTEMIC)
+        , m_instruction(instruction) {
+        HC_LOG_TRACE("");
+        if (instruction != RESET_GLOBAL_RULE_BINDINGS && instruction != REFRESH_ROUTING && instruction != TAKEOVER_KERNEL_ROUTES) {
+            HC_LOG_ERROR("config_msg is incomplet, missing parameters");
+            throw "config_msg is incomplet, missing parameters";
+        }
+    }
+
     config_instruction get_instruction() {
         return m_instruction;
     }
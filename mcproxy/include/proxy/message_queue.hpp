@@ -39,15 +39,35 @@
 
 /**
  * @brief Fixed sized synchronised priority job queue.
+ * Elements of the same priority are dequeued in the order of their insertion.
  */
 template<typename T, typename Compare = std::less<T>>
 class message_queue
 {
 private:
-    std::priority_queue<T, std::vector<T>, Compare> m_q;
+    using entry = std::pair<T, unsigned long long>;
+
+    struct entry_compare {
+        entry_compare(Compare compare): m_compare(compare) {}
+
+        bool operator()(const entry& l, const entry& r) const {
+            if (m_compare(l.first, r.first)) {
+                return true;
+            } else if (m_compare(r.first, l.first)) {
+                return false;
+            } else {
+                return l.second > r.second;
+            }
+        }
+
+        Compare m_compare;
+    };
+
+    std::priority_queue<entry, std::vector<entry>, entry_compare> m_q;
+    unsigned long long m_sequence;
     unsigned int m_size;
 
-    std::mutex m_global_lock;
+    mutable std::mutex m_global_lock;
     std::condition_variable cond_empty;
 
 public:
@@ -86,11 +106,18 @@ public:
      * @brief get and el element on head and wait if empty.
      */
     T dequeue(void);
+
+    /**
+     * @brief Get an element on head without waiting.
+     * @return Return false if the queue is empty.
+     */
+    bool try_dequeue(T& t);
 };
 
 template<typename T, typename Compare>
 message_queue<T, Compare>::message_queue(int size, Compare compare)
-    : m_q(compare)
+    : m_q(entry_compare(compare))
+    , m_sequence(0)
     , m_size(size)
 {
     HC_LOG_TRACE("");
@@ -132,7 +159,7 @@ bool message_queue<T, Compare>::enqueue_loseable(const T& t)
     {
         std::unique_lock<std::mutex> lock(m_global_lock);
         if (m_q.size() < m_size) {
-            m_q.push(t);
+            m_q.push(entry(t, m_sequence++));
         } else {
             HC_LOG_WARN("message_queue is full, failed to insert message");
             return false;
@@ -149,7 +176,7 @@ void message_queue<T, Compare>::enqueue(const T& t)
 
     {
         std::unique_lock<std::mutex> lock(m_global_lock);
-        m_q.push(t);
+        m_q.push(entry(t, m_sequence++));
     }
     cond_empty.notify_one();
     HC_LOG_DEBUG("!!!!!test2");
@@ -167,11 +194,26 @@ T message_queue<T, Compare>::dequeue(void)
             return m_q.size() != 0;
         });
 
-        t = m_q.top();
+        t = m_q.top().first;
         m_q.pop();
     }
     return t;
 }
 
+template<typename T, typename Compare>
+bool message_queue<T, Compare>::try_dequeue(T& t)
+{
+    HC_LOG_TRACE("");
+
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    if (m_q.empty()) {
+        return false;
+    }
+
+    t = m_q.top().first;
+    m_q.pop();
+    return true;
+}
+
 #endif // MESSAGE_QUEUE_HPP
 /** @} */
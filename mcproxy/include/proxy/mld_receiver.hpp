@@ -44,9 +44,12 @@ private:
     int get_ctrl_min_size() override; //size in byte
     int get_iov_min_size() override; //size in byte
     void analyse_packet(struct msghdr* msg, int info_size) override;
+    unsigned int get_packet_if_index(struct msghdr* msg) override;
 
 public:
-    mld_receiver(proxy_instance* pr_i, std::shared_ptr<const mroute_socket> mrt_sock, std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode);
+    mld_receiver(proxy_instance* pr_i, std::shared_ptr<const mroute_socket> mrt_sock, std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode, const std::shared_ptr<receive_loop>& shared_receive_loop = nullptr);
+
+    virtual ~mld_receiver();
 };
 
 #endif // MLD_RECEIVER_HPP
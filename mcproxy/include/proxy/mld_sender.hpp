@@ -51,6 +51,18 @@ typedef u_int16_t pad2 ; //padding
 class mld_sender: public sender
 {
 private:
+    struct query_template {
+        //mldv2 query without sources, the checksum is calculated by the kernel
+        std::vector<unsigned char> m_packet;
+        addr_storage m_dst_addr;
+    };
+
+    mutable std::map<query_template_key, query_template> m_query_templates;
+    mutable std::vector<unsigned char> m_packet_buf;
+
+    //return the query template of an interface, rebuild it if the timers and values have changed
+    const query_template& get_query_template(unsigned int if_index, const timers_values& tv, query_template_type qtt) const;
+
     bool add_hbh_opt_header() const;
 
     bool send_mldv2_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag, const source_list<source>& slist) const;
@@ -60,6 +72,8 @@ public:
 
     bool send_record(unsigned int if_index, mc_filter filter_mode, const addr_storage& gaddr, const source_list<source>& slist) const override;
 
+    bool send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const override;
+
     virtual bool send_general_query(unsigned int if_index, const timers_values& tv) const override;
 
     bool send_mc_addr_specific_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag) const override;
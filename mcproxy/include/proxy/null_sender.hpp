@@ -0,0 +1,61 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_sender Sender
+ * @{
+ */
+
+#ifndef NULL_SENDER_HPP
+#define NULL_SENDER_HPP
+
+#include "include/proxy/sender.hpp"
+
+/**
+ * @brief Sender without a socket, the packets are only counted. Used with a simulated kernel
+ * (see mfc_simulator) to run a proxy instance without any privileges and without transmitting.
+ */
+class null_sender : public sender
+{
+private:
+    mutable unsigned long m_report_count;
+    mutable unsigned long m_query_count;
+
+public:
+    null_sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp);
+
+    bool send_record(unsigned int if_index, mc_filter filter_mode, const addr_storage& gaddr, const source_list<source>& slist) const override;
+
+    bool send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const override;
+
+    bool send_general_query(unsigned int if_index, const timers_values& tv) const override;
+
+    bool send_mc_addr_specific_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag) const override;
+
+    bool send_mc_addr_and_src_specific_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, source_list<source>& slist) const override;
+
+    unsigned long get_report_count() const;
+    unsigned long get_query_count() const;
+};
+
+#endif // NULL_SENDER_HPP
+/** @} */
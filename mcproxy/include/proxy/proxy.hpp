@@ -35,10 +35,23 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <chrono>
+#include <csignal>
+
+//interval to save the membership state for a warm restart
+#define PROXY_SNAPSHOT_INTERVAL 10 //sec
+
+//maximum time to wait for the membership state of a proxy instance
+#define PROXY_SNAPSHOT_TIMEOUT 1000 //msec
 
 class configuration;
 class timing;
+class worker_pool;
+class receive_loop;
 class proxy_instance;
+class capture_file;
+class instance_definition;
+class inst_def_set;
 
 /**
   * @brief start and maintain all proxy instances.
@@ -47,22 +60,73 @@ class proxy
 {
 private:
     static bool m_running;
+    //set by the SIGHUP handler
+    static volatile std::sig_atomic_t m_reload;
     int m_verbose_lvl;
     bool m_print_proxy_status;
     bool m_reset_rp_filter;
     std::string m_config_path;
 
+    //keep the kernel forwarding state on exit and take it over on startup
+    bool m_takeover_kernel_state;
+
+    //membership state of the last run (warm restart), empty = disabled
+    std::string m_snapshot_path;
+    std::chrono::steady_clock::time_point m_last_snapshot;
+
+    //records the received group membership messages of all proxy instances, empty = disabled
+    std::string m_capture_path;
+    std::shared_ptr<capture_file> m_capture;
+
+    //number of executor threads shared by all proxy instances, 0 = one thread per proxy instance, -1 = automatic
+    int m_worker_pool_size;
+
+    //lock all pages into memory before the threads start (see thread_settings)
+    bool m_lock_memory;
+
     std::unique_ptr<configuration> m_configuration;
     std::shared_ptr<timing> m_timing;
 
+    //released after all proxy instances
+    std::shared_ptr<worker_pool> m_worker_pool;
+
+    //address family, receive loop
+    std::map<int, std::shared_ptr<receive_loop>> m_receive_loops;
+
     //table (= interface index), proxy_instance
     std::map<int, std::unique_ptr<proxy_instance>> m_proxy_instances;
 
+    //instance name, table of the running proxy instances
+    std::map<std::string, int> m_instance_tables;
+
     void prozess_commandline_args(int arg_count, char* args[]);
     void help_output();
 
     void start_proxy_instances();
 
+    //create a proxy instance and configure its global rule bindings, upstreams and downstreams
+    void start_proxy_instance(const std::shared_ptr<instance_definition>& pinstance, int table_number);
+
+    //instance name, multicast routing table
+    std::map<std::string, int> get_table_numbers(const inst_def_set& inst_set) const;
+
+    std::shared_ptr<receive_loop> get_receive_loop();
+
+    //collect the membership state of all proxy instances and save it to the snapshot file
+    void save_snapshot();
+
+    //hand the membership state of the snapshot file over to the proxy instances
+    void restore_snapshot();
+
+    //reload the configuration file and apply only the differences to the running proxy instances
+    void reload_configuration();
+
+    //send the changed interfaces and rule bindings of a proxy instance that keeps running
+    void update_proxy_instance(proxy_instance& pr_i, const instance_definition& old_def, const instance_definition& new_def, bool tables_changed);
+
+    //create the shared executor threads and the receive loop, if enabled
+    void init_shared_threads(unsigned int instance_count);
+
 
     static void signal_handler(int sig);
 
@@ -71,7 +135,7 @@ private:
     unsigned int get_default_priority_interval();
 public:
     /**
-     * @brief Set default values of the class members and add signal handlers for the signal SIGINT and SIGTERM.
+     * @brief Set default values of the class members and add signal handlers for the signal SIGINT, SIGTERM and SIGHUP (reload the configuration).
      */
     proxy(int arg_count, char* args[]);
 
@@ -33,21 +33,36 @@
 #include "include/proxy/worker.hpp"
 #include "include/proxy/def.hpp"
 #include "include/proxy/querier.hpp"
+#include "include/proxy/timing.hpp"
 #include "include/parser/interface.hpp"
 
 #include <memory>
 #include <set>
 #include <functional>
+#include <atomic>
 
 class timing;
+class worker_pool;
+class receive_loop;
 class receiver;
 class sender;
 class routing;
 class mroute_socket;
+class kernel_backend;
+class mfc_simulator;
+class capture_file;
 class interface;
 class simple_mc_proxy_routing;
 class routing_management;
 class interface_memberships;
+class membership_aggregation;
+class bench;
+
+//maximum random time a general query is sent earlier than the query interval
+#define PROXY_INSTANCE_GENERAL_QUERY_JITTER_DEFAULT 0 //msec
+
+//time a reporting host is tracked after its last report, 0 disables the explicit tracking
+#define PROXY_INSTANCE_EXPLICIT_TRACKING_DEFAULT 0 //msec
 
 /**
  * @brief Represent a multicast proxy (RFC 4605)
@@ -88,37 +103,66 @@ private:
     const int m_table_number;
     const bool m_in_debug_testing_mode;
 
-    const std::shared_ptr<const interfaces> m_interfaces;
+    //the virtual interfaces and forwarding rules survive the proxy instance and are taken over on the next start
+    const bool m_takeover;
+    std::atomic<bool> m_keep_kernel_state;
+
+    const std::shared_ptr<interfaces> m_interfaces;
     const std::shared_ptr<timing> m_timing;
+    const std::shared_ptr<receive_loop> m_receive_loop;
 
     std::shared_ptr<mroute_socket> m_mrt_sock;
+
+    //sets the kernel table entries in takeover mode, entries not set by the socket with the MRT flag are static
+    std::shared_ptr<mroute_socket> m_static_mrt_sock;
+
+    //the forwarding tables of the routing, the kernel (mroute socket) or the simulator
+    std::shared_ptr<const kernel_backend> m_kernel;
+    const std::shared_ptr<mfc_simulator> m_mfc_simulator;
     std::shared_ptr<sender> m_sender;
 
     std::unique_ptr<receiver> m_receiver;
+
+    //records the received packets and the interfaces of this instance
+    const std::shared_ptr<capture_file> m_capture;
     std::unique_ptr<routing> m_routing;
     std::unique_ptr<routing_management> m_routing_management;
 
     //to match the proxy debug output with the wireshark time stamp
-    const std::chrono::time_point<std::chrono::steady_clock> m_proxy_start_time;
+    const timer_clock::time_point m_proxy_start_time;
 
-    std::set<upstream_infos> m_upstreams;
+    //lag of the processed timers behind their deadlines
+    timer_lag m_timer_lag;
+
+    //equal priorities are allowed while a configuration reload reorders the upstreams
+    std::multiset<upstream_infos> m_upstreams;
 
     //if_indexes of the downstreams, querier
     //std::map<unsigned int, std::unique_ptr<querier>> m_querier;
     std::map<unsigned int, downstream_infos> m_downstreams;
 
+    //counts the added downstreams to assign them general query phases
+    unsigned int m_general_query_slot;
+
     std::shared_ptr<rule_binding> m_upstream_input_rule;
     std::shared_ptr<rule_binding> m_upstream_output_rule;
 
+    //timer value bindings (RBT_TIMER_VALUE)
+    std::list<std::shared_ptr<rule_binding>> m_timer_value_rules;
+
+    //static and predictive upstream joins (RBT_PREJOIN)
+    std::list<std::shared_ptr<rule_binding>> m_prejoin_rules;
+
     //init
     bool init_mrt_socket();
+    bool init_static_mrt_socket();
     bool init_sender();
     bool init_receiver();
     bool init_routing();
     bool init_routing_management();
 
-    //receives and process all events
-    void worker_thread();
+    //process all events
+    void process_msg(const std::shared_ptr<proxy_msg>& msg) override;
 
     //add and del interfaces
     void handle_config(const std::shared_ptr<config_msg>& msg);
@@ -126,6 +170,12 @@ private:
     bool is_upstream(unsigned int if_index) const;
     bool is_downstream(unsigned int if_index) const;
 
+    //returns the configured or the next automatically assigned general query phase of the downstream if_index
+    std::chrono::milliseconds get_general_query_phase(unsigned int if_index, const timers_values& tv);
+
+    //returns the configured timer value (output direction) of the interface if_index, an interface specific binding is preferred to a wildcard binding
+    std::chrono::milliseconds get_timer_value(rb_interface_type interface_type, unsigned int if_index, rb_timer_value_type timer_value_type, const std::chrono::milliseconds& default_value) const;
+
     std::string to_string() const;
     friend std::ostream& operator<<(std::ostream& stream, const proxy_instance& pr_i);
 
@@ -136,8 +186,21 @@ public:
      * @param interfaces Holds all possible needed information of all upstream and downstream interfaces.
      * @param shared_timing Stores and triggers all time-dependent events for this proxy instance.
      * @param in_debug_testing_mode If true this proxy instance stops receiving group membership messages and prints a lot of status messages to the command line.
+     * @param shared_worker_pool If set the events are processed by the executor threads of this pool instead of an own thread.
+     * @param shared_receive_loop If set the group membership messages are received by this loop instead of an own thread.
+     * @param takeover If true the virtual interfaces and forwarding rules are kept in the kernel table when the proxy
+     *        instance is released and the ones of a previous run are taken over (see config_msg::TAKEOVER_KERNEL_ROUTES).
+     * @param simulator If set the virtual interfaces and forwarding rules are maintained by this simulator instead of the
+     *        kernel (the upcalls of the simulator are processed as new sources). The proxy instance opens no sockets and needs
+     *        no privileges, the group membership messages are only injected and the sent packets are counted (null_sender).
+     * @param capture If set the received group membership messages and kernel upcalls are recorded to this capture.
+     */
+    proxy_instance(group_mem_protocol group_mem_protocol, const std::string& intance_name, int table_number, const std::shared_ptr<interfaces>& interfaces, const std::shared_ptr<timing>& shared_timing, bool in_debug_testing_mode = false, const std::shared_ptr<worker_pool>& shared_worker_pool = nullptr, const std::shared_ptr<receive_loop>& shared_receive_loop = nullptr, bool takeover = false, const std::shared_ptr<mfc_simulator>& simulator = nullptr, const std::shared_ptr<capture_file>& capture = nullptr);
+
+    /**
+     * @brief Remove the virtual interfaces and forwarding rules from the kernel table on release, even in takeover mode.
      */
-    proxy_instance(group_mem_protocol group_mem_protocol, const std::string& intance_name, int table_number, const std::shared_ptr<const interfaces>& interfaces, const std::shared_ptr<timing>& shared_timing, bool in_debug_testing_mode = false);
+    void release_kernel_state();
 
     /**
      * @brief Release all resources.
@@ -158,6 +221,8 @@ public:
     friend routing_management;
     friend simple_mc_proxy_routing;
     friend interface_memberships;
+    friend membership_aggregation;
+    friend bench;
 };
 
 #endif // PROXY_INSTANCE_HPP
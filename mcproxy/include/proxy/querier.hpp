@@ -30,6 +30,7 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <random>
 
 class timing;
 class sender;
@@ -37,9 +38,9 @@ class worker;
 
 /**
  * @brief Callback function to publish querier state change informations.
- * The callback function informs about the involved interface index, group address and the involved multicast sources.
+ * The callback function informs about the involved interface index, group address and the change of the membership state.
  */
-using callback_querier_state_change = std::function<void(unsigned int, const addr_storage&)>;
+using callback_querier_state_change = std::function<void(unsigned int, const addr_storage&, const membership_delta&)>;
 
 /**
  * @brief Defines the behaviour of a multicast querier for a specific interface.
@@ -53,6 +54,21 @@ private:
     timers_values m_timers_values;
     callback_querier_state_change m_cb_state_change;
 
+    //the first regular general query is sent earlier by this offset to spread the queries of all interfaces over the query interval
+    const std::chrono::milliseconds m_general_query_phase;
+    bool m_general_query_phase_applied;
+
+    //each regular general query is sent earlier by a random time up to this jitter
+    const std::chrono::milliseconds m_general_query_jitter;
+    std::default_random_engine m_random_engine;
+
+    //a reporting host is tracked for this time after its last report, zero disables the explicit tracking
+    const std::chrono::milliseconds m_explicit_tracking;
+    const timer_clock::time_point m_start_time;
+
+    //generation of the last armed group timer
+    mutable unsigned long m_group_timer_generation;
+
     const std::shared_ptr<const sender> m_sender;
     const std::shared_ptr<timing> m_timing;
 
@@ -60,6 +76,9 @@ private:
     bool router_groups_function(bool subscribe) const;
     bool send_general_query();
 
+    //update the tracked state of the reporting host, return true if the record is completely processed by an immediate leave
+    bool receive_record_explicit_tracking(group_record_msg& gr, gaddr_map::iterator db_info_it);
+
     //
     void receive_record_in_include_mode(mcast_addr_record_type record_type, const addr_storage& gaddr, source_list<source>& slist, gaddr_info& ginfo);
     void receive_record_in_exclude_mode(mcast_addr_record_type record_type, const addr_storage& gaddr, source_list<source>& slist, gaddr_info& ginfo);
@@ -68,30 +87,33 @@ private:
     //Updates the filter_timer to the Multicast Address Listener Interval
     void mali(const addr_storage& gaddr, gaddr_info& ginfo) const;
 
-    //Updates a list of source_timers to the Multicast Address Listener Interval
-    void mali(const addr_storage& gaddr, source_list<source>& slist) const;
+    //Updates specific source timers (tmp_slist) of list slist to the Multicast Address Listener Interval,
+    //the sources of slist end up in the group ginfo
+    void mali(const addr_storage& gaddr, gaddr_info& ginfo, source_list<source>& slist, source_list<source>&& tmp_slist) const;
 
-    //Updates specific source timers (tmp_slist) of list slist to the Multicast Address Listener Interval
-    void mali(const addr_storage& gaddr, source_list<source>& slist, source_list<source>&& tmp_slist) const;
+    //make sure the group timer of ginfo expires not later than deadline
+    void arm_group_timer(const addr_storage& gaddr, gaddr_info& ginfo, const timer_clock::time_point& deadline) const;
 
     //Set specific source timers (tmp_slist) of list slist to the corresponding filter time
     void filter_time(gaddr_info& ginfo, source_list<source>& slist, source_list<source>&& tmp_slist);
 
     //send multicast address specific query
-    void send_Q(const addr_storage& gaddr, gaddr_info& ginfo);
+    void send_Q(const addr_storage& gaddr, gaddr_info& ginfo, bool in_retransmission_state = false);
 
     //send multicast address and source specific and include only elements of tmp_list
     void send_Q(const addr_storage& gaddr, gaddr_info& ginfo, source_list<source>& slist, source_list<source>&& tmp_list, bool in_retransmission_state = false);
 
-    void timer_triggerd_filter_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
-    void timer_triggerd_source_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
-    void timer_triggerd_ret_group_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
-    void timer_triggerd_ret_source_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
+    //schedule the next query retransmission of a group in a shared query round, return the timer of the round
+    std::shared_ptr<query_round_timer_msg> schedule_retransmission(const addr_storage& gaddr, bool source_query);
+
+    void timer_triggerd_group_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
+    void timer_triggerd_query_round_timer(const std::shared_ptr<timer_msg>& msg);
     void timer_triggerd_older_host_present_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg);
     void timer_triggerd_general_query_timer(const std::shared_ptr<timer_msg>& msg);
 
-    //call the callback function querier_state_change
-    void state_change_notification(const addr_storage& gaddr);
+    //call the callback function querier_state_change with the change of the effective membership state,
+    //effects is set if a deleted group was under backward compatibility effects (the routing knows EXCLUDE{})
+    void state_change_notification(const addr_storage& gaddr, membership_delta&& delta, bool effects = false);
 
 public:
     virtual ~querier();
@@ -104,8 +126,12 @@ public:
      * @param shared_timing Stores and triggers all time-dependent events for this querier.
      * @param tv contain all nessesary timers and values.
      * @param cb_state_change Callback function to publish querier state change informations.
+     * @param general_query_phase Phase offset of the general queries within the query interval.
+     * @param general_query_jitter Maximum random time a general query is sent earlier than the query interval.
+     * @param explicit_tracking If greater than zero the state of each reporting host is tracked for this time after its last report
+     *        and the traffic is stopped without multicast address specific queries as soon as the last interested host leaves.
      */
-    querier(worker* msg_worker, group_mem_protocol querier_version_mode, int if_index, const std::shared_ptr<const sender>& sender, const std::shared_ptr<timing>& timing, const timers_values& tv, callback_querier_state_change cb_state_change);
+    querier(worker* msg_worker, group_mem_protocol querier_version_mode, int if_index, const std::shared_ptr<const sender>& sender, const std::shared_ptr<timing>& timing, const timers_values& tv, callback_querier_state_change cb_state_change, const std::chrono::milliseconds& general_query_phase = std::chrono::milliseconds(0), const std::chrono::milliseconds& general_query_jitter = std::chrono::milliseconds(0), const std::chrono::milliseconds& explicit_tracking = std::chrono::milliseconds(0));
 
     /**
      * @brief All received group records of the interface maintained by this querier musst be submitted to this function. 
@@ -128,13 +154,29 @@ public:
      * @param interface_filter_fun If the filter function is false the interface will be not added to rt_slist
      * If the querier suggest to forward traffic of the group address gaddr and the source it adds its own interface to the return list.
      */
-    void suggest_to_forward_traffic(const addr_storage& gaddr, std::list<std::pair<source, std::list<unsigned int>>>& rt_slist, std::function<bool(const addr_storage&)> interface_filter_fun) const;
+    void suggest_to_forward_traffic(const addr_storage& gaddr, pooled_list<std::pair<source, pooled_list<unsigned int>>>& rt_slist, const std::function<bool(const addr_storage&)>& interface_filter_fun) const;
 
     /**
      * @return return all group membership information of group address gaddr
      */
     std::pair<mc_filter, source_list<source>> get_group_membership_infos(const addr_storage& gaddr);
 
+    /**
+     * @return return the group addresses of all groups maintained by this querier
+     */
+    std::list<addr_storage> get_group_addrs() const;
+
+    /**
+     * @return return the membership state of all groups with the remaining time of their timers
+     */
+    std::list<snapshot_group> get_snapshot() const;
+
+    /**
+     * @brief Take over the membership state of a snapshot (warm restart). Groups which are already
+     * known from received records are kept, the restored groups are revalidated by the general queries.
+     */
+    void restore_snapshot(const std::list<snapshot_group>& groups);
+
     /**
      * @brief Roadworks
      */
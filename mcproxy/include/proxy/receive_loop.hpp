@@ -0,0 +1,98 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_receiver Receiver
+ * @{
+ */
+
+#ifndef RECEIVE_LOOP_HPP
+#define RECEIVE_LOOP_HPP
+
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <map>
+
+/**
+ * @brief Maximum number of events fetched by one epoll_wait().
+ */
+#define RECEIVE_LOOP_MAX_EVENTS 32
+
+class receiver;
+
+/**
+ * @brief One thread waits with epoll for the sockets of all receivers of an
+ * address family and lets the receiver of a readable socket process the packet.
+ */
+class receive_loop
+{
+private:
+    const int m_addr_family;
+    int m_epoll_fd;
+
+    bool m_running;
+    std::unique_ptr<std::thread> m_thread;
+
+    //socket descriptor, receiver
+    std::map<int, receiver*> m_receivers;
+
+    //serialises the packet processing and the (un)registration of receivers
+    std::mutex m_global_lock;
+
+    void worker_thread();
+
+    void start();
+    void stop();
+    void join();
+
+    receive_loop(const receive_loop&) = delete;
+    receive_loop& operator=(const receive_loop&) = delete;
+
+public:
+    /**
+     * @param addr_family address family (AF_INET or AF_INET6) of all registered receivers
+     */
+    receive_loop(int addr_family);
+
+    virtual ~receive_loop();
+
+    /**
+     * @brief Wait for packets on the socket sock and pass them to the receiver r.
+     * @return Return true on success.
+     */
+    bool registrate_receiver(int sock, receiver* r);
+
+    /**
+     * @brief Stop waiting for packets on the socket sock. If a packet of this socket
+     * is processed in the meantime the function returns after its processing.
+     */
+    void del_receiver(int sock);
+
+    /**
+     * @return Get the address family (AF_INET | AF_INET6).
+     */
+    int get_addr_family() const;
+};
+
+#endif // RECEIVE_LOOP_HPP
+/** @} */
@@ -36,6 +36,7 @@
 #include "include/proxy/interfaces.hpp"
 #include "include/proxy/message_format.hpp"
 #include "include/proxy/def.hpp"
+#include "include/proxy/capture.hpp"
 
 #include <set>
 #include <thread>
@@ -44,6 +45,7 @@
 #include <sstream>
 
 class proxy_instance;
+class receive_loop;
 
 /**
  * @brief Receive timout set to have not a blocking receive funktion.
@@ -60,17 +62,34 @@ private:
     bool m_running;
     bool m_in_debug_testing_mode;
     std::unique_ptr<std::thread> m_thread;
+    const std::shared_ptr<receive_loop> m_receive_loop;
 
     std::set<unsigned int> m_relevant_if_index;
 
+    //buffers for recvmsg()
+    std::unique_ptr<unsigned char[]> m_iov_buf;
+    std::unique_ptr<unsigned char[]> m_ctrl_buf;
+    struct sockaddr_storage m_name; //address of the sender
+    struct iovec m_iov;
+    struct msghdr m_msg;
+
+    void init_msg_buffer();
+
     void worker_thread();
 
     std::mutex m_data_lock;
 
+    //records the received packets if set
+    std::shared_ptr<capture_file> m_capture;
+
+protected:
+    /**
+     * @brief Stop receiving packets. Has to be called by the destructor of the derived class
+     * to make sure that analyse_packet() is not called while the object is destroyed.
+     */
     void stop();
     void join();
 
-protected:
     const proxy_instance * const m_proxy_instance;
 
     int m_addr_family;
@@ -100,11 +119,19 @@ protected:
      */
     virtual void analyse_packet(struct msghdr* msg, int info_size) = 0;
 
+    /**
+     * @brief Get the interface index a received packet belongs to (the arrival interface of a report
+     * or the interface of a kernel upcall), 0 if unknown.
+     */
+    virtual unsigned int get_packet_if_index(struct msghdr* msg) = 0;
+
 public:
     /**
       * @brief Create a receiver.
+     * @param mrt_sock if not set nothing is received, the packets are only injected with replay_packet()
+     * @param shared_receive_loop if set the packets are received by this loop instead of an own thread
      */
-    receiver(proxy_instance* pr_i, int addr_family, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode= false);
+    receiver(proxy_instance* pr_i, int addr_family, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode= false, const std::shared_ptr<receive_loop>& shared_receive_loop = nullptr);
 
     /**
      * @brief Release all resources.
@@ -126,6 +153,22 @@ public:
      */
     void del_interface(unsigned int if_index);
 
+    /**
+     * @brief Receive and analyse one packet, called by the own thread or by the receive_loop.
+     * @return Return false if the receive failed.
+     */
+    bool receive_packet();
+
+    /**
+     * @brief Analyse a packet that was recorded by a capture before, as if it were received.
+     */
+    void replay_packet(struct msghdr* msg, int info_size);
+
+    /**
+     * @brief Record all packets of the relevant interfaces to capture, nullptr stops the recording.
+     */
+    void set_capture(const std::shared_ptr<capture_file>& capture);
+
     /**
      * @brief Check whether the receiver is running.
      */
@@ -29,16 +29,27 @@
 #ifndef ROUTING_HPP
 #define ROUTING_HPP
 
-//#include "include/utils/mroute_socket.hpp"
 #include "include/utils/if_prop.hpp"
+#include "include/utils/addr_storage.hpp"
+#include "include/utils/object_pool.hpp"
 
 #include <set>
+#include <map>
 #include <list>
 #include <memory>
 
 class interfaces;
-class mroute_socket;
-class addr_storage;
+class kernel_backend;
+
+/**
+ * @brief A multicast forwarding rule found in the Linux kernel table.
+ */
+struct kernel_route {
+    unsigned int input_if_index;
+    addr_storage gaddr;
+    addr_storage saddr;
+    std::list<unsigned int> output_if_indexes;
+};
 
 /**
  * @brief Set and delete virtual interfaces and forwarding rules in the Linux kernel.
@@ -50,13 +61,34 @@ private:
     int m_addr_family; //AF_INET or AF_INET6
 
     const std::shared_ptr<const interfaces> m_interfaces;
-    const std::shared_ptr<const mroute_socket> m_mrt_sock;
+    const std::shared_ptr<const kernel_backend> m_kernel;
     if_prop m_if_prop; //return interface properties
 
     mutable std::set<unsigned int> m_added_ifs; 
 
+    //the virtual interfaces and forwarding rules are left in the kernel table for the next run (takeover mode)
+    const bool m_takeover;
+    bool m_keep_kernel_state;
+
+    //returns true if the kernel table contains the virtual interface vif of the interface if_name
+    bool is_kernel_vif(int vif, const std::string& if_name) const;
+
+    //dumps the IPv4 virtual interfaces (vif ==> if_index) of the own multicast routing table via netlink
+    bool get_kernel_vifs(std::map<int, unsigned int>& kernel_vifs) const;
+
+    //add the virtual interface, a virtual interface kept by a previous run in takeover mode is replaced
+    bool add_kernel_vif(int vif, int if_index, const addr_storage& ip_tunnel_remote_addr) const;
+
+    bool is_own_table(unsigned int table) const;
+
 public:
-    routing(int addr_family, std::shared_ptr<const mroute_socket> mrt_sock, std::shared_ptr<const interfaces> interfaces, int table_number);
+    /**
+     * @param kernel Multicast forwarding tables to manipulate, the mroute socket or the mfc_simulator.
+     * @param takeover If true the virtual interfaces and forwarding rules are added as static entries
+     *        (kernel must be an mroute socket without the MRT flag), they survive the process and are
+     *        taken over on the next start.
+     */
+    routing(int addr_family, std::shared_ptr<const kernel_backend> kernel, std::shared_ptr<const interfaces> interfaces, int table_number, bool takeover = false);
 
     virtual ~routing();
     /**
@@ -75,13 +107,24 @@ public:
       * @brief Add a multicast route to the linux kernel table.
       * @return Return true on success.
       */
-    bool add_route(int input_vif, const addr_storage& g_addr, const addr_storage& src_addr, const std::list<int>& output_vif) const;
+    bool add_route(int input_vif, const addr_storage& g_addr, const addr_storage& src_addr, const pooled_list<int>& output_vif) const;
 
     /**
       * @brief Delete a multicast route from the linux kernel table.
       * @return Return true on success.
       */
     bool del_route(int vif, const addr_storage& g_addr, const addr_storage& src_addr) const;
+
+    /**
+      * @brief Read all resolved multicast forwarding rules of the multicast routing table from the linux kernel (rtnetlink dump).
+      */
+    std::list<kernel_route> get_kernel_routes() const;
+
+    /**
+      * @brief Remove the virtual interfaces and forwarding rules from the kernel table on release
+      *        even in takeover mode (e.g. the proxy instance is stopped by a configuration reload).
+      */
+    void release_kernel_state();
 };
 
 #endif // ROUTING_HPP
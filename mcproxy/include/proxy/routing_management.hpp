@@ -28,11 +28,13 @@
 #include <memory>
 #include <string>
 #include <sstream>
+#include <list>
 
 struct proxy_msg;
 struct source;
 class proxy_instance;
 class addr_storage;
+struct membership_delta;
 
 /**
  * @brief abstract interface of a summary of routing events 
@@ -46,8 +48,10 @@ public:
     routing_management(const proxy_instance* p): m_p(p) {}
 
     virtual void event_new_source(const std::shared_ptr<proxy_msg>& msg) = 0;
-    virtual void event_querier_state_change(unsigned int if_index, const addr_storage& gaddr) = 0;
+    virtual void event_querier_state_change(unsigned int if_index, const addr_storage& gaddr, const membership_delta& delta) = 0;
     virtual void timer_triggerd_maintain_routing_table(const std::shared_ptr<proxy_msg>& msg) = 0;
+    virtual void event_configuration_change() = 0;
+    virtual void event_kernel_route(unsigned int input_if_index, const addr_storage& gaddr, const addr_storage& saddr, const std::list<unsigned int>& output_if_indexes) = 0;
 
     virtual std::string to_string() const {return std::string();}
 
@@ -34,6 +34,8 @@
 #include "include/proxy/interfaces.hpp"
 
 #include "memory"
+#include <map>
+#include <vector>
 
 class timers_values;
 struct source;
@@ -44,17 +46,39 @@ class addr_storage;
 class sender
 {
 protected:
+    /**
+     * @brief Query packets are prebuilt once per interface and per query type.
+     */
+    enum query_template_type {
+        QTT_GENERAL_QUERY, QTT_MC_ADDR_SPECIFIC_QUERY
+    };
+
+    using query_template_key = std::pair<unsigned int, query_template_type>;
+
     group_mem_protocol m_group_mem_protocol;
-    const std::shared_ptr<const interfaces>& m_interfaces;
+    const std::shared_ptr<const interfaces> m_interfaces;
 
     mroute_socket m_sock;
 
+    //change the socket filter of the group from the old to the new state, the kernel reports only the difference (ALLOW/BLOCK)
+    //if the filter mode is kept, otherwise the full state (TO_IN/TO_EX)
+    bool change_socket_filter(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const;
+
+    //create_socket false: the sender has no socket (null_sender)
+    sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp, bool create_socket);
+
 public:
 
     sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp);
 
     virtual bool send_record(unsigned int if_index, mc_filter filter_mode, const addr_storage& gaddr, const source_list<source>& slist) const;
 
+    /**
+     * @brief Report a change of the group membership state from the last reported state (old) to the new state.
+     * If the filter mode is unchanged only the added and removed sources are reported (ALLOW_NEW_SOURCES/BLOCK_OLD_SOURCES).
+     */
+    virtual bool send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const;
+
     virtual bool send_general_query(unsigned int if_index, const timers_values& tv) const;
 
     virtual bool send_mc_addr_specific_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag) const;
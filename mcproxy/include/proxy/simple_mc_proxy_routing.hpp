@@ -28,12 +28,51 @@
 #include "include/parser/interface.hpp"
 
 #include <list>
+#include <map>
+#include <set>
+#include <vector>
 #include <memory>
 #include <chrono>
+#include <string>
+#include <cstdint>
+
+//default window in which the membership changes of an upstream are collected
+//before they are reported, the first change of an idle upstream is reported immediately, 0 disables the coalescing
+#define SIMPLE_MC_PROXY_ROUTING_REPORT_COALESCING_DEFAULT 0 //msec
+
+//time an upstream leave of a group is held back, a join within this time absorbs the leave, 0 disables the hold-down
+#define SIMPLE_MC_PROXY_ROUTING_LEAVE_HOLD_DOWN_DEFAULT 0 //msec
+
+//the predicted prejoins are recalculated periodically from the join scores of the groups, each join of a group
+//(first interested downstream) adds one to its score, the scores decay with the half life
+#define SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL 60 //sec
+#define SIMPLE_MC_PROXY_ROUTING_PREJOIN_HALF_LIFE 1800 //sec
+#define SIMPLE_MC_PROXY_ROUTING_PREJOIN_MIN_SCORE 0.5
+
+//a source is checked for forwarded packets after the minimum life time, the life time of a steady
+//source doubles with each check up to the maximum life time, the life time of a bursty source halves
+//with each check down to the burst life time
+#define SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_MIN 20 //sec
+#define SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_MAX 320 //sec
+#define SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_BURST 5 //sec
+
+//a source is steady if it sends at least this rate, it is bursty if its rate changed by more than the factor 2
+//since the previous check
+#define SIMPLE_MC_PROXY_ROUTING_STEADY_SOURCE_RATE 1 //packets per second
 
 struct timer_msg;
 struct source;
 struct new_source_timer_msg;
+struct upstream_report_timer_msg;
+struct leave_hold_down_timer_msg;
+struct prejoin_timer_msg;
+
+/**
+ * @brief Weight of the channel (S,G) on the upstream interface if_name (rendezvous hashing, RMT_HASH). A channel is
+ * assigned to the matching upstream with the highest weight, so adding or removing an upstream only moves the
+ * channels of this upstream. The any source channel of a group (*,G) uses an empty source address.
+ */
+uint64_t get_channel_weight(const addr_storage& gaddr, const addr_storage& saddr, const std::string& if_name);
 
 struct source_state {
     source_state();
@@ -51,21 +90,179 @@ private:
 
     std::list<std::pair<unsigned int, std::list<source_state>>> m_data;
 
+    //a downstream has a membership of the group
+    bool m_requested;
+
     void merge_membership_infos(source_state& merge_to, const source_state& merge_from) const;
 
-    void process_upstream_in_first(const addr_storage& gaddr, const proxy_instance* pi);
     void process_upstream_in_mutex(const addr_storage& gaddr, const proxy_instance* pi, const simple_routing_data& routing_data);
 
 public:
+    /**
+     * @brief Aggregate the memberships of all downstreams (RMT_MUTEX), the rule matching types
+     * RMT_FIRST and RMT_HASH are maintained incrementally by membership_aggregation.
+     */
     interface_memberships(rb_rule_matching_type upstream_in_rule_matching_type, const addr_storage& gaddr, const proxy_instance* pi, const simple_routing_data& routing_data);
 
     source_state get_group_memberships(unsigned int upstream_if_index);
 
+    /**
+     * @return true if a downstream has a membership of the group
+     */
+    bool is_requested() const;
+
     std::string to_string() const;
 
     static void print(const state_list& sl);
 };
 
+/**
+ * @brief Merged membership state of a group on one upstream, maintained by reference counts of the sources
+ * the downstream states request from this upstream. The states INCLUDE{A1}..INCLUDE{An} and EXCLUDE{B1}..EXCLUDE{Bm}
+ * merge to EXCLUDE{(B1 * .. * Bm) - (A1 + .. + An)}, or to INCLUDE{A1 + .. + An} if m is 0.
+ */
+class upstream_aggregation
+{
+private:
+    //number of the downstream states in EXCLUDE mode
+    unsigned int m_exclude_states;
+
+    //source address ==> number of the INCLUDE states requesting the source
+    pooled_map<addr_storage, unsigned int> m_include_count;
+
+    //source address ==> number of the EXCLUDE states excluding the source
+    pooled_map<addr_storage, unsigned int> m_exclude_count;
+
+    source_state m_merged_state;
+
+    //recalculate the source saddr of the merged state, return true if it changed
+    bool refresh(const addr_storage& saddr);
+
+    //recalculate the merged state after the number of EXCLUDE states changed
+    void refresh_all();
+
+public:
+    upstream_aggregation();
+
+    //add or remove a whole downstream state, return true if the merged state changed
+    bool add_state(const source_state& sstate);
+    bool del_state(const source_state& sstate);
+
+    //add or remove a single source of a downstream state in the filter mode filter, return true if the merged state changed
+    bool add_source(mc_filter filter, const addr_storage& saddr);
+    bool del_source(mc_filter filter, const addr_storage& saddr);
+
+    const source_state& get_merged_state() const;
+};
+
+/**
+ * @brief Persistent membership aggregation of the upstreams (RMT_FIRST, RMT_HASH). For each group the sources a
+ * downstream requests from each upstream are kept, so a querier state change places only the changed sources of
+ * this downstream and updates the merged upstream states by their reference counts.
+ */
+class membership_aggregation
+{
+private:
+    struct downstream_state {
+        downstream_state(const interface* interf)
+            : m_interface(interf) {}
+
+        //the interface (rule bindings) the requests are calculated with
+        const interface* m_interface;
+
+        //the last membership state of the downstream
+        source_state m_state;
+
+        //upstream if_index ==> sources requested from the upstream
+        pooled_map<unsigned int, source_state> m_requests;
+    };
+
+    struct group_state {
+        //downstream if_index ==> requests of the downstream
+        pooled_map<unsigned int, downstream_state> m_downstreams;
+
+        //upstream if_index ==> merged state of the upstream
+        pooled_map<unsigned int, upstream_aggregation> m_upstreams;
+    };
+
+    struct upstream {
+        upstream(unsigned int if_index, const std::string& if_name, const std::shared_ptr<interface>& interf)
+            : m_if_index(if_index)
+            , m_if_name(if_name)
+            , m_interface(interf) {}
+
+        unsigned int m_if_index;
+        std::string m_if_name;
+        std::shared_ptr<interface> m_interface;
+    };
+
+    const proxy_instance* const m_p;
+
+    //the requests are valid for this rule matching type and these upstreams (ordered by priority)
+    rb_rule_matching_type m_rule_matching_type;
+    std::vector<upstream> m_upstreams;
+
+    pooled_map<addr_storage, group_state> m_groups;
+
+    //forget all requests if the rule matching type or the upstreams changed
+    void check_configuration(rb_rule_matching_type rule_matching_type);
+
+    //return true if the upstream joins the group in EXCLUDE mode, the any source channel (*,G) (RMT_HASH)
+    bool is_any_source_upstream(const group_state& group, unsigned int upstream_if_index) const;
+
+    //the upstreams joining the group in EXCLUDE mode, empty for RMT_FIRST
+    pooled_list<unsigned int> get_any_source_upstreams(const group_state& group) const;
+
+    //the upstream if_index the any source channel (*,G) of an EXCLUDE state is requested from, 0 if none (RMT_HASH)
+    unsigned int place_group(const addr_storage& gaddr, const interface& downstream_interface) const;
+
+    //the upstream if_index a source of an INCLUDE state is requested from, 0 if none
+    unsigned int place_source(const addr_storage& gaddr, const addr_storage& saddr, const interface& downstream_interface, const group_state& group) const;
+
+    //return true if the changed sources of an EXCLUDE state keep the upstreams the state is requested from: the
+    //any source channel (*,G) takes all of them (RMT_HASH), or the first upstream accepts or the downstream drops
+    //each of them (RMT_FIRST)
+    bool is_exclude_delta_placeable(const addr_storage& gaddr, const membership_delta& delta, const interface& downstream_interface) const;
+
+    //upstream if_index ==> the sources of the state requested from the upstream
+    pooled_map<unsigned int, source_state> place_state(const addr_storage& gaddr, const source_state& sstate, const interface& downstream_interface, const group_state& group) const;
+
+    //apply the change delta of the querier to the state of the downstream, without a delta the state is read from the
+    //querier (resynchronization), replace places the whole state of the downstream again
+    void update_downstream(const addr_storage& gaddr, group_state& group, unsigned int if_index, const membership_delta* delta, pooled_set<unsigned int>& changed_upstreams, bool replace = false);
+
+    //withdraw or request the sources of one downstream from an upstream, update the merged state
+    void del_request(group_state& group, unsigned int upstream_if_index, const source_state& request, pooled_set<unsigned int>& changed_upstreams);
+    void add_request(group_state& group, unsigned int upstream_if_index, const source_state& request, pooled_set<unsigned int>& changed_upstreams);
+    void change_request(group_state& group, unsigned int upstream_if_index, const source_state& old_request, const source_state& new_request, pooled_set<unsigned int>& changed_upstreams);
+
+public:
+    membership_aggregation(const proxy_instance* p);
+
+    /**
+     * @brief Recalculate the requests of the downstream if_index for the group gaddr.
+     * @param downstream_if_index the changed downstream, 0 recalculates all downstreams
+     * @param delta the change of the membership state of the downstream, without a delta the state is read from the querier
+     * @return the upstreams whose merged state may have changed, all upstreams if all downstreams are recalculated
+     */
+    pooled_list<unsigned int> update(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr, unsigned int downstream_if_index, const membership_delta* delta = nullptr);
+
+    /**
+     * @return the merged membership state of the group gaddr on the upstream upstream_if_index
+     */
+    source_state get_group_memberships(const addr_storage& gaddr, unsigned int upstream_if_index) const;
+
+    /**
+     * @return true if a downstream has a membership of the group gaddr, a group without memberships is not kept
+     */
+    bool is_requested(const addr_storage& gaddr) const;
+
+    /**
+     * @brief Forget all requests, they are recalculated on the next update of a group.
+     */
+    void clear();
+};
+
 /**
  * @brief the simplest way of calculate forwarding rules.
  */
@@ -74,33 +271,112 @@ class simple_mc_proxy_routing : public routing_management
 private:
     simple_routing_data m_data;
 
-    std::chrono::seconds get_source_life_time();
+    //upstream memberships of RMT_FIRST and RMT_HASH
+    membership_aggregation m_aggregation;
+
+    //upstream if_index ==> last pending group state per group address
+    std::map<unsigned int, pooled_map<addr_storage, source_state>> m_pending_records;
+
+    //upstream if_index ==> last reported group state per group address
+    std::map<unsigned int, pooled_map<addr_storage, source_state>> m_reported_states;
+
+    //upstream if_index ==> running report coalescing timer
+    std::map<unsigned int, std::shared_ptr<upstream_report_timer_msg>> m_report_timers;
+
+    //upstream if_index ==> group address ==> hold-down timer of a held back leave,
+    //the forwarding rules of a held group are kept without output interfaces
+    std::map<unsigned int, std::map<addr_storage, std::shared_ptr<leave_hold_down_timer_msg>>> m_held_leaves;
+    unsigned long m_held_leave_count;
+    unsigned long m_absorbed_flap_count;
+
+    //predictive prejoins, group address ==> decayed number of joins
+    std::map<addr_storage, double> m_join_scores;
+    std::set<addr_storage> m_requested_groups;
+    std::set<addr_storage> m_predicted_groups;
+    std::shared_ptr<prejoin_timer_msg> m_prejoin_timer;
+
+    //group address ==> source address ==> output interfaces of a forwarding rule taken over from the kernel,
+    //they are kept until the first source timer expires and the memberships are learned again
+    std::map<addr_storage, std::map<addr_storage, std::list<unsigned int>>> m_kernel_routes;
+
+    //the life time of a source after its timer expired with packets forwarded during the life time,
+    //the packet rate of this life time is returned by packet_rate
+    std::chrono::milliseconds get_source_life_time(const std::shared_ptr<new_source_timer_msg>& expired_timer, unsigned long packets, double& packet_rate) const;
 
     bool is_rule_matching_type(rb_interface_type interface_type, rb_interface_direction interface_direction, rb_rule_matching_type rule_matching_type) const;
 
-    std::list<std::pair<source, std::list<unsigned int>>> collect_interested_interfaces(const addr_storage& gaddr, const source_list<source>& slist) const;
+    pooled_list<std::pair<source, pooled_list<unsigned int>>> collect_interested_interfaces(const addr_storage& gaddr, const source_list<source>& slist) const;
 
-    void set_routes(const addr_storage& gaddr, const std::list<std::pair<source, std::list<unsigned int>>>& output_if_index) const;
+    void set_routes(const addr_storage& gaddr, const pooled_list<std::pair<source, pooled_list<unsigned int>>>& output_if_index) const;
 
     void del_route(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr) const;
 
-    void send_record(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate) const;
+    void send_record(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate, bool hold_down = true);
+
+    //hold back the leave of a reported group, a join cancels the held leave, the leave of a group with an unsent
+    //pending join cancels the join instead, return true if the record is held or cancelled
+    bool hold_down_leave(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate);
+
+    //return true if the leave of the group is held on an upstream
+    bool is_held_down(const addr_storage& gaddr) const;
+
+    //return true if the prejoin binding rb joins the channel (saddr, gaddr) on the upstream, an undefined saddr is any source
+    bool is_prejoin_upstream(const rule_binding& rb, unsigned int upstream_if_index, const addr_storage& gaddr, const addr_storage& saddr) const;
+
+    //the static and predicted joins of the group on the upstream
+    source_state get_prejoin_state(unsigned int upstream_if_index, const addr_storage& gaddr) const;
+
+    //merge the memberships sstate with the prejoins of the group on the upstream
+    source_state add_prejoin_state(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate) const;
+
+    //return true if the group is joined on an upstream without interested downstreams
+    bool is_prejoined(const addr_storage& gaddr) const;
 
-    std::shared_ptr<new_source_timer_msg> set_source_timer(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr);
+    //the maximum number of predicted groups of all prejoin bindings, 0 if none is predictive
+    unsigned int get_predictive_groups() const;
+
+    //count the join of a group, if it is the first interested downstream
+    void count_join(const addr_storage& gaddr, bool requested);
+
+    //decay the join scores and join the groups with the highest scores
+    void update_predicted_groups();
+
+    //report only the difference to the last reported state of the group
+    void report_state_change(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate);
+
+    void set_report_timer(unsigned int upstream_if_index, const std::chrono::milliseconds& report_window);
+
+    void flush_pending_records(unsigned int upstream_if_index);
+
+    //forget the forwarding rule taken over from the kernel, return true if it was found
+    bool del_kernel_route(const addr_storage& gaddr, const addr_storage& saddr);
+
+    //expired_timer is the expired timer of a refreshed source, packets the packets forwarded since the last refresh
+    std::shared_ptr<new_source_timer_msg> set_source_timer(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr, const std::shared_ptr<new_source_timer_msg>& expired_timer = nullptr, unsigned long packets = 0);
 
     bool check_interface(rb_interface_type interface_type, rb_interface_direction interface_direction, unsigned int checking_if_index, unsigned int input_if_index, const addr_storage& gaddr, const addr_storage& saddr) const;
 
-    void process_membership_aggregation(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr);
+    //aggregate the memberships of the changed downstream if_index, 0 aggregates all downstreams,
+    //return true if a downstream has a membership of the group
+    bool process_membership_aggregation(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr, unsigned int downstream_if_index = 0, const membership_delta* delta = nullptr);
+
+    //recalculate the upstream memberships and the routes of a group, the changed downstream if_index reports the
+    //change delta, 0 recalculates all downstreams (configuration change, predicted prejoins)
+    void process_state_change(unsigned int if_index, const addr_storage& gaddr, const membership_delta* delta);
 
 public:
     simple_mc_proxy_routing(const proxy_instance* p);
 
     void event_new_source(const std::shared_ptr<proxy_msg>& msg) override;
 
-    void event_querier_state_change(unsigned int if_index, const addr_storage& gaddr) override;
+    void event_querier_state_change(unsigned int if_index, const addr_storage& gaddr, const membership_delta& delta) override;
 
     void timer_triggerd_maintain_routing_table(const std::shared_ptr<proxy_msg>& msg) override;
 
+    void event_configuration_change() override;
+
+    void event_kernel_route(unsigned int input_if_index, const addr_storage& gaddr, const addr_storage& saddr, const std::list<unsigned int>& output_if_indexes) override;
+
     std::string to_string() const override;
 };
 
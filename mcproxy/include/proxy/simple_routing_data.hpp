@@ -32,7 +32,7 @@
 class addr_storage;
 struct source;
 struct timer_msg;
-class mroute_socket;
+class kernel_backend;
 
 struct sr_data_value {
     sr_data_value(const source_list<source>& slist, std::map<addr_storage, unsigned int> if_map)
@@ -56,19 +56,27 @@ class simple_routing_data
 private:
     s_routing_data m_data;
     group_mem_protocol m_group_mem_protocol;
-    const std::shared_ptr<const mroute_socket> m_mrt_sock;
+    const std::shared_ptr<const kernel_backend> m_kernel;
     unsigned long get_current_packet_count(const addr_storage& gaddr, const addr_storage& saddr);
 
+    //the new source timer of a source refers to the source while it is stored (O(1) lookup on expiry)
+    static void link_source_timer(const source& s, bool linked);
+
 public:
-    simple_routing_data(group_mem_protocol group_mem_protocol, const std::shared_ptr<const mroute_socket>& mrt_sock);
+    simple_routing_data(group_mem_protocol group_mem_protocol, const std::shared_ptr<const kernel_backend>& kernel);
+
+    ~simple_routing_data();
 
     void set_source(unsigned int if_index, const addr_storage& gaddr, const source& saddr);
 
     void del_source(const addr_storage& gaddr, const addr_storage& saddr);
 
-    //return true if the source has been refreshed 
-    //iterator of the refrehed source
-    std::pair<source_list<source>::iterator, bool> refresh_source_or_del_it_if_unused(const addr_storage& gaddr, const addr_storage& saddr);
+    //return true if the source s (referred by its expired timer) has been refreshed, else it is deleted
+    //packets returns the number of packets forwarded since the last refresh
+    bool refresh_source_or_del_it_if_unused(const addr_storage& gaddr, const source& s, unsigned long* packets = nullptr);
+
+    //replace the new source timer of the source s
+    void set_source_timer(const source& s, const std::shared_ptr<timer_msg>& timer);
 
     const source_list<source>& get_available_sources(const addr_storage& gaddr) const;
 
@@ -0,0 +1,106 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_proxy Proxy
+ * @{
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "include/utils/addr_storage.hpp"
+#include "include/proxy/def.hpp"
+
+#include <string>
+#include <list>
+#include <chrono>
+
+//first bytes of a snapshot file
+#define SNAPSHOT_MAGIC "MCPS"
+#define SNAPSHOT_VERSION 1
+
+struct snapshot_source {
+    addr_storage saddr;
+    std::chrono::milliseconds source_timer; //remaining time
+};
+
+struct snapshot_group {
+    addr_storage gaddr;
+    mc_filter filter_mode;
+    std::chrono::milliseconds filter_timer; //remaining time, only used in EXCLUDE_MODE
+    std::list<snapshot_source> include_requested_list;
+    std::list<addr_storage> exclude_list;
+};
+
+struct snapshot_interface {
+    std::string if_name;
+    std::list<snapshot_group> groups;
+};
+
+struct snapshot_instance {
+    std::string instance_name;
+    std::list<snapshot_interface> downstreams;
+};
+
+/**
+ * @brief Membership state of all downstreams of all proxy instances. It is saved periodically and on
+ * shutdown and loaded on startup, so that a restarted proxy forwards traffic before the hosts answer
+ * the startup queries (warm restart).
+ *
+ * The file format is a compact binary encoding in host byte order: a header (magic, version, time stamp
+ * of the snapshot) followed by instances ==> downstreams ==> groups with their source lists and the
+ * remaining time of each timer.
+ */
+class snapshot
+{
+private:
+    std::chrono::system_clock::time_point m_time_stamp;
+    std::list<snapshot_instance> m_instances;
+
+    //reduce all timers by the time since the snapshot was taken and remove the expired state
+    void age(std::chrono::milliseconds elapsed);
+
+public:
+    snapshot();
+
+    void add_instance(snapshot_instance&& instance);
+    const std::list<snapshot_instance>& get_instances() const;
+
+    /**
+     * @brief Write the snapshot to a temporary file and rename it to path, so that a crash
+     * during the write leaves the last complete snapshot.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Map the snapshot file path into memory and decode it. All timers are reduced by
+     * the time since the snapshot was taken, expired sources and groups are removed.
+     */
+    bool load(const std::string& path);
+
+    std::string to_string() const;
+    friend std::ostream& operator<<(std::ostream& stream, const snapshot& s);
+};
+
+#endif // SNAPSHOT_HPP
+/** @} */
@@ -0,0 +1,90 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_proxy Proxy
+ * @{
+ */
+
+#ifndef THREAD_SETTINGS_HPP
+#define THREAD_SETTINGS_HPP
+
+#include <string>
+#include <map>
+#include <mutex>
+
+#include <sched.h>
+
+/**
+ * @brief The threads of the mcproxy: receivers (own threads or receive loops), workers (proxy instance
+ * threads or executors of the worker pool) and the timing.
+ */
+enum thread_class {TC_RECEIVER, TC_WORKER, TC_TIMING};
+
+std::string get_thread_class_name(thread_class tc);
+
+/**
+ * @brief Scheduling settings of the threads, e.g. to keep them away from the CPUs of the forwarding softirqs
+ * and to hold the timer deadlines under load. They are set from the command line before the first thread
+ * starts, each thread applies the settings of its class when it starts.
+ */
+class thread_settings
+{
+private:
+    static std::mutex m_lock;
+
+    //CPUs a thread class is pinned to, a missing class runs on all CPUs
+    static std::map<thread_class, cpu_set_t> m_affinity;
+
+    //SCHED_FIFO priority of the workers and the timing, 0 = default scheduling
+    static int m_realtime_priority;
+
+    static bool m_memory_locked;
+
+public:
+    /**
+     * @brief Pin the threads of class tc to the CPUs of cpu_list, e.g. "0,2-3".
+     * @return false if cpu_list is invalid
+     */
+    static bool set_affinity(thread_class tc, const std::string& cpu_list);
+
+    /**
+     * @brief Run the workers and the timing at SCHED_FIFO with priority (1-99), 0 restores the default scheduling.
+     * @return false if priority is invalid
+     */
+    static bool set_realtime_priority(int priority);
+
+    /**
+     * @brief Lock all current and future pages of the process into memory (mlockall).
+     */
+    static bool lock_memory();
+
+    /**
+     * @brief Apply the settings of class tc to the calling thread, errors are logged.
+     */
+    static void apply(thread_class tc);
+
+    static std::string to_string();
+};
+
+#endif // THREAD_SETTINGS_HPP
+/** @} */
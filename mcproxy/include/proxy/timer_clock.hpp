@@ -0,0 +1,95 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef TIMER_CLOCK_HPP
+#define TIMER_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Source of the current time for all timers of the process. Per default the steady clock is used,
+ * a simulation injects a virtual clock (see timing).
+ */
+class timer_clock
+{
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    /**
+     * @return the current time of this clock
+     */
+    virtual time_point get_time() const = 0;
+
+    virtual ~timer_clock() = default;
+
+    /**
+     * @return the current time of the clock of the process
+     */
+    static time_point now();
+
+    /**
+     * @brief Set the clock of the process, nullptr restores the steady clock.
+     */
+    static void set_clock(const std::shared_ptr<const timer_clock>& clock);
+
+    /**
+     * @return the deadline of a timer which is not running (it never expires)
+     */
+    static time_point not_running();
+
+    /**
+     * @return the time until deadline, zero if it is expired
+     */
+    static std::chrono::milliseconds get_remaining_duration(const time_point& deadline);
+
+    /**
+     * @return the time until deadline in seconds, e.g. "12sec"
+     */
+    static std::string get_remaining_time(const time_point& deadline);
+};
+
+/**
+ * @brief A clock which only moves on request, used by the discrete event simulation of the timing.
+ */
+class virtual_clock: public timer_clock
+{
+private:
+    std::atomic<time_point::rep> m_time;
+
+public:
+    /**
+     * @param start the virtual time to start with, a fixed start time makes simulations reproducible
+     */
+    virtual_clock(const time_point& start = time_point());
+
+    time_point get_time() const override;
+
+    /**
+     * @brief Move the clock to time (a clock never moves backwards).
+     */
+    void advance_to(const time_point& time);
+};
+
+#endif // TIMER_CLOCK_HPP
@@ -30,6 +30,8 @@
 #define TIME_HPP
 
 #include "include/proxy/message_format.hpp"
+#include "include/proxy/timer_clock.hpp"
+#include "include/utils/object_pool.hpp"
 
 #include <list>
 #include <thread>
@@ -39,16 +41,45 @@
 #include <chrono>
 #include <tuple>
 #include <map>
+#include <array>
+#include <string>
 
 #define TIMING_IDLE_POLLING_INTERVAL 1 //sec
 
+//number of buckets of the timer lag histogram (<0.1ms, <1ms, <10ms, <100ms, >=100ms)
+#define TIMER_LAG_BUCKETS 5
+
 class worker;
 
 using timing_db_value = std::tuple<const worker*, std::shared_ptr<proxy_msg>>;
-using timing_db_key = std::chrono::time_point<std::chrono::steady_clock>;
-using timing_db = std::map<timing_db_key, timing_db_value>; 
+using timing_db_key = timer_clock::time_point;
+
+//reminders with the same deadline are kept in the order they were added, the nodes are pooled
+using timing_db = std::multimap<timing_db_key, timing_db_value, std::less<timing_db_key>, pool_allocator<std::pair<const timing_db_key, timing_db_value>>>;
 using timing_db_pair = std::pair<timing_db_key, timing_db_value>;
 
+/**
+ * @brief Statistic of the lag of expired timers, the time between the deadline of a timer and its dispatching or processing.
+ */
+class timer_lag
+{
+private:
+    unsigned long m_count;
+    std::chrono::nanoseconds m_sum;
+    std::chrono::nanoseconds m_max;
+    std::array<unsigned long, TIMER_LAG_BUCKETS> m_buckets;
+
+public:
+    timer_lag();
+
+    /**
+     * @brief Add the lag of a timer expired at deadline.
+     */
+    void add(const timer_clock::time_point& deadline);
+
+    std::string to_string() const;
+};
+
 /**
  * @brief Organizes timer events.
  */
@@ -57,13 +88,22 @@ class timing
 private:
     timing_db m_db;
 
+    //discrete event simulation, the time only moves by run_next_deadline()
+    const std::shared_ptr<virtual_clock> m_virtual_clock;
+
     bool m_running;
     std::unique_ptr<std::thread> m_thread;
     void worker_thread();
 
+    //pass all reminders up to the deadline until to their workers, the global lock has to be held
+    void dispatch(const timing_db_key& until);
+
     std::mutex m_global_lock;
     std::condition_variable m_con_var;
 
+    //lag of the timing thread behind the deadlines
+    timer_lag m_dispatch_lag;
+
     void start();
     void stop();
     void join() const;
@@ -76,6 +116,20 @@ private:
 public:
     timing();
 
+    /**
+     * @brief Discrete event simulation mode. The virtual clock becomes the clock of the process and no thread is
+     *        started, the reminders are dispatched by run_next_deadline() in the calling thread.
+     */
+    timing(const std::shared_ptr<virtual_clock>& vclock);
+
+    /**
+     * @brief Simulation mode only. Advance the virtual clock to the earliest deadline if it is not later than until
+     *        and pass all reminders of this deadline to their workers, otherwise advance the clock to until.
+     *        The workers should process their messages before the next call to keep the order of real time.
+     * @return true if reminders are dispatched
+     */
+    bool run_next_deadline(const timing_db_key& until);
+
     /**
      * @brief Add a new reminder with an predefined time.
      * @param msec predefined time in millisecond
@@ -90,12 +144,22 @@ public:
      */
     void stop_all_time(const worker* msg_worker);
 
+    /**
+     * @return the lag between the deadlines and the passing of the reminders to their workers
+     */
+    timer_lag get_dispatch_lag();
+
     virtual ~timing();
     
         /**
      * @brief Test the functionality of the module Timer.
      */
     static void test_timing();
+
+    /**
+     * @brief Test the discrete event simulation mode of the module Timer.
+     */
+    static void test_timing_simulation();
 };
 
 #endif // TIME_HPP
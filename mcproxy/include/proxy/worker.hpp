@@ -33,27 +33,55 @@
 
 #include <thread>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #define WORKER_MESSAGE_QUEUE_DEFAULT_SIZE 150
 
+class worker_pool;
+
 /**
  * @brief Wraps a priority job queue like a very simple actor pattern.
  * The priority queue syncronised the received jobs for squentially processing.
+ * The jobs are processed either by an own thread or, if a worker_pool is
+ * set, by the executor threads of the shared pool.
  */
 class worker
 {
+private:
+    const std::shared_ptr<worker_pool> m_worker_pool;
+
+    //true as long as the worker is queued at or executed by the worker_pool
+    std::atomic<bool> m_scheduled;
+
+    //set by worker_pool::release(), a released worker is never queued again, guarded by the lock of the worker_pool
+    mutable bool m_released;
+
+    mutable std::mutex m_state_lock;
+    mutable std::condition_variable m_cond_stopped;
+
+    //the worker thread loop if no worker_pool is used
+    void worker_thread();
+
+    //process at most max_msg jobs, return true if more jobs are pending
+    bool process_pending_msgs(unsigned int max_msg);
+
+    //hand the worker over to the worker_pool if it is not already scheduled
+    void schedule();
+
 protected:
     std::unique_ptr<std::thread> m_thread;
 
     /**
-     * @brief Worker thread to process the jobs.
+     * @brief Process a single job. All jobs of a worker are processed squentially.
      */
-    virtual void worker_thread() = 0;
+    virtual void process_msg(const std::shared_ptr<proxy_msg>& msg) = 0;
 
     /**
-     * @brief The threads runs as long as m_running is true.
+     * @brief The worker processes jobs as long as m_running is true.
      */
-    bool m_running;
+    std::atomic<bool> m_running;
 
     /**
      * @brief Job queue to process proxy_msg.
@@ -71,6 +99,12 @@ public:
     worker();
     worker(int queue_size);
 
+    /**
+     * @brief Create a worker which is executed by a shared worker_pool instead of an own thread.
+     * @param shared_worker_pool executor threads shared by many workers, if nullptr the worker uses an own thread
+     */
+    worker(int queue_size, const std::shared_ptr<worker_pool>& shared_worker_pool);
+
     virtual ~worker();
 
     /**
@@ -84,6 +118,8 @@ public:
     void add_msg(const std::shared_ptr<proxy_msg>& msg) const;
 
     static void test_worker();
+
+    friend worker_pool;
 };
 
 #endif // WORKER_HPP
@@ -0,0 +1,114 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+/**
+ * @addtogroup mod_communication Communication
+ * @{
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <thread>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <deque>
+
+/**
+ * @brief Maximum number of jobs a worker processes before its executor thread
+ * looks for other workers, so that a busy proxy instance cannot starve the others.
+ */
+#define WORKER_POOL_SLICE_SIZE 32
+
+class worker;
+
+/**
+ * @brief A fixed number of executor threads shared by many workers (M:N).
+ * A worker is queued at most once, so all jobs of one worker are processed
+ * squentially. Each executor prefers its own run queue (a rescheduled worker
+ * stays on the same executor) and steals from the others if it runs idle.
+ */
+class worker_pool
+{
+private:
+    struct executor {
+        executor(): m_current(nullptr) {}
+        std::deque<worker*> m_run_queue;
+        const worker* m_current;
+    };
+
+    bool m_running;
+    std::vector<executor> m_executors;
+    std::vector<std::unique_ptr<std::thread>> m_threads;
+    unsigned int m_next_executor;
+
+    std::mutex m_global_lock;
+    std::condition_variable m_cond_work;
+    std::condition_variable m_cond_idle;
+
+    void executor_thread(unsigned int executor_id);
+
+    //pop a worker from the own run queue or steal one, requires m_global_lock
+    worker* next_worker(unsigned int executor_id);
+
+    void stop();
+    void join();
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+public:
+    /**
+     * @param size number of executor threads
+     */
+    worker_pool(unsigned int size);
+
+    virtual ~worker_pool();
+
+    /**
+     * @brief Queue a worker with pending jobs.
+     * @return false if the worker is stopped or released and was not queued
+     */
+    bool schedule(worker* w);
+
+    /**
+     * @brief Remove a worker from all run queues and wait until no executor processes its jobs.
+     * The worker is never queued again.
+     */
+    void release(const worker* w);
+
+    /**
+     * @return Get the number of executor threads.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Suggest a pool size, at most one executor per hardware thread and per worker.
+     * @param worker_count number of workers expected to share the pool
+     */
+    static unsigned int get_default_pool_size(unsigned int worker_count);
+};
+
+#endif // WORKER_POOL_HPP
+/** @} */
@@ -0,0 +1,181 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef HOST_POPULATION_HPP
+#define HOST_POPULATION_HPP
+
+#include "include/utils/addr_storage.hpp"
+#include "include/proxy/def.hpp"
+
+#include <vector>
+#include <list>
+#include <map>
+#include <queue>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <cstdint>
+
+//maximum random delay of a retransmitted state change report
+#define HOST_POPULATION_UNSOLICITED_REPORT_INTERVAL_V2 10000 //msec (IGMPv2, MLDv1)
+#define HOST_POPULATION_UNSOLICITED_REPORT_INTERVAL_V3 1000 //msec (IGMPv3, MLDv2)
+
+#define HOST_POPULATION_ROBUSTNESS_DEFAULT 2 //transmissions of a state change report
+
+//maximum size of an ip packet sent by a virtual host
+#define HOST_POPULATION_MAX_PACKET_SIZE 1500 //bytes
+
+/**
+ * @brief Simulates a population of virtual hosts (e.g. set-top boxes) on a link. Each host
+ * watches at most one of consecutive channels (groups) chosen by a Zipf popularity, zaps or
+ * switches off after an exponential dwell time and answers the queries of the querier with
+ * random response delays (with report suppression for IGMPv2 and MLDv1). The membership
+ * reports are crafted with the address of the virtual host and sent with a packet socket.
+ */
+class host_population
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    enum event_type {
+        ET_CHANGE, //zap, join or switch off
+        ET_RETRANSMISSION, //retransmission of the last state change report
+        ET_RESPONSE //answer of a query
+    };
+
+    struct event {
+        clock::time_point m_time;
+        event_type m_type;
+        unsigned int m_host;
+
+        //state generation (ET_RETRANSMISSION) or query number (ET_RESPONSE)
+        uint64_t m_id;
+
+        friend bool operator>(const event& l, const event& r) {
+            return l.m_time > r.m_time;
+        }
+    };
+
+    struct host {
+        addr_storage m_addr;
+        int m_channel = -1; //-1 switched off
+        int m_old_channel = -1; //channel left with the last state change
+        uint64_t m_generation = 0; //incremented by each state change
+        clock::time_point m_response_time; //time of the pending query response
+        std::list<addr_storage> m_response_sources; //queried sources of the pending response, the full state is reported if empty
+    };
+
+    const group_mem_protocol m_group_mem_protocol;
+    const int m_addr_family;
+    const unsigned int m_if_index;
+
+    std::vector<addr_storage> m_channels;
+    std::map<addr_storage, unsigned int> m_channel_index;
+    const std::list<addr_storage> m_sources; //source specific channels if not empty
+
+    std::vector<double> m_zipf_cdf;
+    const std::chrono::milliseconds m_mean_dwell_time;
+    const unsigned int m_off_ratio; //percent
+    const std::chrono::milliseconds m_mean_off_time;
+    const std::chrono::milliseconds m_ramp_time;
+    const unsigned int m_robustness;
+    const bool m_leave_on_exit;
+
+    std::mt19937 m_rng;
+    std::vector<host> m_hosts;
+    std::priority_queue<event, std::vector<event>, std::greater<event>> m_events;
+
+    int m_sock;
+    std::vector<uint8_t> m_packet_buf;
+
+    //IGMPv2 and MLDv1 report suppression, the last query a report of the channel answered
+    uint64_t m_query_count;
+    std::vector<uint64_t> m_last_answered_query;
+
+    //statistics
+    uint64_t m_changes;
+    uint64_t m_joins;
+    uint64_t m_leaves;
+    uint64_t m_zaps;
+    uint64_t m_retransmissions;
+    uint64_t m_general_queries;
+    uint64_t m_specific_queries;
+    uint64_t m_responses;
+    uint64_t m_suppressed;
+    uint64_t m_packets_sent;
+    uint64_t m_send_errors;
+    std::vector<unsigned int> m_viewers;
+
+    bool is_v2() const;
+    unsigned int sample_channel();
+    clock::duration random_delay(const std::chrono::milliseconds& max_delay);
+    clock::duration exponential_delay(const std::chrono::milliseconds& mean);
+
+    void change_state(unsigned int host_index);
+    void send_state_change(unsigned int host_index, bool retransmission);
+    void send_response(unsigned int host_index);
+
+    void process_event(const event& e);
+    void process_packet(const uint8_t* buf, unsigned int size);
+    void process_query(const addr_storage& gaddr, const std::chrono::milliseconds& max_resp_delay, std::list<addr_storage>&& qslist);
+    void process_report(const addr_storage& gaddr);
+
+    //records: <record type, channel, sources>
+    bool send_report(const addr_storage& saddr, const std::list<std::tuple<mcast_addr_record_type, unsigned int, std::list<addr_storage>>>& records);
+    bool send_v2_message(const addr_storage& saddr, bool join, unsigned int channel);
+
+    //adds the ip header (with router alert option) and the checksums to the IGMP or ICMPv6 payload
+    bool send_packet(const addr_storage& saddr, const addr_storage& daddr, std::vector<uint8_t>& payload);
+
+public:
+    /**
+     * @param group_mem_protocol IGMPv2, IGMPv3, MLDv1 or MLDv2
+     * @param if_name link of the virtual hosts
+     * @param host_addr address of the first virtual host, the others follow consecutively (IPv4 addresses have to be in the subnet of the querier)
+     * @param host_count number of virtual hosts
+     * @param gaddr first channel, the others follow consecutively
+     * @param channel_count number of channels
+     * @param sources sources of the channels (IGMPv3 and MLDv2 only), any source if empty
+     * @param zipf_exponent popularity of the channels, the channel of rank k is chosen with a probability proportional to 1/k^zipf_exponent
+     * @param mean_dwell_time mean time a host watches a channel
+     * @param off_ratio percentage of the channel changes that switch a host off instead of zapping
+     * @param mean_off_time mean time a host is switched off
+     * @param ramp_time the hosts switch on randomly distributed within this time
+     * @param robustness transmissions of a state change report
+     * @param leave_on_exit if true the hosts leave their channels when the simulation ends
+     * @param seed of the random generator
+     */
+    host_population(group_mem_protocol group_mem_protocol, const std::string& if_name, const addr_storage& host_addr, unsigned int host_count, const addr_storage& gaddr, unsigned int channel_count, const std::list<addr_storage>& sources, double zipf_exponent, const std::chrono::milliseconds& mean_dwell_time, unsigned int off_ratio, const std::chrono::milliseconds& mean_off_time, const std::chrono::milliseconds& ramp_time, unsigned int robustness, bool leave_on_exit, int seed);
+
+    virtual ~host_population();
+
+    /**
+     * @brief Simulate the hosts until running is false or max_count state changes are done (0 = infinity).
+     */
+    void run(const bool& running, unsigned long max_count, bool print_status_msg);
+
+    std::string to_string() const;
+};
+
+#endif // HOST_POPULATION_HPP
@@ -0,0 +1,121 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef PACKET_STATS_HPP
+#define PACKET_STATS_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#define PACKET_STATS_DEFAULT_WINDOW_SIZE 65536 //packets, power of two
+
+//sub-buckets of a histogram magnitude, the relative error of a recorded value is below 2 / PACKET_STATS_SUB_BUCKETS
+#define PACKET_STATS_SUB_BUCKET_BITS 8
+#define PACKET_STATS_SUB_BUCKETS (1 << PACKET_STATS_SUB_BUCKET_BITS)
+
+/**
+ * @brief Sliding window over the sequence numbers of the received packets. A bitmap
+ * marks the received packets of the window, a packet is lost if it slides out of the
+ * window without being received.
+ */
+class packet_window
+{
+private:
+    std::vector<uint64_t> m_bitmap;
+    uint64_t m_mask;
+    bool m_started;
+    uint64_t m_highest;
+
+    uint64_t m_received;
+    uint64_t m_lost;
+    uint64_t m_duplicates;
+    uint64_t m_reordered;
+    uint64_t m_late;
+
+    bool test(uint64_t seq) const;
+    void set(uint64_t seq);
+    void clear(uint64_t seq);
+
+public:
+    /**
+     * @param window_size number of packets the window covers, rounded up to a power of two
+     */
+    packet_window(uint64_t window_size = PACKET_STATS_DEFAULT_WINDOW_SIZE);
+
+    /**
+     * @return true if the packet seq is received the first time
+     */
+    bool add(uint64_t seq);
+
+    uint64_t get_received() const;
+
+    //the packets slid out of the window and the missing packets of the window
+    uint64_t get_lost() const;
+
+    uint64_t get_duplicates() const;
+    uint64_t get_reordered() const;
+
+    //packets arrived after they slid out of the window (counted as lost)
+    uint64_t get_late() const;
+};
+
+/**
+ * @brief Histogram with logarithmic buckets of linear sub-buckets (like a HDR histogram),
+ * the values are recorded in constant time and memory with a bounded relative error.
+ */
+class latency_histogram
+{
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_total_count;
+    uint64_t m_min;
+    uint64_t m_max;
+    long double m_sum;
+
+    static unsigned int get_index(uint64_t value);
+
+    //the representative value (middle) of the values of bucket index
+    static uint64_t get_value(unsigned int index);
+
+public:
+    latency_histogram();
+
+    void add(uint64_t value);
+
+    uint64_t get_count() const;
+    uint64_t get_min() const;
+    uint64_t get_max() const;
+    double get_mean() const;
+
+    /**
+     * @param percentile between 0 and 100
+     */
+    uint64_t get_percentile(double percentile) const;
+
+    /**
+     * @return one line per used bucket: <value> <count> <cumulative percentile>
+     */
+    std::string to_string() const;
+};
+
+#endif // PACKET_STATS_HPP
@@ -24,6 +24,8 @@
 #define TESTER_HPP
 
 #include "include/tester/config_map.hpp"
+#include "include/tester/packet_stats.hpp"
+#include "include/tester/host_population.hpp"
 #include "include/utils/addr_storage.hpp"
 #include "include/proxy/def.hpp"
 #include "include/utils/mc_socket.hpp"
@@ -34,6 +36,9 @@
 
 #define TESTER_DEFAULT_CONIG_PATH "tester.ini"
 
+//the traffic of a left group has stopped if no packet arrived within this time before the end of the leave wait
+#define TESTER_ZAP_QUIET_TIME 100 //msec
+
 class packet_manager
 {
 private:
@@ -72,6 +77,15 @@ private:
 
     void send_data(const std::unique_ptr<const mc_socket>& ms, addr_storage& gaddr, int port, int ttl, unsigned long max_count, unsigned int& current_packet_number, bool include_time_stamp, const std::chrono::milliseconds& interval, int busy_waiting_counter,  const std::string& msg, bool print_status_msg);
     void receive_data(const std::unique_ptr<const mc_socket>& ms, int port, const addr_storage& gaddr, unsigned long max_count, bool parse_time_stamp, bool print_status_msg, bool save_to_file, const std::string& file_name, bool include_file_header, bool include_data, bool include_summary, bool ignore_duplicated_packets, packet_manager& pmanager, const std::string& file_operation_mode);
+
+    //batched sending (sendmmsg) of packets with a binary sequence number and time stamp, paced by a timerfd to send_rate packets per second (0 unpaced)
+    void send_data_high_rate(const std::unique_ptr<const mc_socket>& ms, const addr_storage& gaddr, int port, int ttl, unsigned long max_count, unsigned long send_rate, unsigned int batch_size, unsigned int packet_size, bool print_status_msg);
+
+    //batched receiving (recvmmsg) of the packets of send_data_high_rate with loss, duplicate and latency statistics
+    void receive_data_high_rate(const std::unique_ptr<const mc_socket>& ms, int port, const addr_storage& gaddr, unsigned long max_count, unsigned int batch_size, unsigned long window_size, bool print_status_msg, bool save_to_file, const std::string& file_name, const std::string& file_operation_mode);
+
+    //change max_count times between group_count consecutive groups starting at gaddr and measure the join, leave and zap latencies
+    void zap_data(const std::unique_ptr<const mc_socket>& ms, const std::string& if_name, const addr_storage& gaddr, unsigned int group_count, unsigned long max_count, bool zapping, const std::chrono::milliseconds& dwell_time, const std::chrono::milliseconds& leave_wait, const std::chrono::milliseconds& timeout, int seed, bool save_to_file, const std::string& file_name, const std::string& file_operation_mode);
     static void signal_handler(int sig);
 
 public:
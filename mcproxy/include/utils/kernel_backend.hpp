@@ -0,0 +1,99 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef KERNEL_BACKEND_HPP
+#define KERNEL_BACKEND_HPP
+
+#include "include/utils/addr_storage.hpp"
+#include "include/utils/object_pool.hpp"
+
+#include <linux/mroute.h>
+#include <linux/mroute6.h>
+
+#include <list>
+
+/**
+ * @brief Interface to the multicast forwarding tables (virtual interfaces and multicast forwarding cache).
+ * Implemented by the mroute_socket for the Linux kernel and by the mfc_simulator for tests without privileges.
+ */
+class kernel_backend
+{
+public:
+    /**
+     * @brief Add a virtual interface.
+     * @param vif_index unique number of the virtual interface (0 <= vif_index < MAXVIFS)
+     * @param if_index interface index
+     * @param ip_tunnel_remote_addr remote address of a tunnel interface, else an empty addr_storage
+     * @return Return true on success.
+     */
+    virtual bool add_vif(int vif_index, uint32_t if_index, const addr_storage& ip_tunnel_remote_addr) const = 0;
+
+    /**
+     * @brief Delete a virtual interface.
+     * @return Return true on success.
+     */
+    virtual bool del_vif(int vif_index) const = 0;
+
+    /**
+     * @brief Bind the interface to a spezific table as output and input interface
+     * @return Return true on success.
+     */
+    virtual bool bind_vif_to_table(uint32_t if_index, int table) const = 0;
+
+    /**
+     * @brief Unbind the interface from a spezific table as output and input interface
+     * @return Return true on success.
+     */
+    virtual bool unbind_vif_form_table(uint32_t if_index, int table) const = 0;
+
+    /**
+     * @brief Add or replace a multicast forwarding rule.
+     * @param vif_index input virtual interface
+     * @param output_vif forward to this virtual interfaces
+     * @return Return true on success.
+     */
+    virtual bool add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const pooled_list<int>& output_vif) const = 0;
+
+    /**
+     * @brief Delete a multicast forwarding rule.
+     * @return Return true on success.
+     */
+    virtual bool del_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr) const = 0;
+
+    /**
+     * @brief Delete all multicast forwarding rules, including the static ones.
+     * @return Return true on success.
+     */
+    virtual bool flush_mroutes() const = 0;
+
+    /**
+     * @brief Get the packet counters of a multicast forwarding rule.
+     * @param sgreq_v4 musst point to a sioc_sg_req struct for IPv4, else nullptr
+     * @param sgreq_v6 musst point to a sioc_sg_req6 struct for IPv6, else nullptr
+     * @return Return true on success.
+     */
+    virtual bool get_mroute_stats(const addr_storage& source_addr, const addr_storage& group_addr, struct sioc_sg_req* sgreq_v4, struct sioc_sg_req6* sgreq_v6) const = 0;
+
+    virtual ~kernel_backend() = default;
+};
+
+#endif // KERNEL_BACKEND_HPP
@@ -141,6 +141,11 @@ public:
      */
     int get_addr_family() const;
 
+    /**
+     * @return Get the socket descriptor, e.g. to register it at an epoll instance.
+     */
+    int get_socket() const;
+
     /**
      * @brief Bind IPv4 or IPv6 socket to a specific port and address.
      * @return Return true on success.
@@ -182,6 +187,17 @@ public:
      */
     bool send_packet(const addr_storage& addr, const unsigned char* data, unsigned int data_size) const;
 
+    /**
+     * @brief Send data to a specific ip address on a specific network interface.
+     *        The interface is chosen per packet (IP_PKTINFO or IPV6_PKTINFO), no choose_if() is needed.
+     * @param addr destination address of packet and the destination port
+     * @param data data to send
+     * @param data_size size of the data
+     * @param if_index outgoing interface
+     * @return Return true on success.
+     */
+    bool send_packet(const addr_storage& addr, const unsigned char* data, unsigned int data_size, uint32_t if_index) const;
+
     /**
      * @brief Receive a datagram
      * @param[out] buf read N bytes into buf from socket
@@ -0,0 +1,151 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef MFC_SIMULATOR_HPP
+#define MFC_SIMULATOR_HPP
+
+#include "include/utils/kernel_backend.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+//the kernel holds at most 10 unresolved forwarding rules, each queues at most 4 packets until it is resolved
+#define MFC_SIMULATOR_MAX_UNRESOLVED 10
+#define MFC_SIMULATOR_MAX_UNRESOLVED_PACKETS 4
+
+/**
+ * @brief Callback function to publish the upcalls (NOCACHE) of the simulator.
+ * The callback function informs about the input virtual interface, the group address and the source address.
+ */
+using callback_upcall = std::function<void(int, const addr_storage&, const addr_storage&)>;
+
+/**
+ * @brief In-memory model of the Linux multicast forwarding tables (virtual interfaces and multicast forwarding cache).
+ * It keeps the virtual interface limit, the packet counters and the upcalls of unresolved packets (NOCACHE), so the
+ * routing of a proxy instance works without privileges and without a multicast capable kernel.
+ */
+class mfc_simulator: public kernel_backend
+{
+private:
+    struct vif_entry {
+        uint32_t if_index;
+        addr_storage ip_tunnel_remote_addr;
+        unsigned long pkt_in;
+        unsigned long pkt_out;
+        unsigned long bytes_in;
+        unsigned long bytes_out;
+    };
+
+    struct mfc_entry {
+        int input_vif;
+        pooled_list<int> output_vif;
+        unsigned long pktcnt;
+        unsigned long bytecnt;
+        unsigned long wrong_if;
+    };
+
+    //source address, group address
+    using mfc_key = std::pair<addr_storage, addr_storage>;
+
+    //input virtual interface and size of the queued packets
+    using unresolved_entry = pooled_list<std::pair<int, unsigned int>>;
+
+    const int m_addr_family;
+    const int m_max_vifs;
+
+    mutable std::mutex m_global_lock;
+    mutable pooled_map<int, vif_entry> m_vifs;
+    mutable pooled_map<mfc_key, mfc_entry> m_mfc;
+    mutable pooled_map<mfc_key, unresolved_entry> m_unresolved;
+    mutable unsigned long m_upcall_count;
+
+    callback_upcall m_cb_upcall;
+
+    //returns the virtual interface of the interface if_index or -1
+    int get_vif(uint32_t if_index) const;
+
+    //forward a packet received on vif_index with the forwarding rule e, returns the number of sent copies
+    unsigned int forward(int vif_index, unsigned int size, mfc_entry& e) const;
+
+public:
+    /**
+     * @param addr_family AF_INET or AF_INET6
+     * @param max_vifs Maximum number of virtual interfaces, 0 uses the kernel limit (MAXVIFS or MAXMIFS).
+     */
+    mfc_simulator(int addr_family, int max_vifs = 0);
+
+    /**
+     * @brief Set the callback function for the upcalls (NOCACHE) of unresolved packets.
+     */
+    void set_upcall_callback(callback_upcall cb_upcall);
+
+    /**
+     * @brief Pass a multicast packet received on interface if_index through the forwarding tables.
+     * A packet without forwarding rule is queued and causes an upcall if it is the first one of the source and group.
+     * @param size packet size in bytes
+     * @return the number of forwarded copies of the packet
+     */
+    unsigned int receive_packet(uint32_t if_index, const addr_storage& source_addr, const addr_storage& group_addr, unsigned int size) const;
+
+    /**
+     * @brief Drop all unresolved packets, the next packet of such a source and group causes a new upcall
+     *        (the kernel expires unresolved forwarding rules after 10 seconds).
+     */
+    void expire_unresolved() const;
+
+    bool add_vif(int vif_index, uint32_t if_index, const addr_storage& ip_tunnel_remote_addr) const override;
+    bool del_vif(int vif_index) const override;
+    bool bind_vif_to_table(uint32_t if_index, int table) const override;
+    bool unbind_vif_form_table(uint32_t if_index, int table) const override;
+    bool add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const pooled_list<int>& output_vif) const override;
+    bool del_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr) const override;
+    bool flush_mroutes() const override;
+    bool get_mroute_stats(const addr_storage& source_addr, const addr_storage& group_addr, struct sioc_sg_req* sgreq_v4, struct sioc_sg_req6* sgreq_v6) const override;
+
+    /**
+     * @brief Get the packet counters of a virtual interface.
+     * @param req_v4 musst point to a sioc_vif_req struct for IPv4, else nullptr
+     * @param req_v6 musst point to a sioc_mif_req6 struct for IPv6, else nullptr
+     * @return Return true on success.
+     */
+    bool get_vif_stats(int vif_index, struct sioc_vif_req* req_v4, struct sioc_mif_req6* req_v6) const;
+
+    /**
+     * @return the number of (resolved) forwarding rules
+     */
+    unsigned int get_mroute_count() const;
+
+    /**
+     * @return the number of upcalls since the start
+     */
+    unsigned long get_upcall_count() const;
+
+    std::string to_string() const;
+    friend std::ostream& operator<<(std::ostream& stream, const mfc_simulator& ms);
+
+    static void test_mfc_simulator();
+};
+
+#endif // MFC_SIMULATOR_HPP
@@ -24,6 +24,7 @@
 #define MROUTE_SOCKET_HPP
 
 #include "include/utils/mc_socket.hpp"
+#include "include/utils/kernel_backend.hpp"
 #include <sys/types.h>
 #include <linux/mroute.h>
 #include <linux/mroute6.h>
@@ -39,7 +40,7 @@
 /**
  * @brief Wrapper for a multicast socket with additional functions to manipulate Linux kernel tables.
  */
-class mroute_socket: public mc_socket
+class mroute_socket: public mc_socket, public kernel_backend
 {
 private:
     //not used
@@ -108,6 +109,15 @@ public:
      */
     u_int16_t calc_checksum(const unsigned char* buf, int buf_size) const;
 
+    /**
+     * @brief Update an internet checksum after a part of the packet has changed (RFC 1624).
+     * @param cksum checksum of the packet before the modification
+     * @param old_data old content of the modified part, nullptr if the part was zero (e.g. appended data)
+     * @param new_data new content of the modified part
+     * @param size size of the modified part, has to be even
+     */
+    u_int16_t update_checksum(u_int16_t cksum, const unsigned char* old_data, const unsigned char* new_data, int size) const;
+
     /**
      * @brief Calculate the ICMPv6 header checksum by sending an ICMPv6 packet.
      *        Per default the ICMP6 checksum (RFC 3542 Section 3.1) will be calculate.
@@ -161,7 +171,7 @@ public:
      * @param ip_tunnel_remote_addr if the interface is a tunnel interface the remote address has to set else it has to be an empty addr_storage
      * @return Return true on success.
      */
-    bool add_vif(int vifNum, uint32_t if_index, const addr_storage& ip_tunnel_remote_addr) const;
+    bool add_vif(int vifNum, uint32_t if_index, const addr_storage& ip_tunnel_remote_addr) const override;
 
     /**
      * @brief Bind the interface to a spezific table as output and input interface
@@ -169,7 +179,7 @@ public:
      * @param table is the spezific table
      * @return Return true on success.
      */
-    bool bind_vif_to_table(uint32_t if_index, int table) const;
+    bool bind_vif_to_table(uint32_t if_index, int table) const override;
 
     /**
      * @brief unbind the interface from a spezific table as output and input interface
@@ -177,14 +187,14 @@ public:
      * @param table is the spezific table
      * @return Return true on success.
      */
-    bool unbind_vif_form_table(uint32_t if_index, int table) const;
+    bool unbind_vif_form_table(uint32_t if_index, int table) const override;
 
     /**
      * @brief Delete the virtual interface from the multicast routing table.
      * @param vif_index virtual index of the interface
      * @return Return true on success.
      */
-    bool del_vif(int vif_index) const;
+    bool del_vif(int vif_index) const override;
 
     /**
      * @brief Adds a multicast route to the kernel.
@@ -197,7 +207,7 @@ public:
      * @param output_vifNum_size size of the interface indexes
      * @return Return true on success.
      */
-    bool add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const std::list<int>& output_vif) const;
+    bool add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const pooled_list<int>& output_vif) const override;
 
     /**
      * @brief Delete a multicast route.
@@ -206,7 +216,14 @@ public:
      * @param group_addr from the receiving packet
      * @return Return true on success.
      */
-    bool del_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr) const;
+    bool del_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr) const override;
+
+    /**
+     * @brief Delete all multicast routes of the multicast routing table, including the static
+     *        routes which outlive the socket that set the MRT flag.
+     * @return Return true on success.
+     */
+    bool flush_mroutes() const override;
 
     /**
      * @brief Get various statistics per interface.
@@ -225,7 +242,7 @@ public:
      * @param sgreq_v6 musst point to a sioc_sg_req6 struct and will filled by this function when ipv6 is used
      * @return Return true on success.
      */
-    bool get_mroute_stats(const addr_storage& source_addr, const addr_storage& group_addr, struct sioc_sg_req* sgreq_v4, struct sioc_sg_req6* sgreq_v6) const;
+    bool get_mroute_stats(const addr_storage& source_addr, const addr_storage& group_addr, struct sioc_sg_req* sgreq_v4, struct sioc_sg_req6* sgreq_v6) const override;
 
     /**
      * @brief simple test outputs
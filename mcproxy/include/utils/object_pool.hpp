@@ -0,0 +1,183 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+//number of objects allocated at once if a pool is exhausted
+#define OBJECT_POOL_CHUNK_SIZE 64
+
+/**
+ * @brief Thread safe free list of equally typed objects. The memory of released objects
+ * is reused and never returned to the heap, so a pool grows only up to its peak usage.
+ */
+template<typename T>
+class object_pool
+{
+private:
+    union slot {
+        slot* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::mutex m_global_lock;
+    slot* m_free;
+    std::vector<std::unique_ptr<slot[]>> m_chunks;
+    unsigned long m_in_use;
+
+    object_pool()
+        : m_free(nullptr)
+        , m_in_use(0) {
+    }
+
+public:
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    /**
+     * @brief Return the pool of the type T. The pool is never destroyed, objects may be
+     * released after the static objects of the process.
+     */
+    static object_pool& instance() {
+        static object_pool* pool = new object_pool();
+        return *pool;
+    }
+
+    /**
+     * @brief Return uninitialised memory for one object, the pool grows by a chunk if it is exhausted.
+     */
+    T* allocate() {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+
+        if (m_free == nullptr) {
+            std::unique_ptr<slot[]> chunk(new slot[OBJECT_POOL_CHUNK_SIZE]);
+            for (unsigned int i = 0; i < OBJECT_POOL_CHUNK_SIZE; ++i) {
+                chunk[i].next = m_free;
+                m_free = &chunk[i];
+            }
+            m_chunks.push_back(std::move(chunk));
+        }
+
+        slot* s = m_free;
+        m_free = s->next;
+        ++m_in_use;
+        return reinterpret_cast<T*>(&s->storage);
+    }
+
+    /**
+     * @brief Give the memory of an object, which is already destructed, back to the pool.
+     */
+    void deallocate(T* p) {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+
+        slot* s = reinterpret_cast<slot*>(p);
+        s->next = m_free;
+        m_free = s;
+        --m_in_use;
+    }
+
+    /**
+     * @brief Return the number of chunks allocated from the heap.
+     */
+    unsigned long get_chunk_count() {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+        return m_chunks.size();
+    }
+
+    /**
+     * @brief Return the number of objects currently allocated from the pool.
+     */
+    unsigned long get_in_use() {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+        return m_in_use;
+    }
+};
+
+/**
+ * @brief Allocator which takes single objects from the object_pool of their type. Used with std::allocate_shared
+ * the object and its reference counter share one pooled slot, used with a node based container each node is pooled.
+ * Arrays are allocated from the heap.
+ */
+template<typename T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template<typename U>
+    pool_allocator(const pool_allocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        if (n == 1) {
+            return object_pool<T>::instance().allocate();
+        } else {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        if (n == 1) {
+            object_pool<T>::instance().deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template<typename U>
+    struct rebind {
+        using other = pool_allocator<U>;
+    };
+};
+
+template<typename T, typename U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&)
+{
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&)
+{
+    return false;
+}
+
+//node based containers of the record processing, their nodes are reused instead of allocated from the heap
+template<typename T>
+using pooled_list = std::list<T, pool_allocator<T>>;
+
+template<typename T>
+using pooled_set = std::set<T, std::less<T>, pool_allocator<T>>;
+
+template<typename Key, typename T>
+using pooled_map = std::map<Key, T, std::less<Key>, pool_allocator<std::pair<const Key, T>>>;
+
+#endif // OBJECT_POOL_HPP
@@ -10,14 +10,29 @@ tester {
     DEFINES += TESTER
 
     SOURCES += src/tester/config_map.cpp \
-           src/tester/tester.cpp
+           src/tester/tester.cpp \
+           src/tester/packet_stats.cpp \
+           src/tester/host_population.cpp
 
     HEADERS += include/tester/config_map.hpp \
-           include/tester/tester.hpp
+           include/tester/tester.hpp \
+           include/tester/packet_stats.hpp \
+           include/tester/host_population.hpp
 
     LIBS += -L/usr/lib -lboost_regex
 }
 
+bench {
+    CONFIG-=mcproxy #removes default mode
+    message("target bench")
+    TARGET = bench
+    DEFINES += BENCH
+
+    SOURCES += src/bench/bench.cpp
+
+    HEADERS += include/bench/bench.hpp
+}
+
 mcproxy { #default mode
     message("target mcproxy")
     TARGET = mcproxy
@@ -53,6 +68,7 @@ SOURCES += src/main.cpp \
            src/utils/mc_socket.cpp \
            src/utils/addr_storage.cpp \
            src/utils/mroute_socket.cpp \
+           src/utils/mfc_simulator.cpp \
            src/utils/if_prop.cpp \
            src/utils/reverse_path_filter.cpp \
                #proxy
@@ -63,10 +79,14 @@ SOURCES += src/main.cpp \
            src/proxy/igmp_receiver.cpp \
            src/proxy/mld_sender.cpp \
            src/proxy/igmp_sender.cpp \
+           src/proxy/null_sender.cpp \
            src/proxy/proxy_instance.cpp \
            src/proxy/routing.cpp \
            src/proxy/worker.cpp \
+           src/proxy/worker_pool.cpp \
+           src/proxy/receive_loop.cpp \
            src/proxy/timing.cpp \
+           src/proxy/timer_clock.cpp \
            src/proxy/check_if.cpp \
            src/proxy/check_kernel.cpp \
            src/proxy/membership_db.cpp \
@@ -76,6 +96,9 @@ SOURCES += src/main.cpp \
            src/proxy/def.cpp \
            src/proxy/simple_mc_proxy_routing.cpp \
            src/proxy/simple_routing_data.cpp \
+           src/proxy/snapshot.cpp \
+           src/proxy/capture.cpp \
+           src/proxy/thread_settings.cpp \
                #parser
            src/parser/scanner.cpp \
            src/parser/token.cpp \
@@ -89,6 +112,9 @@ HEADERS += include/hamcast_logging.h \
            include/utils/addr_storage.hpp \
            include/utils/reverse_path_filter.hpp \
            include/utils/mroute_socket.hpp \
+           include/utils/kernel_backend.hpp \
+           include/utils/mfc_simulator.hpp \
+           include/utils/object_pool.hpp \
            include/utils/if_prop.hpp \
            include/utils/extended_mld_defines.hpp \
            include/utils/extended_igmp_defines.hpp \
@@ -100,12 +126,16 @@ HEADERS += include/hamcast_logging.h \
            include/proxy/igmp_receiver.hpp \
            include/proxy/mld_sender.hpp \
            include/proxy/igmp_sender.hpp \
+           include/proxy/null_sender.hpp \
            include/proxy/proxy_instance.hpp \
            include/proxy/message_queue.hpp \
            include/proxy/message_format.hpp \
            include/proxy/routing.hpp \
            include/proxy/worker.hpp \
+           include/proxy/worker_pool.hpp \
+           include/proxy/receive_loop.hpp \
            include/proxy/timing.hpp \
+           include/proxy/timer_clock.hpp \
            include/proxy/check_if.hpp \
            include/proxy/check_kernel.hpp \
            include/proxy/membership_db.hpp \
@@ -116,6 +146,9 @@ HEADERS += include/hamcast_logging.h \
            include/proxy/routing_management.hpp \
            include/proxy/simple_mc_proxy_routing.hpp \
            include/proxy/simple_routing_data.hpp \
+           include/proxy/snapshot.hpp \
+           include/proxy/capture.hpp \
+           include/proxy/thread_settings.hpp \
                #parser
            include/parser/scanner.hpp \
            include/parser/token.hpp \
@@ -0,0 +1,736 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/bench/bench.hpp"
+#include "include/proxy/proxy_instance.hpp"
+#include "include/proxy/interfaces.hpp"
+#include "include/proxy/timing.hpp"
+#include "include/proxy/message_format.hpp"
+#include "include/proxy/capture.hpp"
+#include "include/proxy/igmp_receiver.hpp"
+#include "include/proxy/mld_receiver.hpp"
+#include "include/proxy/null_sender.hpp"
+#include "include/parser/interface.hpp"
+#include "include/utils/mfc_simulator.hpp"
+#include "include/utils/extended_mld_defines.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <thread>
+
+#include <atomic>
+#include <new>
+
+#include <unistd.h> //for getopt
+#include <malloc.h>
+#include <linux/mroute.h>
+#include <linux/mroute6.h>
+#include <netinet/ip.h>
+
+//counts the heap allocations of the bench process to find allocations on the processing path of a record
+static std::atomic<unsigned long> g_allocation_count(0);
+
+void* operator new(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+//the replaced operator new allocates with malloc, gcc (11 and newer) only sees the inlined free after a std::allocator new
+#if !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+#if !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+//FNV-1a, the digests of two replays are equal if their final states are equal
+static void add_to_digest(uint64_t& digest, const std::string& s)
+{
+    for (unsigned char c : s) {
+        digest ^= c;
+        digest *= 1099511628211ull;
+    }
+}
+
+#define BENCH_DIGEST_BASIS 14695981039346656037ull
+
+bench::bench(int arg_count, char* args[])
+    : m_group_mem_protocol(IGMPv3)
+    , m_group_count(BENCH_DEFAULT_GROUP_COUNT)
+    , m_source_count(BENCH_DEFAULT_SOURCE_COUNT)
+    , m_leave_share(BENCH_DEFAULT_LEAVE_SHARE)
+    , m_record_count(BENCH_DEFAULT_RECORD_COUNT)
+    , m_simulated_kernel(true)
+    , m_simulated_time(0)
+    , m_timer_events(0)
+    , m_continuous_traffic(false)
+    , m_source_checks(0)
+    , m_max_speed(false)
+    , m_check_allocations(false)
+{
+    HC_LOG_TRACE("");
+
+    unsigned int seed = 0;
+
+    for (int c; (c = getopt(arg_count, args, "hkcxzu:d:p:g:s:l:r:n:t:f:i:")) != -1;) {
+        switch (c) {
+        case 'h':
+            help();
+            return;
+        case 'k':
+            m_simulated_kernel = false;
+            break;
+        case 'c':
+            m_continuous_traffic = true;
+            break;
+        case 'u':
+            m_upstream = optarg;
+            break;
+        case 'd':
+            m_downstream = optarg;
+            break;
+        case 'p': {
+            bool found = false;
+            for (auto gmp : {IGMPv1, IGMPv2, IGMPv3, MLDv1, MLDv2}) {
+                if (get_group_mem_protocol_name(gmp) == optarg) {
+                    m_group_mem_protocol = gmp;
+                    found = true;
+                }
+            }
+            if (!found) {
+                throw "unknown group membership protocol";
+            }
+        }
+        break;
+        case 'g':
+            m_group_count = std::max(1, atoi(optarg));
+            break;
+        case 's':
+            m_source_count = std::max(0, atoi(optarg));
+            break;
+        case 'l':
+            m_leave_share = std::min(100, std::max(0, atoi(optarg)));
+            break;
+        case 'r':
+            m_record_count = std::max(1l, atol(optarg));
+            break;
+        case 'n':
+            seed = atoi(optarg);
+            break;
+        case 't':
+            m_simulated_time = std::max(0, atoi(optarg));
+            break;
+        case 'f':
+            m_capture_path = optarg;
+            break;
+        case 'i':
+            m_instance_name = optarg;
+            break;
+        case 'x':
+            m_max_speed = true;
+            break;
+        case 'z':
+            m_check_allocations = true;
+            break;
+        default:
+            throw "Unknown argument! See help (-h) for more information.";
+        }
+    }
+
+    if (!m_capture_path.empty()) {
+        replay();
+        return;
+    }
+
+    if (m_downstream.empty()) {
+        throw "missing downstream interface! See help (-h) for more information.";
+    }
+
+    //sources are meaningless for IGMPv1, IGMPv2 and MLDv1
+    if (m_group_mem_protocol != IGMPv3 && m_group_mem_protocol != MLDv2) {
+        m_source_count = 0;
+    }
+
+    m_random_engine.seed(seed);
+
+    run();
+}
+
+void bench::help()
+{
+    using namespace std;
+    cout << "Usage: bench -d <downstream> [-k] [-u <upstream>] [-p <protocol>] [-g <groups>] [-s <sources>] [-l <leave share>] [-r <records>] [-n <seed>] [-t <seconds> [-c]] [-z]" << endl;
+    cout << "       bench -f <capture file> [-i <instance>] [-x]" << endl;
+    cout << endl;
+    cout << "\t-d\tDownstream interface receiving the group records (preferably an unused one, e.g. a dummy interface)." << endl;
+    cout << "\t-k\tSet the forwarding rules in the kernel tables and send the queries and reports with raw sockets," << endl;
+    cout << "\t\telse the forwarding rules are set in a simulator, nothing is sent and with an upstream interface" << endl;
+    cout << "\t\ta packet of each group is injected into the simulator." << endl;
+    cout << "\t-u\tUpstream interface to aggregate the memberships to." << endl;
+    cout << "\t-p\tGroup membership protocol: IGMPv1, IGMPv2, IGMPv3 (default), MLDv1 or MLDv2." << endl;
+    cout << "\t-g\tNumber of groups (default: " << BENCH_DEFAULT_GROUP_COUNT << ")." << endl;
+    cout << "\t-s\tSize of the source list of a record, 0 = any source multicast (default: " << BENCH_DEFAULT_SOURCE_COUNT << ")." << endl;
+    cout << "\t-l\tShare of leave records in percent (default: " << BENCH_DEFAULT_LEAVE_SHARE << ")." << endl;
+    cout << "\t-r\tNumber of records of the join/leave stream (default: " << BENCH_DEFAULT_RECORD_COUNT << ")." << endl;
+    cout << "\t-n\tSeed of the random join/leave stream (default: 0)." << endl;
+    cout << "\t-t\tSpread the join/leave stream over this protocol time in seconds. The time is simulated, the" << endl;
+    cout << "\t\ttimers (source and filter timers, retransmissions, queries) expire without waiting (default: 0)." << endl;
+    cout << "\t-c\tWith the simulator, an upstream and a protocol time the source of each group keeps sending" << endl;
+    cout << "\t\ta packet per second, otherwise the sources stop after the first packets." << endl;
+    cout << "\t-z\tExit with an error if a record of the second half of the stream (steady state) allocates heap" << endl;
+    cout << "\t\tmemory, the first half warms up the object pools. Use it with -t, in real time the timers of the" << endl;
+    cout << "\t\trecords do not expire during the stream and their pools keep growing." << endl;
+    cout << "\t-f\tReplay a capture of the mcproxy (mcproxy -p) against the simulator instead of the record stream." << endl;
+    cout << "\t-i\tProxy instance of the capture to replay (default: the first one)." << endl;
+    cout << "\t-x\tReplay at maximum speed, else at the original speed. The protocol time is simulated either way." << endl;
+    cout << endl;
+    cout << "Without -k the bench opens no sockets and needs no privileges, the interfaces only have to be up" << endl;
+    cout << "(e.g. lo). With -k the records are processed by a proxy instance of the default multicast routing table," << endl;
+    cout << "so the bench has to be started with root privileges while no mcproxy is running. All groups are joined" << endl;
+    cout << "on the upstream interface then, raise net.ipv4.igmp_max_memberships and net.ipv4.igmp_max_msf" << endl;
+    cout << "(net.ipv6.mld_max_msf) for many groups and large source lists." << endl;
+    cout << "A replay needs the interfaces of the captured proxy instance with the same names and IPv4 subnets" << endl;
+    cout << "(preferably dummy interfaces), they are added at the start with the default timers and without rule bindings." << endl;
+}
+
+void bench::run()
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    int addr_family = get_addr_family(m_group_mem_protocol);
+    auto ifs = make_shared<interfaces>(addr_family, false);
+
+    unsigned int downstream_if_index = interfaces::get_if_index(m_downstream);
+    if (downstream_if_index == 0 || !ifs->add_interface(m_downstream)) {
+        throw "failed to add downstream interface";
+    }
+
+    unsigned int upstream_if_index = 0;
+    if (!m_upstream.empty()) {
+        upstream_if_index = interfaces::get_if_index(m_upstream);
+        if (upstream_if_index == 0 || !ifs->add_interface(m_upstream)) {
+            throw "failed to add upstream interface";
+        }
+    }
+
+    shared_ptr<mfc_simulator> ms = m_simulated_kernel ? make_shared<mfc_simulator>(addr_family) : nullptr;
+    shared_ptr<virtual_clock> vclock = m_simulated_time > 0 ? make_shared<virtual_clock>() : nullptr;
+    shared_ptr<timing> t = vclock != nullptr ? make_shared<timing>(vclock) : make_shared<timing>();
+    proxy_instance pr_i(m_group_mem_protocol, "bench", 0, ifs, t, false, nullptr, nullptr, false, ms);
+
+    //the proxy instance thread is stopped, all messages are processed by the bench thread
+    pr_i.add_msg(make_shared<exit_cmd>());
+    pr_i.join();
+    process_pending_msgs(pr_i);
+
+    if (upstream_if_index != 0) {
+        pr_i.process_msg(make_shared<config_msg>(config_msg::ADD_UPSTREAM, upstream_if_index, 0, make_shared<interface>(m_upstream)));
+    }
+    pr_i.process_msg(make_shared<config_msg>(config_msg::ADD_DOWNSTREAM, downstream_if_index, make_shared<interface>(m_downstream), timers_values()));
+    process_pending_msgs(pr_i);
+
+    cout << "##-- bench --##" << endl;
+    cout << "protocol: " << get_group_mem_protocol_name(m_group_mem_protocol) << endl;
+    cout << "downstream: " << m_downstream << ", upstream: " << (m_upstream.empty() ? "-" : m_upstream) << ", kernel: " << (m_simulated_kernel ? "simulated" : "linux") << endl;
+    cout << "groups: " << m_group_count << ", sources per record: " << m_source_count << ", leave share: " << m_leave_share << "%, records: " << m_record_count << endl;
+
+    init_groups();
+
+    //join all groups to measure the memory per group
+    size_t heap_size = get_heap_size();
+    for (unsigned int i = 0; i < m_group_count; ++i) {
+        process_record(pr_i, get_record(downstream_if_index, i, true, true));
+    }
+    size_t heap_per_group = (get_heap_size() - heap_size) / m_group_count;
+
+    if (ms != nullptr && upstream_if_index != 0) {
+        send_traffic(pr_i, *ms, upstream_if_index);
+    }
+
+    //the join/leave stream is created in advance to measure only the processing
+    uniform_int_distribution<unsigned int> group_dist(0, m_group_count - 1);
+    uniform_int_distribution<unsigned int> share_dist(0, 99);
+    bernoulli_distribution state_change_dist(0.5);
+
+    vector<shared_ptr<group_record_msg>> records;
+    records.reserve(m_record_count);
+    for (unsigned long i = 0; i < m_record_count; ++i) {
+        bool join = share_dist(m_random_engine) >= m_leave_share;
+        records.push_back(get_record(downstream_if_index, group_dist(m_random_engine), join, state_change_dist(m_random_engine)));
+    }
+
+    m_latencies.clear();
+    m_latencies.reserve(m_record_count);
+
+    //the virtual time between two records
+    auto step = chrono::milliseconds(static_cast<chrono::milliseconds::rep>(m_simulated_time) * 1000 / m_record_count);
+
+    bool continuous_traffic = m_continuous_traffic && vclock != nullptr && ms != nullptr && upstream_if_index != 0;
+    auto next_second = vclock != nullptr ? vclock->get_time() : chrono::steady_clock::time_point();
+
+    size_t heap_size_before_stream = get_heap_size();
+    unsigned long allocation_count_before_stream = g_allocation_count;
+    unsigned long allocation_count_before_steady_state = allocation_count_before_stream;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i == records.size() / 2) {
+            allocation_count_before_steady_state = g_allocation_count;
+        }
+        if (vclock != nullptr) {
+            advance(pr_i, *t, *vclock, step);
+        }
+        if (continuous_traffic) {
+            send_continuous_traffic(pr_i, *ms, upstream_if_index, *vclock, next_second);
+        }
+        m_latencies.push_back(process_record(pr_i, records[i]));
+    }
+    auto duration = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    unsigned long allocation_count = g_allocation_count - allocation_count_before_stream;
+    unsigned long steady_state_allocation_count = g_allocation_count - allocation_count_before_steady_state;
+    unsigned long steady_state_record_count = records.size() - records.size() / 2;
+
+    print_results(duration, heap_per_group);
+    print_sent_packets(pr_i);
+    cout << "heap allocations per record: " << static_cast<double>(allocation_count) / m_record_count;
+    cout << " (steady state: " << static_cast<double>(steady_state_allocation_count) / steady_state_record_count << ")" << endl;
+    if (vclock != nullptr) {
+        cout << "simulated time: " << m_simulated_time << "sec, timer events: " << m_timer_events << ", source checks: " << m_source_checks << endl;
+        cout << "heap change during the stream: " << static_cast<long>(get_heap_size()) - static_cast<long>(heap_size_before_stream) << " bytes" << endl;
+    }
+
+    if (m_check_allocations && steady_state_allocation_count > 0) {
+        throw "the records of the steady state allocated heap memory";
+    }
+}
+
+void bench::replay()
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    capture_file cf;
+    if (!cf.load(m_capture_path)) {
+        throw "failed to load the capture file";
+    }
+
+    //the interfaces of the replayed proxy instance, an interface is used as upstream and downstream at most once
+    list<const capture_interface*> cis;
+    set<pair<unsigned int, bool>> known;
+    map<unsigned int, unsigned int> if_indexes; //captured if_index, local if_index
+    for (auto & ci : cf.get_interfaces()) {
+        if (m_instance_name.empty()) {
+            m_instance_name = ci.instance_name;
+        }
+
+        if (ci.instance_name == m_instance_name && known.insert(make_pair(ci.if_index, ci.upstream)).second) {
+            unsigned int if_index = interfaces::get_if_index(ci.if_name);
+            if (if_index == 0) {
+                HC_LOG_ERROR("interface " << ci.if_name << " of the capture not found");
+                throw "interface of the capture not found";
+            }
+            if_indexes[ci.if_index] = if_index;
+            cis.push_back(&ci);
+        }
+    }
+
+    if (cis.empty()) {
+        throw "proxy instance not found in the capture";
+    }
+    m_group_mem_protocol = cis.front()->protocol;
+
+    //keep the order of the captured virtual interfaces
+    cis.sort([](const capture_interface * l, const capture_interface * r) {
+        return l->vif < r->vif;
+    });
+
+    int addr_family = get_addr_family(m_group_mem_protocol);
+    auto ifs = make_shared<interfaces>(addr_family, false);
+    for (auto ci : cis) {
+        if (!ifs->add_interface(if_indexes[ci->if_index])) {
+            throw "failed to add interface";
+        }
+    }
+
+    auto ms = make_shared<mfc_simulator>(addr_family);
+    auto vclock = make_shared<virtual_clock>();
+    auto t = make_shared<timing>(vclock);
+    proxy_instance pr_i(m_group_mem_protocol, m_instance_name, 0, ifs, t, false, nullptr, nullptr, false, ms);
+
+    //the proxy instance thread is stopped, all messages are processed by the bench thread
+    pr_i.add_msg(make_shared<exit_cmd>());
+    pr_i.join();
+    process_pending_msgs(pr_i);
+
+    string upstreams;
+    string downstreams;
+    for (auto ci : cis) {
+        unsigned int if_index = if_indexes[ci->if_index];
+        if (ci->upstream) {
+            pr_i.process_msg(make_shared<config_msg>(config_msg::ADD_UPSTREAM, if_index, ci->upstream_priority, make_shared<interface>(ci->if_name)));
+            upstreams += " " + ci->if_name;
+        } else {
+            pr_i.process_msg(make_shared<config_msg>(config_msg::ADD_DOWNSTREAM, if_index, make_shared<interface>(ci->if_name), timers_values()));
+            downstreams += " " + ci->if_name;
+        }
+    }
+    process_pending_msgs(pr_i);
+
+    cout << "##-- bench replay --##" << endl;
+    cout << "capture: " << m_capture_path << ", proxy instance: " << m_instance_name << ", protocol: " << get_group_mem_protocol_name(m_group_mem_protocol) << endl;
+    cout << "upstreams:" << (upstreams.empty() ? " -" : upstreams) << ", downstreams:" << (downstreams.empty() ? " -" : downstreams) << endl;
+    cout << "speed: " << (m_max_speed ? "maximum" : "original") << endl;
+
+    //receive buffers as in the receiver
+    vector<unsigned char> data(UINT16_MAX);
+    vector<unsigned char> control;
+    struct sockaddr_storage name;
+    struct iovec iov;
+    struct msghdr msg;
+
+    const auto& packets = cf.get_packets();
+    m_latencies.clear();
+    m_latencies.reserve(packets.size());
+
+    auto capture_time = chrono::nanoseconds(0);
+    auto vstart = vclock->get_time();
+    auto start = chrono::steady_clock::now();
+    for (auto & p : packets) {
+        auto it = if_indexes.find(p.if_index);
+        if (it == end(if_indexes)) {
+            continue; //another proxy instance
+        }
+
+        if (!m_max_speed) {
+            this_thread::sleep_until(start + p.time_stamp);
+        }
+
+        //the timers expire at their captured time
+        auto step = chrono::duration_cast<chrono::milliseconds>(vstart + p.time_stamp - vclock->get_time());
+        if (step.count() > 0) {
+            advance(pr_i, *t, *vclock, step);
+        }
+        capture_time = p.time_stamp;
+
+        if (p.data.size() > data.size()) {
+            data.resize(p.data.size());
+        }
+        memcpy(data.data(), p.data.data(), p.data.size());
+        control.assign(p.control.begin(), p.control.end());
+        memset(&name, 0, sizeof(name));
+        memcpy(&name, p.name.data(), min(p.name.size(), sizeof(name)));
+
+        iov.iov_base = data.data();
+        iov.iov_len = p.data.size();
+        msg.msg_name = &name;
+        msg.msg_namelen = min(p.name.size(), sizeof(name));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.empty() ? nullptr : control.data();
+        msg.msg_controllen = control.size();
+        msg.msg_flags = 0;
+        rewrite_packet(*ifs, it->second, data.data(), p.data.size(), &msg);
+
+        auto packet_start = chrono::steady_clock::now();
+        pr_i.m_receiver->replay_packet(&msg, p.data.size());
+        process_pending_msgs(pr_i);
+        m_latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - packet_start));
+    }
+    auto duration = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+
+    cout << fixed << setprecision(2);
+    cout << "packets: " << m_latencies.size() << " of " << packets.size() << ", capture time: " << chrono::duration_cast<chrono::duration<double>>(capture_time).count() << "sec, replay time: " << chrono::duration_cast<chrono::duration<double>>(duration).count() << "sec" << endl;
+    if (!m_latencies.empty()) {
+        print_latencies("packets", duration);
+    }
+
+    print_sent_packets(pr_i);
+
+    unsigned int group_count = 0;
+    uint64_t membership_digest = get_membership_digest(pr_i, group_count);
+
+    //the counters of the rules are part of the digest, they stay 0 without traffic
+    string rules = ms->to_string();
+    uint64_t forwarding_digest = BENCH_DIGEST_BASIS;
+    add_to_digest(forwarding_digest, rules.substr(min(rules.find("##-- simulated forwarding rules --##"), rules.size())));
+
+    cout << hex << setfill('0');
+    cout << "membership digest: " << setw(16) << membership_digest << dec << ", groups: " << group_count << endl;
+    cout << hex << "forwarding digest: " << setw(16) << forwarding_digest << dec << ", forwarding rules: " << ms->get_mroute_count() << ", upcalls: " << ms->get_upcall_count() << endl;
+}
+
+void bench::rewrite_packet(const interfaces& ifs, unsigned int if_index, unsigned char* data, size_t size, struct msghdr* msg) const
+{
+    HC_LOG_TRACE("");
+
+    if (is_IPv4(m_group_mem_protocol)) {
+        //the reports are mapped to their interface by the subnet of the sender
+        if (size >= sizeof(struct igmpmsg) && reinterpret_cast<struct ip*>(data)->ip_p == IGMP_RECEIVER_KERNEL_MSG) {
+            reinterpret_cast<struct igmpmsg*>(data)->im_vif = ifs.get_virtual_if_index(if_index);
+        }
+    } else {
+        if (size >= sizeof(struct mrt6msg) && reinterpret_cast<struct mld_hdr*>(data)->mld_type == MLD_RECEIVER_KERNEL_MSG) {
+            reinterpret_cast<struct mrt6msg*>(data)->im6_mif = ifs.get_virtual_if_index(if_index);
+        } else {
+            for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(msg); cmsgptr != nullptr; cmsgptr = CMSG_NXTHDR(msg, cmsgptr)) {
+                if (cmsgptr->cmsg_len > 0 && cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO) {
+                    reinterpret_cast<struct in6_pktinfo*>(CMSG_DATA(cmsgptr))->ipi6_ifindex = if_index;
+                }
+            }
+        }
+    }
+}
+
+uint64_t bench::get_membership_digest(proxy_instance& pr_i, unsigned int& group_count) const
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    //a line per group, sorted to be independent of the order of the group database
+    vector<string> lines;
+    for (auto & e : pr_i.m_downstreams) {
+        for (auto & g : e.second.m_querier->get_snapshot()) {
+            ostringstream s;
+            s << interfaces::get_if_name(e.first) << " " << g.gaddr << " " << get_mc_filter_name(g.filter_mode) << " include:";
+            for (auto & src : g.include_requested_list) {
+                s << " " << src.saddr;
+            }
+            s << " exclude:";
+            for (auto & src : g.exclude_list) {
+                s << " " << src;
+            }
+            lines.push_back(s.str());
+        }
+    }
+    sort(lines.begin(), lines.end());
+
+    uint64_t digest = BENCH_DIGEST_BASIS;
+    for (auto & l : lines) {
+        add_to_digest(digest, l);
+        add_to_digest(digest, "\n");
+    }
+
+    group_count = lines.size();
+    return digest;
+}
+
+std::chrono::nanoseconds bench::process_record(proxy_instance& pr_i, const std::shared_ptr<group_record_msg>& msg)
+{
+    HC_LOG_TRACE("");
+
+    auto start = std::chrono::steady_clock::now();
+    pr_i.process_msg(msg);
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    process_pending_msgs(pr_i);
+    return latency;
+}
+
+unsigned long bench::process_pending_msgs(proxy_instance& pr_i)
+{
+    HC_LOG_TRACE("");
+
+    unsigned long count = 0;
+    std::shared_ptr<proxy_msg> msg;
+    while (pr_i.m_job_queue.try_dequeue(msg)) {
+        if (msg->get_type() != proxy_msg::EXIT_MSG) {
+            if (msg->get_type() == proxy_msg::NEW_SOURCE_TIMER_MSG) {
+                m_source_checks++;
+            }
+            pr_i.process_msg(msg);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void bench::advance(proxy_instance& pr_i, timing& t, virtual_clock& vclock, const std::chrono::milliseconds& duration)
+{
+    HC_LOG_TRACE("");
+
+    //each deadline is processed before the next one, timers set meanwhile keep their order
+    auto until = vclock.get_time() + duration;
+    while (t.run_next_deadline(until)) {
+        m_timer_events += process_pending_msgs(pr_i);
+    }
+}
+
+std::shared_ptr<group_record_msg> bench::get_record(unsigned int if_index, unsigned int group, bool join, bool state_change) const
+{
+    HC_LOG_TRACE("");
+
+    mcast_addr_record_type record_type;
+    source_list<source> slist;
+
+    if (m_source_count == 0) { //any source multicast
+        if (join) {
+            record_type = state_change ? CHANGE_TO_EXCLUDE_MODE : MODE_IS_EXCLUDE;
+        } else {
+            record_type = CHANGE_TO_INCLUDE_MODE;
+        }
+    } else { //source specific multicast
+        slist = m_slists[group];
+        if (join) {
+            record_type = state_change ? ALLOW_NEW_SOURCES : MODE_IS_INCLUDE;
+        } else {
+            record_type = BLOCK_OLD_SOURCES;
+        }
+    }
+
+    return make_pooled_msg<group_record_msg>(if_index, record_type, m_gaddrs[group], std::move(slist), m_group_mem_protocol);
+}
+
+void bench::send_traffic(proxy_instance& pr_i, mfc_simulator& ms, unsigned int upstream_if_index)
+{
+    HC_LOG_TRACE("");
+
+    for (unsigned int i = 0; i < m_group_count; ++i) {
+        addr_storage saddr = get_traffic_saddr(i);
+
+        //the first packet causes an upcall, the second one is forwarded by the new forwarding rule
+        ms.receive_packet(upstream_if_index, saddr, m_gaddrs[i], 1000);
+        process_pending_msgs(pr_i);
+        ms.receive_packet(upstream_if_index, saddr, m_gaddrs[i], 1000);
+    }
+
+    std::cout << "upcalls: " << ms.get_upcall_count() << ", forwarding rules: " << ms.get_mroute_count() << std::endl;
+}
+
+void bench::send_continuous_traffic(proxy_instance& pr_i, mfc_simulator& ms, unsigned int upstream_if_index, const virtual_clock& vclock, std::chrono::steady_clock::time_point& next_second)
+{
+    HC_LOG_TRACE("");
+
+    while (next_second <= vclock.get_time()) {
+        for (unsigned int i = 0; i < m_group_count; ++i) {
+            //a packet without forwarding rule causes an upcall
+            if (ms.receive_packet(upstream_if_index, get_traffic_saddr(i), m_gaddrs[i], 1000) == 0) {
+                process_pending_msgs(pr_i);
+            }
+        }
+        next_second += std::chrono::seconds(1);
+    }
+}
+
+addr_storage bench::get_traffic_saddr(unsigned int group) const
+{
+    HC_LOG_TRACE("");
+
+    //any source multicast groups receive the traffic of a single source, the others of their first requested source
+    if (m_slists[group].empty()) {
+        return addr_storage(is_IPv4(m_group_mem_protocol) ? "10.2.0.1" : "2001:db8::2:1");
+    } else {
+        return m_slists[group].begin()->saddr;
+    }
+}
+
+void bench::init_groups()
+{
+    HC_LOG_TRACE("");
+
+    addr_storage gaddr(is_IPv4(m_group_mem_protocol) ? "239.1.0.0" : "ff05::1:0");
+    addr_storage saddr(is_IPv4(m_group_mem_protocol) ? "10.1.0.0" : "2001:db8::1:0");
+
+    m_gaddrs.clear();
+    m_slists.clear();
+    for (unsigned int i = 0; i < m_group_count; ++i) {
+        m_gaddrs.push_back(gaddr++);
+
+        //groups share sources with their neighbours
+        source_list<source> slist;
+        addr_storage s = saddr;
+        for (unsigned int k = 0; k < m_source_count; ++k) {
+            slist.insert(source(s++));
+        }
+        m_slists.push_back(std::move(slist));
+
+        if (i % 256 == 255) {
+            saddr = addr_storage(is_IPv4(m_group_mem_protocol) ? "10.1.0.0" : "2001:db8::1:0");
+        } else {
+            ++saddr;
+        }
+    }
+}
+
+size_t bench::get_heap_size()
+{
+    HC_LOG_TRACE("");
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return mallinfo().uordblks;
+#endif
+}
+
+void bench::print_latencies(const std::string& unit, const std::chrono::nanoseconds& duration)
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    auto percentile = [&](double p) {
+        auto it = m_latencies.begin() + static_cast<size_t>(p * (m_latencies.size() - 1));
+        nth_element(m_latencies.begin(), it, m_latencies.end());
+        return chrono::duration_cast<chrono::duration<double, micro>>(*it).count();
+    };
+
+    double seconds = chrono::duration_cast<chrono::duration<double>>(duration).count();
+
+    cout << fixed << setprecision(2);
+    cout << unit << "/s: " << (seconds > 0 ? m_latencies.size() / seconds : 0) << endl;
+    cout << "latency (usec): p50 " << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 " << percentile(0.99) << ", p99.9 " << percentile(0.999) << ", max " << percentile(1) << endl;
+}
+
+void bench::print_sent_packets(proxy_instance& pr_i) const
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    auto ns = dynamic_pointer_cast<null_sender>(pr_i.m_sender);
+    if (ns != nullptr) {
+        cout << "reports: " << ns->get_report_count() << ", queries: " << ns->get_query_count() << " (not transmitted)" << endl;
+    }
+}
+
+void bench::print_results(const std::chrono::nanoseconds& duration, size_t heap_per_group)
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+
+    print_latencies("records", duration);
+    cout << "memory per group: " << heap_per_group << " bytes" << endl;
+}
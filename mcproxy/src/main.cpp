@@ -23,6 +23,7 @@
 #include "include/utils/if_prop.hpp"
 #include "include/utils/mc_socket.hpp"
 #include "include/utils/mroute_socket.hpp"
+#include "include/utils/mfc_simulator.hpp"
 #include "include/utils/addr_storage.hpp"
 #include "include/proxy/proxy.hpp"
 #include "include/proxy/timing.hpp"
@@ -37,6 +38,7 @@
 #include "include/proxy/igmp_sender.hpp"
 #include "include/parser/configuration.hpp"
 #include "include/tester/tester.hpp"
+#include "include/bench/bench.hpp"
 
 #include <iostream>
 #include <unistd.h>
@@ -52,6 +54,13 @@ int main(int arg_count, char* args[])
     } catch (const char* e) {
         std::cout << e << std::endl;
     }
+#elif defined(BENCH)
+    try {
+        bench(arg_count, args);
+    } catch (const char* e) {
+        std::cout << e << std::endl;
+        return 1;
+    }
 #else
     try {
         proxy p(arg_count, args);
@@ -88,11 +97,13 @@ void test_test()
     //timers_values::test_timers_values();
     //timers_values::test_timers_values_copy();
     //timing::test_timing();
+    //timing::test_timing_simulation();
     //worker::test_worker();
     //proxy_instance::test_querier("lo");
     //simple_routing_data::test_simple_routing_data();
     //igmp_sender::test_igmp_sender();
     //mroute_socket::quick_test();
+    //mfc_simulator::test_mfc_simulator();
     //configuration::test_configuration();
     //if_prop::test_if_prop();
 }
@@ -27,7 +27,7 @@
 #include <algorithm>
 #include <fstream>
 
-configuration::configuration(const std::string& path, bool reset_reverse_path_filter)
+configuration::configuration(const std::string& path, bool reset_reverse_path_filter, const configuration* running_configuration)
     : m_reset_reverse_path_filter(reset_reverse_path_filter)
     , m_gmp(IGMPv3) //default setting
     , m_global_table_set(std::make_shared<global_table_set>())
@@ -35,7 +35,12 @@ configuration::configuration(const std::string& path, bool reset_reverse_path_fi
     HC_LOG_TRACE("");
     m_cmds = separate_commands(delete_comments(load_file(path)));
     run_parser();
-    initalize_interfaces();
+
+    if (running_configuration == nullptr) {
+        initalize_interfaces(nullptr);
+    } else {
+        check_interfaces();
+    }
 }
 
 // trim from start
@@ -170,34 +175,60 @@ void configuration::run_parser()
     }
 }
 
-void configuration::initalize_interfaces()
+void configuration::add_interfaces(interfaces& ifs, const instance_definition& inst) const
 {
     HC_LOG_TRACE("");
 
-    unsigned int if_index;
+    auto add = [&](const std::shared_ptr<interface>& interf) {
+        unsigned int if_index = interfaces::get_if_index(interf->get_if_name());
+        if (if_index == 0) {
+            HC_LOG_ERROR("interface " << interf->get_if_name() << " not found");
+            throw "unknown interface";
+        }
+
+        if (!ifs.add_interface(if_index)) {
+            throw "failed to add interface";
+        }
+    };
+
+    for (auto & downstream : inst.get_downstreams()) {
+        add(downstream);
+    }
+
+    for (auto & upstream : inst.get_upstreams()) {
+        add(upstream);
+    }
+}
+
+void configuration::check_interfaces() const
+{
+    HC_LOG_TRACE("");
 
     for (auto & inst : m_inst_def_set) {
-        auto result = std::make_shared<interfaces>(get_addr_family(m_gmp), m_reset_reverse_path_filter);
-        auto add = [&](const std::shared_ptr<interface>& interf) {
-            if_index = interfaces::get_if_index(interf->get_if_name());
-            if (if_index == 0) {
-                HC_LOG_ERROR("interface " << interf->get_if_name() << " not found");
-                throw "unknown interface";
-            }
+        //the reverse path filters are untouched until the configuration is applied
+        interfaces candidate(get_addr_family(m_gmp), false);
+        add_interfaces(candidate, *inst);
+    }
+}
 
-            if (!result->add_interface(if_index)) {
-                throw "failed to add interface";
-            }
-        };
+void configuration::initalize_interfaces(const configuration* running_configuration)
+{
+    HC_LOG_TRACE("");
 
-        for (auto & downstream : inst->get_downstreams()) {
-            add(downstream);
+    for (auto & inst : m_inst_def_set) {
+        std::shared_ptr<interfaces> result;
+        if (running_configuration != nullptr && running_configuration->get_group_mem_protocol() == m_gmp) {
+            result = running_configuration->get_interfaces_for_pinstance(inst->get_instance_name());
         }
 
-        for (auto & upstream : inst->get_upstreams()) {
-            add(upstream);
+        if (result == nullptr) {
+            result = std::make_shared<interfaces>(get_addr_family(m_gmp), m_reset_reverse_path_filter);
+        } else if (!result->refresh_network_interfaces()) {
+            throw "failed to refresh network interfaces";
         }
 
+        add_interfaces(*result, *inst);
+
         if (!m_interfaces_map.insert(std::pair<std::string, std::shared_ptr<interfaces>>(inst->get_instance_name(), result)).second) {
             HC_LOG_ERROR("proxy instance " << inst->get_instance_name() << " already exists");
             throw "failed to add instance";
@@ -244,7 +275,7 @@ void configuration::test_configuration()
 }
 #endif /* DEBUG_MODE */
 
-const std::shared_ptr<const interfaces> configuration::get_interfaces_for_pinstance(const std::string& instance_name) const{
+const std::shared_ptr<interfaces> configuration::get_interfaces_for_pinstance(const std::string& instance_name) const{
     HC_LOG_TRACE("");
     auto it = m_interfaces_map.find(instance_name);
     if(it == m_interfaces_map.end()){
@@ -266,6 +297,12 @@ const inst_def_set& configuration::get_inst_def_set() const
     return m_inst_def_set;
 }
 
+const std::shared_ptr<global_table_set>& configuration::get_global_table_set() const
+{
+    HC_LOG_TRACE("");
+    return m_global_table_set;
+}
+
 std::string configuration::to_string() const
 {
     HC_LOG_TRACE("");
@@ -26,6 +26,7 @@
 #include "include/proxy/interfaces.hpp"
 
 #include <sstream>
+#include <algorithm>
 
 //-----------------------------------------------------
 bool addr_match::is_wildcard(const addr_storage& addr, int addr_family) const
@@ -216,6 +217,32 @@ std::string rule_table_ref::to_string() const
     return s.str();
 }
 //-----------------------------------------------------
+std::string get_rb_timer_value_type_name(rb_timer_value_type timer_value_type)
+{
+    std::map<rb_timer_value_type, std::string> name_map = {
+        {TVT_REPORT_COALESCING,    "reportcoalescing"  },
+        {TVT_GENERAL_QUERY_PHASE,  "generalqueryphase" },
+        {TVT_GENERAL_QUERY_JITTER, "generalqueryjitter"},
+        {TVT_EXPLICIT_TRACKING,    "explicittracking"  },
+        {TVT_LEAVE_HOLD_DOWN,      "leaveholddown"     },
+        {TVT_UNDEFINED,            "undefined"         }
+    };
+    return name_map[timer_value_type];
+}
+
+rb_timer_value_type get_rb_timer_value_type(const std::string& timer_value_name)
+{
+    std::string cmp_str = timer_value_name;
+    std::transform(cmp_str.begin(), cmp_str.end(), cmp_str.begin(), ::tolower);
+
+    for (int i = 0; i < TVT_UNDEFINED; ++i) {
+        if (get_rb_timer_value_type_name(static_cast<rb_timer_value_type>(i)) == cmp_str) {
+            return static_cast<rb_timer_value_type>(i);
+        }
+    }
+    return TVT_UNDEFINED;
+}
+//-----------------------------------------------------
 rule_binding::rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_filter_type filter_type, std::unique_ptr<table> filter_table)
     : m_rule_binding_type(RBT_FILTER)
     , m_instance_name(instance_name)
@@ -226,6 +253,9 @@ rule_binding::rule_binding(const std::string& instance_name, rb_interface_type i
     , m_table(std::move(filter_table))
     , m_rule_matching_type(RMT_UNDEFINED)
     , m_timeout(std::chrono::milliseconds(0))
+    , m_timer_value_type(TVT_UNDEFINED)
+    , m_timer_value(std::chrono::milliseconds(0))
+    , m_predictive_groups(0)
 {
     HC_LOG_TRACE("");
 }
@@ -240,6 +270,44 @@ rule_binding::rule_binding(const std::string& instance_name, rb_interface_type i
     , m_table(nullptr)
     , m_rule_matching_type(rule_matching_type)
     , m_timeout(timeout)
+    , m_timer_value_type(TVT_UNDEFINED)
+    , m_timer_value(std::chrono::milliseconds(0))
+    , m_predictive_groups(0)
+{
+    HC_LOG_TRACE("");
+}
+
+rule_binding::rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_timer_value_type timer_value_type, const std::chrono::milliseconds& timer_value)
+    : m_rule_binding_type(RBT_TIMER_VALUE)
+    , m_instance_name(instance_name)
+    , m_interface_type(interface_type)
+    , m_if_name(if_name)
+    , m_filter_direction(filter_direction)
+    , m_filter_type(FT_UNDEFINED)
+    , m_table(nullptr)
+    , m_rule_matching_type(RMT_UNDEFINED)
+    , m_timeout(std::chrono::milliseconds(0))
+    , m_timer_value_type(timer_value_type)
+    , m_timer_value(timer_value)
+    , m_predictive_groups(0)
+{
+    HC_LOG_TRACE("");
+}
+
+rule_binding::rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, std::list<std::pair<addr_storage, addr_storage>>&& prejoins, unsigned int predictive_groups)
+    : m_rule_binding_type(RBT_PREJOIN)
+    , m_instance_name(instance_name)
+    , m_interface_type(interface_type)
+    , m_if_name(if_name)
+    , m_filter_direction(filter_direction)
+    , m_filter_type(FT_UNDEFINED)
+    , m_table(nullptr)
+    , m_rule_matching_type(RMT_UNDEFINED)
+    , m_timeout(std::chrono::milliseconds(0))
+    , m_timer_value_type(TVT_UNDEFINED)
+    , m_timer_value(std::chrono::milliseconds(0))
+    , m_prejoins(std::move(prejoins))
+    , m_predictive_groups(predictive_groups)
 {
     HC_LOG_TRACE("");
 }
@@ -298,6 +366,30 @@ std::chrono::milliseconds rule_binding::get_timeout() const
     return m_timeout;
 }
 
+rb_timer_value_type rule_binding::get_timer_value_type() const
+{
+    HC_LOG_TRACE("");
+    return m_timer_value_type;
+}
+
+std::chrono::milliseconds rule_binding::get_timer_value() const
+{
+    HC_LOG_TRACE("");
+    return m_timer_value;
+}
+
+const std::list<std::pair<addr_storage, addr_storage>>& rule_binding::get_prejoins() const
+{
+    HC_LOG_TRACE("");
+    return m_prejoins;
+}
+
+unsigned int rule_binding::get_predictive_groups() const
+{
+    HC_LOG_TRACE("");
+    return m_predictive_groups;
+}
+
 bool rule_binding::match(const std::string& if_name, const addr_storage& saddr, const addr_storage& gaddr) const
 {
     HC_LOG_TRACE("");
@@ -346,6 +438,10 @@ std::string rule_binding::to_string() const
         s << to_string_table_filter();
     } else if (m_rule_binding_type == RBT_RULE_MATCHING) {
         s << to_string_rule_matching();
+    } else if (m_rule_binding_type == RBT_TIMER_VALUE) {
+        s << to_string_timer_value();
+    } else if (m_rule_binding_type == RBT_PREJOIN) {
+        s << to_string_prejoin();
     } else {
         HC_LOG_ERROR("unkown rule binding type");
         s << "??? ";
@@ -394,6 +490,8 @@ std::string rule_binding::to_string_rule_matching() const
         s << "first ";
     } else if (m_rule_matching_type == RMT_MUTEX) {
         s << "mutex " << m_timeout.count();
+    } else if (m_rule_matching_type == RMT_HASH) {
+        s << "hash ";
     } else {
         HC_LOG_ERROR("unkown rule matching type");
         s << "???";
@@ -401,6 +499,39 @@ std::string rule_binding::to_string_rule_matching() const
 
     return s.str();
 }
+std::string rule_binding::to_string_timer_value() const
+{
+    HC_LOG_TRACE("");
+    using namespace std;
+    ostringstream s;
+
+    s << "timer " << get_rb_timer_value_type_name(m_timer_value_type) << " " << m_timer_value.count();
+
+    return s.str();
+}
+
+std::string rule_binding::to_string_prejoin() const
+{
+    HC_LOG_TRACE("");
+    using namespace std;
+    ostringstream s;
+
+    s << "prejoin";
+    if (m_predictive_groups > 0) {
+        s << " predictive " << m_predictive_groups;
+    } else {
+        for (auto & e : m_prejoins) {
+            s << " (" << e.first << " | ";
+            if (e.second.is_valid()) {
+                s << e.second << ")";
+            } else {
+                s << "*)";
+            }
+        }
+    }
+
+    return s.str();
+}
 //-----------------------------------------------------
 interface::interface(const std::string& if_name)
     : m_if_name(if_name)
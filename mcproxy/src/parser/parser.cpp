@@ -430,11 +430,15 @@ void parser::parse_interface_rule_binding(const std::shared_ptr<const global_tab
             error_notification();
         }
 
-        get_next_token();
+        get_next_context_token();
         if (m_current_token.get_type() == TT_WHITELIST || m_current_token.get_type() == TT_BLACKLIST) {
             return parse_interface_table_binding(std::move(instance_name), interface_type, std::move(if_name), filter_direction, gts, gmp, ids);
         } else if (m_current_token.get_type() == TT_RULE_MATCHING) {
             return parse_interface_rule_match_binding(std::move(instance_name), interface_type, std::move(if_name), filter_direction, ids);
+        } else if (m_current_token.get_type() == TT_TIMER) {
+            return parse_interface_timer_value_binding(std::move(instance_name), interface_type, std::move(if_name), filter_direction, ids);
+        } else if (m_current_token.get_type() == TT_PREJOIN) {
+            return parse_interface_prejoin_binding(std::move(instance_name), interface_type, std::move(if_name), filter_direction, gmp, ids);
         } else {
             error_notification();
         }
@@ -549,12 +553,15 @@ void parser::parse_interface_rule_match_binding(
     rb_rule_matching_type rule_matching_type = RMT_UNDEFINED;
     std::chrono::milliseconds timeout(0);
     //pinstance A upstream ap in rulematching mutex 10000;
+    //pinstance A upstream * in rulematching hash;
     if (m_current_token.get_type() == TT_RULE_MATCHING) {
-        get_next_token();
+        get_next_context_token();
         if (m_current_token.get_type() == TT_ALL) {
             rule_matching_type = RMT_ALL;
         } else if (m_current_token.get_type() == TT_FIRST) {
             rule_matching_type = RMT_FIRST;
+        } else if (m_current_token.get_type() == TT_HASH) {
+            rule_matching_type = RMT_HASH;
         } else if (m_current_token.get_type() == TT_MUTEX) {
             rule_matching_type = RMT_MUTEX;
 
@@ -613,7 +620,192 @@ void parser::parse_interface_rule_match_binding(
     //}
 }
 
+void parser::parse_interface_timer_value_binding(
+    std::string && instance_name
+    , rb_interface_type interface_type
+    , std::string && if_name
+    , rb_interface_direction filter_direction
+    , const inst_def_set& ids)
+{
+    HC_LOG_TRACE("");
+    auto error_notification = [&]() {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " unknown token " << get_token_type_name(m_current_token.get_type()) << " with value " << m_current_token.get_string() << " in this context");
+        throw "failed to parse config file";
+    };
+
+    rb_timer_value_type timer_value_type = TVT_UNDEFINED;
+    std::chrono::milliseconds timer_value(0);
+    //pinstance A upstream * out timer reportcoalescing 100;
+    //pinstance A upstream * out timer leaveholddown 5000;
+    //pinstance A downstream eth1 out timer generalqueryphase 30000;
+    //pinstance A downstream eth1 out timer explicittracking 260000;
+    if (filter_direction != ID_OUT) {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " timer values are only allowed for the output direction");
+        throw "failed to parse config file";
+    }
+
+    if (m_current_token.get_type() == TT_TIMER) {
+        get_next_token();
+        if (m_current_token.get_type() == TT_STRING) {
+            timer_value_type = get_rb_timer_value_type(m_current_token.get_string());
+            if (timer_value_type == TVT_UNDEFINED) {
+                error_notification();
+            }
+        } else {
+            error_notification();
+        }
+
+        get_next_token();
+        if (m_current_token.get_type() == TT_STRING) {
+            try {
+                int tmp_timer_value = std::stoi(m_current_token.get_string());
+                if (tmp_timer_value < 0) {
+                    error_notification();
+                }
+                timer_value = std::chrono::milliseconds(tmp_timer_value);
+            } catch (...) {
+                error_notification();
+            }
+        } else {
+            error_notification();
+        }
+    } else {
+        error_notification();
+    }
+
+    get_next_token();
+    if (m_current_token.get_type() != TT_NIL) {
+        error_notification();
+    }
+
+    auto instance_it = ids.find(instance_name);
+    if (instance_it != ids.end()) {
+        auto rb = std::make_shared<rule_binding>(instance_name, interface_type, if_name, filter_direction, timer_value_type, timer_value);
+        (*instance_it)->m_global_settings.push_back(rb);
+        return;
+    } else {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " proxy instance " << m_current_token.get_string() << " not defined");
+        throw "failed to parse config file";
+    }
+}
+
+void parser::parse_interface_prejoin_binding(
+    std::string && instance_name
+    , rb_interface_type interface_type
+    , std::string && if_name
+    , rb_interface_direction filter_direction
+    , group_mem_protocol gmp
+    , const inst_def_set& ids)
+{
+    HC_LOG_TRACE("");
+    auto error_notification = [&]() {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " unknown token " << get_token_type_name(m_current_token.get_type()) << " with value " << m_current_token.get_string() << " in this context");
+        throw "failed to parse config file";
+    };
+
+    std::list<std::pair<addr_storage, addr_storage>> prejoins;
+    unsigned int predictive_groups = 0;
+    //pinstance A upstream * out prejoin (239.1.1.1 | *) (232.1.1.1 | 10.1.1.1);
+    //pinstance A upstream eth0 out prejoin predictive 10;
+    if (interface_type != IT_UPSTREAM || filter_direction != ID_OUT) {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " prejoins are only allowed for the output direction of upstreams");
+        throw "failed to parse config file";
+    }
+
+    if (m_current_token.get_type() == TT_PREJOIN) {
+        get_next_token();
+        if (m_current_token.get_type() == TT_STRING) {
+            std::string cmp_str = m_current_token.get_string();
+            std::transform(cmp_str.begin(), cmp_str.end(), cmp_str.begin(), ::tolower);
+            if (cmp_str != "predictive") {
+                error_notification();
+            }
+
+            get_next_token();
+            if (m_current_token.get_type() == TT_STRING) {
+                try {
+                    int tmp_predictive_groups = std::stoi(m_current_token.get_string());
+                    if (tmp_predictive_groups <= 0) {
+                        error_notification();
+                    }
+                    predictive_groups = tmp_predictive_groups;
+                } catch (...) {
+                    error_notification();
+                }
+            } else {
+                error_notification();
+            }
+            get_next_token();
+        } else if (m_current_token.get_type() == TT_LEFT_BRACKET) {
+            while (m_current_token.get_type() == TT_LEFT_BRACKET) {
+                get_next_token();
+                addr_storage gaddr = get_addr(gmp);
+                if (!gaddr.is_multicast_addr()) {
+                    HC_LOG_ERROR("failed to parse line " << m_current_line << " prejoin group " << gaddr << " is not a multicast address");
+                    throw "failed to parse config file";
+                }
+
+                if (m_current_token.get_type() != TT_PIPE) {
+                    error_notification();
+                }
+
+                get_next_token();
+                addr_storage saddr;
+                if (m_current_token.get_type() == TT_STAR) {
+                    get_next_token();
+                } else {
+                    saddr = get_addr(gmp);
+                }
+
+                if (m_current_token.get_type() != TT_RIGHT_BRACKET) {
+                    error_notification();
+                }
+
+                prejoins.push_back(std::make_pair(gaddr, saddr));
+                get_next_token();
+            }
+        } else {
+            error_notification();
+        }
+    } else {
+        error_notification();
+    }
+
+    if (m_current_token.get_type() != TT_NIL) {
+        error_notification();
+    }
+
+    auto instance_it = ids.find(instance_name);
+    if (instance_it != ids.end()) {
+        auto rb = std::make_shared<rule_binding>(instance_name, interface_type, if_name, filter_direction, std::move(prejoins), predictive_groups);
+        (*instance_it)->m_global_settings.push_back(rb);
+        return;
+    } else {
+        HC_LOG_ERROR("failed to parse line " << m_current_line << " proxy instance " << m_current_token.get_string() << " not defined");
+        throw "failed to parse config file";
+    }
+}
+
 void parser::get_next_token()
 {
     m_current_token = m_scanner.get_next_token();
 }
+
+void parser::get_next_context_token()
+{
+    get_next_token();
+
+    //hash, timer and prejoin are no reserved words (e.g. an interface or a table
+    //can be named timer), they are only keywords where a keyword is expected
+    if (m_current_token.get_type() == TT_STRING) {
+        std::string cmp_str = m_current_token.get_string();
+        std::transform(cmp_str.begin(), cmp_str.end(), cmp_str.begin(), ::tolower);
+        if (cmp_str.compare("hash") == 0) {
+            m_current_token = TT_HASH;
+        } else if (cmp_str.compare("timer") == 0) {
+            m_current_token = TT_TIMER;
+        } else if (cmp_str.compare("prejoin") == 0) {
+            m_current_token = TT_PREJOIN;
+        }
+    }
+}
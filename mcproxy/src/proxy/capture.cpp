@@ -0,0 +1,284 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/capture.hpp"
+#include "include/proxy/interfaces.hpp"
+
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------
+//encoding
+template <typename T>
+inline void put_value(std::string& buf, T value)
+{
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename S>
+inline void put_bytes(std::string& buf, const void* data, size_t size)
+{
+    put_value<S>(buf, size);
+    buf.append(static_cast<const char*>(data), size);
+}
+
+//------------------------------------------------------------------------
+//decoding, all functions return false if the buffer is too short
+struct capture_reader {
+    capture_reader(const char* data, size_t size): m_data(data), m_size(size), m_pos(0) {}
+
+    template <typename T>
+    bool get_value(T& value) {
+        if (m_pos + sizeof(T) > m_size) {
+            return false;
+        }
+        std::memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    template <typename S>
+    bool get_bytes(std::string& s) {
+        S size;
+        if (!get_value(size) || m_pos + size > m_size) {
+            return false;
+        }
+        s.assign(m_data + m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    bool at_end() const {
+        return m_pos == m_size;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+};
+
+//------------------------------------------------------------------------
+capture_file::capture_file()
+    : m_start(std::chrono::steady_clock::now())
+    , m_last_flush(m_start)
+{
+    HC_LOG_TRACE("");
+}
+
+capture_file::~capture_file()
+{
+    HC_LOG_TRACE("");
+
+    if (m_file.is_open()) {
+        m_file.close();
+    }
+}
+
+std::chrono::nanoseconds capture_file::get_time_stamp() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+}
+
+void capture_file::write(const std::string& buf)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (!m_file.is_open()) {
+        return;
+    }
+
+    m_file.write(buf.data(), buf.size());
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_last_flush >= std::chrono::milliseconds(CAPTURE_FLUSH_INTERVAL)) {
+        m_file.flush();
+        m_last_flush = now;
+    }
+}
+
+bool capture_file::open(const std::string& path)
+{
+    HC_LOG_TRACE("");
+    using namespace std::chrono;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    m_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!m_file) {
+        HC_LOG_ERROR("failed to open capture file: " << path);
+        return false;
+    }
+
+    m_start = steady_clock::now();
+    m_last_flush = m_start;
+
+    std::string buf;
+    buf.append(CAPTURE_MAGIC);
+    put_value<uint32_t>(buf, CAPTURE_VERSION);
+    put_value<int64_t>(buf, duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count());
+    m_file.write(buf.data(), buf.size());
+    m_file.flush();
+
+    return static_cast<bool>(m_file);
+}
+
+void capture_file::write_interface(const std::string& instance_name, group_mem_protocol protocol, unsigned int if_index, int vif, bool upstream, unsigned int upstream_priority)
+{
+    HC_LOG_TRACE("");
+
+    std::string if_name = interfaces::get_if_name(if_index);
+
+    std::string buf;
+    put_value<uint8_t>(buf, CRT_INTERFACE);
+    put_value<int64_t>(buf, get_time_stamp().count());
+    put_bytes<uint16_t>(buf, instance_name.data(), instance_name.size());
+    put_value<uint8_t>(buf, protocol);
+    put_bytes<uint16_t>(buf, if_name.data(), if_name.size());
+    put_value<uint32_t>(buf, if_index);
+    put_value<int32_t>(buf, vif);
+    put_value<uint8_t>(buf, upstream);
+    put_value<uint32_t>(buf, upstream_priority);
+
+    write(buf);
+}
+
+void capture_file::write_packet(unsigned int if_index, const struct msghdr* msg, int info_size)
+{
+    HC_LOG_TRACE("");
+
+    std::string buf;
+    buf.reserve(32 + msg->msg_namelen + msg->msg_controllen + info_size);
+    put_value<uint8_t>(buf, CRT_PACKET);
+    put_value<int64_t>(buf, get_time_stamp().count());
+    put_value<uint32_t>(buf, if_index);
+    put_bytes<uint16_t>(buf, msg->msg_name, msg->msg_name != nullptr ? msg->msg_namelen : 0);
+    put_bytes<uint16_t>(buf, msg->msg_control, msg->msg_control != nullptr ? msg->msg_controllen : 0);
+    put_bytes<uint32_t>(buf, msg->msg_iov->iov_base, info_size);
+
+    write(buf);
+}
+
+bool capture_file::load(const std::string& path)
+{
+    HC_LOG_TRACE("");
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        HC_LOG_ERROR("failed to open capture file: " << path << "! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        HC_LOG_ERROR("failed to get the size of capture file: " << path);
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        HC_LOG_ERROR("failed to map capture file: " << path << "! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    capture_reader r(static_cast<const char*>(data), st.st_size);
+    m_interfaces.clear();
+    m_packets.clear();
+
+    bool rc = [&]() {
+        char magic[sizeof(CAPTURE_MAGIC) - 1];
+        uint32_t version;
+        int64_t start_time;
+        if (!r.get_value(magic) || std::memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0 || !r.get_value(version) || version != CAPTURE_VERSION || !r.get_value(start_time)) {
+            HC_LOG_ERROR("unknown capture format");
+            return false;
+        }
+
+        //a capture of a killed proxy ends with an incomplete record
+        while (!r.at_end()) {
+            uint8_t type;
+            int64_t time_stamp;
+            if (!r.get_value(type) || !r.get_value(time_stamp)) {
+                HC_LOG_WARN("incomplete record at the end of the capture file");
+                return true;
+            }
+
+            if (type == CRT_INTERFACE) {
+                capture_interface ci;
+                uint8_t protocol;
+                uint32_t if_index;
+                int32_t vif;
+                uint8_t upstream;
+                uint32_t upstream_priority;
+                if (!r.get_bytes<uint16_t>(ci.instance_name) || !r.get_value(protocol) || !r.get_bytes<uint16_t>(ci.if_name) || !r.get_value(if_index) || !r.get_value(vif) || !r.get_value(upstream) || !r.get_value(upstream_priority)) {
+                    HC_LOG_WARN("incomplete record at the end of the capture file");
+                    return true;
+                }
+                ci.time_stamp = std::chrono::nanoseconds(time_stamp);
+                ci.protocol = static_cast<group_mem_protocol>(protocol);
+                ci.if_index = if_index;
+                ci.vif = vif;
+                ci.upstream = upstream != 0;
+                ci.upstream_priority = upstream_priority;
+                m_interfaces.push_back(std::move(ci));
+            } else if (type == CRT_PACKET) {
+                capture_packet cp;
+                uint32_t if_index;
+                if (!r.get_value(if_index) || !r.get_bytes<uint16_t>(cp.name) || !r.get_bytes<uint16_t>(cp.control) || !r.get_bytes<uint32_t>(cp.data)) {
+                    HC_LOG_WARN("incomplete record at the end of the capture file");
+                    return true;
+                }
+                cp.time_stamp = std::chrono::nanoseconds(time_stamp);
+                cp.if_index = if_index;
+                m_packets.push_back(std::move(cp));
+            } else {
+                HC_LOG_ERROR("unknown capture record type: " << static_cast<int>(type));
+                return false;
+            }
+        }
+
+        return true;
+    }();
+
+    munmap(data, st.st_size);
+    return rc;
+}
+
+const std::list<capture_interface>& capture_file::get_interfaces() const
+{
+    HC_LOG_TRACE("");
+    return m_interfaces;
+}
+
+const std::vector<capture_packet>& capture_file::get_packets() const
+{
+    HC_LOG_TRACE("");
+    return m_packets;
+}
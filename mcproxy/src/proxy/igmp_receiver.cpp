@@ -74,13 +74,20 @@ void print_buf(const unsigned char * buf, unsigned int size)
 }
 #endif /* DEBUG_MODE */
 
-igmp_receiver::igmp_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode): receiver(pr_i, AF_INET, mrt_sock, interfaces, in_debug_testing_mode)
+igmp_receiver::igmp_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode, const std::shared_ptr<receive_loop>& shared_receive_loop): receiver(pr_i, AF_INET, mrt_sock, interfaces, in_debug_testing_mode, shared_receive_loop)
 {
     HC_LOG_TRACE("");
 
     start();
 }
 
+igmp_receiver::~igmp_receiver()
+{
+    HC_LOG_TRACE("");
+    stop();
+    join();
+}
+
 int igmp_receiver::get_iov_min_size()
 {
     HC_LOG_TRACE("");
@@ -96,6 +103,20 @@ int igmp_receiver::get_ctrl_min_size()
     return 0;
 }
 
+unsigned int igmp_receiver::get_packet_if_index(struct msghdr* msg)
+{
+    HC_LOG_TRACE("");
+
+    struct ip* ip_hdr = (struct ip*)msg->msg_iov->iov_base;
+
+    if (ip_hdr->ip_p == IGMP_RECEIVER_KERNEL_MSG) {
+        struct igmpmsg *igmpctl = (struct igmpmsg *) msg->msg_iov->iov_base;
+        return m_interfaces->get_if_index(igmpctl->im_vif);
+    } else {
+        return m_interfaces->get_if_index(addr_storage(ip_hdr->ip_src));
+    }
+}
+
 void igmp_receiver::analyse_packet(struct msghdr* msg, int)
 {
     HC_LOG_TRACE("");
@@ -133,7 +154,7 @@ void igmp_receiver::analyse_packet(struct msghdr* msg, int)
                 return;
             }
 
-            m_proxy_instance->add_msg(std::make_shared<new_source_msg>(if_index, gaddr, saddr));
+            m_proxy_instance->add_msg(make_pooled_msg<new_source_msg>(if_index, gaddr, saddr));
             break;
         }
         default:
@@ -162,10 +183,10 @@ void igmp_receiver::analyse_packet(struct msghdr* msg, int)
 
             if (igmp_hdr->igmp_type == IGMP_V2_MEMBERSHIP_REPORT) {
                 HC_LOG_DEBUG("\treport received");
-                m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, MODE_IS_EXCLUDE, gaddr, source_list<source>(), IGMPv2));
+                m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, MODE_IS_EXCLUDE, gaddr, source_list<source>(), IGMPv2, saddr));
             } else if (igmp_hdr->igmp_type == IGMP_V2_LEAVE_GROUP) {
                 HC_LOG_DEBUG("\tleave group received");
-                m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, CHANGE_TO_INCLUDE_MODE, gaddr, source_list<source>(), IGMPv2));
+                m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, CHANGE_TO_INCLUDE_MODE, gaddr, source_list<source>(), IGMPv2, saddr));
             } else {
                 HC_LOG_ERROR("unkown igmp type: " << igmp_hdr->igmp_type); 
             }
@@ -210,7 +231,7 @@ void igmp_receiver::analyse_packet(struct msghdr* msg, int)
                 HC_LOG_DEBUG("\tgaddr: " << gaddr);
                 HC_LOG_DEBUG("\tnumber of sources: " << slist.size());
                 HC_LOG_DEBUG("\tsource_list: " << slist);
-                m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, rec_type, gaddr, move(slist), IGMPv3));
+                m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, rec_type, gaddr, move(slist), IGMPv3, saddr));
 
                 rec = reinterpret_cast<igmpv3_mc_record*>(reinterpret_cast<unsigned char*>(rec) + sizeof(igmpv3_mc_record) + nos * sizeof(in_addr) + aux_size);
             }
@@ -67,6 +67,18 @@ bool igmp_sender::send_record(unsigned int if_index, mc_filter filter_mode, cons
     }
 }
 
+bool igmp_sender::send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const
+{
+    HC_LOG_TRACE("");
+
+    if ((old_filter_mode != INCLUDE_MODE && old_filter_mode != EXCLUDE_MODE) || (new_filter_mode != INCLUDE_MODE && new_filter_mode != EXCLUDE_MODE)) {
+        HC_LOG_ERROR("unknown filter mode");
+        return false;
+    }
+
+    return change_socket_filter(if_index, gaddr, old_filter_mode, old_slist, new_filter_mode, new_slist);
+}
+
 bool igmp_sender::send_general_query(unsigned int if_index, const timers_values& tv) const
 {
     HC_LOG_TRACE("");
@@ -96,14 +108,14 @@ bool igmp_sender::send_mc_addr_and_src_specific_query(unsigned int if_index, con
                 rc = true;
             }
 
-            if (e.shared_source_timer.get() != nullptr) {
-                if (e.shared_source_timer->is_remaining_time_greater_than(tv.get_last_listener_query_time())) {
+            if (e.source_timer != timer_clock::not_running()) {
+                if (timer_clock::now() + tv.get_last_listener_query_time() <= e.source_timer) {
                     slist_higher.insert(e);
                 } else {
                     slist_lower.insert(e);
                 }
             } else {
-                HC_LOG_ERROR("the shared source timer shouldnt be null");
+                HC_LOG_ERROR("the source timer should be running");
             }
         }
     }
@@ -119,35 +131,52 @@ bool igmp_sender::send_mc_addr_and_src_specific_query(unsigned int if_index, con
     return rc;
 }
 
-bool igmp_sender::send_igmpv3_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag, const source_list<source>& slist) const
+const igmp_sender::query_template& igmp_sender::get_query_template(unsigned int if_index, const timers_values& tv, query_template_type qtt) const
 {
     HC_LOG_TRACE("");
 
-    std::unique_ptr<unsigned char[]> packet;
-    unsigned int size;
+    const unsigned int ip_hdr_size = sizeof(ip) + sizeof(router_alert_option);
+    const unsigned int size = ip_hdr_size + sizeof(igmpv3_query);
+
+    uint8_t igmp_code;
+    if (qtt == QTT_GENERAL_QUERY) {
+        igmp_code = tv.maxrespi_to_maxrespc_igmpv3(tv.get_query_response_interval());
+    } else {
+        igmp_code = tv.maxrespi_to_maxrespc_igmpv3(tv.get_last_listener_query_time());
+    }
+
+    uint8_t qrv = tv.get_robustness_variable() <= 7 ? tv.get_robustness_variable() : 0;
+    uint8_t qqic = tv.qqi_to_qqic(tv.get_query_interval());
+
+    //the address of the interface can change (refresh on a reload)
+    unsigned int refresh_count = m_interfaces->get_refresh_count();
 
-    if (slist.empty()) {
-        size = sizeof(ip) + sizeof(router_alert_option) + sizeof(igmpv3_query);
-        packet.reset(new unsigned char[size]);
-    } else { //all other types of queries
-        size = sizeof(ip) + sizeof(router_alert_option) + sizeof(igmpv3_query) + (slist.size() * sizeof(in_addr));
-        packet.reset(new unsigned char[size]);
+    auto it = m_query_templates.find(query_template_key(if_index, qtt));
+    if (it != std::end(m_query_templates)) {
+        const igmpv3_query* query = reinterpret_cast<const igmpv3_query*>(it->second.m_packet.data() + ip_hdr_size);
+        if (query->igmp_code == igmp_code && query->qrv == qrv && query->qqic == qqic && it->second.m_refresh_count == refresh_count) {
+            return it->second;
+        }
     }
 
-    addr_storage dst_addr;
+    HC_LOG_DEBUG("build query template for interface " << interfaces::get_if_name(if_index));
+
+    query_template t;
+    t.m_packet.resize(size, 0);
+    t.m_refresh_count = refresh_count;
 
-    if (gaddr == addr_storage(AF_INET)) { //is general query
-        dst_addr = IPV4_ALL_HOST_ADDR;
+    if (qtt == QTT_GENERAL_QUERY) {
+        t.m_dst_addr = IPV4_ALL_HOST_ADDR;
     } else {
-        dst_addr = gaddr;
+        t.m_dst_addr = addr_storage(AF_INET); //filled in per query
     }
 
     //-------------------------------------------------------------------
     //fill ip header
-    ip* ip_hdr = reinterpret_cast<ip*>(packet.get());
+    ip* ip_hdr = reinterpret_cast<ip*>(t.m_packet.data());
 
     ip_hdr->ip_v = 4;
-    ip_hdr->ip_hl = (sizeof(ip) + sizeof(router_alert_option)) / 4;
+    ip_hdr->ip_hl = ip_hdr_size / 4;
     ip_hdr->ip_tos = 0;
     ip_hdr->ip_len = htons(size);
     ip_hdr->ip_id = 0;
@@ -156,57 +185,82 @@ bool igmp_sender::send_igmpv3_query(unsigned int if_index, const timers_values&
     ip_hdr->ip_p = IPPROTO_IGMP;
     ip_hdr->ip_sum = 0;
     ip_hdr->ip_src = m_interfaces->get_saddr(interfaces::get_if_name(if_index)).get_in_addr();
-    ip_hdr->ip_dst = dst_addr.get_in_addr();
+    ip_hdr->ip_dst = t.m_dst_addr.get_in_addr();
 
     //-------------------------------------------------------------------
     //fill router_alert_option header
-    router_alert_option* ra_hdr = reinterpret_cast<router_alert_option*>(reinterpret_cast<unsigned char*>(ip_hdr) + sizeof(ip));
+    router_alert_option* ra_hdr = reinterpret_cast<router_alert_option*>(t.m_packet.data() + sizeof(ip));
     *ra_hdr = router_alert_option();
 
-    ip_hdr->ip_sum = m_sock.calc_checksum(reinterpret_cast<unsigned char*>(ip_hdr), sizeof(ip) + sizeof(router_alert_option));
+    ip_hdr->ip_sum = m_sock.calc_checksum(reinterpret_cast<unsigned char*>(ip_hdr), ip_hdr_size);
 
     //-------------------------------------------------------------------
-    //fill igmpv3 query
-    igmpv3_query* query = reinterpret_cast<igmpv3_query*>(reinterpret_cast<unsigned char*>(ra_hdr) + sizeof(router_alert_option));
+    //fill igmpv3 query, group address, s flag and sources are filled in per query
+    igmpv3_query* query = reinterpret_cast<igmpv3_query*>(t.m_packet.data() + ip_hdr_size);
 
     query->igmp_type = IGMP_MEMBERSHIP_QUERY;
-
-    if (gaddr == addr_storage(AF_INET)) { //general query
-        query->igmp_code = tv.maxrespi_to_maxrespc_igmpv3(tv.get_query_response_interval());
-    } else {
-        query->igmp_code = tv.maxrespi_to_maxrespc_igmpv3(tv.get_last_listener_query_time());
-    }
-
+    query->igmp_code = igmp_code;
     query->igmp_cksum = 0;
-    query->igmp_group = gaddr.get_in_addr();
+    query->igmp_group = addr_storage(AF_INET).get_in_addr();
     query->resv2 = 0;
-    query->suppress = s_flag;
+    query->suppress = false;
+    query->qrv = qrv;
+    query->qqic = qqic;
+    query->num_of_srcs = 0;
 
-    if (tv.get_robustness_variable() <= 7) {
-        query->qrv = tv.get_robustness_variable();
-    } else {
-        query->qrv = 0;
+    query->igmp_cksum = m_sock.calc_checksum(reinterpret_cast<unsigned char*>(query), sizeof(igmpv3_query));
+
+    return m_query_templates[query_template_key(if_index, qtt)] = std::move(t);
+}
+
+bool igmp_sender::send_igmpv3_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag, const source_list<source>& slist) const
+{
+    HC_LOG_TRACE("");
+
+    const unsigned int ip_hdr_size = sizeof(ip) + sizeof(router_alert_option);
+    bool is_general_query = (gaddr == addr_storage(AF_INET));
+    const query_template& t = get_query_template(if_index, tv, is_general_query ? QTT_GENERAL_QUERY : QTT_MC_ADDR_SPECIFIC_QUERY);
+
+    unsigned int size = t.m_packet.size() + (slist.size() * sizeof(in_addr));
+    if (m_packet_buf.size() < size) {
+        m_packet_buf.resize(size);
     }
 
-    query->qqic = tv.qqi_to_qqic(tv.get_query_interval());
-    query->num_of_srcs = ntohs(slist.size());
+    unsigned char* packet = m_packet_buf.data();
+    std::copy(t.m_packet.begin(), t.m_packet.end(), packet);
+
+    const ip* t_ip_hdr = reinterpret_cast<const ip*>(t.m_packet.data());
+    const igmpv3_query* t_query = reinterpret_cast<const igmpv3_query*>(t.m_packet.data() + ip_hdr_size);
+    ip* ip_hdr = reinterpret_cast<ip*>(packet);
+    igmpv3_query* query = reinterpret_cast<igmpv3_query*>(packet + ip_hdr_size);
+
+    addr_storage dst_addr = is_general_query ? t.m_dst_addr : gaddr;
+
+    //-------------------------------------------------------------------
+    //patch ip header (length and destination)
+    ip_hdr->ip_len = htons(size);
+    ip_hdr->ip_dst = dst_addr.get_in_addr();
+    ip_hdr->ip_sum = m_sock.update_checksum(ip_hdr->ip_sum, reinterpret_cast<const unsigned char*>(&t_ip_hdr->ip_len), reinterpret_cast<const unsigned char*>(&ip_hdr->ip_len), sizeof(ip_hdr->ip_len));
+    ip_hdr->ip_sum = m_sock.update_checksum(ip_hdr->ip_sum, reinterpret_cast<const unsigned char*>(&t_ip_hdr->ip_dst), reinterpret_cast<const unsigned char*>(&ip_hdr->ip_dst), sizeof(ip_hdr->ip_dst));
 
     //-------------------------------------------------------------------
-    //add sources
+    //patch igmpv3 query (group address, s flag, number of sources) and add sources
+    query->igmp_group = gaddr.get_in_addr();
+    query->suppress = s_flag;
+    query->num_of_srcs = htons(slist.size());
+
+    //the group address, the flags and the number of sources follow the checksum field
+    const unsigned int var_offset = sizeof(query->igmp_type) + sizeof(query->igmp_code) + sizeof(query->igmp_cksum);
+    query->igmp_cksum = m_sock.update_checksum(query->igmp_cksum, reinterpret_cast<const unsigned char*>(t_query) + var_offset, reinterpret_cast<const unsigned char*>(query) + var_offset, sizeof(igmpv3_query) - var_offset);
+
     if (!slist.empty()) {
-        in_addr* source_ptr = reinterpret_cast<in_addr*>(reinterpret_cast<unsigned char*>(query) + sizeof(igmpv3_query));
+        in_addr* source_ptr = reinterpret_cast<in_addr*>(packet + t.m_packet.size());
         for (auto & e : slist) {
             *source_ptr = e.saddr.get_in_addr();
             source_ptr++;
         }
+        query->igmp_cksum = m_sock.update_checksum(query->igmp_cksum, nullptr, packet + t.m_packet.size(), slist.size() * sizeof(in_addr));
     }
 
-    query->igmp_cksum = m_sock.calc_checksum(reinterpret_cast<unsigned char*>(query), (sizeof(igmpv3_query) + (slist.size() * sizeof(in_addr))));
-
-    if (!m_sock.choose_if(if_index)) {
-        return false;
-    }
-
-    return m_sock.send_packet(dst_addr, reinterpret_cast<unsigned char*>(ip_hdr), size);
+    return m_sock.send_packet(dst_addr, packet, size, if_index);
 }
-
@@ -30,6 +30,7 @@
 
 interfaces::interfaces(int addr_family, bool reset_reverse_path_filter)
     : m_addr_family(addr_family)
+    , m_refresh_count(0)
 {
     HC_LOG_TRACE("");
 
@@ -62,6 +63,7 @@ bool interfaces::add_interface(const std::string& if_name)
 bool interfaces::add_interface(unsigned int if_index)
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
     int free_vif =  get_free_vif_number();
     HC_LOG_DEBUG("if_index: " << if_index << " (" << interfaces::get_if_name(if_index) << ")" << " free_vif: " << free_vif);
     if (free_vif > INTERFACES_UNKOWN_VIF_INDEX) {
@@ -102,9 +104,12 @@ bool interfaces::del_interface(unsigned int if_index)
 {
     HC_LOG_TRACE("");
     if (if_index != INTERFACES_UNKOWN_IF_INDEX) {
-        int vif = get_virtual_if_index(if_index);
-        m_vif_if.erase(vif);
-        m_if_vif.erase(if_index);
+        std::lock_guard<std::mutex> lock(m_global_lock);
+        auto it = m_if_vif.find(if_index);
+        if (it != end(m_if_vif)) {
+            m_vif_if.erase(it->second);
+            m_if_vif.erase(it);
+        }
 
         if (m_reset_reverse_path_filter) {
             m_reverse_path_filter.restore_rp_filter(get_if_name(if_index));
@@ -119,9 +124,17 @@ bool interfaces::del_interface(unsigned int if_index)
 bool interfaces::refresh_network_interfaces()
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    ++m_refresh_count;
     return m_if_prop.refresh_network_interfaces();
 }
 
+unsigned int interfaces::get_refresh_count() const
+{
+    HC_LOG_TRACE("");
+    return m_refresh_count;
+}
+
 unsigned int interfaces::get_if_index(const std::string& if_name)
 {
     HC_LOG_TRACE("");
@@ -137,6 +150,7 @@ unsigned int interfaces::get_if_index(const char* if_name)
 unsigned int interfaces::get_if_index(int virtual_if_index) const
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
     auto rc = m_vif_if.find(virtual_if_index);
     if (rc != end(m_vif_if)) {
         return rc->second;
@@ -148,6 +162,8 @@ unsigned int interfaces::get_if_index(int virtual_if_index) const
 
 int interfaces::get_virtual_if_index(unsigned int if_index) const
 {
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
     auto rc = m_if_vif.find(if_index);
     if (rc != end(m_if_vif)) {
         return rc->second;
@@ -155,13 +171,12 @@ int interfaces::get_virtual_if_index(unsigned int if_index) const
         HC_LOG_WARN("cannot map if_index (#" << if_index << ") to virutal if_index");
         return INTERFACES_UNKOWN_VIF_INDEX;
     }
-    HC_LOG_TRACE("");
-
 }
 
 addr_storage interfaces::get_saddr(const std::string& if_name) const
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
 
     if (m_addr_family == AF_INET) {
         auto tmp = m_if_prop.get_ip4_if(if_name);
@@ -203,6 +218,7 @@ unsigned int interfaces::get_if_index(const addr_storage& saddr) const
 
     const if_prop_map* prop_map;
 
+    std::lock_guard<std::mutex> lock(m_global_lock);
     if (saddr.get_addr_family() == AF_INET) {
         prop_map = m_if_prop.get_if_props();
         for (auto & e : *prop_map) {
@@ -287,6 +303,7 @@ bool interfaces::is_interface(unsigned if_index, unsigned int interface_flags) c
 std::string interfaces::to_string() const
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
     std::ostringstream s;
     s << "##-- interfaces --##" << std::endl;
     s << "virtual interface index mapped to interface:" << std::endl;
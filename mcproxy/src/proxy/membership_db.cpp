@@ -28,6 +28,8 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <algorithm>
+#include <iterator>
 
 #ifdef DEBUG_MODE
 void membership_db::test_arithmetic()
@@ -82,19 +84,146 @@ void membership_db::test_arithmetic()
 }
 #endif /* DEBUG_MODE */
 
+host_key get_host_key(const addr_storage& addr)
+{
+    host_key key(0, 0);
+    if (addr.get_addr_family() == AF_INET) {
+        key.first = addr.get_in_addr().s_addr;
+    } else if (addr.get_addr_family() == AF_INET6) {
+        const unsigned char* a = addr.get_in6_addr().s6_addr;
+        for (int i = 0; i < 8; ++i) {
+            key.first = (key.first << 8) | a[i];
+            key.second = (key.second << 8) | a[i + 8];
+        }
+    }
+    return key;
+}
+
+host_info::host_info()
+    : filter_mode(INCLUDE_MODE)
+    , expiry(timer_clock::not_running())
+{
+}
+
+bool host_info::is_interested(const host_key& s) const
+{
+    bool listed = std::binary_search(std::begin(slist), std::end(slist), s);
+    return filter_mode == INCLUDE_MODE ? listed : !listed;
+}
+
 gaddr_info::gaddr_info(group_mem_protocol compatibility_mode_variable)
     : filter_mode(INCLUDE_MODE)
-    , shared_filter_timer(nullptr)
+    , filter_timer(timer_clock::not_running())
+    , group_timer(timer_clock::not_running())
+    , group_timer_generation(0)
     , compatibility_mode_variable(compatibility_mode_variable)
     , older_host_present_timer(nullptr)  
     , group_retransmission_timer(nullptr)
     , group_retransmission_count(-1) //not in a retransmission state
     , source_retransmission_timer(nullptr)
+    , untracked_host_timer(timer_clock::time_point())
+{
+    HC_LOG_TRACE("");
+}
+
+void gaddr_info::track_host(const host_key& host, mcast_addr_record_type record_type, const source_list<source>& slist, const timer_clock::time_point& expiry)
 {
     HC_LOG_TRACE("");
+
+    auto now = timer_clock::now();
+    for (auto it = std::begin(tracked_hosts); it != std::end(tracked_hosts);) {
+        if (it->second.expiry <= now) {
+            it = tracked_hosts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<host_key> B;
+    B.reserve(slist.size());
+    for (auto & e : slist) {
+        B.push_back(get_host_key(e.saddr));
+    }
+    std::sort(std::begin(B), std::end(B));
+
+    host_info& h = tracked_hosts[host];
+    std::vector<host_key> A = std::move(h.slist);
+    h.slist.clear();
+
+    //the state of a single host follows the record type (RFC 3810 Section 6.1), a new host starts with INCLUDE({})
+    switch (record_type) {
+    case MODE_IS_INCLUDE:
+    case CHANGE_TO_INCLUDE_MODE:
+        h.filter_mode = INCLUDE_MODE;
+        h.slist = std::move(B);
+        break;
+    case MODE_IS_EXCLUDE:
+    case CHANGE_TO_EXCLUDE_MODE:
+        h.filter_mode = EXCLUDE_MODE;
+        h.slist = std::move(B);
+        break;
+    case ALLOW_NEW_SOURCES:
+        if (h.filter_mode == INCLUDE_MODE) { //INCLUDE (A+B)
+            std::set_union(std::begin(A), std::end(A), std::begin(B), std::end(B), std::back_inserter(h.slist));
+        } else { //EXCLUDE (A-B)
+            std::set_difference(std::begin(A), std::end(A), std::begin(B), std::end(B), std::back_inserter(h.slist));
+        }
+        break;
+    case BLOCK_OLD_SOURCES:
+        if (h.filter_mode == INCLUDE_MODE) { //INCLUDE (A-B)
+            std::set_difference(std::begin(A), std::end(A), std::begin(B), std::end(B), std::back_inserter(h.slist));
+        } else { //EXCLUDE (A+B)
+            std::set_union(std::begin(A), std::end(A), std::begin(B), std::end(B), std::back_inserter(h.slist));
+        }
+        break;
+    default:
+        HC_LOG_ERROR("unknown multicast record type: " << record_type);
+        h.slist = std::move(A);
+        break;
+    }
+
+    if (h.filter_mode == INCLUDE_MODE && h.slist.empty()) {
+        tracked_hosts.erase(host);
+    } else {
+        h.expiry = expiry;
+    }
+}
+
+bool gaddr_info::has_tracked_interest() const
+{
+    auto now = timer_clock::now();
+    for (auto & e : tracked_hosts) {
+        if (e.second.expiry > now && (e.second.filter_mode == EXCLUDE_MODE || !e.second.slist.empty())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool gaddr_info::has_tracked_interest(const source& s) const
+{
+    auto now = timer_clock::now();
+    auto key = get_host_key(s.saddr);
+    for (auto & e : tracked_hosts) {
+        if (e.second.expiry > now && e.second.is_interested(key)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
+timer_clock::time_point gaddr_info::get_next_deadline() const
+{
+    auto next_deadline = filter_mode == EXCLUDE_MODE ? filter_timer : timer_clock::not_running();
+    for (auto & e : include_requested_list) {
+        if (e.source_timer < next_deadline) {
+            next_deadline = e.source_timer;
+        }
+    }
+    return next_deadline;
+}
+
 bool gaddr_info::is_in_backward_compatibility_mode() const{
     return !is_newest_version(compatibility_mode_variable);
 }
@@ -119,9 +248,9 @@ std::string gaddr_info::to_string() const
 
     s << ", " << get_mc_filter_name(filter_mode);
     if ((filter_mode == EXCLUDE_MODE) && (group_retransmission_timer.get() != nullptr)) {
-        s << "(" << shared_filter_timer->get_remaining_time() << "," << group_retransmission_timer->get_remaining_time() << "," << group_retransmission_count << "x)" << endl;
+        s << "(" << timer_clock::get_remaining_time(filter_timer) << "," << group_retransmission_timer->get_remaining_time() << "," << group_retransmission_count << "x)" << endl;
     } else if (filter_mode == EXCLUDE_MODE) {
-        s << "(" << shared_filter_timer->get_remaining_time() << ")" << endl;
+        s << "(" << timer_clock::get_remaining_time(filter_timer) << ")" << endl;
     }else{
         s << endl; 
     }
@@ -145,6 +274,35 @@ std::string gaddr_info::to_string() const
             HC_LOG_ERROR("unknown filter mode");
         }
     }
+
+    if (!tracked_hosts.empty()) {
+        if (filter_mode == EXCLUDE_MODE) {
+            s << endl;
+        }
+        s << "tracked hosts(#" << tracked_hosts.size() << ")";
+    }
+    return s.str();
+}
+
+membership_delta::membership_delta(mc_filter old_filter_mode, mc_filter new_filter_mode)
+    : old_filter_mode(old_filter_mode)
+    , new_filter_mode(new_filter_mode)
+{
+}
+
+bool query_round::empty() const
+{
+    return group_queries.empty() && source_queries.empty();
+}
+
+std::string query_round::to_string() const
+{
+    using namespace std;
+    ostringstream s;
+    if (round_timer.get() != nullptr) {
+        s << "(" << round_timer->get_remaining_time() << ")";
+    }
+    s << " group queries: " << group_queries.size() << ", source queries: " << source_queries.size();
     return s.str();
 }
 
@@ -168,6 +326,10 @@ std::string membership_db::to_string() const
         s << "general query timer: " << general_query_timer->get_remaining_time() << endl;
     }
     s << "startup query count: " << startup_query_count << endl;
+    if (!current_query_round.empty() || !next_query_round.empty()) {
+        s << "current query round:" << current_query_round.to_string() << endl;
+        s << "next query round:" << next_query_round.to_string() << endl;
+    }
 
     s << "subscribed groups: " << group_info.size();
     for (auto & e : group_info) {
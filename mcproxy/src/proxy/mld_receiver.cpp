@@ -34,21 +34,30 @@
 //DEBUG
 #include <net/if.h>
 
-mld_receiver::mld_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode)
-    : receiver(pr_i, AF_INET6, mrt_sock, interfaces, in_debug_testing_mode)
+mld_receiver::mld_receiver(proxy_instance* pr_i, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode, const std::shared_ptr<receive_loop>& shared_receive_loop)
+    : receiver(pr_i, AF_INET6, mrt_sock, interfaces, in_debug_testing_mode, shared_receive_loop)
 {
     HC_LOG_TRACE("");
-    if (!m_mrt_sock->set_ipv6_recv_icmpv6_msg()) {
-        throw "failed to set receive icmpv6 message";
-    }
+    if (m_mrt_sock != nullptr) {
+        if (!m_mrt_sock->set_ipv6_recv_icmpv6_msg()) {
+            throw "failed to set receive icmpv6 message";
+        }
 
-    if (!m_mrt_sock->set_ipv6_recv_pkt_info()) {
-        throw "faield to set receive paket info";
+        if (!m_mrt_sock->set_ipv6_recv_pkt_info()) {
+            throw "faield to set receive paket info";
+        }
     }
 
     start();
 }
 
+mld_receiver::~mld_receiver()
+{
+    HC_LOG_TRACE("");
+    stop();
+    join();
+}
+
 int mld_receiver::get_iov_min_size()
 {
     HC_LOG_TRACE("");
@@ -64,6 +73,26 @@ int mld_receiver::get_ctrl_min_size()
     return sizeof(struct cmsghdr) + sizeof(struct in6_pktinfo);
 }
 
+unsigned int mld_receiver::get_packet_if_index(struct msghdr* msg)
+{
+    HC_LOG_TRACE("");
+
+    struct mld_hdr* hdr = (struct mld_hdr*)msg->msg_iov->iov_base;
+
+    if (hdr->mld_type == MLD_RECEIVER_KERNEL_MSG) {
+        struct mrt6msg* mldctl = (struct mrt6msg*)msg->msg_iov->iov_base;
+        return m_interfaces->get_if_index(mldctl->im6_mif);
+    }
+
+    for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(msg); cmsgptr != nullptr; cmsgptr = CMSG_NXTHDR(msg, cmsgptr)) {
+        if (cmsgptr->cmsg_len > 0 && cmsgptr->cmsg_level == IPPROTO_IPV6 && cmsgptr->cmsg_type == IPV6_PKTINFO ) {
+            return ((struct in6_pktinfo*)CMSG_DATA(cmsgptr))->ipi6_ifindex;
+        }
+    }
+
+    return 0;
+}
+
 void mld_receiver::analyse_packet(struct msghdr* msg, int)
 {
     HC_LOG_TRACE("");
@@ -99,7 +128,7 @@ void mld_receiver::analyse_packet(struct msghdr* msg, int)
                 return;
             }
 
-            m_proxy_instance->add_msg(std::make_shared<new_source_msg>(if_index, gaddr, saddr));
+            m_proxy_instance->add_msg(make_pooled_msg<new_source_msg>(if_index, gaddr, saddr));
             break;
         }
         default:
@@ -119,7 +148,10 @@ void mld_receiver::analyse_packet(struct msghdr* msg, int)
             return;
         }
 
-        HC_LOG_DEBUG("\tsaddr: " << addr_storage(packet_info->ipi6_addr));
+        if (msg->msg_namelen > 0) {
+            saddr = addr_storage(*reinterpret_cast<sockaddr*>(msg->msg_name));
+        }
+        HC_LOG_DEBUG("\tsaddr: " << saddr);
         if_index = packet_info->ipi6_ifindex;
         HC_LOG_DEBUG("\treceived on interface:" << interfaces::get_if_name(if_index));
 
@@ -133,10 +165,10 @@ void mld_receiver::analyse_packet(struct msghdr* msg, int)
 
         if (hdr->mld_type == MLD_LISTENER_REPORT) {
             HC_LOG_DEBUG("\treport received");
-            m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, MODE_IS_EXCLUDE, gaddr, source_list<source>(), MLDv1));
+            m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, MODE_IS_EXCLUDE, gaddr, source_list<source>(), MLDv1, saddr));
         } else if (hdr->mld_type == MLD_LISTENER_REDUCTION) {
             HC_LOG_DEBUG("\tlistener reduction received");
-            m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, CHANGE_TO_INCLUDE_MODE, gaddr, source_list<source>(), MLDv1));
+            m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, CHANGE_TO_INCLUDE_MODE, gaddr, source_list<source>(), MLDv1, saddr));
         } else {
             HC_LOG_ERROR("unkown mld type: " << hdr->mld_type);
         }
@@ -160,6 +192,11 @@ void mld_receiver::analyse_packet(struct msghdr* msg, int)
         int num_records = ntohs(v3_report->num_of_mc_records);
         HC_LOG_DEBUG("\tnum of multicast records: " << num_records);
 
+        if (msg->msg_namelen > 0) {
+            saddr = addr_storage(*reinterpret_cast<sockaddr*>(msg->msg_name));
+        }
+        HC_LOG_DEBUG("\tsaddr: " << saddr);
+
         if_index = packet_info->ipi6_ifindex;
         HC_LOG_DEBUG("\treceived on interface:" << interfaces::get_if_name(if_index));
 
@@ -186,7 +223,7 @@ void mld_receiver::analyse_packet(struct msghdr* msg, int)
             HC_LOG_DEBUG("\tgaddr: " << gaddr);
             HC_LOG_DEBUG("\tnumber of sources: " << slist.size());
             HC_LOG_DEBUG("\tsource_list: " << slist);
-            m_proxy_instance->add_msg(std::make_shared<group_record_msg>(if_index, rec_type, gaddr, move(slist), MLDv2));
+            m_proxy_instance->add_msg(make_pooled_msg<group_record_msg>(if_index, rec_type, gaddr, move(slist), MLDv2, saddr));
 
             rec = reinterpret_cast<mldv2_mc_record*>(reinterpret_cast<unsigned char*>(rec) + sizeof(mldv2_mc_record) + nos * sizeof(in6_addr) + aux_size);
         }
@@ -55,7 +55,7 @@ bool mld_sender::send_record(unsigned int if_index, mc_filter filter_mode, const
     if (filter_mode == INCLUDE_MODE && slist.empty() ) {
         m_sock.leave_group(gaddr, if_index);
         return true;
-    } else if (filter_mode == EXCLUDE_MODE || filter_mode == EXCLUDE_MODE) {
+    } else if (filter_mode == EXCLUDE_MODE || filter_mode == INCLUDE_MODE) {
         m_sock.join_group(gaddr, if_index);
         std::list<addr_storage> src_list;
         for (auto & e : slist) {
@@ -69,6 +69,18 @@ bool mld_sender::send_record(unsigned int if_index, mc_filter filter_mode, const
     }
 }
 
+bool mld_sender::send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const
+{
+    HC_LOG_TRACE("");
+
+    if ((old_filter_mode != INCLUDE_MODE && old_filter_mode != EXCLUDE_MODE) || (new_filter_mode != INCLUDE_MODE && new_filter_mode != EXCLUDE_MODE)) {
+        HC_LOG_ERROR("unknown filter mode");
+        return false;
+    }
+
+    return change_socket_filter(if_index, gaddr, old_filter_mode, old_slist, new_filter_mode, new_slist);
+}
+
 bool mld_sender::send_general_query(unsigned int if_index, const timers_values& tv) const
 {
     HC_LOG_TRACE("");
@@ -98,14 +110,14 @@ bool mld_sender::send_mc_addr_and_src_specific_query(unsigned int if_index, cons
                 rc = true;
             }
 
-            if (e.shared_source_timer.get() != nullptr) {
-                if (e.shared_source_timer->is_remaining_time_greater_than(tv.get_last_listener_query_time())) {
+            if (e.source_timer != timer_clock::not_running()) {
+                if (timer_clock::now() + tv.get_last_listener_query_time() <= e.source_timer) {
                     slist_higher.insert(e);
                 } else {
                     slist_lower.insert(e);
                 }
             } else {
-                HC_LOG_ERROR("the shared source timer shouldnt be null");
+                HC_LOG_ERROR("the source timer should be running");
             }
         }
     }
@@ -121,62 +133,85 @@ bool mld_sender::send_mc_addr_and_src_specific_query(unsigned int if_index, cons
     return rc;
 }
 
-bool mld_sender::send_mldv2_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag, const source_list<source>& slist) const
+const mld_sender::query_template& mld_sender::get_query_template(unsigned int if_index, const timers_values& tv, query_template_type qtt) const
 {
     HC_LOG_TRACE("");
 
-    std::unique_ptr<mldv2_query> q;
-    unsigned int size;
+    uint16_t max_resp_delay;
+    if (qtt == QTT_GENERAL_QUERY) {
+        max_resp_delay = htons(tv.maxrespi_to_maxrespc_mldv2(tv.get_query_response_interval()));
+    } else {
+        max_resp_delay = htons(tv.maxrespi_to_maxrespc_mldv2(tv.get_last_listener_query_time()));
+    }
+
+    uint8_t qrv = tv.get_robustness_variable() <= 7 ? tv.get_robustness_variable() : 0;
+    uint8_t qqic = tv.qqi_to_qqic(tv.get_query_interval());
+
+    auto it = m_query_templates.find(query_template_key(if_index, qtt));
+    if (it != std::end(m_query_templates)) {
+        const mldv2_query* q = reinterpret_cast<const mldv2_query*>(it->second.m_packet.data());
+        if (q->max_resp_delay == max_resp_delay && q->qrv == qrv && q->qqic == qqic) {
+            return it->second;
+        }
+    }
+
+    HC_LOG_DEBUG("build query template for interface " << interfaces::get_if_name(if_index));
+
+    query_template t;
+    t.m_packet.resize(sizeof(mldv2_query), 0);
 
-    if (slist.empty()) {
-        size = sizeof(mldv2_query);
-        q.reset(new mldv2_query);
+    if (qtt == QTT_GENERAL_QUERY) {
+        t.m_dst_addr = IPV6_ALL_NODES_ADDR;
     } else {
-        size = sizeof(mldv2_query) + (slist.size() * sizeof(in6_addr));
-        q.reset(reinterpret_cast<mldv2_query*>(new unsigned char[size]));
+        t.m_dst_addr = addr_storage(AF_INET6); //filled in per query
     }
 
+    //group address, s flag and sources are filled in per query
+    mldv2_query* q = reinterpret_cast<mldv2_query*>(t.m_packet.data());
     q->type = MLD_LISTENER_QUERY;
     q->code = 0;
     q->checksum = MC_MASSAGES_AUTO_FILL;
+    q->max_resp_delay = max_resp_delay;
+    q->reserved = 0;
+    q->gaddr = addr_storage(AF_INET6).get_in6_addr();
+    q->resv2 = 0;
+    q->suppress = false;
+    q->qrv = qrv;
+    q->qqic = qqic;
+    q->num_of_srcs = 0;
 
-    addr_storage dst_addr;
+    return m_query_templates[query_template_key(if_index, qtt)] = std::move(t);
+}
 
-    if (gaddr == addr_storage(AF_INET6)) { //general query
-        dst_addr = IPV6_ALL_NODES_ADDR;
-        q->max_resp_delay = htons(tv.maxrespi_to_maxrespc_mldv2(tv.get_query_response_interval()));
-    } else { //all other types of queries
-        dst_addr = gaddr;
-        q->max_resp_delay = htons(tv.maxrespi_to_maxrespc_mldv2(tv.get_last_listener_query_time()));
-    }
+bool mld_sender::send_mldv2_query(unsigned int if_index, const timers_values& tv, const addr_storage& gaddr, bool s_flag, const source_list<source>& slist) const
+{
+    HC_LOG_TRACE("");
 
-    q->reserved = 0;
-    q->gaddr = gaddr.get_in6_addr();
-    q->resv2 = 0;
-    q->suppress = s_flag;
+    bool is_general_query = (gaddr == addr_storage(AF_INET6));
+    const query_template& t = get_query_template(if_index, tv, is_general_query ? QTT_GENERAL_QUERY : QTT_MC_ADDR_SPECIFIC_QUERY);
 
-    if (tv.get_robustness_variable() <= 7) {
-        q->qrv = tv.get_robustness_variable();
-    } else {
-        q->qrv = 0;
+    unsigned int size = t.m_packet.size() + (slist.size() * sizeof(in6_addr));
+    if (m_packet_buf.size() < size) {
+        m_packet_buf.resize(size);
     }
 
-    q->qqic = tv.qqi_to_qqic(tv.get_query_interval());
-    q->num_of_srcs = ntohs(slist.size());
+    unsigned char* packet = m_packet_buf.data();
+    std::copy(t.m_packet.begin(), t.m_packet.end(), packet);
+
+    mldv2_query* q = reinterpret_cast<mldv2_query*>(packet);
+    q->gaddr = gaddr.get_in6_addr();
+    q->suppress = s_flag;
+    q->num_of_srcs = htons(slist.size());
 
     if (!slist.empty()) {
-        in6_addr* source_ptr = reinterpret_cast<in6_addr*>(reinterpret_cast<unsigned char*>(q.get()) + sizeof(mldv2_query));
+        in6_addr* source_ptr = reinterpret_cast<in6_addr*>(packet + t.m_packet.size());
         for (auto & e : slist) {
             *source_ptr = e.saddr.get_in6_addr();
             source_ptr++;
         }
     }
 
-    if (!m_sock.choose_if(if_index)) {
-        return false;
-    }
-
-    return m_sock.send_packet(dst_addr, reinterpret_cast<unsigned char*>(q.get()), size);
+    return m_sock.send_packet(is_general_query ? t.m_dst_addr : gaddr, packet, size, if_index);
 }
 
 bool mld_sender::add_hbh_opt_header() const
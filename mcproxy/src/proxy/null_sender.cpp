@@ -0,0 +1,99 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/null_sender.hpp"
+#include "include/proxy/message_format.hpp" //source
+
+null_sender::null_sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp)
+    : sender(interfaces, gmp, false)
+    , m_report_count(0)
+    , m_query_count(0)
+{
+    HC_LOG_TRACE("");
+}
+
+bool null_sender::send_record(unsigned int, mc_filter, const addr_storage&, const source_list<source>&) const
+{
+    HC_LOG_TRACE("");
+    ++m_report_count;
+    return true;
+}
+
+bool null_sender::send_record_change(unsigned int, const addr_storage&, mc_filter, const source_list<source>&, mc_filter, const source_list<source>&) const
+{
+    HC_LOG_TRACE("");
+    ++m_report_count;
+    return true;
+}
+
+bool null_sender::send_general_query(unsigned int, const timers_values&) const
+{
+    HC_LOG_TRACE("");
+    ++m_query_count;
+    return true;
+}
+
+bool null_sender::send_mc_addr_specific_query(unsigned int, const timers_values&, const addr_storage&, bool) const
+{
+    HC_LOG_TRACE("");
+    ++m_query_count;
+    return true;
+}
+
+bool null_sender::send_mc_addr_and_src_specific_query(unsigned int, const timers_values&, const addr_storage&, source_list<source>& slist) const
+{
+    HC_LOG_TRACE("");
+
+    //the retransmissions are counted down like by the real senders
+    bool sent = false;
+    bool rc = false;
+    for (auto & e : slist) {
+        if (e.retransmission_count > 0) {
+            e.retransmission_count--;
+            sent = true;
+
+            if (e.retransmission_count > 0) {
+                rc = true;
+            }
+        }
+    }
+
+    if (sent) {
+        ++m_query_count;
+    }
+
+    return rc;
+}
+
+unsigned long null_sender::get_report_count() const
+{
+    HC_LOG_TRACE("");
+    return m_report_count;
+}
+
+unsigned long null_sender::get_query_count() const
+{
+    HC_LOG_TRACE("");
+    return m_query_count;
+}
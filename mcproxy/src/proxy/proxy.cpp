@@ -26,34 +26,53 @@
 #include "include/proxy/proxy.hpp"
 #include "include/proxy/check_kernel.hpp"
 #include "include/proxy/timing.hpp"
+#include "include/proxy/worker_pool.hpp"
+#include "include/proxy/receive_loop.hpp"
 #include "include/proxy/proxy_instance.hpp"
+#include "include/proxy/snapshot.hpp"
+#include "include/proxy/capture.hpp"
+#include "include/proxy/thread_settings.hpp"
 //#include "include/proxy/proxy_configuration.hpp"
 #include "include/parser/configuration.hpp"
 
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <set>
+#include <list>
+#include <future>
 
 #include <signal.h>
 #include <unistd.h>
 
 bool proxy::m_running = false;
+volatile std::sig_atomic_t proxy::m_reload = 0;
 
 proxy::proxy(int arg_count, char* args[])
     : m_verbose_lvl(0)
     , m_print_proxy_status(false)
     , m_reset_rp_filter(false)
     , m_config_path(CONFIGURATION_DEFAULT_CONIG_PATH)
+    , m_takeover_kernel_state(false)
+    , m_worker_pool_size(-1)
+    , m_lock_memory(false)
     , m_configuration(nullptr)
-    , m_timing(std::make_shared<timing>())
+    , m_timing(nullptr)
 {
     HC_LOG_TRACE("");
 
     signal(SIGINT, proxy::signal_handler);
     signal(SIGTERM, proxy::signal_handler);
+    signal(SIGHUP, proxy::signal_handler);
 
     prozess_commandline_args(arg_count, args);
 
+    //the thread settings are applied by the threads on start
+    if (m_lock_memory && !thread_settings::lock_memory()) {
+        throw "failed to lock the memory";
+    }
+    m_timing = std::make_shared<timing>();
+
     //admin test
     // Check root privilegis
     if (geteuid() != 0) {  //no root privilegis
@@ -63,8 +82,19 @@ proxy::proxy(int arg_count, char* args[])
 
     m_configuration.reset(new configuration(m_config_path, m_reset_rp_filter));
 
+    if (!m_capture_path.empty()) {
+        m_capture = std::make_shared<capture_file>();
+        if (!m_capture->open(m_capture_path)) {
+            throw "failed to open the capture file";
+        }
+    }
+
     start_proxy_instances();
 
+    if (!m_snapshot_path.empty()) {
+        restore_snapshot();
+    }
+
     start();
 }
 
@@ -91,7 +121,7 @@ void proxy::help_output()
     cout << "Usage:" << endl;
     cout << "  mcproxy [-h]" << endl;
     cout << "  mcproxy [-c]" << endl;
-    cout << "  mcproxy [-r] [-d] [-s] [-v [-v]] [-f <config file>]" << endl;
+    cout << "  mcproxy [-r] [-d] [-s] [-v [-v]] [-k] [-t <threads>] [-a <thread class>:<cpus>] [-R <priority>] [-l] [-w <snapshot file>] [-p <capture file>] [-f <config file>]" << endl;
     cout << endl;
     cout << "\t-h" << endl;
     cout << "\t\tDisplay this help screen." << endl;
@@ -110,8 +140,39 @@ void proxy::help_output()
     cout << "\t-v" << endl;
     cout << "\t\tBe verbose. Give twice to see even more messages" << endl;
 
+    cout << "\t-k" << endl;
+    cout << "\t\tKeep the virtual interfaces and forwarding rules in the kernel" << endl;
+    cout << "\t\ton exit and take them over on startup, the forwarding continues" << endl;
+    cout << "\t\tacross a restart (e.g. an upgrade) of the mcproxy." << endl;
+
+    cout << "\t-t" << endl;
+    cout << "\t\tNumber of worker threads shared by all proxy instances" << endl;
+    cout << "\t\t(default: one per processor, at most one per instance)." << endl;
+    cout << "\t\tSet to 0 to run each proxy instance in its own threads." << endl;
+
+    cout << "\t-a" << endl;
+    cout << "\t\tPin the threads of a class (receiver, worker or timing) to a" << endl;
+    cout << "\t\tlist of CPUs, e.g. -a receiver:0 -a worker:2-3 -a timing:1,3." << endl;
+
+    cout << "\t-R" << endl;
+    cout << "\t\tRun the worker and timing threads at SCHED_FIFO with this" << endl;
+    cout << "\t\treal-time priority (1-99) to keep the timer deadlines under load." << endl;
+
+    cout << "\t-l" << endl;
+    cout << "\t\tLock all current and future memory pages (mlockall) to avoid" << endl;
+    cout << "\t\tpage faults on the processing path." << endl;
+
+    cout << "\t-w" << endl;
+    cout << "\t\tSave the group memberships of all downstreams periodically and on" << endl;
+    cout << "\t\tshutdown to this file and restore them on startup (warm restart)." << endl;
+
+    cout << "\t-p" << endl;
+    cout << "\t\tRecord all received group membership messages and kernel upcalls" << endl;
+    cout << "\t\tto this file, a capture can be replayed by the mcproxy-bench." << endl;
+
     cout << "\t-f" << endl;
-    cout << "\t\tTo specify the configuration file." << endl;
+    cout << "\t\tTo specify the configuration file. Send SIGHUP to reload it," << endl;
+    cout << "\t\tonly the changed interfaces and rule bindings are applied." << endl;
 
     cout << "\t-c" << endl;
     cout << "\t\tCheck the currently available kernel features." << endl;
@@ -127,7 +188,7 @@ void proxy::prozess_commandline_args(int arg_count, char* args[])
     if (arg_count == 1) {
 
     } else {
-        for (int c; (c = getopt(arg_count, args, "hrdsvcf:")) != -1;) {
+        for (int c; (c = getopt(arg_count, args, "hrdsvcklt:a:R:w:p:f:")) != -1;) {
             switch (c) {
             case 'h':
                 help_output();
@@ -145,9 +206,53 @@ void proxy::prozess_commandline_args(int arg_count, char* args[])
             case 's':
                 m_print_proxy_status = true;
                 break;
+            case 'k':
+                m_takeover_kernel_state = true;
+                break;
             case 'v':
                 m_verbose_lvl++;
                 break;
+            case 't': {
+                std::istringstream is(optarg);
+                if (!(is >> m_worker_pool_size) || m_worker_pool_size < 0) {
+                    HC_LOG_ERROR("invalid number of worker threads: " << optarg);
+                    throw "invalid number of worker threads";
+                }
+            }
+            break;
+            case 'a': {
+                std::string arg(optarg);
+                auto pos = arg.find(':');
+                bool found = false;
+                for (auto tc : {TC_RECEIVER, TC_WORKER, TC_TIMING}) {
+                    if (pos != std::string::npos && arg.substr(0, pos) == get_thread_class_name(tc)) {
+                        found = thread_settings::set_affinity(tc, arg.substr(pos + 1));
+                    }
+                }
+                if (!found) {
+                    HC_LOG_ERROR("invalid cpu affinity: " << optarg);
+                    throw "invalid cpu affinity";
+                }
+            }
+            break;
+            case 'R': {
+                std::istringstream is(optarg);
+                int priority;
+                if (!(is >> priority) || !thread_settings::set_realtime_priority(priority)) {
+                    HC_LOG_ERROR("invalid real-time priority: " << optarg);
+                    throw "invalid real-time priority";
+                }
+            }
+            break;
+            case 'l':
+                m_lock_memory = true;
+                break;
+            case 'w':
+                m_snapshot_path = std::string(optarg);
+                break;
+            case 'p':
+                m_capture_path = std::string(optarg);
+                break;
             case 'f':
                 m_config_path = std::string(optarg);
                 //if (args[optind][0] != '-') {
@@ -197,13 +302,24 @@ void proxy::start_proxy_instances()
 {
     HC_LOG_TRACE("");
 
-    int table_number = 0;
-    auto inst_set = m_configuration->get_inst_def_set();
+    auto& inst_set = m_configuration->get_inst_def_set();
+
+    init_shared_threads(inst_set.size());
+
+    auto table_numbers = get_table_numbers(inst_set);
     for (auto & pinstance : inst_set) {
+        start_proxy_instance(pinstance, table_numbers[pinstance->get_instance_name()]);
+    }
+}
 
-        const std::string& instance_name = pinstance->get_instance_name();
+std::map<std::string, int> proxy::get_table_numbers(const inst_def_set& inst_set) const
+{
+    HC_LOG_TRACE("");
 
+    std::map<std::string, int> result;
+    int table_number = 0;
 
+    for (auto & pinstance : inst_set) {
         if (!pinstance->get_user_selected_table_number()) {
             table_number++;
             if (inst_set.size() <= 1) {
@@ -213,54 +329,342 @@ void proxy::start_proxy_instances()
             table_number = pinstance->get_table_number();
         }
 
-        auto& upstreams = pinstance->get_upstreams();
-        auto& downstreams = pinstance->get_downstreams();
+        result[pinstance->get_instance_name()] = table_number;
+    }
 
-        auto& interfaces = m_configuration->get_interfaces_for_pinstance(instance_name);
+    return result;
+}
 
-        std::unique_ptr<proxy_instance> pr_i(new proxy_instance(m_configuration->get_group_mem_protocol(), instance_name, table_number, interfaces, m_timing));
+std::shared_ptr<receive_loop> proxy::get_receive_loop()
+{
+    HC_LOG_TRACE("");
 
-        //global rule bindung      
-        auto& global_settings = pinstance->get_global_settings();
-        for (auto & r : global_settings) {
-                pr_i->add_msg(std::make_shared<config_msg>(config_msg::SET_GLOBAL_RULE_BINDING, r));
+    std::shared_ptr<receive_loop> rl;
+    if (m_worker_pool != nullptr) {
+        int addr_family = get_addr_family(m_configuration->get_group_mem_protocol());
+        rl = m_receive_loops[addr_family];
+        if (rl == nullptr) {
+            rl = std::make_shared<receive_loop>(addr_family);
+            m_receive_loops[addr_family] = rl;
         }
+    }
+    return rl;
+}
+
+void proxy::start_proxy_instance(const std::shared_ptr<instance_definition>& pinstance, int table_number)
+{
+    HC_LOG_TRACE("");
+
+    const std::string& instance_name = pinstance->get_instance_name();
+
+    auto& upstreams = pinstance->get_upstreams();
+    auto& downstreams = pinstance->get_downstreams();
+
+    auto interfaces = m_configuration->get_interfaces_for_pinstance(instance_name);
+
+    std::unique_ptr<proxy_instance> pr_i(new proxy_instance(m_configuration->get_group_mem_protocol(), instance_name, table_number, interfaces, m_timing, false, m_worker_pool, get_receive_loop(), m_takeover_kernel_state, nullptr, m_capture));
+
+    //global rule bindung
+    auto& global_settings = pinstance->get_global_settings();
+    for (auto & r : global_settings) {
+        pr_i->add_msg(std::make_shared<config_msg>(config_msg::SET_GLOBAL_RULE_BINDING, r));
+    }
+
+    //add upstream
+    unsigned int upstream_priority = 0;
+    for (auto & u : upstreams) {
+        unsigned int if_index = interfaces::get_if_index(u->get_if_name());
+        if (if_index == 0) {
+            HC_LOG_ERROR("failed to map upstream interface " << u->get_if_name() << " interface index");
+            throw "interface not found";
+        }
+        pr_i->add_msg(std::make_shared<config_msg>(config_msg::ADD_UPSTREAM, if_index, upstream_priority, u));
+        upstream_priority += get_default_priority_interval();
+    }
+
+    //add downstream
+    for (auto & d : downstreams) {
+        unsigned int if_index = interfaces::get_if_index(d->get_if_name());
+        if (if_index == 0) {
+            HC_LOG_ERROR("failed to map downstream interface " << d->get_if_name() << " interface index");
+            throw "interface not found";
+        }
+
+        timers_values tv;
+        //std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!here I mod the timers and values for debugging aim" << std::endl;
+        //tv.set_query_interval(std::chrono::seconds(15));
+        //tv.set_startup_query_interval(std::chrono::seconds(15));
+        //tv.set_last_listener_query_count(2);
+        //tv.set_last_listener_query_interval(std::chrono::seconds(4));
 
-        //add upstream
-        unsigned int upstream_priority = 0;
-        for (auto & u : upstreams) {
-            unsigned int if_index = interfaces::get_if_index(u->get_if_name());
-            if (if_index == 0) {
-                HC_LOG_ERROR("failed to map upstream interface " << u->get_if_name() << " interface index");
-                throw "interface not found";
+        pr_i->add_msg(std::make_shared<config_msg>(config_msg::ADD_DOWNSTREAM, if_index, d, tv));
+    }
+
+    //the kernel forwarding rules are taken over after all interfaces are known
+    if (m_takeover_kernel_state) {
+        pr_i->add_msg(std::make_shared<config_msg>(config_msg::TAKEOVER_KERNEL_ROUTES));
+    }
+
+    //the prejoins are reported as soon as all upstreams are known
+    for (auto & r : global_settings) {
+        if (r->get_rule_binding_type() == RBT_PREJOIN) {
+            pr_i->add_msg(std::make_shared<config_msg>(config_msg::REFRESH_ROUTING));
+            break;
+        }
+    }
+
+    m_proxy_instances.insert(std::pair<int, std::unique_ptr<proxy_instance>>(table_number, std::move(pr_i)));
+    m_instance_tables[instance_name] = table_number;
+}
+
+void proxy::save_snapshot()
+{
+    HC_LOG_TRACE("");
+
+    m_last_snapshot = std::chrono::steady_clock::now();
+
+    std::list<std::pair<std::string, std::future<snapshot_instance>>> pending;
+    for (auto & e : m_instance_tables) {
+        auto msg = std::make_shared<snapshot_msg>();
+        pending.push_back(std::make_pair(e.first, msg->get_future()));
+        m_proxy_instances[e.second]->add_msg(msg);
+    }
+
+    snapshot s;
+    for (auto & e : pending) {
+        try {
+            if (e.second.wait_for(std::chrono::milliseconds(PROXY_SNAPSHOT_TIMEOUT)) == std::future_status::ready) {
+                s.add_instance(e.second.get());
+                continue;
             }
-            pr_i->add_msg(std::make_shared<config_msg>(config_msg::ADD_UPSTREAM, if_index, upstream_priority, u));
-            upstream_priority+=get_default_priority_interval();
+        } catch (const std::future_error&) {
         }
+        HC_LOG_WARN("failed to get the membership state of proxy instance " << e.first);
+    }
 
-        //add downstream
-        for (auto & d : downstreams) {
-            unsigned int if_index = interfaces::get_if_index(d->get_if_name());
-            if (if_index == 0) {
-                HC_LOG_ERROR("failed to map downstream interface " << d->get_if_name() << " interface index");
-                throw "interface not found";
+    if (!s.save(m_snapshot_path)) {
+        HC_LOG_ERROR("failed to save snapshot: " << m_snapshot_path);
+    }
+}
+
+void proxy::restore_snapshot()
+{
+    HC_LOG_TRACE("");
+
+    snapshot s;
+    if (!s.load(m_snapshot_path)) {
+        HC_LOG_DEBUG("no snapshot to restore: " << m_snapshot_path);
+        return;
+    }
+
+    HC_LOG_DEBUG(s);
+    for (auto & inst : s.get_instances()) {
+        auto it = m_instance_tables.find(inst.instance_name);
+        if (it != m_instance_tables.end()) {
+            m_proxy_instances[it->second]->add_msg(std::make_shared<restore_snapshot_msg>(inst));
+        } else {
+            HC_LOG_DEBUG("proxy instance " << inst.instance_name << " of the snapshot not found");
+        }
+    }
+
+    m_last_snapshot = std::chrono::steady_clock::now();
+}
+
+void proxy::reload_configuration()
+{
+    HC_LOG_TRACE("");
+
+    std::unique_ptr<configuration> new_configuration;
+    try {
+        new_configuration.reset(new configuration(m_config_path, m_reset_rp_filter, m_configuration.get()));
+    } catch (const char* e) {
+        HC_LOG_ERROR("failed to reload the configuration file " << m_config_path << ": " << e << "; keep the running configuration");
+        return;
+    }
+
+    if (new_configuration->get_group_mem_protocol() != m_configuration->get_group_mem_protocol()) {
+        HC_LOG_ERROR("failed to reload the configuration file " << m_config_path << ": the group membership protocol cannot be changed at runtime; keep the running configuration");
+        return;
+    }
+
+    try {
+        new_configuration->initalize_interfaces(m_configuration.get());
+    } catch (const char* e) {
+        HC_LOG_ERROR("failed to reload the configuration file " << m_config_path << ": " << e << "; keep the running configuration");
+        return;
+    }
+
+    auto& old_inst_set = m_configuration->get_inst_def_set();
+    auto& new_inst_set = new_configuration->get_inst_def_set();
+    auto new_table_numbers = get_table_numbers(new_inst_set);
+    bool tables_changed = m_configuration->get_global_table_set()->to_string() != new_configuration->get_global_table_set()->to_string();
+
+    //stop all removed proxy instances and all proxy instances with a new multicast routing table
+    std::set<std::string> restarted_instances;
+    for (auto it = m_instance_tables.begin(); it != m_instance_tables.end();) {
+        auto new_table_it = new_table_numbers.find(it->first);
+        if (new_table_it == new_table_numbers.end() || new_table_it->second != it->second) {
+            HC_LOG_DEBUG("stop proxy instance " << it->first << " (table:" << it->second << ")");
+            if (new_table_it != new_table_numbers.end()) {
+                restarted_instances.insert(it->first);
             }
+            m_proxy_instances[it->second]->release_kernel_state();
+            m_proxy_instances.erase(it->second);
+            it = m_instance_tables.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::swap(m_configuration, new_configuration);
+    auto& old_configuration = new_configuration;
+
+    for (auto & pinstance : new_inst_set) {
+        const std::string& instance_name = pinstance->get_instance_name();
+        auto old_it = old_inst_set.find(instance_name);
+        auto table_it = m_instance_tables.find(instance_name);
+
+        if (table_it != m_instance_tables.end() && old_it != old_inst_set.end()) {
+            update_proxy_instance(*m_proxy_instances[table_it->second], **old_it, *pinstance, tables_changed);
+        } else {
+            if (restarted_instances.find(instance_name) != restarted_instances.end() && old_it != old_inst_set.end()) {
+                //the interfaces are taken over from the stopped proxy instance, release the unused ones
+                auto interfaces = m_configuration->get_interfaces_for_pinstance(instance_name);
+                auto is_used = [&](const std::string & if_name) {
+                    auto cmp = [&](const std::shared_ptr<interface>& i) {
+                        return i->get_if_name() == if_name;
+                    };
+                    return std::any_of(pinstance->get_upstreams().begin(), pinstance->get_upstreams().end(), cmp) || std::any_of(pinstance->get_downstreams().begin(), pinstance->get_downstreams().end(), cmp);
+                };
+                for (auto & i : (*old_it)->get_upstreams()) {
+                    if (!is_used(i->get_if_name())) {
+                        interfaces->del_interface(i->get_if_name());
+                    }
+                }
+                for (auto & i : (*old_it)->get_downstreams()) {
+                    if (!is_used(i->get_if_name())) {
+                        interfaces->del_interface(i->get_if_name());
+                    }
+                }
+            }
+
+            HC_LOG_DEBUG("start proxy instance " << instance_name << " (table:" << new_table_numbers[instance_name] << ")");
+            try {
+                start_proxy_instance(pinstance, new_table_numbers[instance_name]);
+            } catch (const char* e) {
+                HC_LOG_ERROR("failed to start proxy instance " << instance_name << ": " << e);
+            }
+        }
+    }
+
+    HC_LOG_DEBUG("configuration reloaded, " << m_proxy_instances.size() << " proxy instance(s) running");
+    old_configuration.reset();
+}
 
-            timers_values tv;
-            //std::cout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!here I mod the timers and values for debugging aim" << std::endl;
-            //tv.set_query_interval(std::chrono::seconds(15));
-            //tv.set_startup_query_interval(std::chrono::seconds(15));
-            //tv.set_last_listener_query_count(2);
-            //tv.set_last_listener_query_interval(std::chrono::seconds(4));
+void proxy::update_proxy_instance(proxy_instance& pr_i, const instance_definition& old_def, const instance_definition& new_def, bool tables_changed)
+{
+    HC_LOG_TRACE("");
+
+    bool changed = false;
+
+    //global rule bindings
+    auto global_settings_to_string = [](const instance_definition & def) {
+        std::ostringstream s;
+        for (auto & r : def.get_global_settings()) {
+            s << r->to_string() << std::endl;
+        }
+        return s.str();
+    };
+
+    if (global_settings_to_string(old_def) != global_settings_to_string(new_def)) {
+        HC_LOG_DEBUG("global rule bindings of proxy instance " << new_def.get_instance_name() << " changed");
+        pr_i.add_msg(std::make_shared<config_msg>(config_msg::RESET_GLOBAL_RULE_BINDINGS));
+        for (auto & r : new_def.get_global_settings()) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::SET_GLOBAL_RULE_BINDING, r));
+        }
+        changed = true;
+    }
+
+    //interface name, <upstream priority, interface>
+    using if_map = std::map<std::string, std::pair<unsigned int, std::shared_ptr<interface>>>;
+    auto get_if_map = [this](const std::list<std::shared_ptr<interface>>& if_list) {
+        if_map result;
+        unsigned int priority = 0;
+        for (auto & i : if_list) {
+            result[i->get_if_name()] = std::make_pair(priority, i);
+            priority += get_default_priority_interval();
+        }
+        return result;
+    };
+
+    auto is_modified = [tables_changed](const std::shared_ptr<interface>& old_if, const std::shared_ptr<interface>& new_if) {
+        std::string new_rule_bindings = new_if->to_string_rule_binding();
+        return old_if->to_string_rule_binding() != new_rule_bindings || (tables_changed && !new_rule_bindings.empty());
+    };
+
+    if_map old_upstreams = get_if_map(old_def.get_upstreams());
+    if_map new_upstreams = get_if_map(new_def.get_upstreams());
+    if_map old_downstreams = get_if_map(old_def.get_downstreams());
+    if_map new_downstreams = get_if_map(new_def.get_downstreams());
+
+    //new interfaces are added before the removed ones are deleted, an interface that changes its role keeps its virtual interface
+    for (auto & e : new_upstreams) {
+        unsigned int if_index = interfaces::get_if_index(e.first);
+        auto old_it = old_upstreams.find(e.first);
+        if (old_it == old_upstreams.end()) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::ADD_UPSTREAM, if_index, e.second.first, e.second.second));
+            changed = true;
+        } else if (old_it->second.first != e.second.first || is_modified(old_it->second.second, e.second.second)) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::SET_UPSTREAM, if_index, e.second.first, e.second.second));
+            changed = true;
+        }
+    }
+
+    for (auto & e : new_downstreams) {
+        unsigned int if_index = interfaces::get_if_index(e.first);
+        auto old_it = old_downstreams.find(e.first);
+        if (old_it == old_downstreams.end()) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::ADD_DOWNSTREAM, if_index, e.second.second, timers_values()));
+            changed = true;
+        } else if (is_modified(old_it->second.second, e.second.second)) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::SET_DOWNSTREAM, if_index, e.second.second, timers_values()));
+            changed = true;
+        }
+    }
 
-            pr_i->add_msg(std::make_shared<config_msg>(config_msg::ADD_DOWNSTREAM, if_index, d, tv));
+    for (auto & e : old_upstreams) {
+        if (new_upstreams.find(e.first) == new_upstreams.end()) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::DEL_UPSTREAM, interfaces::get_if_index(e.first), e.second.first, e.second.second));
+            changed = true;
         }
+    }
 
-        m_proxy_instances.insert(std::pair<int, std::unique_ptr<proxy_instance>>(table_number, std::move(pr_i)));
+    for (auto & e : old_downstreams) {
+        if (new_downstreams.find(e.first) == new_downstreams.end()) {
+            pr_i.add_msg(std::make_shared<config_msg>(config_msg::DEL_DOWNSTREAM, interfaces::get_if_index(e.first), e.second.first, e.second.second));
+            changed = true;
+        }
+    }
 
+    if (changed) {
+        HC_LOG_DEBUG("proxy instance " << new_def.get_instance_name() << " changed");
+        pr_i.add_msg(std::make_shared<config_msg>(config_msg::REFRESH_ROUTING));
+    } else {
+        HC_LOG_DEBUG("proxy instance " << new_def.get_instance_name() << " unchanged");
     }
+}
 
+void proxy::init_shared_threads(unsigned int instance_count)
+{
+    HC_LOG_TRACE("");
+
+    if (m_worker_pool != nullptr || m_worker_pool_size == 0) {
+        return;
+    }
 
+    unsigned int size = m_worker_pool_size < 0 ? worker_pool::get_default_pool_size(instance_count) : m_worker_pool_size;
+    HC_LOG_DEBUG("worker pool size: " << size << " for " << instance_count << " proxy instance(s)");
+    m_worker_pool = std::make_shared<worker_pool>(size);
 }
 
 void proxy::start()
@@ -277,6 +681,15 @@ void proxy::start()
 
     while (m_running) {
 
+        if (m_reload) {
+            m_reload = 0;
+            reload_configuration();
+        }
+
+        if (!m_snapshot_path.empty() && std::chrono::steady_clock::now() - m_last_snapshot >= std::chrono::seconds(PROXY_SNAPSHOT_INTERVAL)) {
+            save_snapshot();
+        }
+
         if (m_print_proxy_status) {
             for (auto & e : m_proxy_instances) {
                 e.second->add_msg(std::make_shared<debug_msg>());
@@ -289,6 +702,10 @@ void proxy::start()
     }
 
 
+    if (!m_snapshot_path.empty()) {
+        save_snapshot();
+    }
+
     //kill all proxy_instances
     std::for_each(begin(m_proxy_instances), end(m_proxy_instances), [](pair<const int, std::unique_ptr<proxy_instance>>& e) {
         e.second->add_msg(std::make_shared<exit_cmd>());
@@ -411,9 +828,13 @@ void proxy::start()
 
 }
 
-void proxy::signal_handler(int)
+void proxy::signal_handler(int sig)
 {
-    proxy::m_running = false;
+    if (sig == SIGHUP) {
+        proxy::m_reload = 1;
+    } else {
+        proxy::m_running = false;
+    }
 }
 
 std::string proxy::to_string() const
@@ -427,6 +848,11 @@ std::string proxy::to_string() const
     s << "print proxy_status information: " << m_print_proxy_status << endl;
     s << "reset all reverse path filter: " << m_reset_rp_filter << endl;
     s << "config path: " << m_config_path << endl;
+    s << "snapshot path: " << m_snapshot_path << endl;
+    s << "capture path: " << m_capture_path << endl;
+    s << "take over kernel state: " << m_takeover_kernel_state << endl;
+    s << "worker threads: " << (m_worker_pool != nullptr ? m_worker_pool->size() : 0) << endl;
+    s << "thread settings: " << thread_settings::to_string() << endl;
 
     s << "-- proxy configuration --" << endl;
     s << m_configuration.get()->to_string() << endl;
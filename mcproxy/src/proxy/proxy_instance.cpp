@@ -30,12 +30,15 @@
 #include "include/proxy/sender.hpp"
 #include "include/proxy/igmp_sender.hpp"
 #include "include/proxy/mld_sender.hpp"
+#include "include/proxy/null_sender.hpp"
 #include "include/proxy/routing.hpp"
 #include "include/proxy/querier.hpp"
 #include "include/proxy/interfaces.hpp"
 #include "include/proxy/timing.hpp"
 #include "include/proxy/routing_management.hpp"
 #include "include/proxy/simple_mc_proxy_routing.hpp"
+#include "include/proxy/capture.hpp"
+#include "include/utils/mfc_simulator.hpp"
 
 #include <sstream>
 #include <iostream>
@@ -45,18 +48,27 @@
 #include <unistd.h>
 #include <net/if.h>
 
-proxy_instance::proxy_instance(group_mem_protocol group_mem_protocol, const std::string& instance_name, int table_number, const std::shared_ptr<const interfaces>& interfaces, const std::shared_ptr<timing>& shared_timing, bool in_debug_testing_mode)
-: m_group_mem_protocol(group_mem_protocol)
+proxy_instance::proxy_instance(group_mem_protocol group_mem_protocol, const std::string& instance_name, int table_number, const std::shared_ptr<interfaces>& interfaces, const std::shared_ptr<timing>& shared_timing, bool in_debug_testing_mode, const std::shared_ptr<worker_pool>& shared_worker_pool, const std::shared_ptr<receive_loop>& shared_receive_loop, bool takeover, const std::shared_ptr<mfc_simulator>& simulator, const std::shared_ptr<capture_file>& capture)
+: worker(WORKER_MESSAGE_QUEUE_DEFAULT_SIZE, shared_worker_pool)
+, m_group_mem_protocol(group_mem_protocol)
 , m_instance_name(instance_name)
 , m_table_number(table_number)
 , m_in_debug_testing_mode(in_debug_testing_mode)
+, m_takeover(takeover)
+, m_keep_kernel_state(takeover)
 , m_interfaces(interfaces)
 , m_timing(shared_timing)
+, m_receive_loop(shared_receive_loop)
 , m_mrt_sock(nullptr)
+, m_static_mrt_sock(nullptr)
+, m_kernel(nullptr)
+, m_mfc_simulator(simulator)
 , m_sender(nullptr)
 , m_receiver(nullptr)
+, m_capture(capture)
 , m_routing(nullptr)
-, m_proxy_start_time(std::chrono::steady_clock::now())
+, m_proxy_start_time(timer_clock::now())
+, m_general_query_slot(0)
 , m_upstream_input_rule(std::make_shared<rule_binding>(instance_name, IT_UPSTREAM, "*", ID_IN, RMT_FIRST, std::chrono::milliseconds(0)))
 , m_upstream_output_rule(std::make_shared<rule_binding>(instance_name, IT_UPSTREAM, "*", ID_OUT, RMT_ALL, std::chrono::milliseconds(0)))
 {
@@ -64,10 +76,18 @@ proxy_instance::proxy_instance(group_mem_protocol group_mem_protocol, const std:
     //rule_binding(const std::string& instance_name, rb_interface_type interface_type, const std::string& if_name, rb_interface_direction filter_direction, rb_rule_matching_type rule_matching_type, const std::chrono::milliseconds& timeout);
     HC_LOG_TRACE("");
 
+    if (m_takeover && m_mfc_simulator != nullptr) {
+        throw "the takeover of the kernel state needs the kernel tables";
+    }
+
     if (!init_mrt_socket()) {
         throw "failed to initialize mroute socket";
     }
 
+    if (m_takeover && !init_static_mrt_socket()) {
+        throw "failed to initialize static mroute socket";
+    }
+
     if (!init_sender()) {
         throw "failed to initialize sender";
     }
@@ -90,6 +110,12 @@ proxy_instance::proxy_instance(group_mem_protocol group_mem_protocol, const std:
 bool proxy_instance::init_mrt_socket()
 {
     HC_LOG_TRACE("");
+
+    //the simulator has no tables in the kernel and the group membership messages are injected
+    if (m_mfc_simulator != nullptr) {
+        return true;
+    }
+
     m_mrt_sock = std::make_shared<mroute_socket>();
     if (is_IPv4(m_group_mem_protocol)) {
         m_mrt_sock->create_raw_ipv4_socket();
@@ -115,10 +141,34 @@ bool proxy_instance::init_mrt_socket()
     return true;
 }
 
-bool proxy_instance::init_sender()
+bool proxy_instance::init_static_mrt_socket()
 {
     HC_LOG_TRACE("");
+    m_static_mrt_sock = std::make_shared<mroute_socket>();
     if (is_IPv4(m_group_mem_protocol)) {
+        m_static_mrt_sock->create_raw_ipv4_socket();
+    } else if (is_IPv6(m_group_mem_protocol)) {
+        m_static_mrt_sock->create_raw_ipv6_socket();
+    } else {
+        HC_LOG_ERROR("unknown ip version");
+        return false;
+    }
+
+    if (m_table_number > 0) {
+        if (!m_static_mrt_sock->set_kernel_table(m_table_number)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool proxy_instance::init_sender()
+{
+    HC_LOG_TRACE("");
+    if (m_mfc_simulator != nullptr) {
+        m_sender = std::make_shared<null_sender>(m_interfaces, m_group_mem_protocol);
+    } else if (is_IPv4(m_group_mem_protocol)) {
         m_sender = std::make_shared<igmp_sender>(m_interfaces);
     } else if (is_IPv6(m_group_mem_protocol)) {
         m_sender = std::make_shared<mld_sender>(m_interfaces);
@@ -135,21 +185,36 @@ bool proxy_instance::init_receiver()
     HC_LOG_TRACE("");
 
     if (is_IPv4(m_group_mem_protocol)) {
-        m_receiver.reset(new igmp_receiver(this, m_mrt_sock, m_interfaces, m_in_debug_testing_mode));
+        m_receiver.reset(new igmp_receiver(this, m_mrt_sock, m_interfaces, m_in_debug_testing_mode, m_receive_loop));
     } else if (is_IPv6(m_group_mem_protocol)) {
-        m_receiver.reset(new mld_receiver(this, m_mrt_sock, m_interfaces, m_in_debug_testing_mode));
+        m_receiver.reset(new mld_receiver(this, m_mrt_sock, m_interfaces, m_in_debug_testing_mode, m_receive_loop));
     } else {
         HC_LOG_ERROR("unknown ip version");
         return false;
     }
 
+    m_receiver->set_capture(m_capture);
     return true;
 }
 
 bool proxy_instance::init_routing()
 {
     HC_LOG_TRACE("");
-    m_routing.reset(new routing(get_addr_family(m_group_mem_protocol), m_mrt_sock, m_interfaces, m_table_number));
+    if (m_mfc_simulator != nullptr) {
+        m_mfc_simulator->set_upcall_callback([this](int vif, const addr_storage & gaddr, const addr_storage & saddr) {
+            unsigned int if_index = m_interfaces->get_if_index(vif);
+            if (if_index != 0) {
+                add_msg(make_pooled_msg<new_source_msg>(if_index, gaddr, saddr));
+            }
+        });
+        m_kernel = m_mfc_simulator;
+    } else if (m_takeover) {
+        m_kernel = m_static_mrt_sock;
+    } else {
+        m_kernel = m_mrt_sock;
+    }
+
+    m_routing.reset(new routing(get_addr_family(m_group_mem_protocol), m_kernel, m_interfaces, m_table_number, m_takeover));
     return true;
 }
 
@@ -164,72 +229,111 @@ proxy_instance::~proxy_instance()
 {
     HC_LOG_TRACE("");
     add_msg(std::make_shared<exit_cmd>());
+
+    //wait for the exit command before the members are released
+    join();
+
+    //a stopped proxy instance can be released while the other proxy instances keep running (configuration reload)
+    m_timing->stop_all_time(this);
+
+    if (!m_keep_kernel_state && m_routing != nullptr) {
+        m_routing->release_kernel_state();
+    }
+
+    if (m_mfc_simulator != nullptr) {
+        m_mfc_simulator->set_upcall_callback(nullptr);
+    }
 }
 
-void proxy_instance::worker_thread()
+void proxy_instance::release_kernel_state()
 {
     HC_LOG_TRACE("");
-    while (m_running) {
-        auto msg = m_job_queue.dequeue();
-        switch (msg->get_type()) {
-        case proxy_msg::TEST_MSG:
-            (*msg)();
-            break;
-        case proxy_msg::CONFIG_MSG:
-            handle_config(std::static_pointer_cast<config_msg>(msg));
-            break;
-        case proxy_msg::FILTER_TIMER_MSG:
-        case proxy_msg::SOURCE_TIMER_MSG:
-        case proxy_msg::RET_GROUP_TIMER_MSG:
-        case proxy_msg::RET_SOURCE_TIMER_MSG:
-        case proxy_msg::OLDER_HOST_PRESENT_TIMER_MSG:
-        case proxy_msg::GENERAL_QUERY_TIMER_MSG: {
-            auto it = m_downstreams.find(std::static_pointer_cast<timer_msg>(msg)->get_if_index());
-            if (it != std::end(m_downstreams)) {
-                it->second.m_querier->timer_triggerd(msg);
-            } else {
-                HC_LOG_DEBUG("failed to find querier of interface: " << interfaces::get_if_name(std::static_pointer_cast<timer_msg>(msg)->get_if_index()));
-            }
-        }
+    m_keep_kernel_state = false;
+}
+
+void proxy_instance::process_msg(const std::shared_ptr<proxy_msg>& msg)
+{
+    HC_LOG_TRACE("");
+    switch (msg->get_type()) {
+    case proxy_msg::TEST_MSG:
+        (*msg)();
         break;
-        case proxy_msg::GROUP_RECORD_MSG: {
-            auto r =  std::static_pointer_cast<group_record_msg>(msg);
+    case proxy_msg::CONFIG_MSG:
+        handle_config(std::static_pointer_cast<config_msg>(msg));
+        break;
+    case proxy_msg::GROUP_TIMER_MSG:
+    case proxy_msg::QUERY_ROUND_TIMER_MSG:
+    case proxy_msg::OLDER_HOST_PRESENT_TIMER_MSG:
+    case proxy_msg::GENERAL_QUERY_TIMER_MSG: {
+        m_timer_lag.add(std::static_pointer_cast<timer_msg>(msg)->get_end_time());
+        auto it = m_downstreams.find(std::static_pointer_cast<timer_msg>(msg)->get_if_index());
+        if (it != std::end(m_downstreams)) {
+            it->second.m_querier->timer_triggerd(msg);
+        } else {
+            HC_LOG_DEBUG("failed to find querier of interface: " << interfaces::get_if_name(std::static_pointer_cast<timer_msg>(msg)->get_if_index()));
+        }
+    }
+    break;
+    case proxy_msg::GROUP_RECORD_MSG: {
+        auto r =  std::static_pointer_cast<group_record_msg>(msg);
 
-            if (m_in_debug_testing_mode) {
-                std::cout << "!!--ACTION: receive record" << std::endl;
-                std::cout << *r << std::endl;
-                std::cout << std::endl;
-            }
+        if (m_in_debug_testing_mode) {
+            std::cout << "!!--ACTION: receive record" << std::endl;
+            std::cout << *r << std::endl;
+            std::cout << std::endl;
+        }
 
-            auto it = m_downstreams.find(r->get_if_index());
+        auto it = m_downstreams.find(r->get_if_index());
+        if (it != std::end(m_downstreams)) {
+            it->second.m_querier->receive_record(msg);
+        } else {
+            HC_LOG_DEBUG("failed to find querier of interface: " << interfaces::get_if_name(std::static_pointer_cast<timer_msg>(msg)->get_if_index()));
+        }
+    }
+    break;
+    case proxy_msg::NEW_SOURCE_MSG:
+        m_routing_management->event_new_source(msg);
+        break;
+    case proxy_msg::NEW_SOURCE_TIMER_MSG:
+    case proxy_msg::UPSTREAM_REPORT_TIMER_MSG:
+    case proxy_msg::LEAVE_HOLD_DOWN_TIMER_MSG:
+    case proxy_msg::PREJOIN_TIMER_MSG:
+        m_timer_lag.add(std::static_pointer_cast<timer_msg>(msg)->get_end_time());
+        m_routing_management->timer_triggerd_maintain_routing_table(msg);
+        break;
+    case proxy_msg::DEBUG_MSG:
+        std::cout << *this << std::endl;
+        std::cout << std::endl;
+        break;
+    case proxy_msg::SNAPSHOT_MSG: {
+        snapshot_instance si;
+        si.instance_name = m_instance_name;
+        for (auto & e : m_downstreams) {
+            si.downstreams.push_back(snapshot_interface{interfaces::get_if_name(e.first), e.second.m_querier->get_snapshot()});
+        }
+        std::static_pointer_cast<snapshot_msg>(msg)->set_snapshot_instance(std::move(si));
+    }
+    break;
+    case proxy_msg::RESTORE_SNAPSHOT_MSG: {
+        for (auto & d : std::static_pointer_cast<restore_snapshot_msg>(msg)->get_snapshot_instance().downstreams) {
+            auto it = m_downstreams.find(interfaces::get_if_index(d.if_name));
             if (it != std::end(m_downstreams)) {
-                it->second.m_querier->receive_record(msg);
+                HC_LOG_DEBUG("restore " << d.groups.size() << " group(s) of downstream interface: " << d.if_name);
+                it->second.m_querier->restore_snapshot(d.groups);
             } else {
-                HC_LOG_DEBUG("failed to find querier of interface: " << interfaces::get_if_name(std::static_pointer_cast<timer_msg>(msg)->get_if_index()));
+                HC_LOG_DEBUG("failed to restore downstream interface: " << d.if_name << " interface not found");
             }
         }
+    }
+    break;
+    case proxy_msg::EXIT_MSG:
+        HC_LOG_DEBUG("received exit command");
+        stop();
+        break;
+    default:
+        HC_LOG_ERROR("Received unknown message");
         break;
-        case proxy_msg::NEW_SOURCE_MSG:
-            m_routing_management->event_new_source(msg);
-            break;
-        case proxy_msg::NEW_SOURCE_TIMER_MSG:
-            m_routing_management->timer_triggerd_maintain_routing_table(msg);
-            break;
-        case proxy_msg::DEBUG_MSG:
-            std::cout << *this << std::endl;
-            std::cout << std::endl;
-            break;
-        case proxy_msg::EXIT_MSG:
-            HC_LOG_DEBUG("received exit command");
-            stop();
-            break;
-        default:
-            HC_LOG_ERROR("Received unknown message");
-            break;
-        }
     }
-
-    HC_LOG_DEBUG("worker thread proxy_instance end");
 }
 
 std::string proxy_instance::to_string() const
@@ -237,7 +341,7 @@ std::string proxy_instance::to_string() const
     HC_LOG_TRACE("");
     std::ostringstream s;
 
-    auto current_time = std::chrono::steady_clock::now();
+    auto current_time = timer_clock::now();
     auto time_span = current_time - m_proxy_start_time;
     double seconds = time_span.count()  * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
 
@@ -247,6 +351,10 @@ std::string proxy_instance::to_string() const
 
     s << *m_routing_management << std::endl;
 
+    s << "##-- timer lag --##" << std::endl;
+    s << "dispatched: " << m_timing->get_dispatch_lag().to_string() << std::endl;
+    s << "processed: " << m_timer_lag.to_string() << std::endl;
+
     s << "##-- upstream interfaces --##" << std::endl;
     for (auto & e : m_upstreams) {
         s << interfaces::get_if_name(e.m_if_index) << "(index:" << e.m_if_index << ") ";
@@ -283,9 +391,16 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
             }
 
             //create a querier
-            std::function<void(unsigned int, const addr_storage&)> cb_state_change = std::bind(&routing_management::event_querier_state_change, m_routing_management.get(), std::placeholders::_1, std::placeholders::_2);
-            std::unique_ptr<querier> q(new querier(this, m_group_mem_protocol, msg->get_if_index(), m_sender, m_timing, msg->get_timers_values(), cb_state_change));
+            callback_querier_state_change cb_state_change = std::bind(&routing_management::event_querier_state_change, m_routing_management.get(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+            auto general_query_phase = get_general_query_phase(msg->get_if_index(), msg->get_timers_values());
+            auto general_query_jitter = get_timer_value(IT_DOWNSTREAM, msg->get_if_index(), TVT_GENERAL_QUERY_JITTER, std::chrono::milliseconds(PROXY_INSTANCE_GENERAL_QUERY_JITTER_DEFAULT));
+            auto explicit_tracking = get_timer_value(IT_DOWNSTREAM, msg->get_if_index(), TVT_EXPLICIT_TRACKING, std::chrono::milliseconds(PROXY_INSTANCE_EXPLICIT_TRACKING_DEFAULT));
+            std::unique_ptr<querier> q(new querier(this, m_group_mem_protocol, msg->get_if_index(), m_sender, m_timing, msg->get_timers_values(), cb_state_change, general_query_phase, general_query_jitter, explicit_tracking));
             m_downstreams.insert(std::pair<unsigned int, downstream_infos>(msg->get_if_index(), downstream_infos(move(q), msg->get_interface())));
+
+            if (m_capture != nullptr) {
+                m_capture->write_interface(m_instance_name, m_group_mem_protocol, msg->get_if_index(), m_interfaces->get_virtual_if_index(msg->get_if_index()), false, 0);
+            }
         } else {
             HC_LOG_WARN("downstream interface: " << interfaces::get_if_name(msg->get_if_index()) << " already exists");
         }
@@ -300,6 +415,7 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
             if (!is_upstream(msg->get_if_index())) {
                 m_routing->del_vif(msg->get_if_index(), m_interfaces->get_virtual_if_index(msg->get_if_index()));
                 m_receiver->del_interface(msg->get_if_index());
+                m_interfaces->del_interface(msg->get_if_index());
             } else {
                 HC_LOG_DEBUG("interface still used as upstream");
             }
@@ -329,6 +445,10 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
             HC_LOG_DEBUG("registerd upstreams: " << m_upstreams.size());
             HC_LOG_DEBUG("upstream priority: " << msg->get_upstream_priority());
             m_upstreams.insert(upstream_infos(msg->get_if_index(), msg->get_interface(), msg->get_upstream_priority()));
+
+            if (m_capture != nullptr) {
+                m_capture->write_interface(m_instance_name, m_group_mem_protocol, msg->get_if_index(), m_interfaces->get_virtual_if_index(msg->get_if_index()), true, msg->get_upstream_priority());
+            }
         }
         else {
             HC_LOG_WARN("upstream interface: " << interfaces::get_if_name(msg->get_if_index()) << " already exists");
@@ -347,6 +467,7 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
             if (!is_downstream(msg->get_if_index())) {
                 m_routing->del_vif(msg->get_if_index(), m_interfaces->get_virtual_if_index(msg->get_if_index()));
                 m_receiver->del_interface(msg->get_if_index());
+                m_interfaces->del_interface(msg->get_if_index());
             } else {
                 HC_LOG_DEBUG("interface still used as downstream");
             }
@@ -372,6 +493,13 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
                 } else {
                     HC_LOG_ERROR("failed to set global rule binding, wrong interface type");
                 }
+            } else if (rb->get_rule_binding_type() == RBT_TIMER_VALUE) {
+                m_timer_value_rules.remove_if([&rb](const std::shared_ptr<rule_binding>& e) {
+                    return e->get_interface_type() == rb->get_interface_type() && e->get_if_name() == rb->get_if_name() && e->get_timer_value_type() == rb->get_timer_value_type();
+                });
+                m_timer_value_rules.push_back(rb);
+            } else if (rb->get_rule_binding_type() == RBT_PREJOIN) {
+                m_prejoin_rules.push_back(rb);
             } else {
                 HC_LOG_ERROR("failed to set global rule binding, unknown rule binding type");
             }
@@ -380,6 +508,61 @@ void proxy_instance::handle_config(const std::shared_ptr<config_msg>& msg)
         }
     }
     break;
+    case config_msg::SET_DOWNSTREAM: {
+        auto it = m_downstreams.find(msg->get_if_index());
+        if (it != std::end(m_downstreams)) {
+            HC_LOG_DEBUG("set downstream interface: " << interfaces::get_if_name(msg->get_if_index()));
+            it->second.m_interface = msg->get_interface();
+        } else {
+            HC_LOG_WARN("failed to set downstream interface: " << interfaces::get_if_name(msg->get_if_index()) << " interface not found");
+        }
+    }
+    break;
+    case config_msg::SET_UPSTREAM: {
+        auto it = std::find_if(m_upstreams.begin(), m_upstreams.end(), [&](const upstream_infos & ui) {
+            return ui.m_if_index == msg->get_if_index();
+        } );
+
+        if (it != m_upstreams.end()) {
+            HC_LOG_DEBUG("set upstream interface: " << interfaces::get_if_name(msg->get_if_index()) << " with priority: " << msg->get_upstream_priority());
+
+            //the priority is the sort key of the upstreams
+            m_upstreams.erase(it);
+            m_upstreams.insert(upstream_infos(msg->get_if_index(), msg->get_interface(), msg->get_upstream_priority()));
+        } else {
+            HC_LOG_WARN("failed to set upstream interface: " << interfaces::get_if_name(msg->get_if_index()) << " interface not found");
+        }
+    }
+    break;
+    case config_msg::RESET_GLOBAL_RULE_BINDINGS:
+        m_upstream_input_rule = std::make_shared<rule_binding>(m_instance_name, IT_UPSTREAM, "*", ID_IN, RMT_FIRST, std::chrono::milliseconds(0));
+        m_upstream_output_rule = std::make_shared<rule_binding>(m_instance_name, IT_UPSTREAM, "*", ID_OUT, RMT_ALL, std::chrono::milliseconds(0));
+        m_timer_value_rules.clear();
+        m_prejoin_rules.clear();
+        break;
+    case config_msg::REFRESH_ROUTING:
+        m_routing_management->event_configuration_change();
+        break;
+    case config_msg::TAKEOVER_KERNEL_ROUTES: {
+        auto is_own_interface = [this](unsigned int if_index) {
+            return is_upstream(if_index) || is_downstream(if_index);
+        };
+
+        for (auto & kr : m_routing->get_kernel_routes()) {
+            if (!is_own_interface(kr.input_if_index)) {
+                HC_LOG_DEBUG("ignore kernel route (" << kr.gaddr << ", " << kr.saddr << ") of the foreign input interface " << interfaces::get_if_name(kr.input_if_index));
+                continue;
+            }
+
+            kr.output_if_indexes.remove_if([&](unsigned int if_index) {
+                return !is_own_interface(if_index);
+            });
+
+            HC_LOG_DEBUG("take over kernel route (" << kr.gaddr << ", " << kr.saddr << ") from input interface " << interfaces::get_if_name(kr.input_if_index));
+            m_routing_management->event_kernel_route(kr.input_if_index, kr.gaddr, kr.saddr, kr.output_if_indexes);
+        }
+    }
+    break;
     default:
         HC_LOG_ERROR("unknown config message format");
     }
@@ -405,6 +588,51 @@ bool proxy_instance::is_downstream(unsigned int if_index) const
     return m_downstreams.find(if_index) != m_downstreams.end();
 }
 
+std::chrono::milliseconds proxy_instance::get_general_query_phase(unsigned int if_index, const timers_values& tv)
+{
+    HC_LOG_TRACE("");
+
+    std::chrono::milliseconds query_interval = tv.get_query_interval();
+
+    //the phases of the downstreams follow the golden ratio sequence, so any number of
+    //downstreams is spread evenly over the query interval without knowing it in advance
+    const double golden_ratio_conjugate = 0.6180339887498949;
+    double slot_phase = m_general_query_slot++ * golden_ratio_conjugate;
+    slot_phase -= static_cast<unsigned long>(slot_phase);
+    std::chrono::milliseconds auto_phase(static_cast<long>(slot_phase * query_interval.count()));
+
+    auto phase = get_timer_value(IT_DOWNSTREAM, if_index, TVT_GENERAL_QUERY_PHASE, auto_phase);
+    if (query_interval.count() > 0) {
+        phase = std::chrono::milliseconds(phase.count() % query_interval.count());
+    }
+
+    return phase;
+}
+
+std::chrono::milliseconds proxy_instance::get_timer_value(rb_interface_type interface_type, unsigned int if_index, rb_timer_value_type timer_value_type, const std::chrono::milliseconds& default_value) const
+{
+    HC_LOG_TRACE("");
+
+    std::string if_name = interfaces::get_if_name(if_index);
+    std::shared_ptr<rule_binding> wildcard_rule;
+
+    for (auto & e : m_timer_value_rules) {
+        if (e->get_interface_type() == interface_type && e->get_interface_direction() == ID_OUT && e->get_timer_value_type() == timer_value_type) {
+            if (e->get_if_name() == if_name) {
+                return e->get_timer_value();
+            } else if (e->get_if_name() == "*") {
+                wildcard_rule = e;
+            }
+        }
+    }
+
+    if (wildcard_rule != nullptr) {
+        return wildcard_rule->get_timer_value();
+    } else {
+        return default_value;
+    }
+}
+
 #ifdef DEBUG_MODE
 void proxy_instance::test_querier(std::string if_name)
 {
@@ -35,12 +35,19 @@
 #include <iostream>
 #include <sstream>
 
-querier::querier(worker* msg_worker, group_mem_protocol querier_version_mode, int if_index, const std::shared_ptr<const sender>& sender, const std::shared_ptr<timing>& timing, const timers_values& tv, callback_querier_state_change cb_state_change)
+querier::querier(worker* msg_worker, group_mem_protocol querier_version_mode, int if_index, const std::shared_ptr<const sender>& sender, const std::shared_ptr<timing>& timing, const timers_values& tv, callback_querier_state_change cb_state_change, const std::chrono::milliseconds& general_query_phase, const std::chrono::milliseconds& general_query_jitter, const std::chrono::milliseconds& explicit_tracking)
     : m_msg_worker(msg_worker)
     , m_if_index(if_index)
     , m_db(querier_version_mode)
     , m_timers_values(tv)
     , m_cb_state_change(cb_state_change)
+    , m_general_query_phase(general_query_phase)
+    , m_general_query_phase_applied(false)
+    , m_general_query_jitter(general_query_jitter)
+    , m_random_engine(timer_clock::now().time_since_epoch().count() + if_index)
+    , m_explicit_tracking(explicit_tracking)
+    , m_start_time(timer_clock::now())
+    , m_group_timer_generation(0)
     , m_sender(sender)
     , m_timing(timing)
 {
@@ -99,15 +106,30 @@ bool querier::send_general_query()
         m_db.startup_query_count = m_timers_values.get_startup_query_count() - 1;
     }
 
-    std::chrono::seconds t;
+    std::chrono::milliseconds t;
     if (m_db.startup_query_count > 0) {
         m_db.startup_query_count--;
         t  = m_timers_values.get_startup_query_interval();
     } else {
         t = m_timers_values.get_query_interval();
+
+        //the queries are only brought forward, a longer interval would shorten the Multicast Address Listening Interval
+        if (!m_general_query_phase_applied) {
+            t -= m_general_query_phase;
+            m_general_query_phase_applied = true;
+        }
+
+        if (m_general_query_jitter.count() > 0) {
+            std::uniform_int_distribution<long> jitter(0, m_general_query_jitter.count());
+            t -= std::chrono::milliseconds(jitter(m_random_engine));
+        }
+
+        if (t < m_timers_values.get_query_response_interval()) {
+            t = m_timers_values.get_query_response_interval();
+        }
     }
 
-    auto gqt = std::make_shared<general_query_timer_msg>(m_if_index, t);
+    auto gqt = make_pooled_msg<general_query_timer_msg>(m_if_index, t);
     m_db.general_query_timer = gqt;
 
     m_timing->add_time(t, m_msg_worker, gqt);
@@ -135,10 +157,20 @@ void querier::receive_record(const std::shared_ptr<proxy_msg>& msg)
 
     //backwards compatibility coordination
     if (!is_newest_version(gr->get_grp_mem_proto()) && is_older_or_equal_version(gr->get_grp_mem_proto(), m_db.querier_version_mode) ) {
-        db_info_it->second.compatibility_mode_variable = gr->get_grp_mem_proto();
-        auto ohpt = std::make_shared<older_host_present_timer_msg>(m_if_index, db_info_it->first, m_timers_values.get_older_host_present_interval());
-        db_info_it->second.older_host_present_timer = ohpt;
+        gaddr_info& ginfo = db_info_it->second;
+        bool effects = ginfo.is_under_bakcward_compatibility_effects();
+
+        ginfo.compatibility_mode_variable = gr->get_grp_mem_proto();
+        auto ohpt = make_pooled_msg<older_host_present_timer_msg>(m_if_index, db_info_it->first, m_timers_values.get_older_host_present_interval());
+        ginfo.older_host_present_timer = ohpt;
         m_timing->add_time(m_timers_values.get_older_host_present_interval(), m_msg_worker, ohpt);
+
+        //the sources are not blocked any more, the routing sees EXCLUDE{} until the effects end
+        if (!effects) {
+            membership_delta delta(ginfo.filter_mode, EXCLUDE_MODE);
+            delta.removed_sources = ginfo.filter_mode == INCLUDE_MODE ? ginfo.include_requested_list : ginfo.exclude_list;
+            m_cb_state_change(m_if_index, db_info_it->first, delta);
+        }
     }
 
     //section 8.3.2. In the Presence of MLDv1 Multicast Address Listeners
@@ -152,13 +184,22 @@ void querier::receive_record(const std::shared_ptr<proxy_msg>& msg)
         }
     }
 
+    if (m_explicit_tracking.count() > 0 && receive_record_explicit_tracking(*gr, db_info_it)) {
+        return;
+    }
+
     switch (db_info_it->second.filter_mode) {
     case  INCLUDE_MODE:
         receive_record_in_include_mode(gr->get_record_type(), gr->get_gaddr(), gr->get_slist(), db_info_it->second);
 
         //if the new created group is not used delete it
         if (db_info_it->second.filter_mode == INCLUDE_MODE && db_info_it->second.include_requested_list.empty()) {
+            bool effects = db_info_it->second.is_under_bakcward_compatibility_effects();
             m_db.group_info.erase(db_info_it);
+
+            if (effects) {
+                state_change_notification(gr->get_gaddr(), membership_delta(EXCLUDE_MODE, INCLUDE_MODE), true);
+            }
         }
 
         break;
@@ -172,6 +213,82 @@ void querier::receive_record(const std::shared_ptr<proxy_msg>& msg)
 
 }
 
+bool querier::receive_record_explicit_tracking(group_record_msg& gr, gaddr_map::iterator db_info_it)
+{
+    HC_LOG_TRACE("");
+
+    gaddr_info& ginfo = db_info_it->second;
+    auto now = timer_clock::now();
+
+    if (!gr.get_host_addr().is_valid() || gr.get_host_addr() == addr_storage(gr.get_host_addr().get_addr_family())) {
+        ginfo.untracked_host_timer = now + m_explicit_tracking;
+        return false;
+    }
+
+    ginfo.track_host(get_host_key(gr.get_host_addr()), gr.get_record_type(), gr.get_slist(), now + m_explicit_tracking);
+
+    if (gr.get_record_type() != CHANGE_TO_INCLUDE_MODE && gr.get_record_type() != BLOCK_OLD_SOURCES) {
+        return false;
+    }
+
+    //the tracked hosts are complete if all hosts had the chance to answer a general query,
+    //no host suppresses its reports (older versions) and no host reported without an address
+    if (now < m_start_time + m_timers_values.get_query_interval() || ginfo.is_under_bakcward_compatibility_effects() || now < ginfo.untracked_host_timer) {
+        return false;
+    }
+
+    const addr_storage& gaddr = db_info_it->first;
+
+    //no tracked host is interested any more, delete the group without a query
+    if (!ginfo.has_tracked_interest()) {
+        HC_LOG_DEBUG("last tracked host left group: " << gaddr);
+        membership_delta delta(ginfo.filter_mode, INCLUDE_MODE);
+        delta.removed_sources = std::move(ginfo.filter_mode == INCLUDE_MODE ? ginfo.include_requested_list : ginfo.exclude_list);
+
+        addr_storage notify_gaddr = gaddr;
+        m_db.group_info.erase(db_info_it);
+
+        state_change_notification(notify_gaddr, std::move(delta));
+        return true;
+    }
+
+    if (ginfo.filter_mode != INCLUDE_MODE) {
+        return false;
+    }
+
+    //INCLUDE (A)     TO_IN (B)      INCLUDE (A+B)        (B)=MALI
+    //                                                    Delete (A-B) without a tracked host
+    //INCLUDE (A)     BLOCK (B)      INCLUDE (A)          Delete (A*B) without a tracked host
+    source_list<source>& A = ginfo.include_requested_list;
+    source_list<source>& B = gr.get_slist();
+
+    membership_delta delta(INCLUDE_MODE, INCLUDE_MODE);
+    source_list<source> leaving;
+    if (gr.get_record_type() == CHANGE_TO_INCLUDE_MODE) {
+        leaving = A - B;
+        delta.added_sources = B - A;
+        A += B;
+        mali(gaddr, ginfo, A, std::move(B));
+    } else {
+        leaving = A * B;
+    }
+
+    for (auto & e : leaving) {
+        if (!ginfo.has_tracked_interest(e)) {
+            A.erase(e);
+            delta.removed_sources.insert(e);
+        }
+    }
+
+    addr_storage notify_gaddr = gaddr;
+    if (A.empty()) {
+        m_db.group_info.erase(db_info_it);
+    }
+
+    state_change_notification(notify_gaddr, std::move(delta));
+    return true;
+}
+
 void querier::receive_record_in_include_mode(mcast_addr_record_type record_type, const addr_storage& gaddr, source_list<source>& slist, gaddr_info& ginfo)
 {
     HC_LOG_TRACE("record type: " << record_type);
@@ -189,11 +306,13 @@ void querier::receive_record_in_include_mode(mcast_addr_record_type record_type,
         //------------  ---------------  ----------------     -------
         //INCLUDE (A)     ALLOW (B)      INCLUDE (A+B)        (B)=MALI
     case ALLOW_NEW_SOURCES: {//ALLOW(x)
+        membership_delta delta(INCLUDE_MODE, INCLUDE_MODE);
+        delta.added_sources = B - A;
         A += B;
 
-        mali(gaddr, A, std::move(B));
+        mali(gaddr, ginfo, A, std::move(B));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -210,15 +329,19 @@ void querier::receive_record_in_include_mode(mcast_addr_record_type record_type,
     //                                                    Send Q(MA,A*B)
     //                                                    Filter Timer=MALI
     case CHANGE_TO_EXCLUDE_MODE: {//TO_EX(x)
+        membership_delta delta(INCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = A;
+
         ginfo.filter_mode = EXCLUDE_MODE;
         ginfo.include_requested_list *= B;
         ginfo.exclude_list = B - A;
+        delta.added_sources = ginfo.exclude_list;
 
         send_Q(gaddr, ginfo, ginfo.include_requested_list, (A * B)),
                mali(gaddr, filter_timer);
 
 
-        state_change_notification(gaddr); //all sources
+        state_change_notification(gaddr, std::move(delta)); //all sources
     }
     break;
 
@@ -226,12 +349,14 @@ void querier::receive_record_in_include_mode(mcast_addr_record_type record_type,
     //INCLUDE (A)     TO_IN (B)      INCLUDE (A+B)        (B)=MALI
     //                                                    Send Q(MA,A-B)
     case CHANGE_TO_INCLUDE_MODE: {//TO_IN(x)
+        membership_delta delta(INCLUDE_MODE, INCLUDE_MODE);
+        delta.added_sources = B - A;
         A += B;
 
         send_Q(gaddr, ginfo, A, (A - B));
-        mali(gaddr, A, std::move(B));
+        mali(gaddr, ginfo, A, std::move(B));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -240,24 +365,30 @@ void querier::receive_record_in_include_mode(mcast_addr_record_type record_type,
     //                                                    Delete (A-B)
     //                                                    Filter Timer=MALI
     case  MODE_IS_EXCLUDE: {//IS_EX(x)
+        membership_delta delta(INCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = A;
+
         ginfo.filter_mode = EXCLUDE_MODE;
         ginfo.include_requested_list *= B;
         ginfo.exclude_list = B - A;
+        delta.added_sources = ginfo.exclude_list;
 
         mali(gaddr, filter_timer);
 
-        state_change_notification(gaddr); //all sources
+        state_change_notification(gaddr, std::move(delta)); //all sources
     }
     break;
 
 
     //INCLUDE (A)       IS_IN (B)     INCLUDE (A+B)      (B)=MALI
     case MODE_IS_INCLUDE: {//IS_IN(x)
+        membership_delta delta(INCLUDE_MODE, INCLUDE_MODE);
+        delta.added_sources = B - A;
         A += B;
 
-        mali(gaddr, A, move(B));
+        mali(gaddr, ginfo, A, move(B));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -288,12 +419,14 @@ void querier::receive_record_in_exclude_mode(mcast_addr_record_type record_type,
         //------------  ---------------  ----------------     -------
         //EXCLUDE (X,Y)   ALLOW (A)      EXCLUDE (X+A,Y-A)    (A)=MALI
     case ALLOW_NEW_SOURCES: {//ALLOW(x)
+        membership_delta delta(EXCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = Y * A;
         X += A;
         Y -= A;
 
-        mali(gaddr, X, std::move(A));
+        mali(gaddr, ginfo, X, std::move(A));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -326,13 +459,15 @@ void querier::receive_record_in_exclude_mode(mcast_addr_record_type record_type,
         X *= A;
         X += (A - Y);
 
+        membership_delta delta(EXCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = Y - A;
         Y *= A;
 
         auto tmpXa = X;
         send_Q(gaddr, ginfo, X, move(tmpXa)); //bad style, but i haven't a better solution right now ???????????
         mali(gaddr, filter_timer);
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -341,14 +476,16 @@ void querier::receive_record_in_exclude_mode(mcast_addr_record_type record_type,
     //                                                    Send Q(MA,X-A)
     //                                                    Send Q(MA)
     case CHANGE_TO_INCLUDE_MODE: {//TO_IN(x)
+        membership_delta delta(EXCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = Y * A;
         X += A;
         Y -= A;
 
         send_Q(gaddr, ginfo, X, (X - A));
         send_Q(gaddr, ginfo);
-        mali(gaddr, X, std::move(A));
+        mali(gaddr, ginfo, X, std::move(A));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
@@ -358,30 +495,34 @@ void querier::receive_record_in_exclude_mode(mcast_addr_record_type record_type,
     //                                                   Delete (Y-A)
     //                                                   Filter Timer=MALI
     case  MODE_IS_EXCLUDE: {//IS_EX(x)
-        mali(gaddr, A, (A - X) - Y);
+        mali(gaddr, ginfo, A, (A - X) - Y);
 
         //X = (A - Y);
         //this is bad!! if in request_list is IP 1.1.1.1 and in A 1.1.1.1 then you create a zombie in X (without a running timer)?????????????????????
         X *= A;
         X += (A - Y);
 
+        membership_delta delta(EXCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = Y - A;
         Y *= A;
 
         mali(gaddr, filter_timer);
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
 
 
     //EXCLUDE (X,Y)     IS_IN (A)     EXCLUDE (X+A, Y-A) (A)=MALI
     case MODE_IS_INCLUDE: {//IS_IN(x)
+        membership_delta delta(EXCLUDE_MODE, EXCLUDE_MODE);
+        delta.removed_sources = Y * A;
         X += A;
         Y -= A;
 
-        mali(gaddr, X, std::move(A));
+        mali(gaddr, ginfo, X, std::move(A));
 
-        state_change_notification(gaddr);
+        state_change_notification(gaddr, std::move(delta));
     }
     break;
     default:
@@ -396,47 +537,35 @@ void querier::timer_triggerd(const std::shared_ptr<proxy_msg>& msg)
     gaddr_map::iterator db_info_it;
     std::shared_ptr<timer_msg> tm;
 
-    if (!msg.unique()) {
-        switch (msg->get_type()) {
-        case proxy_msg::FILTER_TIMER_MSG:
-        case proxy_msg::SOURCE_TIMER_MSG:
-        case proxy_msg::RET_GROUP_TIMER_MSG:
-        case proxy_msg::RET_SOURCE_TIMER_MSG:
-        case proxy_msg::OLDER_HOST_PRESENT_TIMER_MSG: {
-            tm = std::static_pointer_cast<timer_msg>(msg);
+    //a timer is outdated if its group is deleted or its owner refers to another timer (message or generation)
+    switch (msg->get_type()) {
+    case proxy_msg::GROUP_TIMER_MSG:
+    case proxy_msg::OLDER_HOST_PRESENT_TIMER_MSG: {
+        tm = std::static_pointer_cast<timer_msg>(msg);
 
-            db_info_it = m_db.group_info.find(tm->get_gaddr());
+        db_info_it = m_db.group_info.find(tm->get_gaddr());
 
-            if (db_info_it == end(m_db.group_info)) {
-                HC_LOG_ERROR("filter_timer message is still in use but cannot found");
-                return;
-            }
-        }
-        break;
-        case proxy_msg::GENERAL_QUERY_TIMER_MSG:
-            tm = std::static_pointer_cast<timer_msg>(msg);
-            break;
-        default:
-            HC_LOG_ERROR("unknown timer message format");
+        if (db_info_it == end(m_db.group_info)) {
+            HC_LOG_DEBUG("timer is outdate, the group is deleted");
             return;
         }
-    } else {
-        HC_LOG_DEBUG("filter_timer is outdate");
+    }
+    break;
+    case proxy_msg::GENERAL_QUERY_TIMER_MSG:
+    case proxy_msg::QUERY_ROUND_TIMER_MSG:
+        tm = std::static_pointer_cast<timer_msg>(msg);
+        break;
+    default:
+        HC_LOG_ERROR("unknown timer message format");
         return;
     }
 
     switch (msg->get_type()) {
-    case proxy_msg::FILTER_TIMER_MSG:
-        timer_triggerd_filter_timer(db_info_it, tm);
-        break;
-    case proxy_msg::SOURCE_TIMER_MSG:
-        timer_triggerd_source_timer(db_info_it, tm);
+    case proxy_msg::GROUP_TIMER_MSG:
+        timer_triggerd_group_timer(db_info_it, tm);
         break;
-    case proxy_msg::RET_GROUP_TIMER_MSG:
-        timer_triggerd_ret_group_timer(db_info_it, tm);
-        break;
-    case proxy_msg::RET_SOURCE_TIMER_MSG:
-        timer_triggerd_ret_source_timer(db_info_it, tm);
+    case proxy_msg::QUERY_ROUND_TIMER_MSG:
+        timer_triggerd_query_round_timer(tm);
         break;
     case proxy_msg::GENERAL_QUERY_TIMER_MSG:
         timer_triggerd_general_query_timer(tm);
@@ -450,22 +579,26 @@ void querier::timer_triggerd(const std::shared_ptr<proxy_msg>& msg)
     }
 }
 
-void querier::timer_triggerd_filter_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg)
+void querier::timer_triggerd_group_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg)
 {
     HC_LOG_TRACE("");
 
     gaddr_info& ginfo = db_info_it->second;
+    auto gt = std::static_pointer_cast<group_timer_msg>(msg);
 
-    auto ftimer = std::static_pointer_cast<filter_timer_msg>(msg);
-
-    if (ftimer->is_used_as_source_timer()) {
-        timer_triggerd_source_timer(db_info_it, msg);
-    }
-
-    if (ginfo.shared_filter_timer.get() != ftimer.get()) {
-        HC_LOG_ERROR("found filter_timer differs from processing filter_timer");
+    if (ginfo.group_timer == timer_clock::not_running() || ginfo.group_timer_generation != gt->get_generation()) {
+        HC_LOG_DEBUG("group timer is outdate");
         return;
     }
+
+    ginfo.group_timer = timer_clock::not_running();
+
+    addr_storage notify_gaddr = db_info_it->first;
+    auto now = timer_clock::now();
+    bool state_changed = false;
+    bool effects = ginfo.is_under_bakcward_compatibility_effects();
+    membership_delta delta(ginfo.filter_mode, ginfo.filter_mode);
+
     //7.2.2.  Definition of Filter Timers
     //Router               Filter
     //Filter Mode          Timer Value        Actions/Comments
@@ -489,113 +622,115 @@ void querier::timer_triggerd_filter_timer(gaddr_map::iterator db_info_it, const
     //                                        moved to the Include
     //                                        List, and the Exclude
     //                                        List is deleted.
+    if (ginfo.filter_mode == EXCLUDE_MODE && ginfo.filter_timer <= now) {
+        delta.new_filter_mode = INCLUDE_MODE;
+        delta.removed_sources = std::move(ginfo.exclude_list);
 
-    if (ginfo.filter_mode == EXCLUDE_MODE) {
         if (ginfo.include_requested_list.empty()) {
-            addr_storage notify_gaddr = db_info_it->first;
-
             m_db.group_info.erase(db_info_it);
 
-            state_change_notification(notify_gaddr); //only A
+            state_change_notification(notify_gaddr, std::move(delta), effects); //only A
+            return;
         } else {
-            addr_storage notify_gaddr = db_info_it->first;
-
             ginfo.filter_mode = INCLUDE_MODE;
-            ginfo.shared_filter_timer.reset();
+            ginfo.filter_timer = timer_clock::not_running();
             ginfo.exclude_list.clear();
-
-            state_change_notification(notify_gaddr); //only A
+            state_changed = true;
         }
-    } else {
-        HC_LOG_ERROR("filter_mode is not in expected mode EXCLUDE");
     }
 
-}
-
-void querier::timer_triggerd_source_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg)
-{
-    HC_LOG_TRACE("");
-
-    gaddr_info& ginfo = db_info_it->second;
-
-    switch (ginfo.filter_mode) {
-
-
-        //7.2.3.  Definition of Source Timers
-        //If the timer of a
-        //source from the Include List expires, the source is deleted from the
-        //Include List.  If there are no more source records left, the
-        //multicast address record is deleted from the router.
-    case INCLUDE_MODE: {
-        addr_storage notify_gaddr = db_info_it->first;
-
-        for (auto it = std::begin(ginfo.include_requested_list); it != std::end(ginfo.include_requested_list);) {
-            if (it->shared_source_timer.get() == msg.get()) {
-
-                it = ginfo.include_requested_list.erase(it);
-                continue;
+    //7.2.3.  Definition of Source Timers
+    //If the timer of a
+    //source from the Include List expires, the source is deleted from the
+    //Include List.  If there are no more source records left, the
+    //multicast address record is deleted from the router.
+    //If the timer
+    //of a source from the Requested List expires, the source is moved to
+    //the Exclude List.
+    for (auto it = std::begin(ginfo.include_requested_list); it != std::end(ginfo.include_requested_list);) {
+        if (it->source_timer <= now) {
+            if (ginfo.filter_mode == EXCLUDE_MODE) {
+                it->source_timer = timer_clock::not_running();
+                ginfo.exclude_list.insert(*it);
+                delta.added_sources.insert(*it);
+            } else if (delta.old_filter_mode == INCLUDE_MODE) {
+                delta.removed_sources.insert(*it);
             }
-            ++it;
-        }
 
-        if (ginfo.include_requested_list.empty()) {
-            m_db.group_info.erase(db_info_it);
+            it = ginfo.include_requested_list.erase(it);
+            state_changed = true;
+            continue;
         }
+        ++it;
+    }
 
+    if (ginfo.filter_mode == INCLUDE_MODE && ginfo.include_requested_list.empty()) {
+        m_db.group_info.erase(db_info_it);
 
-        state_change_notification(notify_gaddr); //only A
-        break;
+        state_change_notification(notify_gaddr, std::move(delta), effects); //only A
+        return;
     }
 
-    //7.2.3.  Definition of Source Timers
-    //If the timer
-    //of a source from the Requested List expires, the source is moved to
-    //the Exclude List.
-    case EXCLUDE_MODE: {
-        addr_storage notify_gaddr = db_info_it->first;
+    //the wake-up of the remaining timers
+    arm_group_timer(notify_gaddr, ginfo, ginfo.get_next_deadline());
 
-        for (auto it = std::begin(ginfo.include_requested_list); it != std::end(ginfo.include_requested_list);) {
-            if (it->shared_source_timer.get() == msg.get()) {
-                it->shared_source_timer.reset();
-                ginfo.exclude_list.insert(*it);
-
-                it = ginfo.include_requested_list.erase(it);
-                continue;
-            }
-            ++it;
+    if (state_changed) {
+        //the filter mode changed to INCLUDE, the remaining requested list is the new source list
+        if (delta.old_filter_mode != delta.new_filter_mode) {
+            delta.added_sources = ginfo.include_requested_list;
         }
 
-        state_change_notification(notify_gaddr); //only A
-        break;
-    }
-    default:
-        HC_LOG_ERROR("unknown filter mode");
+        state_change_notification(notify_gaddr, std::move(delta)); //only A
     }
 }
 
-void querier::timer_triggerd_ret_group_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg)
+void querier::timer_triggerd_query_round_timer(const std::shared_ptr<timer_msg>& msg)
 {
     HC_LOG_TRACE("");
 
-    gaddr_info& ginfo = db_info_it->second;
-
-    if (ginfo.group_retransmission_timer.get() == msg.get()) { //msg is an retransmit filter timer message
-        send_Q(msg->get_gaddr(), ginfo);
-    } else { //msg is an retransmit source timer message
-        HC_LOG_ERROR("retransmission timer not found");
+    if (m_db.current_query_round.round_timer.get() != msg.get()) {
+        HC_LOG_ERROR("query round timer not found");
+        return;
     }
-}
 
-void querier::timer_triggerd_ret_source_timer(gaddr_map::iterator db_info_it, const std::shared_ptr<timer_msg>& msg)
-{
-    HC_LOG_TRACE("");
+    query_round round = std::move(m_db.current_query_round);
+    m_db.current_query_round = std::move(m_db.next_query_round);
+    m_db.next_query_round = query_round();
+
+    //arm the following round for the groups which are already waiting for it
+    if (!m_db.current_query_round.empty()) {
+        auto llqi = m_timers_values.get_last_listener_query_interval();
+        auto rt = make_pooled_msg<query_round_timer_msg>(m_if_index, llqi);
+        m_db.current_query_round.round_timer = rt;
+        m_timing->add_time(llqi, m_msg_worker, rt);
+
+        for (auto & e : m_db.current_query_round.group_queries) {
+            auto it = m_db.group_info.find(e);
+            if (it != std::end(m_db.group_info) && it->second.group_retransmission_timer == round.round_timer) {
+                it->second.group_retransmission_timer = rt;
+            }
+        }
 
-    gaddr_info& ginfo = db_info_it->second;
+        for (auto & e : m_db.current_query_round.source_queries) {
+            auto it = m_db.group_info.find(e);
+            if (it != std::end(m_db.group_info) && it->second.source_retransmission_timer == round.round_timer) {
+                it->second.source_retransmission_timer = rt;
+            }
+        }
+    }
 
-    if (ginfo.source_retransmission_timer.get() == msg.get()) { //msg is an retransmit filter timer message
-        send_Q(msg->get_gaddr(), ginfo, ginfo.include_requested_list , source_list<source>(), true);
-    } else { //msg is an retransmit source timer message
-        HC_LOG_ERROR("retransmission timer not found");
+    for (auto & e : round.group_queries) {
+        auto it = m_db.group_info.find(e);
+        if (it != std::end(m_db.group_info) && it->second.group_retransmission_timer == round.round_timer) {
+            send_Q(e, it->second, true);
+        }
+    }
+
+    for (auto & e : round.source_queries) {
+        auto it = m_db.group_info.find(e);
+        if (it != std::end(m_db.group_info) && it->second.source_retransmission_timer == round.round_timer) {
+            send_Q(e, it->second, it->second.include_requested_list, source_list<source>(), true);
+        }
     }
 }
 
@@ -619,7 +754,11 @@ void querier::timer_triggerd_older_host_present_timer(gaddr_map::iterator db_inf
     if (ginfo.older_host_present_timer.get() == msg.get()) {
         if (is_newest_version(ginfo.compatibility_mode_variable)) {
             ginfo.older_host_present_timer = nullptr;
-            state_change_notification(db_info_it->first);
+
+            //the sources are blocked again, the routing learns the whole state
+            membership_delta delta(EXCLUDE_MODE, ginfo.filter_mode);
+            delta.added_sources = ginfo.filter_mode == INCLUDE_MODE ? ginfo.include_requested_list : ginfo.exclude_list;
+            state_change_notification(db_info_it->first, std::move(delta));
         } else {
             ginfo.compatibility_mode_variable = get_next_newer_version(ginfo.compatibility_mode_variable);
 
@@ -634,7 +773,7 @@ void querier::timer_triggerd_older_host_present_timer(gaddr_map::iterator db_inf
                 delay = m_timers_values.get_older_host_present_interval();
             }
 
-            auto ohpt = std::make_shared<older_host_present_timer_msg>(m_if_index, db_info_it->first, delay);
+            auto ohpt = make_pooled_msg<older_host_present_timer_msg>(m_if_index, db_info_it->first, delay);
             ginfo.older_host_present_timer = ohpt;
             m_timing->add_time(delay, m_msg_worker, ohpt);
         }
@@ -644,56 +783,68 @@ void querier::timer_triggerd_older_host_present_timer(gaddr_map::iterator db_inf
 void querier::mali(const addr_storage& gaddr, gaddr_info& ginfo) const
 {
     HC_LOG_TRACE("");
-    auto ft = std::make_shared<filter_timer_msg>(m_if_index, gaddr, m_timers_values.get_multicast_address_listening_interval());
-
-    ginfo.shared_filter_timer = ft;
-
-    m_timing->add_time(m_timers_values.get_multicast_address_listening_interval(), m_msg_worker, ft);
+    ginfo.filter_timer = timer_clock::now() + m_timers_values.get_multicast_address_listening_interval();
+    arm_group_timer(gaddr, ginfo, ginfo.filter_timer);
 }
 
-void querier::mali(const addr_storage& gaddr, source_list<source>& slist) const
+void querier::mali(const addr_storage& gaddr, gaddr_info& ginfo, source_list<source>& slist, source_list<source>&& tmp_slist) const
 {
     HC_LOG_TRACE("");
-    auto st = std::make_shared<source_timer_msg>(m_if_index, gaddr, m_timers_values.get_multicast_address_listening_interval());
+    auto deadline = timer_clock::now() + m_timers_values.get_multicast_address_listening_interval();
 
-    for (auto & e : slist) {
-        e.shared_source_timer = st; //shard_source_timer is mutable
-        e.retransmission_count = -1;
+    for (auto & e : tmp_slist) {
+        auto it = slist.find(e);
+        if (it != std::end(slist)) {
+            it->source_timer = deadline; //source_timer is mutable
+            it->retransmission_count = -1;
+        }
     }
 
-    if (!slist.empty()) {
-        m_timing->add_time(m_timers_values.get_multicast_address_listening_interval(), m_msg_worker, st);
+    if (!tmp_slist.empty()) {
+        arm_group_timer(gaddr, ginfo, deadline);
     }
 }
 
-void querier::mali(const addr_storage& gaddr, source_list<source>& slist, source_list<source>&& tmp_slist) const
+void querier::arm_group_timer(const addr_storage& gaddr, gaddr_info& ginfo, const timer_clock::time_point& deadline) const
 {
     HC_LOG_TRACE("");
-    mali(gaddr, tmp_slist);
 
-    for (auto & e : tmp_slist) {
-        auto it = slist.find(e);
-        if (it != std::end(slist)) {
-            it->shared_source_timer = e.shared_source_timer;
-            it->retransmission_count = -1;
-        }
+    //a refreshed timer keeps the armed wake-up, it is armed again for the later deadline when it expires
+    if (deadline == timer_clock::not_running() || ginfo.group_timer <= deadline) {
+        return;
     }
+
+    //rounded up, the wake-up must not expire before the deadline
+    auto time_span = deadline - timer_clock::now();
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(time_span);
+    if (delay < time_span) {
+        delay += std::chrono::milliseconds(1);
+    }
+
+    if (delay.count() < 0) {
+        delay = std::chrono::milliseconds(0);
+    }
+
+    auto gt = make_pooled_msg<group_timer_msg>(m_if_index, gaddr, delay, ++m_group_timer_generation);
+    ginfo.group_timer = gt->get_end_time();
+    ginfo.group_timer_generation = gt->get_generation();
+    m_timing->add_time(delay, m_msg_worker, gt);
 }
 
 void querier::filter_time(gaddr_info& ginfo, source_list<source>& slist, source_list<source>&&  tmp_slist)
 {
     HC_LOG_TRACE("");
 
+    //the filter timer is already armed
     for (auto & e : tmp_slist) {
         auto it = slist.find(e);
         if (it != std::end(slist)) {
-            std::static_pointer_cast<filter_timer_msg>(ginfo.shared_filter_timer)->set_as_source_timer();
-            it->shared_source_timer = ginfo.shared_filter_timer;
+            it->source_timer = ginfo.filter_timer;
         }
     }
 }
 
-void querier::send_Q(const addr_storage& gaddr, gaddr_info& ginfo)
+void querier::send_Q(const addr_storage& gaddr, gaddr_info& ginfo, bool in_retransmission_state)
 {
     HC_LOG_TRACE("");
 
@@ -710,26 +861,21 @@ void querier::send_Q(const addr_storage& gaddr, gaddr_info& ginfo)
 
     if (ginfo.group_retransmission_timer == nullptr) {
         ginfo.group_retransmission_count = m_timers_values.get_last_listener_query_count();
-        auto llqt = m_timers_values.get_last_listener_query_time();
-        auto ftimer = std::make_shared<filter_timer_msg>(m_if_index, gaddr, llqt);
-
-        ginfo.shared_filter_timer = ftimer;
-
-        m_timing->add_time(llqt, m_msg_worker, ftimer);
+        ginfo.filter_timer = timer_clock::now() + m_timers_values.get_last_listener_query_time();
+        arm_group_timer(gaddr, ginfo, ginfo.filter_timer);
+    } else if (!in_retransmission_state) {
+        //the retransmissions of this group are already scheduled in a query round
+        return;
     }
 
     if (ginfo.group_retransmission_count > 0) {
         ginfo.group_retransmission_count--;
 
-        if (ginfo.group_retransmission_count > 0) {
-            auto llqi = m_timers_values.get_last_listener_query_interval();
-            auto rtimer = std::make_shared<retransmit_group_timer_msg>(m_if_index, gaddr, llqi);
-            ginfo.group_retransmission_timer = rtimer;
-            m_timing->add_time(llqi, m_msg_worker, rtimer);
-        }
-
-        m_sender->send_mc_addr_specific_query(m_if_index, m_timers_values, gaddr, ginfo.shared_filter_timer->is_remaining_time_greater_than(m_timers_values.get_last_listener_query_time()));
+        m_sender->send_mc_addr_specific_query(m_if_index, m_timers_values, gaddr, timer_clock::now() + m_timers_values.get_last_listener_query_time() <= ginfo.filter_timer);
+    }
 
+    if (ginfo.group_retransmission_count > 0) {
+        ginfo.group_retransmission_timer = schedule_retransmission(gaddr, false);
     } else { //reset itself
         ginfo.group_retransmission_timer = nullptr;
         ginfo.group_retransmission_count = -1;
@@ -743,8 +889,7 @@ void querier::send_Q(const addr_storage& gaddr, gaddr_info& ginfo, source_list<s
 
     bool is_used = false;
 
-    auto llqt = m_timers_values.get_last_listener_query_time();
-    auto st = std::make_shared<source_timer_msg>(m_if_index, gaddr, llqt);
+    auto deadline = timer_clock::now() + m_timers_values.get_last_listener_query_time();
 
     for (auto & e : tmp_list) {
         auto it = slist.find(e);
@@ -752,30 +897,68 @@ void querier::send_Q(const addr_storage& gaddr, gaddr_info& ginfo, source_list<s
             if (it->retransmission_count < 1) {
                 is_used = true;
 
-                it->shared_source_timer = st;
+                it->source_timer = deadline;
                 it->retransmission_count = m_timers_values.get_last_listener_query_count();
             }
         }
     }
 
     if (is_used) {
-        m_timing->add_time(llqt, m_msg_worker, st);
+        arm_group_timer(gaddr, ginfo, deadline);
     }
 
     if (is_used  || in_retransmission_state) {
         if (m_sender->send_mc_addr_and_src_specific_query(m_if_index, m_timers_values, gaddr, slist)) {
-            auto llqi = m_timers_values.get_last_listener_query_interval();
-            auto rst = std::make_shared<retransmit_source_timer_msg>(m_if_index, gaddr, llqi);
-            ginfo.source_retransmission_timer = rst;
-            m_timing->add_time(llqi, m_msg_worker, rst);
+            ginfo.source_retransmission_timer = schedule_retransmission(gaddr, true);
+        } else {
+            ginfo.source_retransmission_timer = nullptr;
+        }
+    }
+}
+
+std::shared_ptr<query_round_timer_msg> querier::schedule_retransmission(const addr_storage& gaddr, bool source_query)
+{
+    HC_LOG_TRACE("");
+
+    //RFC 3810 7.6.3. The retransmissions are sent every [Last Listener Query Interval] over [Last Listener Query Time].
+    //All groups share the retransmission rounds of the interface. A group joins the armed round if it expires
+    //at least half an interval from now, otherwise the following one. So the first retransmission is sent after
+    //0.5 to 1.5 intervals and the last one still within [Last Listener Query Time].
+    auto llqi = m_timers_values.get_last_listener_query_interval();
+    auto& current_round = m_db.current_query_round;
+    auto& next_round = m_db.next_query_round;
+
+    if (current_round.round_timer == nullptr) {
+        current_round.round_timer = make_pooled_msg<query_round_timer_msg>(m_if_index, llqi);
+        m_timing->add_time(llqi, m_msg_worker, current_round.round_timer);
+    }
+
+    auto& current_queries = source_query ? current_round.source_queries : current_round.group_queries;
+    auto& next_queries = source_query ? next_round.source_queries : next_round.group_queries;
+
+    if (current_queries.find(gaddr) == std::end(current_queries) && next_queries.find(gaddr) == std::end(next_queries)) {
+        if (current_round.round_timer->is_remaining_time_greater_than(llqi / 2)) {
+            current_queries.insert(gaddr);
+        } else {
+            next_queries.insert(gaddr);
         }
     }
+
+    return current_round.round_timer;
 }
 
-void querier::state_change_notification(const addr_storage& gaddr)
+void querier::state_change_notification(const addr_storage& gaddr, membership_delta&& delta, bool effects)
 {
     HC_LOG_TRACE("");
-    m_cb_state_change(m_if_index, gaddr);
+
+    //RFC 3810 8.3.2. sources are not blocked under backward compatibility effects, the routing knows only EXCLUDE{}
+    auto db_info_it = m_db.group_info.find(gaddr);
+    bool deleted = db_info_it == std::end(m_db.group_info);
+    if (effects || (!deleted && db_info_it->second.is_under_bakcward_compatibility_effects())) {
+        delta = membership_delta(EXCLUDE_MODE, deleted ? INCLUDE_MODE : EXCLUDE_MODE);
+    }
+
+    m_cb_state_change(m_if_index, gaddr, delta);
 }
 
 querier::~querier()
@@ -791,7 +974,7 @@ timers_values& querier::get_timers_values()
 }
 
 //interface_filter_fun is very useless, please overwork ???????????????
-void querier::suggest_to_forward_traffic(const addr_storage& gaddr, std::list<std::pair<source, std::list<unsigned int>>>& rt_slist, std::function<bool(const addr_storage&)> interface_filter_fun) const
+void querier::suggest_to_forward_traffic(const addr_storage& gaddr, pooled_list<std::pair<source, pooled_list<unsigned int>>>& rt_slist, const std::function<bool(const addr_storage&)>& interface_filter_fun) const
 {
     HC_LOG_TRACE("");
 
@@ -837,6 +1020,89 @@ void querier::suggest_to_forward_traffic(const addr_storage& gaddr, std::list<st
 
 }
 
+std::list<addr_storage> querier::get_group_addrs() const
+{
+    HC_LOG_TRACE("");
+    std::list<addr_storage> rt_list;
+    for (auto & e : m_db.group_info) {
+        rt_list.push_back(e.first);
+    }
+    return rt_list;
+}
+
+std::list<snapshot_group> querier::get_snapshot() const
+{
+    HC_LOG_TRACE("");
+    std::list<snapshot_group> rt_list;
+
+    for (auto & e : m_db.group_info) {
+        const gaddr_info& ginfo = e.second;
+        snapshot_group g;
+        g.gaddr = e.first;
+        g.filter_mode = ginfo.filter_mode;
+        g.filter_timer = std::chrono::milliseconds(0);
+        if (ginfo.filter_mode == EXCLUDE_MODE && ginfo.filter_timer != timer_clock::not_running()) {
+            g.filter_timer = timer_clock::get_remaining_duration(ginfo.filter_timer);
+        }
+
+        for (auto & s : ginfo.include_requested_list) {
+            if (s.source_timer != timer_clock::not_running()) {
+                g.include_requested_list.push_back(snapshot_source{s.saddr, timer_clock::get_remaining_duration(s.source_timer)});
+            }
+        }
+
+        for (auto & s : ginfo.exclude_list) {
+            g.exclude_list.push_back(s.saddr);
+        }
+
+        rt_list.push_back(std::move(g));
+    }
+
+    return rt_list;
+}
+
+void querier::restore_snapshot(const std::list<snapshot_group>& groups)
+{
+    HC_LOG_TRACE("");
+
+    for (auto & g : groups) {
+        if (g.gaddr.get_addr_family() != get_addr_family(m_db.querier_version_mode)) {
+            HC_LOG_WARN("failed to restore group " << g.gaddr << ", wrong address family");
+            continue;
+        }
+
+        if (m_db.group_info.find(g.gaddr) != std::end(m_db.group_info)) {
+            HC_LOG_DEBUG("group " << g.gaddr << " already known, snapshot ignored");
+            continue;
+        }
+
+        gaddr_info ginfo(m_db.querier_version_mode);
+        ginfo.filter_mode = g.filter_mode;
+
+        auto now = timer_clock::now();
+        if (g.filter_mode == EXCLUDE_MODE) {
+            ginfo.filter_timer = now + g.filter_timer;
+
+            for (auto & saddr : g.exclude_list) {
+                ginfo.exclude_list.insert(source(saddr));
+            }
+        }
+
+        for (auto & s : g.include_requested_list) {
+            source tmp_source(s.saddr);
+            tmp_source.source_timer = now + s.source_timer;
+            ginfo.include_requested_list.insert(tmp_source);
+        }
+
+        membership_delta delta(INCLUDE_MODE, ginfo.filter_mode);
+        delta.added_sources = ginfo.filter_mode == INCLUDE_MODE ? ginfo.include_requested_list : ginfo.exclude_list;
+
+        auto db_info_it = m_db.group_info.insert(gaddr_pair(g.gaddr, std::move(ginfo))).first;
+        arm_group_timer(g.gaddr, db_info_it->second, db_info_it->second.get_next_deadline());
+        state_change_notification(g.gaddr, std::move(delta));
+    }
+}
+
 std::pair<mc_filter, source_list<source>> querier::get_group_membership_infos(const addr_storage& gaddr)
 {
     HC_LOG_TRACE("");
@@ -870,6 +1136,10 @@ std::string querier::to_string() const
 {
     std::ostringstream s;
     s << "##-- downstream interface: " << interfaces::get_if_name(m_if_index) << " (index:" << m_if_index << ") --##" << std::endl;
+    s << "general query phase: " << time_to_string(m_general_query_phase) << ", jitter: " << time_to_string(m_general_query_jitter) << std::endl;
+    if (m_explicit_tracking.count() > 0) {
+        s << "explicit tracking: " << time_to_string(m_explicit_tracking) << std::endl;
+    }
     s << m_db;
     return s.str();
 }
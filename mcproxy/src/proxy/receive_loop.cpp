@@ -0,0 +1,144 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/receive_loop.hpp"
+#include "include/proxy/receiver.hpp"
+#include "include/proxy/thread_settings.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+receive_loop::receive_loop(int addr_family)
+    : m_addr_family(addr_family)
+    , m_epoll_fd(-1)
+    , m_running(false)
+    , m_thread(nullptr)
+{
+    HC_LOG_TRACE("");
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd < 0) {
+        HC_LOG_ERROR("failed to create epoll instance! Error: " << strerror(errno) << " errno: " << errno);
+        throw "failed to create epoll instance";
+    }
+
+    start();
+}
+
+receive_loop::~receive_loop()
+{
+    HC_LOG_TRACE("");
+    stop();
+    join();
+    close(m_epoll_fd);
+}
+
+bool receive_loop::registrate_receiver(int sock, receiver* r)
+{
+    HC_LOG_TRACE("");
+
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = sock;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+        HC_LOG_ERROR("failed to add socket to epoll instance! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    m_receivers[sock] = r;
+    return true;
+}
+
+void receive_loop::del_receiver(int sock)
+{
+    HC_LOG_TRACE("");
+
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if (m_receivers.erase(sock) > 0) {
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, sock, nullptr) < 0) {
+            HC_LOG_WARN("failed to delete socket from epoll instance! Error: " << strerror(errno) << " errno: " << errno);
+        }
+    }
+}
+
+int receive_loop::get_addr_family() const
+{
+    HC_LOG_TRACE("");
+    return m_addr_family;
+}
+
+void receive_loop::worker_thread()
+{
+    HC_LOG_TRACE("");
+    thread_settings::apply(TC_RECEIVER);
+
+    struct epoll_event events[RECEIVE_LOOP_MAX_EVENTS];
+
+    while (m_running) {
+        int n = epoll_wait(m_epoll_fd, events, RECEIVE_LOOP_MAX_EVENTS, RECEIVER_RECV_TIMEOUT);
+        if (n < 0) {
+            if (errno != EINTR) {
+                HC_LOG_ERROR("epoll_wait failed! Error: " << strerror(errno) << " errno: " << errno);
+                sleep(1);
+            }
+            continue;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            std::lock_guard<std::mutex> lock(m_global_lock);
+            auto it = m_receivers.find(events[i].data.fd);
+            if (it != std::end(m_receivers)) {
+                it->second->receive_packet();
+            }
+        }
+    }
+}
+
+void receive_loop::start()
+{
+    HC_LOG_TRACE("");
+    m_running = true;
+    m_thread.reset(new std::thread(&receive_loop::worker_thread, this));
+}
+
+void receive_loop::stop()
+{
+    HC_LOG_TRACE("");
+    m_running = false;
+}
+
+void receive_loop::join()
+{
+    HC_LOG_TRACE("");
+    if (m_thread.get() != nullptr) {
+        m_thread->join();
+    }
+}
@@ -23,13 +23,16 @@
 
 #include "include/hamcast_logging.h"
 #include "include/proxy/receiver.hpp"
+#include "include/proxy/receive_loop.hpp"
+#include "include/proxy/thread_settings.hpp"
 
 #include <unistd.h>
 
-receiver::receiver(proxy_instance* pr_i, int addr_family, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode)
+receiver::receiver(proxy_instance* pr_i, int addr_family, const std::shared_ptr<const mroute_socket> mrt_sock, const std::shared_ptr<const interfaces> interfaces, bool in_debug_testing_mode, const std::shared_ptr<receive_loop>& shared_receive_loop)
     : m_running(false)
     , m_in_debug_testing_mode(in_debug_testing_mode)
     , m_thread(nullptr)
+    , m_receive_loop(shared_receive_loop)
     , m_proxy_instance(pr_i)
     , m_addr_family(addr_family)
     , m_mrt_sock(mrt_sock)
@@ -37,7 +40,7 @@ receiver::receiver(proxy_instance* pr_i, int addr_family, const std::shared_ptr<
 {
     HC_LOG_TRACE("");
 
-    if (!m_mrt_sock->set_receive_timeout(RECEIVER_RECV_TIMEOUT)) {
+    if (m_mrt_sock != nullptr && !m_mrt_sock->set_receive_timeout(RECEIVER_RECV_TIMEOUT)) {
         throw std::string("failed to set receive timeout");
     }
 
@@ -74,53 +77,85 @@ void receiver::del_interface(unsigned int if_index)
     m_relevant_if_index.erase(if_index);
 }
 
-void receiver::worker_thread()
+void receiver::init_msg_buffer()
+{
+    HC_LOG_TRACE("");
+
+    m_iov_buf.reset(new unsigned char[get_iov_min_size()]);
+    m_iov.iov_base = m_iov_buf.get();
+    m_iov.iov_len = get_iov_min_size();
+
+    m_ctrl_buf.reset(new unsigned char[get_ctrl_min_size()]);
+
+    m_msg.msg_name = &m_name;
+    m_msg.msg_namelen = sizeof(m_name);
+
+    m_msg.msg_iov = &m_iov;
+    m_msg.msg_iovlen = 1;
+
+    m_msg.msg_control = m_ctrl_buf.get();
+    m_msg.msg_controllen = get_ctrl_min_size();
+
+    m_msg.msg_flags = 0;
+}
+
+bool receiver::receive_packet()
 {
     HC_LOG_TRACE("");
 
     int info_size = 0;
 
-    //########################
-    //create msg
-    //iov
+    //recvmsg() shrinks the control length to the received size
+    m_iov.iov_len = get_iov_min_size();
+    m_msg.msg_controllen = get_ctrl_min_size();
+    m_msg.msg_namelen = sizeof(m_name);
+    m_msg.msg_flags = 0;
+
+    if (!m_mrt_sock->receive_msg(&m_msg, info_size)) {
+        HC_LOG_ERROR("received failed");
+        return false;
+    }
+
+    if (info_size == 0) {
+        return true; //on timeout
+    }
 
-    std::unique_ptr<unsigned char[]> iov_buf { new unsigned char[get_iov_min_size()] };
-    //unsigned char iov_buf[r->get_iov_min_size()];
-    struct iovec iov;
-    iov.iov_base = iov_buf.get();
-    iov.iov_len = get_iov_min_size(); //sizeof(iov_buf);
+    std::lock_guard<std::mutex> lock(m_data_lock);
+    if (m_capture != nullptr) {
+        unsigned int if_index = get_packet_if_index(&m_msg);
+        if (is_if_index_relevant(if_index)) {
+            m_capture->write_packet(if_index, &m_msg, info_size);
+        }
+    }
+    analyse_packet(&m_msg, info_size);
+    return true;
+}
 
-    //control
-    std::unique_ptr<unsigned char[]> ctrl { new unsigned char[get_ctrl_min_size()] };
-    //unsigned char ctrl[r->get_ctrl_min_size()];
+void receiver::replay_packet(struct msghdr* msg, int info_size)
+{
+    HC_LOG_TRACE("");
 
-    //create msghdr
-    struct msghdr msg;
-    msg.msg_name = nullptr;
-    msg.msg_namelen = 0;
+    std::lock_guard<std::mutex> lock(m_data_lock);
+    analyse_packet(msg, info_size);
+}
 
-    msg.msg_iov = &iov;
-    msg.msg_iovlen = 1;
+void receiver::set_capture(const std::shared_ptr<capture_file>& capture)
+{
+    HC_LOG_TRACE("");
 
-    msg.msg_control = ctrl.get();
-    msg.msg_controllen = get_ctrl_min_size(); //sizeof(ctrl);
+    std::lock_guard<std::mutex> lock(m_data_lock);
+    m_capture = capture;
+}
 
-    msg.msg_flags = 0;
-    //########################
+void receiver::worker_thread()
+{
+    HC_LOG_TRACE("");
+    thread_settings::apply(TC_RECEIVER);
 
     while (m_running) {
-        if (!m_mrt_sock->receive_msg(&msg, info_size)) {
-            HC_LOG_ERROR("received failed");
+        if (!receive_packet()) {
             sleep(1);
-            continue;
         }
-        if (info_size == 0) {
-            continue; //on timeout
-        }
-
-        m_data_lock.lock();
-        analyse_packet(&msg, info_size);
-        m_data_lock.unlock();
     }
 }
 
@@ -133,9 +168,16 @@ bool receiver::is_running()
 void receiver::start()
 {
     HC_LOG_TRACE("");
-    if (!m_in_debug_testing_mode) {
+    if (!m_in_debug_testing_mode && m_mrt_sock != nullptr) {
+        init_msg_buffer();
         m_running =  true;
-        m_thread.reset(new std::thread(&receiver::worker_thread, this));
+        if (m_receive_loop != nullptr) {
+            if (!m_receive_loop->registrate_receiver(m_mrt_sock->get_socket(), this)) {
+                throw "failed to register receiver at the receive loop";
+            }
+        } else {
+            m_thread.reset(new std::thread(&receiver::worker_thread, this));
+        }
     }
 }
 
@@ -144,13 +186,16 @@ void receiver::stop()
     HC_LOG_TRACE("");
 
     m_running = false;
+    if (m_receive_loop != nullptr && m_mrt_sock != nullptr) {
+        m_receive_loop->del_receiver(m_mrt_sock->get_socket());
+    }
 }
 
 void receiver::join()
 {
     HC_LOG_TRACE("");
 
-    if (m_thread.get() != nullptr) {
+    if (m_thread.get() != nullptr && m_thread->joinable()) {
         m_thread->join();
     }
 }
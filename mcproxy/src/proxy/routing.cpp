@@ -25,18 +25,29 @@
 #include "include/proxy/routing.hpp"
 #include "include/proxy/interfaces.hpp"
 #include "include/utils/addr_storage.hpp"
-#include "include/utils/mroute_socket.hpp"
+#include "include/utils/kernel_backend.hpp"
 
 #include <net/if.h>
 #include <linux/mroute.h>
 #include <linux/mroute6.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
 #include <iostream>
 
-routing::routing(int addr_family, std::shared_ptr<const mroute_socket> mrt_sock, std::shared_ptr<const interfaces> interfaces, int table_number)
+routing::routing(int addr_family, std::shared_ptr<const kernel_backend> kernel, std::shared_ptr<const interfaces> interfaces, int table_number, bool takeover)
     : m_table_number(table_number)
     , m_addr_family(addr_family)
     , m_interfaces(interfaces)
-    , m_mrt_sock(mrt_sock)
+    , m_kernel(kernel)
+    , m_takeover(takeover)
+    , m_keep_kernel_state(takeover)
 {
     HC_LOG_TRACE("");
 
@@ -70,16 +81,23 @@ bool routing::add_vif(int if_index, int vif) const
         return false;
     }
 
+    //take over the virtual interface kept by a previous run, the forwarding rules using it keep working
+    if (m_takeover && is_kernel_vif(vif, if_name)) {
+        m_added_ifs.insert(if_index);
+        HC_LOG_DEBUG("took over interface: " << if_name << " with vif number:" << vif);
+        return true;
+    }
+
     if ((item->ifa_flags & IFF_POINTOPOINT) && (item->ifa_dstaddr != nullptr)) { //tunnel
 
         //addr_storage p2p_addr(*(item->ifa_dstaddr));
 
-        if (!m_mrt_sock->add_vif(vif, if_index, addr_storage(*(item->ifa_dstaddr)))) {
+        if (!add_kernel_vif(vif, if_index, addr_storage(*(item->ifa_dstaddr)))) {
             return false;
         }
 
     } else { //phyint
-        if (!m_mrt_sock->add_vif(vif, if_index, addr_storage())) {
+        if (!add_kernel_vif(vif, if_index, addr_storage())) {
             return false;
         } else {
             if (!m_added_ifs.insert(if_index).second) {
@@ -90,7 +108,7 @@ bool routing::add_vif(int if_index, int vif) const
     }
 
     if (m_table_number > 0) {
-        if (!m_mrt_sock->bind_vif_to_table(if_index, m_table_number)) {
+        if (!m_kernel->bind_vif_to_table(if_index, m_table_number)) {
             return false;
         }
     }
@@ -99,7 +117,296 @@ bool routing::add_vif(int if_index, int vif) const
     return true;
 }
 
-bool routing::add_route(int input_vif, const addr_storage& g_addr, const addr_storage& src_addr, const std::list<int>& output_vif) const
+bool routing::add_kernel_vif(int vif, int if_index, const addr_storage& ip_tunnel_remote_addr) const
+{
+    HC_LOG_TRACE("");
+
+    if (m_kernel->add_vif(vif, if_index, ip_tunnel_remote_addr)) {
+        return true;
+    }
+
+    //the vif number is occupied by a virtual interface kept by a previous run (takeover mode)
+    HC_LOG_DEBUG("replace virtual interface with vif number: " << vif);
+    m_kernel->del_vif(vif);
+    if (m_table_number > 0) {
+        m_kernel->unbind_vif_form_table(if_index, m_table_number);
+    }
+    return m_kernel->add_vif(vif, if_index, ip_tunnel_remote_addr);
+}
+
+bool routing::is_kernel_vif(int vif, const std::string& if_name) const
+{
+    HC_LOG_TRACE("");
+
+    std::map<int, unsigned int> kernel_vifs;
+    if (m_addr_family == AF_INET && get_kernel_vifs(kernel_vifs)) {
+        auto it = kernel_vifs.find(vif);
+        return it != kernel_vifs.end() && it->second == interfaces::get_if_index(if_name);
+    }
+
+    //the proc files show only the default multicast routing table, the IPv6 virtual interfaces cannot be dumped via netlink
+    if (m_table_number > 0) {
+        HC_LOG_DEBUG("failed to get the virtual interfaces of multicast routing table " << m_table_number);
+        return false;
+    }
+
+    std::ifstream file(m_addr_family == AF_INET ? "/proc/net/ip_mr_vif" : "/proc/net/ip6_mr_vif");
+    std::string line;
+
+    //skip the headline
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        int kernel_vif;
+        std::string kernel_if_name;
+        if ((iss >> kernel_vif >> kernel_if_name) && kernel_vif == vif) {
+            return kernel_if_name == if_name;
+        }
+    }
+
+    return false;
+}
+
+bool routing::get_kernel_vifs(std::map<int, unsigned int>& kernel_vifs) const
+{
+    HC_LOG_TRACE("");
+
+    int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (sock < 0) {
+        HC_LOG_ERROR("failed to create netlink socket! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    struct {
+        struct nlmsghdr nlh;
+        struct ifinfomsg ifi;
+    } req;
+    memset(&req, 0, sizeof(req));
+
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    req.nlh.nlmsg_type = RTM_GETLINK;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = 1;
+    req.ifi.ifi_family = RTNL_FAMILY_IPMR;
+
+    if (send(sock, &req, req.nlh.nlmsg_len, 0) < 0) {
+        HC_LOG_ERROR("failed to request the virtual interfaces! Error: " << strerror(errno) << " errno: " << errno);
+        close(sock);
+        return false;
+    }
+
+    //one message per multicast routing table: [IFLA_AF_SPEC [IPMRA_TABLE_ID] [IPMRA_TABLE_VIFS [IPMRA_VIF [IPMRA_VIFA_xxx]]]]
+    std::vector<char> buf(32768);
+    bool done = false;
+    bool rc = false;
+    while (!done) {
+        int len = recv(sock, buf.data(), buf.size(), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            HC_LOG_ERROR("failed to receive the virtual interfaces! Error: " << strerror(errno) << " errno: " << errno);
+            break;
+        } else if (len == 0) {
+            break;
+        }
+
+        for (struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(buf.data()); NLMSG_OK(nlh, static_cast<unsigned int>(len)); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_DONE) {
+                rc = true;
+                done = true;
+                break;
+            } else if (nlh->nlmsg_type == NLMSG_ERROR) {
+                //kernel older than 4.13
+                HC_LOG_DEBUG("failed to dump the virtual interfaces");
+                done = true;
+                break;
+            } else if (nlh->nlmsg_type != RTM_NEWLINK) {
+                continue;
+            }
+
+            struct ifinfomsg* ifi = reinterpret_cast<struct ifinfomsg*>(NLMSG_DATA(nlh));
+            unsigned int table = 0;
+            std::map<int, unsigned int> vifs;
+
+            int attr_len = IFLA_PAYLOAD(nlh);
+            for (struct rtattr* af = IFLA_RTA(ifi); RTA_OK(af, attr_len); af = RTA_NEXT(af, attr_len)) {
+                if (af->rta_type != IFLA_AF_SPEC) {
+                    continue;
+                }
+
+                int af_len = RTA_PAYLOAD(af);
+                for (struct rtattr* rta = reinterpret_cast<struct rtattr*>(RTA_DATA(af)); RTA_OK(rta, af_len); rta = RTA_NEXT(rta, af_len)) {
+                    if (rta->rta_type == IPMRA_TABLE_ID) {
+                        table = *reinterpret_cast<uint32_t*>(RTA_DATA(rta));
+                    } else if (rta->rta_type == IPMRA_TABLE_VIFS) {
+                        int vifs_len = RTA_PAYLOAD(rta);
+                        for (struct rtattr* vif_rta = reinterpret_cast<struct rtattr*>(RTA_DATA(rta)); RTA_OK(vif_rta, vifs_len); vif_rta = RTA_NEXT(vif_rta, vifs_len)) {
+                            if (vif_rta->rta_type != IPMRA_VIF) {
+                                continue;
+                            }
+
+                            int vif = -1;
+                            unsigned int if_index = 0;
+                            int vifa_len = RTA_PAYLOAD(vif_rta);
+                            for (struct rtattr* vifa = reinterpret_cast<struct rtattr*>(RTA_DATA(vif_rta)); RTA_OK(vifa, vifa_len); vifa = RTA_NEXT(vifa, vifa_len)) {
+                                if (vifa->rta_type == IPMRA_VIFA_IFINDEX) {
+                                    if_index = *reinterpret_cast<uint32_t*>(RTA_DATA(vifa));
+                                } else if (vifa->rta_type == IPMRA_VIFA_VIF_ID) {
+                                    vif = *reinterpret_cast<uint16_t*>(RTA_DATA(vifa));
+                                }
+                            }
+
+                            if (vif >= 0) {
+                                vifs[vif] = if_index;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (is_own_table(table)) {
+                kernel_vifs.insert(vifs.begin(), vifs.end());
+            }
+        }
+    }
+
+    close(sock);
+    return rc;
+}
+
+bool routing::is_own_table(unsigned int table) const
+{
+    HC_LOG_TRACE("");
+
+    if (m_table_number > 0) {
+        return table == static_cast<unsigned int>(m_table_number);
+    } else {
+        //the default multicast routing table of IPv4 is RT_TABLE_DEFAULT, of IPv6 RT_TABLE_MAIN or RT_TABLE_DEFAULT
+        return table == RT_TABLE_DEFAULT || table == RT_TABLE_MAIN;
+    }
+}
+
+std::list<kernel_route> routing::get_kernel_routes() const
+{
+    HC_LOG_TRACE("");
+
+    std::list<kernel_route> result;
+
+    int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (sock < 0) {
+        HC_LOG_ERROR("failed to create netlink socket! Error: " << strerror(errno) << " errno: " << errno);
+        return result;
+    }
+
+    struct {
+        struct nlmsghdr nlh;
+        struct rtmsg rtm;
+    } req;
+    memset(&req, 0, sizeof(req));
+
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+    req.nlh.nlmsg_type = RTM_GETROUTE;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = 1;
+    req.rtm.rtm_family = (m_addr_family == AF_INET) ? RTNL_FAMILY_IPMR : RTNL_FAMILY_IP6MR;
+
+    if (send(sock, &req, req.nlh.nlmsg_len, 0) < 0) {
+        HC_LOG_ERROR("failed to request the multicast routes! Error: " << strerror(errno) << " errno: " << errno);
+        close(sock);
+        return result;
+    }
+
+    auto to_addr = [&](const struct rtattr * rta) {
+        if (m_addr_family == AF_INET && RTA_PAYLOAD(rta) >= sizeof(struct in_addr)) {
+            return addr_storage(*reinterpret_cast<const struct in_addr*>(RTA_DATA(rta)));
+        } else if (m_addr_family == AF_INET6 && RTA_PAYLOAD(rta) >= sizeof(struct in6_addr)) {
+            return addr_storage(*reinterpret_cast<const struct in6_addr*>(RTA_DATA(rta)));
+        } else {
+            return addr_storage();
+        }
+    };
+
+    std::vector<char> buf(32768);
+    bool done = false;
+    while (!done) {
+        int len = recv(sock, buf.data(), buf.size(), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            HC_LOG_ERROR("failed to receive the multicast routes! Error: " << strerror(errno) << " errno: " << errno);
+            break;
+        } else if (len == 0) {
+            break;
+        }
+
+        for (struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(buf.data()); NLMSG_OK(nlh, static_cast<unsigned int>(len)); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_DONE) {
+                done = true;
+                break;
+            } else if (nlh->nlmsg_type == NLMSG_ERROR) {
+                HC_LOG_ERROR("failed to dump the multicast routes");
+                done = true;
+                break;
+            } else if (nlh->nlmsg_type != RTM_NEWROUTE) {
+                continue;
+            }
+
+            struct rtmsg* rtm = reinterpret_cast<struct rtmsg*>(NLMSG_DATA(nlh));
+            unsigned int table = rtm->rtm_table;
+            kernel_route kr;
+            kr.input_if_index = 0;
+
+            int attr_len = RTM_PAYLOAD(nlh);
+            for (struct rtattr* rta = RTM_RTA(rtm); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len)) {
+                switch (rta->rta_type) {
+                case RTA_TABLE:
+                    table = *reinterpret_cast<uint32_t*>(RTA_DATA(rta));
+                    break;
+                case RTA_SRC:
+                    kr.saddr = to_addr(rta);
+                    break;
+                case RTA_DST:
+                    kr.gaddr = to_addr(rta);
+                    break;
+                case RTA_IIF:
+                    kr.input_if_index = *reinterpret_cast<uint32_t*>(RTA_DATA(rta));
+                    break;
+                case RTA_MULTIPATH: {
+                    struct rtnexthop* rtnh = reinterpret_cast<struct rtnexthop*>(RTA_DATA(rta));
+                    int nh_len = RTA_PAYLOAD(rta);
+                    while (RTNH_OK(rtnh, nh_len)) {
+                        kr.output_if_indexes.push_back(rtnh->rtnh_ifindex);
+                        nh_len -= RTNH_ALIGN(rtnh->rtnh_len);
+                        rtnh = RTNH_NEXT(rtnh);
+                    }
+                }
+                break;
+                default:
+                    break;
+                }
+            }
+
+            //unresolved entries have no input interface, (*,G) entries are not set by a proxy instance
+            if (is_own_table(table) && kr.input_if_index != 0 && kr.gaddr.is_valid() && kr.saddr.is_valid() && kr.saddr != addr_storage(m_addr_family)) {
+                result.push_back(kr);
+            }
+        }
+    }
+
+    close(sock);
+    return result;
+}
+
+void routing::release_kernel_state()
+{
+    HC_LOG_TRACE("");
+    m_keep_kernel_state = false;
+}
+
+bool routing::add_route(int input_vif, const addr_storage& g_addr, const addr_storage& src_addr, const pooled_list<int>& output_vif) const
 {
     HC_LOG_TRACE("");
 
@@ -116,7 +423,7 @@ bool routing::add_route(int input_vif, const addr_storage& g_addr, const addr_st
         return false;
     }
 
-    if (!m_mrt_sock->add_mroute(input_vif, src_addr, g_addr, output_vif)) {
+    if (!m_kernel->add_mroute(input_vif, src_addr, g_addr, output_vif)) {
         return false;
     }
 
@@ -127,7 +434,7 @@ bool routing::del_route(int vif, const addr_storage& g_addr, const addr_storage&
 {
     HC_LOG_TRACE("");
 
-    if (!m_mrt_sock->del_mroute(vif, src_addr, g_addr)) {
+    if (!m_kernel->del_mroute(vif, src_addr, g_addr)) {
         return false;
     }
 
@@ -138,12 +445,12 @@ bool routing::del_vif(int if_index, int vif) const
 {
     HC_LOG_TRACE("");
 
-    if (!m_mrt_sock->del_vif(vif)) {
+    if (!m_kernel->del_vif(vif)) {
         return false;
     }
 
     if (m_table_number > 0) {
-        if (!m_mrt_sock->unbind_vif_form_table(if_index, m_table_number)) {
+        if (!m_kernel->unbind_vif_form_table(if_index, m_table_number)) {
             return false;
         }
     }
@@ -161,8 +468,19 @@ routing::~routing()
 {
     HC_LOG_TRACE("");
 
-    //clean up all added interfaces
-    for (auto e : m_added_ifs) {
+    if (m_keep_kernel_state) {
+        HC_LOG_DEBUG("keep the virtual interfaces and forwarding rules for the next run");
+        return;
+    }
+
+    //the static forwarding rules of the takeover mode are not removed with the mroute socket
+    if (m_takeover) {
+        m_kernel->flush_mroutes();
+    }
+
+    //clean up all added interfaces, del_vif erases them from m_added_ifs
+    auto added_ifs = m_added_ifs;
+    for (auto e : added_ifs) {
         del_vif(e, m_interfaces->get_virtual_if_index(e));
     }
 }
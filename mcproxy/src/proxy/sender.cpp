@@ -28,11 +28,21 @@
 
 #include <iostream>
 sender::sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp)
+    : sender(interfaces, gmp, true)
+{
+    HC_LOG_TRACE("");
+}
+
+sender::sender(const std::shared_ptr<const interfaces>& interfaces, group_mem_protocol gmp, bool create_socket)
     : m_group_mem_protocol(gmp)
     , m_interfaces(interfaces)
 {
     HC_LOG_TRACE("");
 
+    if (!create_socket) {
+        return;
+    }
+
     if (is_IPv4(m_group_mem_protocol)) {
         if (!m_sock.create_raw_ipv4_socket()) {
             throw "failed to create raw ipv4 socket";
@@ -65,6 +75,30 @@ bool sender::send_record(unsigned int if_index, mc_filter filter_mode, const add
     return true;
 }
 
+bool sender::send_record_change(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+    cout << "!!--ACTION: send report" << endl;
+    cout << "interface: " << interfaces::get_if_name(if_index) << endl;
+    cout << "group address: " << gaddr << endl;
+    if (old_filter_mode == new_filter_mode) {
+        cout << "filter mode: " << get_mc_filter_name(new_filter_mode) << endl;
+        if (new_filter_mode == INCLUDE_MODE) {
+            cout << "allow new sources: " << new_slist - old_slist << endl;
+            cout << "block old sources: " << old_slist - new_slist << endl;
+        } else {
+            cout << "allow new sources: " << old_slist - new_slist << endl;
+            cout << "block old sources: " << new_slist - old_slist << endl;
+        }
+    } else {
+        cout << "change filter mode to: " << get_mc_filter_name(new_filter_mode) << endl;
+        cout << "source list: " << new_slist << endl;
+    }
+    cout << endl;
+    return true;
+}
+
 bool sender::send_general_query(unsigned int if_index, const timers_values& tv) const
 {
     using namespace std;
@@ -109,14 +143,14 @@ bool sender::send_mc_addr_and_src_specific_query(unsigned int if_index, const ti
                 rc = true;
             }
 
-            if (e.shared_source_timer.get() != nullptr) {
-                if (e.shared_source_timer->is_remaining_time_greater_than(tv.get_last_listener_query_time())) {
+            if (e.source_timer != timer_clock::not_running()) {
+                if (timer_clock::now() + tv.get_last_listener_query_time() <= e.source_timer) {
                     list_higher.insert(e);
                 } else {
                     list_lower.insert(e);
                 }
             } else {
-                HC_LOG_ERROR("the shared source timer shouldnt be null");
+                HC_LOG_ERROR("the source timer should be running");
             }
         }
     }
@@ -142,6 +176,11 @@ bool sender::send_record(unsigned int, mc_filter, const addr_storage&, const sou
     return false;
 }
 
+bool sender::send_record_change(unsigned int, const addr_storage&, mc_filter, const source_list<source>&, mc_filter, const source_list<source>&) const
+{
+    return false;
+}
+
 bool sender::send_general_query(unsigned int, const timers_values&) const
 {
     return false;
@@ -158,6 +197,65 @@ bool sender::send_mc_addr_and_src_specific_query(unsigned int, const timers_valu
 
 #endif /* DEBUG_MODE */
 
+bool sender::change_socket_filter(unsigned int if_index, const addr_storage& gaddr, mc_filter old_filter_mode, const source_list<source>& old_slist, mc_filter new_filter_mode, const source_list<source>& new_slist) const
+{
+    HC_LOG_TRACE("");
+
+    bool old_joined = !(old_filter_mode == INCLUDE_MODE && old_slist.empty());
+    bool new_joined = !(new_filter_mode == INCLUDE_MODE && new_slist.empty());
+
+    if (!new_joined) {
+        return old_joined ? m_sock.leave_group(gaddr, if_index) : true;
+    }
+
+    if (!old_joined && new_filter_mode == INCLUDE_MODE) {
+        //join source by source to report ALLOW{S} instead of TO_IN{S}
+        bool rc = true;
+        for (auto & e : new_slist) {
+            rc = m_sock.join_source_group(gaddr, e.saddr, if_index) && rc;
+        }
+        return rc;
+    } else if (old_joined && old_filter_mode == new_filter_mode) {
+        source_list<source> added = new_slist - old_slist;
+        source_list<source> removed = old_slist - new_slist;
+
+        //it is cheaper to replace the filter than to change more sources than it contains,
+        //the kernel reports the difference of the filter anyway
+        if (added.size() + removed.size() <= new_slist.size() + 1) {
+            bool rc = true;
+            if (new_filter_mode == INCLUDE_MODE) {
+                //add first, removing the last source would leave the group
+                for (auto & e : added) {
+                    rc = m_sock.join_source_group(gaddr, e.saddr, if_index) && rc;
+                }
+                for (auto & e : removed) {
+                    rc = m_sock.leave_source_group(gaddr, e.saddr, if_index) && rc;
+                }
+            } else if (new_filter_mode == EXCLUDE_MODE) {
+                for (auto & e : removed) {
+                    rc = m_sock.unblock_source(gaddr, e.saddr, if_index) && rc;
+                }
+                for (auto & e : added) {
+                    rc = m_sock.block_source(gaddr, e.saddr, if_index) && rc;
+                }
+            } else {
+                HC_LOG_ERROR("unknown filter mode");
+                return false;
+            }
+            return rc;
+        }
+    } else if (!old_joined) {
+        m_sock.join_group(gaddr, if_index);
+    }
+
+    std::list<addr_storage> src_list;
+    for (auto & e : new_slist) {
+        src_list.push_back(e.saddr);
+    }
+
+    return m_sock.set_source_filter(if_index, gaddr, new_filter_mode, src_list);
+}
+
 sender::~sender()
 {
     HC_LOG_TRACE("");
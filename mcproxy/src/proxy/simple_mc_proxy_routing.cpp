@@ -32,7 +32,43 @@
 #include "include/proxy/timing.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
+#include <set>
+#include <vector>
+
+//-------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+uint64_t get_channel_weight(const addr_storage& gaddr, const addr_storage& saddr, const std::string& if_name)
+{
+    HC_LOG_TRACE("");
+
+    //FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const void* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<const uint8_t*>(data)[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    for (auto addr : {&gaddr, &saddr}) {
+        if (addr->get_addr_family() == AF_INET) {
+            add(&addr->get_in_addr(), sizeof(in_addr));
+        } else if (addr->get_addr_family() == AF_INET6) {
+            add(&addr->get_in6_addr(), sizeof(in6_addr));
+        }
+    }
+    add(if_name.data(), if_name.size());
+
+    //the low bits of FNV-1a are poorly mixed for similar keys
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
 
 //-------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------
@@ -59,13 +95,14 @@ std::string source_state::to_string() const
 //-------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------
 interface_memberships::interface_memberships(rb_rule_matching_type upstream_in_rule_matching_type, const addr_storage& gaddr, const proxy_instance* pi, const simple_routing_data& routing_data)
+    : m_requested(false)
 {
     HC_LOG_TRACE("");
 
-    if (upstream_in_rule_matching_type == RMT_FIRST) {
-        process_upstream_in_first(gaddr, pi);
-    } else {
+    if (upstream_in_rule_matching_type == RMT_MUTEX) {
         process_upstream_in_mutex(gaddr, pi, routing_data);
+    } else {
+        HC_LOG_ERROR("unkown rule matching type in this context");
     }
 }
 
@@ -95,60 +132,6 @@ void interface_memberships::merge_membership_infos(source_state& merge_to, const
     }
 }
 
-void interface_memberships::process_upstream_in_first(const addr_storage& gaddr, const proxy_instance* pi)
-{
-    HC_LOG_TRACE("");
-
-    state_list init_sstate_list;
-    for (auto & downs_e : pi->m_downstreams) {
-        init_sstate_list.push_back(state_pair(source_state(downs_e.second.m_querier->get_group_membership_infos(gaddr)), downs_e.second.m_interface));
-    }
-
-    //init and fill database
-    for (auto & upstr_e : pi->m_upstreams) {
-
-        state_list tmp_sstate_list;
-
-        for (auto & cs : init_sstate_list) {
-
-            source_state tmp_sstate;
-            tmp_sstate.m_mc_filter = cs.first.m_mc_filter;
-
-            //sort out all unwanted sources
-            for (auto source_it = cs.first.m_source_list.begin(); source_it != cs.first.m_source_list.end();) {
-
-                //downstream out
-                if (!cs.second->match_output_filter(interfaces::get_if_name(upstr_e.m_if_index), gaddr, source_it->saddr)) {
-                    source_it = cs.first.m_source_list.erase(source_it);
-                    continue;
-                }
-
-                //upstream in
-                if (!upstr_e.m_interface->match_input_filter(interfaces::get_if_name(upstr_e.m_if_index), gaddr, source_it->saddr)) {
-                    tmp_sstate.m_source_list.insert(*source_it);
-                    source_it = cs.first.m_source_list.erase(source_it);
-                    continue;
-                }
-
-                ++source_it;
-            }
-
-            if (!tmp_sstate.m_source_list.empty()) {
-                tmp_sstate_list.push_back(state_pair(tmp_sstate, cs.second));
-            }
-
-        }
-
-        std::list<source_state> ret_source_list;
-        for (auto & e : init_sstate_list) {
-            ret_source_list.push_back(std::move(e.first));
-        }
-        m_data.push_back(std::pair<unsigned int, std::list<source_state>>(upstr_e.m_if_index, std::move(ret_source_list)));
-        init_sstate_list = std::move(tmp_sstate_list);
-    }
-
-}
-
 void interface_memberships::process_upstream_in_mutex(const addr_storage& gaddr, const proxy_instance* pi, const simple_routing_data& routing_data)
 {
     HC_LOG_TRACE("");
@@ -157,13 +140,22 @@ void interface_memberships::process_upstream_in_mutex(const addr_storage& gaddr,
 
     for (auto & downs_e : pi->m_downstreams) {
         ref_sstate_list.push_back(state_pair(source_state(downs_e.second.m_querier->get_group_membership_infos(gaddr)), downs_e.second.m_interface));
+        const source_state& sstate = ref_sstate_list.back().first;
+        m_requested = m_requested || sstate.m_mc_filter != INCLUDE_MODE || !sstate.m_source_list.empty();
     }
     //print(ref_sstate_list);
 
+    const std::map<addr_storage, unsigned int>& available_sources = routing_data.get_interface_map(gaddr);
+
+    //available source ==> the states of this->m_data containing the source, a source is kept by one upstream only
+    std::map<addr_storage, std::list<source_state>*> placed_sources;
+
     //init and fill database
     for (auto & upstr_e : pi->m_upstreams) {
 
         std::list<source_state> tmp_sstate_list;
+        std::list<addr_storage> tmp_placed_sources;
+        std::string upstr_name = upstr_e.m_interface->get_if_name();
 
         //for every downstream interface
         for (auto cs_it = ref_sstate_list.begin(); cs_it != ref_sstate_list.end();) {
@@ -175,40 +167,39 @@ void interface_memberships::process_upstream_in_mutex(const addr_storage& gaddr,
             for (auto source_it = cs_it->first.m_source_list.begin(); source_it != cs_it->first.m_source_list.end();) {
 
                 //downstream out
-                if (!cs_it->second->match_output_filter(interfaces::get_if_name(upstr_e.m_if_index), gaddr, source_it->saddr)) {
+                if (!cs_it->second->match_output_filter(upstr_name, gaddr, source_it->saddr)) {
                     ++source_it;
                     continue;
                 }
 
                 //upstream in
-                if (!upstr_e.m_interface->match_input_filter(interfaces::get_if_name(upstr_e.m_if_index), gaddr, source_it->saddr)) {
+                if (!upstr_e.m_interface->match_input_filter(upstr_name, gaddr, source_it->saddr)) {
                     ++source_it;
                     continue;
                 }
 
-                const std::map<addr_storage, unsigned int>& available_sources = routing_data.get_interface_map(gaddr);
                 auto av_src_it = available_sources.find(source_it->saddr);
                 if (av_src_it != available_sources.end()) {
 
                     if (pi->is_upstream(av_src_it->second)) {
                         tmp_sstate.m_source_list.insert(*source_it);
+                        tmp_placed_sources.push_back(source_it->saddr);
                     }
 
                     //clean this->m_data
-                    for (auto & data_e : m_data) {
-                        for (auto sstate_it = data_e.second.begin(); sstate_it != data_e.second.end();) {
-
-                            auto s_it = sstate_it->m_source_list.find(*source_it);
-                            if (s_it != sstate_it->m_source_list.end()) {
-                                sstate_it->m_source_list.erase(s_it);
-                            }
+                    auto placed_it = placed_sources.find(source_it->saddr);
+                    if (placed_it != placed_sources.end()) {
+                        auto& data_sstates = *placed_it->second;
+                        for (auto sstate_it = data_sstates.begin(); sstate_it != data_sstates.end();) {
+                            sstate_it->m_source_list.erase(*source_it);
 
                             if (sstate_it->m_source_list.empty()) {
-                                sstate_it = data_e.second.erase(sstate_it);
+                                sstate_it = data_sstates.erase(sstate_it);
                                 continue;
                             }
                             ++sstate_it;
                         }
+                        placed_sources.erase(placed_it);
                     }
 
                     source_it = cs_it->first.m_source_list.erase(source_it);
@@ -234,6 +225,9 @@ void interface_memberships::process_upstream_in_mutex(const addr_storage& gaddr,
         }
 
         m_data.push_back(std::pair<unsigned int, std::list<source_state>>(upstr_e.m_if_index, std::move(tmp_sstate_list)));
+        for (auto & e : tmp_placed_sources) {
+            placed_sources[e] = &m_data.back().second;
+        }
     }
 
 }
@@ -257,6 +251,12 @@ source_state interface_memberships::get_group_memberships(unsigned int upstream_
     return result;
 }
 
+bool interface_memberships::is_requested() const
+{
+    HC_LOG_TRACE("");
+    return m_requested;
+}
+
 std::string interface_memberships::to_string() const
 {
     std::ostringstream s;
@@ -282,19 +282,663 @@ void interface_memberships::print(const state_list& sl)
 }
 #endif /* DEBUG_MODE */
 
+//-------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+upstream_aggregation::upstream_aggregation()
+    : m_exclude_states(0)
+{
+    HC_LOG_TRACE("");
+}
+
+bool upstream_aggregation::refresh(const addr_storage& saddr)
+{
+    HC_LOG_TRACE("");
+
+    auto include_it = m_include_count.find(saddr);
+    bool in_merged_state;
+    if (m_exclude_states == 0) {
+        in_merged_state = include_it != m_include_count.end();
+    } else {
+        auto exclude_it = m_exclude_count.find(saddr);
+        in_merged_state = include_it == m_include_count.end() && exclude_it != m_exclude_count.end() && exclude_it->second == m_exclude_states;
+    }
+
+    auto& slist = m_merged_state.m_source_list;
+    auto s_it = slist.find(saddr);
+    if (in_merged_state && s_it == slist.end()) {
+        slist.insert(source(saddr));
+        return true;
+    } else if (!in_merged_state && s_it != slist.end()) {
+        slist.erase(s_it);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void upstream_aggregation::refresh_all()
+{
+    HC_LOG_TRACE("");
+
+    m_merged_state.m_source_list.clear();
+    if (m_exclude_states == 0) {
+        m_merged_state.m_mc_filter = INCLUDE_MODE;
+        for (auto & e : m_include_count) {
+            m_merged_state.m_source_list.insert(source(e.first));
+        }
+    } else {
+        m_merged_state.m_mc_filter = EXCLUDE_MODE;
+        for (auto & e : m_exclude_count) {
+            if (e.second == m_exclude_states && m_include_count.find(e.first) == m_include_count.end()) {
+                m_merged_state.m_source_list.insert(source(e.first));
+            }
+        }
+    }
+}
+
+bool upstream_aggregation::add_state(const source_state& sstate)
+{
+    HC_LOG_TRACE("");
+
+    if (sstate.m_mc_filter == EXCLUDE_MODE) {
+        ++m_exclude_states;
+        for (auto & e : sstate.m_source_list) {
+            ++m_exclude_count[e.saddr];
+        }
+        refresh_all();
+        return true;
+    } else {
+        bool changed = false;
+        for (auto & e : sstate.m_source_list) {
+            changed |= add_source(INCLUDE_MODE, e.saddr);
+        }
+        return changed;
+    }
+}
+
+bool upstream_aggregation::del_state(const source_state& sstate)
+{
+    HC_LOG_TRACE("");
+
+    if (sstate.m_mc_filter == EXCLUDE_MODE) {
+        --m_exclude_states;
+        for (auto & e : sstate.m_source_list) {
+            auto it = m_exclude_count.find(e.saddr);
+            if (it != m_exclude_count.end() && --it->second == 0) {
+                m_exclude_count.erase(it);
+            }
+        }
+        refresh_all();
+        return true;
+    } else {
+        bool changed = false;
+        for (auto & e : sstate.m_source_list) {
+            changed |= del_source(INCLUDE_MODE, e.saddr);
+        }
+        return changed;
+    }
+}
+
+bool upstream_aggregation::add_source(mc_filter filter, const addr_storage& saddr)
+{
+    HC_LOG_TRACE("");
+
+    if (filter == INCLUDE_MODE) {
+        ++m_include_count[saddr];
+    } else {
+        ++m_exclude_count[saddr];
+    }
+    return refresh(saddr);
+}
+
+bool upstream_aggregation::del_source(mc_filter filter, const addr_storage& saddr)
+{
+    HC_LOG_TRACE("");
+
+    auto& count = filter == INCLUDE_MODE ? m_include_count : m_exclude_count;
+    auto it = count.find(saddr);
+    if (it == count.end()) {
+        HC_LOG_ERROR("source " << saddr << " not requested");
+        return false;
+    }
+
+    if (--it->second == 0) {
+        count.erase(it);
+    }
+    return refresh(saddr);
+}
+
+const source_state& upstream_aggregation::get_merged_state() const
+{
+    HC_LOG_TRACE("");
+    return m_merged_state;
+}
+
+//-------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+membership_aggregation::membership_aggregation(const proxy_instance* p)
+    : m_p(p)
+    , m_rule_matching_type(RMT_UNDEFINED)
+{
+    HC_LOG_TRACE("");
+}
+
+void membership_aggregation::check_configuration(rb_rule_matching_type rule_matching_type)
+{
+    HC_LOG_TRACE("");
+
+    bool valid = m_rule_matching_type == rule_matching_type && m_upstreams.size() == m_p->m_upstreams.size();
+    if (valid) {
+        auto it = m_upstreams.begin();
+        for (auto & e : m_p->m_upstreams) {
+            if (it->m_if_index != e.m_if_index || it->m_interface != e.m_interface) {
+                valid = false;
+                break;
+            }
+            ++it;
+        }
+    }
+
+    if (!valid) {
+        HC_LOG_DEBUG("upstream configuration changed, recalculate all upstream memberships");
+        clear();
+        m_rule_matching_type = rule_matching_type;
+        for (auto & e : m_p->m_upstreams) {
+            m_upstreams.push_back(upstream(e.m_if_index, e.m_interface->get_if_name(), e.m_interface));
+        }
+    }
+}
+
+bool membership_aggregation::is_any_source_upstream(const group_state& group, unsigned int upstream_if_index) const
+{
+    HC_LOG_TRACE("");
+
+    auto upstream_it = group.m_upstreams.find(upstream_if_index);
+    return upstream_it != group.m_upstreams.end() && upstream_it->second.get_merged_state().m_mc_filter == EXCLUDE_MODE;
+}
+
+pooled_list<unsigned int> membership_aggregation::get_any_source_upstreams(const group_state& group) const
+{
+    HC_LOG_TRACE("");
+
+    pooled_list<unsigned int> result;
+    if (m_rule_matching_type == RMT_HASH) {
+        for (auto & e : m_upstreams) {
+            if (is_any_source_upstream(group, e.m_if_index)) {
+                result.push_back(e.m_if_index);
+            }
+        }
+    }
+    return result;
+}
+
+unsigned int membership_aggregation::place_group(const addr_storage& gaddr, const interface& downstream_interface) const
+{
+    HC_LOG_TRACE("");
+
+    //the filters are matched with the wildcard source, the weight is calculated with the empty source of (*,G)
+    addr_storage any_source(gaddr.get_addr_family());
+    unsigned int result = 0;
+    uint64_t result_weight = 0;
+    for (auto & e : m_upstreams) {
+        if (downstream_interface.match_output_filter(e.m_if_name, gaddr, any_source) && e.m_interface->match_input_filter(e.m_if_name, gaddr, any_source)) {
+            uint64_t weight = get_channel_weight(gaddr, addr_storage(), e.m_if_name);
+            if (result == 0 || weight > result_weight) {
+                result = e.m_if_index;
+                result_weight = weight;
+            }
+        }
+    }
+    return result;
+}
+
+unsigned int membership_aggregation::place_source(const addr_storage& gaddr, const addr_storage& saddr, const interface& downstream_interface, const group_state& group) const
+{
+    HC_LOG_TRACE("");
+
+    if (m_rule_matching_type == RMT_HASH) {
+        //an upstream joining the group in EXCLUDE mode receives the source anyway, so the source is requested from
+        //this upstream instead of the upstream of its channel (S,G), otherwise the traffic arrives on both upstreams
+        for (bool any_source_upstreams : {true, false}) {
+            unsigned int result = 0;
+            uint64_t result_weight = 0;
+            for (auto & e : m_upstreams) {
+                if (any_source_upstreams && !is_any_source_upstream(group, e.m_if_index)) {
+                    continue;
+                }
+
+                if (downstream_interface.match_output_filter(e.m_if_name, gaddr, saddr) && e.m_interface->match_input_filter(e.m_if_name, gaddr, saddr)) {
+                    uint64_t weight = get_channel_weight(gaddr, saddr, e.m_if_name);
+                    if (result == 0 || weight > result_weight) {
+                        result = e.m_if_index;
+                        result_weight = weight;
+                    }
+                }
+            }
+
+            if (result != 0) {
+                return result;
+            }
+        }
+        return 0;
+    } else { //RMT_FIRST
+        for (auto & e : m_upstreams) {
+            //downstream out
+            if (!downstream_interface.match_output_filter(e.m_if_name, gaddr, saddr)) {
+                return 0;
+            }
+
+            //upstream in, otherwise try the next upstream
+            if (e.m_interface->match_input_filter(e.m_if_name, gaddr, saddr)) {
+                return e.m_if_index;
+            }
+        }
+        return 0;
+    }
+}
+
+bool membership_aggregation::is_exclude_delta_placeable(const addr_storage& gaddr, const membership_delta& delta, const interface& downstream_interface) const
+{
+    HC_LOG_TRACE("");
+
+    if (m_rule_matching_type == RMT_HASH) {
+        return true;
+    } else if (m_upstreams.empty()) {
+        return false;
+    }
+
+    //a source the first upstream does not accept is excluded on the next upstreams (see place_state)
+    auto& first = m_upstreams.front();
+    for (auto slist : {&delta.added_sources, &delta.removed_sources}) {
+        for (auto & s : *slist) {
+            if (downstream_interface.match_output_filter(first.m_if_name, gaddr, s.saddr) && !first.m_interface->match_input_filter(first.m_if_name, gaddr, s.saddr)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+pooled_map<unsigned int, source_state> membership_aggregation::place_state(const addr_storage& gaddr, const source_state& sstate, const interface& downstream_interface, const group_state& group) const
+{
+    HC_LOG_TRACE("");
+
+    pooled_map<unsigned int, source_state> result;
+
+    if (sstate.m_mc_filter == INCLUDE_MODE) {
+        for (auto & e : sstate.m_source_list) {
+            unsigned int upstream_if_index = place_source(gaddr, e.saddr, downstream_interface, group);
+            if (upstream_if_index != 0) {
+                result[upstream_if_index].m_source_list.insert(source(e.saddr));
+            }
+        }
+    } else if (m_rule_matching_type == RMT_HASH) {
+        //the group is a single channel (*,G)
+        unsigned int upstream_if_index = place_group(gaddr, downstream_interface);
+        if (upstream_if_index != 0) {
+            result[upstream_if_index].m_mc_filter = EXCLUDE_MODE;
+            for (auto & e : sstate.m_source_list) {
+                result[upstream_if_index].m_source_list.insert(source(e.saddr));
+            }
+        }
+    } else { //RMT_FIRST
+        //the first upstream gets the state, the next ones only the excluded sources the previous upstream does not accept
+        source_list<source> slist;
+        for (auto & e : sstate.m_source_list) {
+            slist.insert(source(e.saddr));
+        }
+
+        bool first_upstream = true;
+        for (auto & e : m_upstreams) {
+            if (!first_upstream && slist.empty()) {
+                break;
+            }
+
+            source_state& request = result[e.m_if_index];
+            request.m_mc_filter = EXCLUDE_MODE;
+
+            source_list<source> next_slist;
+            for (auto & s : slist) {
+                //downstream out
+                if (!downstream_interface.match_output_filter(e.m_if_name, gaddr, s.saddr)) {
+                    continue;
+                }
+
+                //upstream in
+                if (!e.m_interface->match_input_filter(e.m_if_name, gaddr, s.saddr)) {
+                    next_slist.insert(s);
+                    continue;
+                }
+
+                request.m_source_list.insert(s);
+            }
+
+            slist = std::move(next_slist);
+            first_upstream = false;
+        }
+    }
+
+    return result;
+}
+
+void membership_aggregation::del_request(group_state& group, unsigned int upstream_if_index, const source_state& request, pooled_set<unsigned int>& changed_upstreams)
+{
+    HC_LOG_TRACE("");
+
+    if (group.m_upstreams[upstream_if_index].del_state(request)) {
+        changed_upstreams.insert(upstream_if_index);
+    }
+}
+
+void membership_aggregation::add_request(group_state& group, unsigned int upstream_if_index, const source_state& request, pooled_set<unsigned int>& changed_upstreams)
+{
+    HC_LOG_TRACE("");
+
+    if (group.m_upstreams[upstream_if_index].add_state(request)) {
+        changed_upstreams.insert(upstream_if_index);
+    }
+}
+
+void membership_aggregation::change_request(group_state& group, unsigned int upstream_if_index, const source_state& old_request, const source_state& new_request, pooled_set<unsigned int>& changed_upstreams)
+{
+    HC_LOG_TRACE("");
+
+    if (old_request.m_mc_filter != new_request.m_mc_filter) {
+        del_request(group, upstream_if_index, old_request, changed_upstreams);
+        add_request(group, upstream_if_index, new_request, changed_upstreams);
+        return;
+    }
+
+    //only the difference of both requests
+    auto& aggregation = group.m_upstreams[upstream_if_index];
+    bool changed = false;
+    auto old_it = old_request.m_source_list.begin();
+    auto new_it = new_request.m_source_list.begin();
+    while (old_it != old_request.m_source_list.end() || new_it != new_request.m_source_list.end()) {
+        if (new_it == new_request.m_source_list.end() || (old_it != old_request.m_source_list.end() && *old_it < *new_it)) {
+            changed |= aggregation.del_source(old_request.m_mc_filter, old_it->saddr);
+            ++old_it;
+        } else if (old_it == old_request.m_source_list.end() || *new_it < *old_it) {
+            changed |= aggregation.add_source(new_request.m_mc_filter, new_it->saddr);
+            ++new_it;
+        } else {
+            ++old_it;
+            ++new_it;
+        }
+    }
+
+    if (changed) {
+        changed_upstreams.insert(upstream_if_index);
+    }
+}
+
+void membership_aggregation::update_downstream(const addr_storage& gaddr, group_state& group, unsigned int if_index, const membership_delta* delta, pooled_set<unsigned int>& changed_upstreams, bool replace)
+{
+    HC_LOG_TRACE("");
+
+    auto downs_it = m_p->m_downstreams.find(if_index);
+    auto state_it = group.m_downstreams.find(if_index);
+    const interface* interf = downs_it != m_p->m_downstreams.end() ? downs_it->second.m_interface.get() : nullptr;
+
+    if (state_it == group.m_downstreams.end()) {
+        if (interf == nullptr || replace) {
+            return;
+        }
+        state_it = group.m_downstreams.insert(std::make_pair(if_index, downstream_state(interf))).first;
+    }
+
+    auto& ds = state_it->second;
+    auto& sstate = ds.m_state;
+
+    bool same_filter_mode = delta != nullptr && !replace && interf != nullptr && ds.m_interface == interf && sstate.m_mc_filter == delta->new_filter_mode;
+
+    if (same_filter_mode && sstate.m_mc_filter == INCLUDE_MODE) {
+        //place only the changed sources
+        for (auto & s : delta->removed_sources) {
+            if (sstate.m_source_list.erase(s) == 0) {
+                continue;
+            }
+
+            for (auto request_it = ds.m_requests.begin(); request_it != ds.m_requests.end(); ++request_it) {
+                if (request_it->second.m_source_list.erase(s) > 0) {
+                    if (group.m_upstreams[request_it->first].del_source(INCLUDE_MODE, s.saddr)) {
+                        changed_upstreams.insert(request_it->first);
+                    }
+                    if (request_it->second.m_source_list.empty()) {
+                        ds.m_requests.erase(request_it);
+                    }
+                    break;
+                }
+            }
+        }
+
+        for (auto & s : delta->added_sources) {
+            if (!sstate.m_source_list.insert(s).second) {
+                continue;
+            }
+
+            unsigned int upstream_if_index = place_source(gaddr, s.saddr, *interf, group);
+            if (upstream_if_index != 0) {
+                ds.m_requests[upstream_if_index].m_source_list.insert(source(s.saddr));
+                if (group.m_upstreams[upstream_if_index].add_source(INCLUDE_MODE, s.saddr)) {
+                    changed_upstreams.insert(upstream_if_index);
+                }
+            }
+        }
+    } else if (same_filter_mode && sstate.m_mc_filter == EXCLUDE_MODE && is_exclude_delta_placeable(gaddr, *delta, *interf)) {
+        //exclude only the changed sources, the requests of the downstream keep their upstreams
+        for (auto & s : delta->removed_sources) {
+            if (sstate.m_source_list.erase(s) == 0) {
+                continue;
+            }
+
+            for (auto & e : ds.m_requests) {
+                if (e.second.m_source_list.erase(s) > 0) {
+                    if (group.m_upstreams[e.first].del_source(EXCLUDE_MODE, s.saddr)) {
+                        changed_upstreams.insert(e.first);
+                    }
+                    break;
+                }
+            }
+        }
+
+        for (auto & s : delta->added_sources) {
+            if (!sstate.m_source_list.insert(s).second) {
+                continue;
+            }
+
+            //the single request of the any source channel (RMT_HASH) or the request of the first upstream (RMT_FIRST)
+            auto request_it = ds.m_requests.begin();
+            if (m_rule_matching_type != RMT_HASH) {
+                request_it = ds.m_requests.find(m_upstreams.front().m_if_index);
+                if (!interf->match_output_filter(m_upstreams.front().m_if_name, gaddr, s.saddr)) {
+                    continue;
+                }
+            }
+
+            if (request_it != ds.m_requests.end()) {
+                request_it->second.m_source_list.insert(source(s.saddr));
+                if (group.m_upstreams[request_it->first].add_source(EXCLUDE_MODE, s.saddr)) {
+                    changed_upstreams.insert(request_it->first);
+                }
+            }
+        }
+    } else {
+        //the filter mode, the rule bindings, the any source upstreams or the upstreams of an EXCLUDE state changed,
+        //place the whole state
+        if (interf == nullptr) {
+            sstate = source_state();
+        } else if (delta != nullptr) {
+            if (sstate.m_mc_filter != delta->new_filter_mode) {
+                sstate.m_mc_filter = delta->new_filter_mode;
+                sstate.m_source_list.clear();
+            } else {
+                sstate.m_source_list -= delta->removed_sources;
+            }
+            sstate.m_source_list += delta->added_sources;
+        } else if (!replace) {
+            sstate = source_state(downs_it->second.m_querier->get_group_membership_infos(gaddr));
+        }
+
+        pooled_map<unsigned int, source_state> new_requests;
+        if (interf != nullptr) {
+            new_requests = place_state(gaddr, sstate, *interf, group);
+        }
+
+        for (auto & e : ds.m_requests) {
+            auto new_request_it = new_requests.find(e.first);
+            if (new_request_it == new_requests.end()) {
+                del_request(group, e.first, e.second, changed_upstreams);
+            } else {
+                change_request(group, e.first, e.second, new_request_it->second, changed_upstreams);
+            }
+        }
+
+        for (auto & e : new_requests) {
+            if (ds.m_requests.find(e.first) == ds.m_requests.end()) {
+                add_request(group, e.first, e.second, changed_upstreams);
+            }
+        }
+
+        ds.m_requests = std::move(new_requests);
+        ds.m_interface = interf;
+    }
+
+    if (sstate.m_mc_filter == INCLUDE_MODE && sstate.m_source_list.empty()) {
+        group.m_downstreams.erase(state_it);
+    }
+}
+
+pooled_list<unsigned int> membership_aggregation::update(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr, unsigned int downstream_if_index, const membership_delta* delta)
+{
+    HC_LOG_TRACE("");
+
+    check_configuration(rule_matching_type);
+
+    auto group_it = m_groups.find(gaddr);
+    bool all_downstreams = downstream_if_index == 0 || group_it == m_groups.end();
+    if (group_it == m_groups.end()) {
+        group_it = m_groups.insert(std::make_pair(gaddr, group_state())).first;
+    }
+    auto& group = group_it->second;
+
+    pooled_set<unsigned int> changed_upstreams;
+    pooled_list<unsigned int> any_source_upstreams = get_any_source_upstreams(group);
+
+    //withdraw the requests of removed downstreams
+    pooled_list<unsigned int> removed_downstreams;
+    for (auto & e : group.m_downstreams) {
+        if (!m_p->is_downstream(e.first)) {
+            removed_downstreams.push_back(e.first);
+        }
+    }
+    for (auto if_index : removed_downstreams) {
+        update_downstream(gaddr, group, if_index, nullptr, changed_upstreams);
+    }
+
+    //a group unknown to the aggregation (new or after a configuration change) is read from the queriers once
+    if (all_downstreams) {
+        for (auto & e : m_p->m_downstreams) {
+            update_downstream(gaddr, group, e.first, nullptr, changed_upstreams);
+        }
+    } else {
+        update_downstream(gaddr, group, downstream_if_index, delta, changed_upstreams);
+    }
+
+    //an upstream joined or left the any source channel (*,G), the INCLUDE states follow it
+    if (get_any_source_upstreams(group) != any_source_upstreams) {
+        pooled_list<unsigned int> include_downstreams;
+        for (auto & e : group.m_downstreams) {
+            if (e.second.m_state.m_mc_filter == INCLUDE_MODE) {
+                include_downstreams.push_back(e.first);
+            }
+        }
+        for (auto if_index : include_downstreams) {
+            update_downstream(gaddr, group, if_index, nullptr, changed_upstreams, true);
+        }
+    }
+
+    pooled_list<unsigned int> result;
+    for (auto & e : m_upstreams) {
+        if (all_downstreams || changed_upstreams.find(e.m_if_index) != changed_upstreams.end()) {
+            result.push_back(e.m_if_index);
+        }
+    }
+
+    //no downstream requests the group anymore
+    if (group.m_downstreams.empty()) {
+        m_groups.erase(group_it);
+    }
+
+    return result;
+}
+
+source_state membership_aggregation::get_group_memberships(const addr_storage& gaddr, unsigned int upstream_if_index) const
+{
+    HC_LOG_TRACE("");
+
+    auto group_it = m_groups.find(gaddr);
+    if (group_it != m_groups.end()) {
+        auto upstream_it = group_it->second.m_upstreams.find(upstream_if_index);
+        if (upstream_it != group_it->second.m_upstreams.end()) {
+            return upstream_it->second.get_merged_state();
+        }
+    }
+
+    return source_state();
+}
+
+bool membership_aggregation::is_requested(const addr_storage& gaddr) const
+{
+    HC_LOG_TRACE("");
+    return m_groups.find(gaddr) != m_groups.end();
+}
+
+void membership_aggregation::clear()
+{
+    HC_LOG_TRACE("");
+    m_groups.clear();
+    m_upstreams.clear();
+    m_rule_matching_type = RMT_UNDEFINED;
+}
+
 //-------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------
 simple_mc_proxy_routing::simple_mc_proxy_routing(const proxy_instance* p)
     : routing_management(p)
-    , m_data(p->m_group_mem_protocol, p->m_mrt_sock)
+    , m_data(p->m_group_mem_protocol, p->m_kernel)
+    , m_aggregation(p)
+    , m_held_leave_count(0)
+    , m_absorbed_flap_count(0)
 {
     HC_LOG_TRACE("");
 }
 
-std::chrono::seconds simple_mc_proxy_routing::get_source_life_time()
+std::chrono::milliseconds simple_mc_proxy_routing::get_source_life_time(const std::shared_ptr<new_source_timer_msg>& expired_timer, unsigned long packets, double& packet_rate) const
 {
     HC_LOG_TRACE("");
-    return std::chrono::seconds(20);
+
+    std::chrono::milliseconds min_life_time = std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_MIN);
+    packet_rate = 0;
+    if (expired_timer == nullptr) {
+        return min_life_time;
+    }
+
+    auto life_time = expired_timer->get_life_time();
+    packet_rate = packets * 1000.0 / life_time.count();
+
+    //a bursty source is checked faster with each check, the first check of a source has no previous rate
+    double previous_rate = expired_timer->get_packet_rate();
+    if (previous_rate > 0 && (packet_rate * 2 < previous_rate || packet_rate > previous_rate * 2)) {
+        return std::max<std::chrono::milliseconds>(life_time / 2, std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_BURST));
+    }
+
+    //a slow source is checked again after the minimum life time
+    if (packet_rate < SIMPLE_MC_PROXY_ROUTING_STEADY_SOURCE_RATE) {
+        return min_life_time;
+    }
+
+    return std::min<std::chrono::milliseconds>(std::max(life_time, min_life_time) * 2, std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_SOURCE_LIFE_TIME_MAX));
 }
 
 void simple_mc_proxy_routing::event_new_source(const std::shared_ptr<proxy_msg>& msg)
@@ -325,21 +969,34 @@ void simple_mc_proxy_routing::event_new_source(const std::shared_ptr<proxy_msg>&
     }
 }
 
-void simple_mc_proxy_routing::event_querier_state_change(unsigned int /*if_index*/, const addr_storage& gaddr)
+void simple_mc_proxy_routing::event_querier_state_change(unsigned int if_index, const addr_storage& gaddr, const membership_delta& delta)
 {
     HC_LOG_TRACE("");
+    process_state_change(if_index, gaddr, &delta);
+}
 
-    //route calculation
-    set_routes(gaddr, collect_interested_interfaces(gaddr, m_data.get_available_sources(gaddr)));
+void simple_mc_proxy_routing::process_state_change(unsigned int if_index, const addr_storage& gaddr, const membership_delta* delta)
+{
+    HC_LOG_TRACE("");
 
-    //membership agregation
+    //membership agregation, before the routes are calculated to know whether a leave is held back
+    bool requested = false;
     if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_FIRST)) {
-        process_membership_aggregation(RMT_FIRST, gaddr);
+        requested = process_membership_aggregation(RMT_FIRST, gaddr, if_index, delta);
+    } else if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_HASH)) {
+        requested = process_membership_aggregation(RMT_HASH, gaddr, if_index, delta);
     } else if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_MUTEX)) {
-        process_membership_aggregation(RMT_MUTEX, gaddr);
+        requested = process_membership_aggregation(RMT_MUTEX, gaddr);
     } else {
         HC_LOG_ERROR("unkown rule matching type in this context");
     }
+
+    if (if_index != 0 && get_predictive_groups() > 0) {
+        count_join(gaddr, requested);
+    }
+
+    //route calculation
+    set_routes(gaddr, collect_interested_interfaces(gaddr, m_data.get_available_sources(gaddr)));
 }
 
 void simple_mc_proxy_routing::timer_triggerd_maintain_routing_table(const std::shared_ptr<proxy_msg>& msg)
@@ -348,44 +1005,161 @@ void simple_mc_proxy_routing::timer_triggerd_maintain_routing_table(const std::s
 
     std::shared_ptr<new_source_timer_msg> tm;
 
-    if (!msg.unique()) {
-        switch (msg->get_type()) {
-        case proxy_msg::NEW_SOURCE_TIMER_MSG: {
-            tm = std::static_pointer_cast<new_source_timer_msg>(msg);
+    //a timer is outdated if its owner refers to another timer message
+    switch (msg->get_type()) {
+    case proxy_msg::UPSTREAM_REPORT_TIMER_MSG: {
+        auto rtm = std::static_pointer_cast<upstream_report_timer_msg>(msg);
+        auto timer_it = m_report_timers.find(rtm->get_if_index());
+        if (timer_it != m_report_timers.end() && timer_it->second.get() == rtm.get()) {
+            flush_pending_records(rtm->get_if_index());
+        } else {
+            HC_LOG_DEBUG("report timer is outdate");
+        }
+    }
+    break;
+    case proxy_msg::LEAVE_HOLD_DOWN_TIMER_MSG: {
+        auto htm = std::static_pointer_cast<leave_hold_down_timer_msg>(msg);
+        auto held_it = m_held_leaves.find(htm->get_if_index());
+        if (held_it == m_held_leaves.end()) {
+            HC_LOG_DEBUG("hold-down timer is outdate");
+            break;
+        }
 
-            auto cmp_source_lst = m_data.get_available_sources(tm->get_gaddr());
-            auto cmp_source_it = cmp_source_lst.find(tm->get_saddr());
-            if (cmp_source_it != cmp_source_lst.end()) {
-                if (tm.get() == cmp_source_it->shared_source_timer.get()) {
-                    auto saddr_it = m_data.refresh_source_or_del_it_if_unused(tm->get_gaddr(), tm->get_saddr());
-                    if (!saddr_it.second) {
+        auto gaddr_it = held_it->second.find(htm->get_gaddr());
+        if (gaddr_it == held_it->second.end() || gaddr_it->second.get() != htm.get()) {
+            HC_LOG_DEBUG("hold-down timer is outdate");
+            break;
+        }
 
-                        del_route(tm->get_if_index(), tm->get_gaddr(), tm->get_saddr());
+        held_it->second.erase(gaddr_it);
+        if (held_it->second.empty()) {
+            m_held_leaves.erase(held_it);
+        }
 
-                        if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_MUTEX)) {
-                            process_membership_aggregation(RMT_MUTEX, tm->get_gaddr());
-                        }
-                    } else {
-                        saddr_it.first->shared_source_timer = set_source_timer(tm->get_if_index(), tm->get_gaddr(), tm->get_saddr());
+        //no join during the hold-down, the leave is sent and the kept forwarding rules are deleted
+        send_record(htm->get_if_index(), htm->get_gaddr(), add_prejoin_state(htm->get_if_index(), htm->get_gaddr(), source_state()), false);
+        set_routes(htm->get_gaddr(), collect_interested_interfaces(htm->get_gaddr(), m_data.get_available_sources(htm->get_gaddr())));
+    }
+    break;
+    case proxy_msg::PREJOIN_TIMER_MSG:
+        if (msg.get() == m_prejoin_timer.get()) {
+            m_prejoin_timer = make_pooled_msg<prejoin_timer_msg>(std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL));
+            m_p->m_timing->add_time(std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL), m_p, m_prejoin_timer);
+            update_predicted_groups();
+        } else {
+            HC_LOG_DEBUG("prejoin timer is outdate");
+        }
+        break;
+    case proxy_msg::NEW_SOURCE_TIMER_MSG: {
+        tm = std::static_pointer_cast<new_source_timer_msg>(msg);
+
+        //the timer refers to its source until the source is deleted or the timer is replaced
+        const source* cmp_source = tm->get_source();
+        if (cmp_source != nullptr) {
+            if (tm.get() == cmp_source->shared_source_timer.get()) {
+                unsigned long packets = 0;
+                bool refreshed = m_data.refresh_source_or_del_it_if_unused(tm->get_gaddr(), *cmp_source, &packets);
+                bool kernel_route = del_kernel_route(tm->get_gaddr(), tm->get_saddr());
+                if (!refreshed) {
+
+                    del_route(tm->get_if_index(), tm->get_gaddr(), tm->get_saddr());
+
+                    if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_MUTEX)) {
+                        process_membership_aggregation(RMT_MUTEX, tm->get_gaddr());
                     }
-
                 } else {
-                    HC_LOG_DEBUG("filter_timer is outdate");
+                    m_data.set_source_timer(*cmp_source, set_source_timer(tm->get_if_index(), tm->get_gaddr(), tm->get_saddr(), tm, packets));
+
+                    //reconcile the forwarding rule taken over from the kernel with the learned memberships
+                    if (kernel_route) {
+                        set_routes(tm->get_gaddr(), collect_interested_interfaces(tm->get_gaddr(), {tm->get_saddr()}));
+                    }
                 }
+
+            } else {
+                HC_LOG_DEBUG("filter_timer is outdate");
+            }
+        }
+
+    }
+    break;
+    default:
+        HC_LOG_ERROR("unknown timer message format");
+        return;
+    }
+}
+
+void simple_mc_proxy_routing::event_configuration_change()
+{
+    HC_LOG_TRACE("");
+
+    std::set<addr_storage> gaddrs;
+
+    //the upstream memberships are recalculated with the new rule bindings
+    m_aggregation.clear();
+
+    //leave all groups of removed upstreams
+    for (auto it = m_reported_states.begin(); it != m_reported_states.end();) {
+        if (!m_p->is_upstream(it->first)) {
+            auto reported_states = it->second;
+            for (auto & e : reported_states) {
+                report_state_change(it->first, e.first, source_state());
+            }
+            m_pending_records.erase(it->first);
+            m_report_timers.erase(it->first);
+            m_held_leaves.erase(it->first);
+            it = m_reported_states.erase(it);
+        } else {
+            for (auto & e : it->second) {
+                gaddrs.insert(e.first);
             }
+            ++it;
+        }
+    }
 
+    for (auto & e : m_p->m_downstreams) {
+        for (auto & gaddr : e.second.m_querier->get_group_addrs()) {
+            gaddrs.insert(gaddr);
         }
-        break;
-        default:
-            HC_LOG_ERROR("unknown timer message format");
-            return;
+    }
+
+    //new static prejoins are reported, the removed ones are left with the reported states
+    for (auto & rb : m_p->m_prejoin_rules) {
+        for (auto & e : rb->get_prejoins()) {
+            gaddrs.insert(e.first);
+        }
+    }
+
+    if (get_predictive_groups() > 0) {
+        if (m_prejoin_timer == nullptr) {
+            m_prejoin_timer = make_pooled_msg<prejoin_timer_msg>(std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL));
+            m_p->m_timing->add_time(std::chrono::seconds(SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL), m_p, m_prejoin_timer);
         }
     } else {
-        HC_LOG_DEBUG("filter_timer is outdate");
-        return;
+        m_prejoin_timer = nullptr;
+        m_join_scores.clear();
+        m_requested_groups.clear();
+        m_predicted_groups.clear();
+    }
+
+    //recalculate the routes and the upstream memberships with the new rule bindings
+    for (auto & gaddr : gaddrs) {
+        process_state_change(0, gaddr, nullptr);
     }
 }
 
+void simple_mc_proxy_routing::event_kernel_route(unsigned int input_if_index, const addr_storage& gaddr, const addr_storage& saddr, const std::list<unsigned int>& output_if_indexes)
+{
+    HC_LOG_TRACE("");
+
+    //the forwarding rule is already set in the kernel table, so it is only registered
+    source s(saddr);
+    s.shared_source_timer = set_source_timer(input_if_index, gaddr, saddr);
+    m_data.set_source(input_if_index, gaddr, s);
+
+    m_kernel_routes[gaddr][saddr] = output_if_indexes;
+}
+
 bool simple_mc_proxy_routing::is_rule_matching_type(rb_interface_type interface_type, rb_interface_direction interface_direction, rb_rule_matching_type rule_matching_type) const
 {
     HC_LOG_TRACE("");
@@ -415,14 +1189,14 @@ bool simple_mc_proxy_routing::is_rule_matching_type(rb_interface_type interface_
     }
 }
 
-std::list<std::pair<source, std::list<unsigned int>>> simple_mc_proxy_routing::collect_interested_interfaces(const addr_storage& gaddr, const source_list<source>& slist) const
+pooled_list<std::pair<source, pooled_list<unsigned int>>> simple_mc_proxy_routing::collect_interested_interfaces(const addr_storage& gaddr, const source_list<source>& slist) const
 {
     HC_LOG_TRACE("");
 
     const std::map<addr_storage, unsigned int>& input_if_index_map = m_data.get_interface_map(gaddr);
 
     //add upstream interfaces
-    std::list<std::pair<source, std::list<unsigned int>>> rt_list;
+    pooled_list<std::pair<source, pooled_list<unsigned int>>> rt_list;
     for (auto & s : slist) {
 
         auto input_if_it = input_if_index_map.find(s.saddr);
@@ -438,7 +1212,9 @@ std::list<std::pair<source, std::list<unsigned int>>> simple_mc_proxy_routing::c
                 continue;
             }
 
-            std::list<unsigned int> up_if_list;
+            pooled_list<unsigned int> up_if_list;
+            unsigned int hash_if_index = 0;
+            uint64_t hash_weight = 0;
             for (auto ui : m_p->m_upstreams) {
                 if (check_interface(IT_UPSTREAM, ID_OUT, ui.m_if_index, input_if_it->second, gaddr, s.saddr)) {
 
@@ -447,21 +1223,31 @@ std::list<std::pair<source, std::list<unsigned int>>> simple_mc_proxy_routing::c
                     } else if (is_rule_matching_type(IT_UPSTREAM, ID_OUT, RMT_FIRST)) {
                         up_if_list.push_back(ui.m_if_index);
                         break;
+                    } else if (is_rule_matching_type(IT_UPSTREAM, ID_OUT, RMT_HASH)) {
+                        uint64_t weight = get_channel_weight(gaddr, s.saddr, ui.m_interface->get_if_name());
+                        if (hash_if_index == 0 || weight > hash_weight) {
+                            hash_if_index = ui.m_if_index;
+                            hash_weight = weight;
+                        }
                     } else {
                         HC_LOG_ERROR("unknown rule matching type");
                     }
 
                 }
             }
-            rt_list.push_back(std::pair<source, std::list<unsigned int>>(s, up_if_list));
+
+            if (hash_if_index != 0) {
+                up_if_list.push_back(hash_if_index);
+            }
+            rt_list.push_back(std::pair<source, pooled_list<unsigned int>>(s, std::move(up_if_list)));
 
         } else { //data from an upstream are not forwarded to an other upstream interface
-            rt_list.push_back(std::pair<source, std::list<unsigned int>>(s, {}));
+            rt_list.push_back(std::pair<source, pooled_list<unsigned int>>(s, {}));
         }
     }
 
     //add downstream interfaces
-    std::function<bool(unsigned int, const addr_storage&)> filter_fun = [&](unsigned int output_if_index, const addr_storage & saddr) {
+    auto filter_fun = [&](unsigned int output_if_index, const addr_storage & saddr) {
         auto input_if_it = input_if_index_map.find(saddr);
         if (input_if_it == input_if_index_map.end()) {
             HC_LOG_ERROR("input interface of multicast source " << saddr << " not found");
@@ -476,34 +1262,60 @@ std::list<std::pair<source, std::list<unsigned int>>> simple_mc_proxy_routing::c
     };
 
     for (auto & dif : m_p->m_downstreams) {
-        dif.second.m_querier->suggest_to_forward_traffic(gaddr, rt_list, std::bind(filter_fun, dif.first, std::placeholders::_1));
+        //captures only a reference and the if_index, so the std::function is stored without a heap allocation
+        unsigned int output_if_index = dif.first;
+        dif.second.m_querier->suggest_to_forward_traffic(gaddr, rt_list, [&filter_fun, output_if_index](const addr_storage & saddr) {
+            return filter_fun(output_if_index, saddr);
+        });
     }
 
     return rt_list;
 }
 
-void simple_mc_proxy_routing::process_membership_aggregation(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr)
+bool simple_mc_proxy_routing::process_membership_aggregation(rb_rule_matching_type rule_matching_type, const addr_storage& gaddr, unsigned int downstream_if_index, const membership_delta* delta)
 {
     HC_LOG_TRACE("");
 
-    if (rule_matching_type == RMT_FIRST || rule_matching_type == RMT_MUTEX) {
+    if (rule_matching_type == RMT_FIRST || rule_matching_type == RMT_HASH) {
+        for (auto upstream_if_index : m_aggregation.update(rule_matching_type, gaddr, downstream_if_index, delta)) {
+            send_record(upstream_if_index, gaddr, add_prejoin_state(upstream_if_index, gaddr, m_aggregation.get_group_memberships(gaddr, upstream_if_index)));
+        }
+        return m_aggregation.is_requested(gaddr);
+    } else if (rule_matching_type == RMT_MUTEX) {
         interface_memberships im(rule_matching_type , gaddr, m_p, m_data);
         for (auto & e : m_p->m_upstreams) {
-            send_record(e.m_if_index, gaddr, im.get_group_memberships(e.m_if_index));
+            send_record(e.m_if_index, gaddr, add_prejoin_state(e.m_if_index, gaddr, im.get_group_memberships(e.m_if_index)));
         }
+        return im.is_requested();
     } else {
         HC_LOG_ERROR("unkown rule matching type in this context");
+        return false;
     }
 }
 
-void simple_mc_proxy_routing::set_routes(const addr_storage& gaddr, const std::list<std::pair<source, std::list<unsigned int>>>& output_if_index) const
+void simple_mc_proxy_routing::set_routes(const addr_storage& gaddr, const pooled_list<std::pair<source, pooled_list<unsigned int>>>& output_if_index) const
 {
     HC_LOG_TRACE("");
 
     const std::map<addr_storage, unsigned int>& input_if_index_map = m_data.get_interface_map(gaddr);
     unsigned int input_if_index;
 
-    for (auto & e : output_if_index) {
+    for (auto & r : output_if_index) {
+        auto e = r;
+
+        //a forwarding rule taken over from the kernel does not lose output interfaces before it is reconciled
+        auto kernel_gaddr_it = m_kernel_routes.find(gaddr);
+        if (kernel_gaddr_it != m_kernel_routes.end()) {
+            auto kernel_saddr_it = kernel_gaddr_it->second.find(e.first.saddr);
+            if (kernel_saddr_it != kernel_gaddr_it->second.end()) {
+                for (auto outif : kernel_saddr_it->second) {
+                    if (std::find(e.second.begin(), e.second.end(), outif) == e.second.end()) {
+                        e.second.push_back(outif);
+                    }
+                }
+            }
+        }
+
         if (e.second.empty()) {
 
             auto input_if_it = input_if_index_map.find(e.first.saddr);
@@ -514,9 +1326,14 @@ void simple_mc_proxy_routing::set_routes(const addr_storage& gaddr, const std::l
                 continue;
             }
 
-            del_route(input_if_index, gaddr, e.first.saddr);
+            if (is_held_down(gaddr) || is_prejoined(gaddr)) {
+                //the upstream is still joined, so the forwarding rule is kept without output interfaces
+                m_p->m_routing->add_route(m_p->m_interfaces->get_virtual_if_index(input_if_index), gaddr, e.first.saddr, {});
+            } else {
+                del_route(input_if_index, gaddr, e.first.saddr);
+            }
         } else {
-            std::list<int> vif_out;
+            pooled_list<int> vif_out;
 
             for (auto outif : e.second) {
                 vif_out.push_back(m_p->m_interfaces->get_virtual_if_index(outif));
@@ -554,10 +1371,332 @@ void simple_mc_proxy_routing::set_routes(const addr_storage& gaddr, const std::l
     }
 }
 
-void simple_mc_proxy_routing::send_record(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate) const
+void simple_mc_proxy_routing::send_record(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate, bool hold_down)
+{
+    HC_LOG_TRACE("");
+
+    if (hold_down && hold_down_leave(upstream_if_index, gaddr, sstate)) {
+        return;
+    }
+
+    auto report_window = m_p->get_timer_value(IT_UPSTREAM, upstream_if_index, TVT_REPORT_COALESCING, std::chrono::milliseconds(SIMPLE_MC_PROXY_ROUTING_REPORT_COALESCING_DEFAULT));
+
+    if (report_window.count() == 0) {
+        report_state_change(upstream_if_index, gaddr, sstate);
+    } else if (m_report_timers.find(upstream_if_index) == m_report_timers.end()) {
+        //idle upstream, report now and collect the following changes
+        report_state_change(upstream_if_index, gaddr, sstate);
+        set_report_timer(upstream_if_index, report_window);
+    } else {
+        //only the last state of a group is reported
+        m_pending_records[upstream_if_index][gaddr] = sstate;
+    }
+}
+
+bool simple_mc_proxy_routing::hold_down_leave(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate)
+{
+    HC_LOG_TRACE("");
+
+    auto held_it = m_held_leaves.find(upstream_if_index);
+    bool held = held_it != m_held_leaves.end() && held_it->second.find(gaddr) != held_it->second.end();
+
+    if (sstate.m_mc_filter != INCLUDE_MODE || !sstate.m_source_list.empty()) {
+        //joined again during the hold-down, the leave and the rejoin are not reported
+        if (held) {
+            HC_LOG_DEBUG("absorbed flap of group " << gaddr << " on upstream " << interfaces::get_if_name(upstream_if_index));
+            held_it->second.erase(gaddr);
+            if (held_it->second.empty()) {
+                m_held_leaves.erase(held_it);
+            }
+            m_absorbed_flap_count++;
+        }
+        return false;
+    }
+
+    if (held) {
+        return true;
+    }
+
+    auto hold_down = m_p->get_timer_value(IT_UPSTREAM, upstream_if_index, TVT_LEAVE_HOLD_DOWN, std::chrono::milliseconds(SIMPLE_MC_PROXY_ROUTING_LEAVE_HOLD_DOWN_DEFAULT));
+    if (hold_down.count() == 0) {
+        return false;
+    }
+
+    //only a leave of a reported group is held back
+    auto reported_it = m_reported_states.find(upstream_if_index);
+    if (reported_it == m_reported_states.end() || reported_it->second.find(gaddr) == reported_it->second.end()) {
+        //the join is still pending and was never sent, it is cancelled and there is nothing to leave
+        auto pending_it = m_pending_records.find(upstream_if_index);
+        if (pending_it != m_pending_records.end() && pending_it->second.erase(gaddr) > 0) {
+            HC_LOG_DEBUG("cancelled pending join of group " << gaddr << " on upstream " << interfaces::get_if_name(upstream_if_index));
+            return true;
+        }
+        return false;
+    }
+
+    //a pending change of the reported group is replaced by the held leave
+    auto pending_it = m_pending_records.find(upstream_if_index);
+    if (pending_it != m_pending_records.end()) {
+        pending_it->second.erase(gaddr);
+    }
+
+    auto htm = make_pooled_msg<leave_hold_down_timer_msg>(upstream_if_index, gaddr, hold_down);
+    m_held_leaves[upstream_if_index][gaddr] = htm;
+    m_p->m_timing->add_time(hold_down, m_p, htm);
+    m_held_leave_count++;
+    return true;
+}
+
+bool simple_mc_proxy_routing::is_held_down(const addr_storage& gaddr) const
+{
+    HC_LOG_TRACE("");
+
+    for (auto & e : m_held_leaves) {
+        if (e.second.find(gaddr) != e.second.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool simple_mc_proxy_routing::is_prejoin_upstream(const rule_binding& rb, unsigned int upstream_if_index, const addr_storage& gaddr, const addr_storage& saddr) const
+{
+    HC_LOG_TRACE("");
+
+    if (rb.get_if_name() != "*") {
+        return rb.get_if_name() == interfaces::get_if_name(upstream_if_index);
+    }
+
+    //a wildcard binding joins the upstream the memberships of the channel are reported to
+    unsigned int result = 0;
+    uint64_t result_weight = 0;
+    for (auto & e : m_p->m_upstreams) {
+        const std::string& if_name = e.m_interface->get_if_name();
+        if (saddr.is_valid() && !e.m_interface->match_input_filter(if_name, gaddr, saddr)) {
+            continue;
+        }
+
+        if (is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_HASH)) {
+            uint64_t weight = get_channel_weight(gaddr, saddr.is_valid() ? saddr : addr_storage(), if_name);
+            if (result == 0 || weight > result_weight) {
+                result = e.m_if_index;
+                result_weight = weight;
+            }
+        } else {
+            result = e.m_if_index;
+            break;
+        }
+    }
+
+    return result != 0 && result == upstream_if_index;
+}
+
+source_state simple_mc_proxy_routing::get_prejoin_state(unsigned int upstream_if_index, const addr_storage& gaddr) const
+{
+    HC_LOG_TRACE("");
+
+    upstream_aggregation prejoins;
+    for (auto & rb : m_p->m_prejoin_rules) {
+        for (auto & e : rb->get_prejoins()) {
+            if (e.first == gaddr && is_prejoin_upstream(*rb, upstream_if_index, gaddr, e.second)) {
+                source_state sstate;
+                if (e.second.is_valid()) {
+                    sstate.m_source_list.insert(source(e.second));
+                } else {
+                    sstate.m_mc_filter = EXCLUDE_MODE;
+                }
+                prejoins.add_state(sstate);
+            }
+        }
+
+        if (rb->get_predictive_groups() > 0 && m_predicted_groups.find(gaddr) != m_predicted_groups.end() && is_prejoin_upstream(*rb, upstream_if_index, gaddr, addr_storage())) {
+            source_state sstate;
+            sstate.m_mc_filter = EXCLUDE_MODE;
+            prejoins.add_state(sstate);
+        }
+    }
+
+    return prejoins.get_merged_state();
+}
+
+source_state simple_mc_proxy_routing::add_prejoin_state(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate) const
+{
+    HC_LOG_TRACE("");
+
+    if (m_p->m_prejoin_rules.empty()) {
+        return sstate;
+    }
+
+    source_state prejoin_state = get_prejoin_state(upstream_if_index, gaddr);
+    if (prejoin_state.m_mc_filter == INCLUDE_MODE && prejoin_state.m_source_list.empty()) {
+        return sstate;
+    }
+
+    upstream_aggregation result;
+    result.add_state(sstate);
+    result.add_state(prejoin_state);
+    return result.get_merged_state();
+}
+
+bool simple_mc_proxy_routing::is_prejoined(const addr_storage& gaddr) const
+{
+    HC_LOG_TRACE("");
+
+    for (auto & rb : m_p->m_prejoin_rules) {
+        for (auto & e : rb->get_prejoins()) {
+            if (e.first == gaddr) {
+                return true;
+            }
+        }
+
+        if (rb->get_predictive_groups() > 0 && m_predicted_groups.find(gaddr) != m_predicted_groups.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int simple_mc_proxy_routing::get_predictive_groups() const
+{
+    HC_LOG_TRACE("");
+
+    unsigned int result = 0;
+    for (auto & rb : m_p->m_prejoin_rules) {
+        result = std::max(result, rb->get_predictive_groups());
+    }
+    return result;
+}
+
+void simple_mc_proxy_routing::count_join(const addr_storage& gaddr, bool requested)
+{
+    HC_LOG_TRACE("");
+
+    //link local groups (224.0.0.0/24, ff02::/16) are not routed, so they are not predicted
+    if (gaddr.get_addr_family() == AF_INET) {
+        if ((ntohl(gaddr.get_in_addr().s_addr) & 0xffffff00) == 0xe0000000) {
+            return;
+        }
+    } else if (gaddr.get_addr_family() == AF_INET6) {
+        if ((gaddr.get_in6_addr().s6_addr[1] & 0x0f) <= 2) {
+            return;
+        }
+    }
+
+    if (requested) {
+        if (m_requested_groups.insert(gaddr).second) {
+            m_join_scores[gaddr] += 1;
+        }
+    } else {
+        m_requested_groups.erase(gaddr);
+    }
+}
+
+void simple_mc_proxy_routing::update_predicted_groups()
+{
+    HC_LOG_TRACE("");
+
+    double decay = std::pow(0.5, static_cast<double>(SIMPLE_MC_PROXY_ROUTING_PREJOIN_INTERVAL) / SIMPLE_MC_PROXY_ROUTING_PREJOIN_HALF_LIFE);
+
+    std::vector<std::pair<double, addr_storage>> ranking;
+    for (auto it = m_join_scores.begin(); it != m_join_scores.end();) {
+        it->second *= decay;
+        if (it->second < SIMPLE_MC_PROXY_ROUTING_PREJOIN_MIN_SCORE) {
+            if (m_requested_groups.find(it->first) == m_requested_groups.end()) {
+                it = m_join_scores.erase(it);
+            } else {
+                ++it;
+            }
+        } else {
+            ranking.push_back(std::make_pair(it->second, it->first));
+            ++it;
+        }
+    }
+
+    size_t predictive_groups = std::min<size_t>(get_predictive_groups(), ranking.size());
+    std::partial_sort(ranking.begin(), ranking.begin() + predictive_groups, ranking.end(), [](const std::pair<double, addr_storage>& l, const std::pair<double, addr_storage>& r) {
+        return l.first > r.first;
+    });
+
+    std::set<addr_storage> predicted_groups;
+    for (size_t i = 0; i < predictive_groups; ++i) {
+        predicted_groups.insert(ranking[i].second);
+    }
+
+    std::vector<addr_storage> changed_groups;
+    std::set_symmetric_difference(m_predicted_groups.begin(), m_predicted_groups.end(), predicted_groups.begin(), predicted_groups.end(), std::back_inserter(changed_groups));
+    m_predicted_groups = std::move(predicted_groups);
+
+    for (auto & gaddr : changed_groups) {
+        HC_LOG_DEBUG("predicted prejoin of group " << gaddr << (m_predicted_groups.find(gaddr) != m_predicted_groups.end() ? " added" : " removed"));
+        process_state_change(0, gaddr, nullptr);
+    }
+}
+
+void simple_mc_proxy_routing::report_state_change(unsigned int upstream_if_index, const addr_storage& gaddr, const source_state& sstate)
+{
+    HC_LOG_TRACE("");
+
+    auto& reported_states = m_reported_states[upstream_if_index];
+    auto reported_it = reported_states.find(gaddr);
+
+    source_state old_state;
+    if (reported_it != reported_states.end()) {
+        old_state = reported_it->second;
+    }
+
+    if (old_state.m_mc_filter == sstate.m_mc_filter && old_state.m_source_list == sstate.m_source_list) {
+        HC_LOG_DEBUG("group state of " << gaddr << " unchanged, nothing to report");
+        return;
+    }
+
+    m_p->m_sender->send_record_change(upstream_if_index, gaddr, old_state.m_mc_filter, old_state.m_source_list, sstate.m_mc_filter, sstate.m_source_list);
+
+    if (sstate.m_mc_filter == INCLUDE_MODE && sstate.m_source_list.empty()) {
+        if (reported_it != reported_states.end()) {
+            reported_states.erase(reported_it);
+        }
+    } else if (reported_it != reported_states.end()) {
+        reported_it->second = sstate;
+    } else {
+        reported_states.insert(std::make_pair(gaddr, sstate));
+    }
+}
+
+void simple_mc_proxy_routing::set_report_timer(unsigned int upstream_if_index, const std::chrono::milliseconds& report_window)
+{
+    HC_LOG_TRACE("");
+    auto rtm = make_pooled_msg<upstream_report_timer_msg>(upstream_if_index, report_window);
+    m_report_timers[upstream_if_index] = rtm;
+    m_p->m_timing->add_time(report_window, m_p, rtm);
+}
+
+void simple_mc_proxy_routing::flush_pending_records(unsigned int upstream_if_index)
 {
     HC_LOG_TRACE("");
-    m_p->m_sender->send_record(upstream_if_index, sstate.m_mc_filter, gaddr, sstate.m_source_list);
+
+    auto pending_it = m_pending_records.find(upstream_if_index);
+    if (pending_it == m_pending_records.end() || pending_it->second.empty()) {
+        //nothing changed during the window, the upstream becomes idle
+        m_report_timers.erase(upstream_if_index);
+        m_pending_records.erase(upstream_if_index);
+        return;
+    }
+
+    auto records = std::move(pending_it->second);
+    m_pending_records.erase(pending_it);
+
+    if (m_p->is_upstream(upstream_if_index)) {
+        for (auto & e : records) {
+            report_state_change(upstream_if_index, e.first, e.second);
+        }
+
+        //keep the window open for the next changes
+        set_report_timer(upstream_if_index, m_p->get_timer_value(IT_UPSTREAM, upstream_if_index, TVT_REPORT_COALESCING, std::chrono::milliseconds(SIMPLE_MC_PROXY_ROUTING_REPORT_COALESCING_DEFAULT)));
+    } else {
+        HC_LOG_DEBUG("upstream " << interfaces::get_if_name(upstream_if_index) << " removed, drop " << records.size() << " pending records");
+        m_report_timers.erase(upstream_if_index);
+        m_reported_states.erase(upstream_if_index);
+    }
 }
 
 void simple_mc_proxy_routing::del_route(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr) const
@@ -566,18 +1705,35 @@ void simple_mc_proxy_routing::del_route(unsigned int if_index, const addr_storag
     m_p->m_routing->del_route(m_p->m_interfaces->get_virtual_if_index(if_index), gaddr, saddr);
 }
 
-std::shared_ptr<new_source_timer_msg> simple_mc_proxy_routing::set_source_timer(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr)
+bool simple_mc_proxy_routing::del_kernel_route(const addr_storage& gaddr, const addr_storage& saddr)
+{
+    HC_LOG_TRACE("");
+
+    auto gaddr_it = m_kernel_routes.find(gaddr);
+    if (gaddr_it == m_kernel_routes.end() || gaddr_it->second.erase(saddr) < 1) {
+        return false;
+    }
+
+    if (gaddr_it->second.empty()) {
+        m_kernel_routes.erase(gaddr_it);
+    }
+
+    return true;
+}
+
+std::shared_ptr<new_source_timer_msg> simple_mc_proxy_routing::set_source_timer(unsigned int if_index, const addr_storage& gaddr, const addr_storage& saddr, const std::shared_ptr<new_source_timer_msg>& expired_timer, unsigned long packets)
 {
     HC_LOG_TRACE("");
     std::chrono::milliseconds source_life_time;
-    if (m_p->is_upstream(if_index) && is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_MUTEX)) {
+    double packet_rate = 0;
+    if (m_p->is_upstream(if_index) && is_rule_matching_type(IT_UPSTREAM, ID_IN, RMT_MUTEX) && m_p->m_upstream_input_rule->get_timeout().count() > 0) {
         source_life_time = m_p->m_upstream_input_rule->get_timeout();
     } else {
-        source_life_time = get_source_life_time();
+        source_life_time = get_source_life_time(expired_timer, packets, packet_rate);
     }
 
-    auto nst = std::make_shared<new_source_timer_msg>(if_index, gaddr, saddr, source_life_time);
-    m_p->m_timing->add_time(get_source_life_time(), m_p, nst);
+    auto nst = make_pooled_msg<new_source_timer_msg>(if_index, gaddr, saddr, source_life_time, packet_rate);
+    m_p->m_timing->add_time(source_life_time, m_p, nst);
 
     return nst;
 }
@@ -635,6 +1791,41 @@ bool simple_mc_proxy_routing::check_interface(rb_interface_type interface_type,
 std::string simple_mc_proxy_routing::to_string() const
 {
     HC_LOG_TRACE("");
-    return m_data.to_string();
+    std::ostringstream s;
+    s << m_data.to_string();
+
+    if (!m_kernel_routes.empty()) {
+        s << std::endl << "##-- not reconciled kernel routes --##";
+        for (auto & g : m_kernel_routes) {
+            for (auto & e : g.second) {
+                s << std::endl << "(" << g.first << ", " << e.first << ") ==>";
+                for (auto outif : e.second) {
+                    s << " " << interfaces::get_if_name(outif);
+                }
+            }
+        }
+    }
+
+    if (m_held_leave_count > 0) {
+        s << std::endl << "##-- leave hold-down --##";
+        s << std::endl << "held leaves: " << m_held_leave_count << ", absorbed flaps: " << m_absorbed_flap_count;
+        for (auto & e : m_held_leaves) {
+            for (auto & g : e.second) {
+                s << std::endl << interfaces::get_if_name(e.first) << ": " << g.first << "(" << g.second->get_remaining_time() << ")";
+            }
+        }
+    }
+
+    if (!m_join_scores.empty()) {
+        s << std::endl << "##-- predicted prejoins --##";
+        for (auto & e : m_join_scores) {
+            s << std::endl << e.first << "(score:" << e.second << ")";
+            if (m_predicted_groups.find(e.first) != m_predicted_groups.end()) {
+                s << " joined";
+            }
+        }
+    }
+
+    return s.str();
 }
 
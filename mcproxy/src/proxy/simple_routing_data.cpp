@@ -23,30 +23,50 @@
 #include "include/hamcast_logging.h"
 #include "include/proxy/simple_routing_data.hpp"
 #include "include/proxy/message_format.hpp"
-#include "include/utils/mroute_socket.hpp"
+#include "include/utils/kernel_backend.hpp"
 #include "include/proxy/interfaces.hpp"
 
-simple_routing_data::simple_routing_data(group_mem_protocol group_mem_protocol, const std::shared_ptr<const mroute_socket>& mrt_sock)
+simple_routing_data::simple_routing_data(group_mem_protocol group_mem_protocol, const std::shared_ptr<const kernel_backend>& kernel)
     : m_group_mem_protocol(group_mem_protocol)
-    , m_mrt_sock(mrt_sock)
+    , m_kernel(kernel)
 {
     HC_LOG_TRACE("");
 }
 
+simple_routing_data::~simple_routing_data()
+{
+    HC_LOG_TRACE("");
+
+    for (auto & d : m_data) {
+        for (auto & s : d.second.m_source_list) {
+            link_source_timer(s, false);
+        }
+    }
+}
+
+void simple_routing_data::link_source_timer(const source& s, bool linked)
+{
+    HC_LOG_TRACE("");
+
+    if (s.shared_source_timer != nullptr && s.shared_source_timer->get_type() == proxy_msg::NEW_SOURCE_TIMER_MSG) {
+        static_cast<new_source_timer_msg*>(s.shared_source_timer.get())->set_source(linked ? &s : nullptr);
+    }
+}
+
 unsigned long simple_routing_data::get_current_packet_count(const addr_storage& gaddr, const addr_storage& saddr)
 {
     HC_LOG_TRACE("");
 
     if (is_IPv4(m_group_mem_protocol)) {
         struct sioc_sg_req tmp_stat;
-        if (m_mrt_sock->get_mroute_stats(saddr, gaddr, &tmp_stat, nullptr)) {
+        if (m_kernel->get_mroute_stats(saddr, gaddr, &tmp_stat, nullptr)) {
             return tmp_stat.pktcnt;
         } else {
             return true;
         }
     } else if (is_IPv6(m_group_mem_protocol)) {
         struct sioc_sg_req6 tmp_stat;
-        if (m_mrt_sock->get_mroute_stats(saddr, gaddr, nullptr, &tmp_stat)) {
+        if (m_kernel->get_mroute_stats(saddr, gaddr, nullptr, &tmp_stat)) {
             return tmp_stat.pktcnt;
         } else {
             return true;
@@ -65,9 +85,11 @@ void simple_routing_data::set_source(unsigned int if_index, const addr_storage&
         auto list_result = gaddr_it->second.m_source_list.insert(saddr);
         if (!list_result.second) { //failed to inert
             saddr.retransmission_count = get_current_packet_count(gaddr, saddr.saddr);
+            link_source_timer(*list_result.first, false);
             gaddr_it->second.m_source_list.erase(list_result.first);
-            gaddr_it->second.m_source_list.insert(saddr);
+            list_result = gaddr_it->second.m_source_list.insert(saddr);
         }
+        link_source_timer(*list_result.first, true);
 
         auto map_result = gaddr_it->second.m_if_map.insert(std::pair<addr_storage, unsigned int>(saddr.saddr, if_index));
         if (!map_result.second) {
@@ -76,7 +98,8 @@ void simple_routing_data::set_source(unsigned int if_index, const addr_storage&
         }
 
     } else {
-        m_data.insert(s_routing_data_pair(gaddr, sr_data_value({saddr}, {std::pair<addr_storage, unsigned int>(saddr.saddr, if_index)})));
+        gaddr_it = m_data.insert(s_routing_data_pair(gaddr, sr_data_value({saddr}, {std::pair<addr_storage, unsigned int>(saddr.saddr, if_index)}))).first;
+        link_source_timer(*gaddr_it->second.m_source_list.begin(), true);
     }
 }
 
@@ -85,7 +108,11 @@ void simple_routing_data::del_source(const addr_storage& gaddr, const addr_stora
     HC_LOG_TRACE("");
     auto gaddr_it = m_data.find(gaddr);
     if (gaddr_it != std::end(m_data)) {
-        gaddr_it->second.m_source_list.erase(saddr);
+        auto saddr_it = gaddr_it->second.m_source_list.find(saddr);
+        if (saddr_it != std::end(gaddr_it->second.m_source_list)) {
+            link_source_timer(*saddr_it, false);
+            gaddr_it->second.m_source_list.erase(saddr_it);
+        }
         gaddr_it->second.m_if_map.erase(saddr);
         if (gaddr_it->second.m_source_list.empty()) {
             m_data.erase(gaddr_it);
@@ -94,34 +121,33 @@ void simple_routing_data::del_source(const addr_storage& gaddr, const addr_stora
 
 }
 
-std::pair<source_list<source>::iterator, bool> simple_routing_data::refresh_source_or_del_it_if_unused(const addr_storage& gaddr, const addr_storage& saddr)
+bool simple_routing_data::refresh_source_or_del_it_if_unused(const addr_storage& gaddr, const source& s, unsigned long* packets)
 {
     HC_LOG_TRACE("");
-    auto gaddr_it = m_data.find(gaddr);
-    if (gaddr_it != std::end(m_data)) {
-
-        auto saddr_it = gaddr_it->second.m_source_list.find(saddr);
-        if (saddr_it != std::end(gaddr_it->second.m_source_list)) {
-
-            auto cnt = get_current_packet_count(gaddr, saddr);
-            if (static_cast<unsigned long>(saddr_it->retransmission_count) == cnt) {
-                gaddr_it->second.m_source_list.erase(saddr_it);
-                gaddr_it->second.m_if_map.erase(saddr);
-            } else {
-                saddr_it->retransmission_count = cnt;
-                return std::pair<source_list<source>::iterator, bool>(saddr_it, true);
-            }
 
-        }
+    auto cnt = get_current_packet_count(gaddr, s.saddr);
+    if (static_cast<unsigned long>(s.retransmission_count) == cnt) {
+        //the source is unused, s is invalid after its deletion
+        addr_storage saddr = s.saddr;
+        del_source(gaddr, saddr);
+        return false;
+    }
 
-        gaddr_it->second.m_source_list.erase(saddr);
-        gaddr_it->second.m_if_map.erase(saddr);
-        if (gaddr_it->second.m_source_list.empty()) {
-            m_data.erase(gaddr_it);
-        }
+    if (packets != nullptr) {
+        //the packet count of a new source is counted from the creation of its forwarding rule
+        *packets = s.retransmission_count < 0 ? cnt : cnt - s.retransmission_count;
     }
+    s.retransmission_count = cnt;
+    return true;
+}
+
+void simple_routing_data::set_source_timer(const source& s, const std::shared_ptr<timer_msg>& timer)
+{
+    HC_LOG_TRACE("");
 
-    return std::pair<source_list<source>::iterator, bool>(source_list<source>::iterator(), false);
+    link_source_timer(s, false);
+    s.shared_source_timer = timer;
+    link_source_timer(s, true);
 }
 
 const source_list<source>& simple_routing_data::get_available_sources(const addr_storage& gaddr) const
@@ -0,0 +1,378 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/snapshot.hpp"
+
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------------------------------------------------
+//encoding
+template <typename T>
+inline void put_value(std::string& buf, T value)
+{
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void put_string(std::string& buf, const std::string& s)
+{
+    put_value<uint16_t>(buf, s.size());
+    buf.append(s);
+}
+
+inline void put_addr(std::string& buf, const addr_storage& addr)
+{
+    if (addr.get_addr_family() == AF_INET) {
+        put_value<uint8_t>(buf, AF_INET);
+        put_value(buf, addr.get_in_addr());
+    } else {
+        put_value<uint8_t>(buf, AF_INET6);
+        put_value(buf, addr.get_in6_addr());
+    }
+}
+
+inline void put_msec(std::string& buf, std::chrono::milliseconds msec)
+{
+    put_value<int64_t>(buf, msec.count());
+}
+
+//------------------------------------------------------------------------
+//decoding, all functions return false if the buffer is too short
+struct snapshot_reader {
+    snapshot_reader(const char* data, size_t size): m_data(data), m_size(size), m_pos(0) {}
+
+    template <typename T>
+    bool get_value(T& value) {
+        if (m_pos + sizeof(T) > m_size) {
+            return false;
+        }
+        std::memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool get_string(std::string& s) {
+        uint16_t size;
+        if (!get_value(size) || m_pos + size > m_size) {
+            return false;
+        }
+        s.assign(m_data + m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    bool get_addr(addr_storage& addr) {
+        uint8_t family;
+        if (!get_value(family)) {
+            return false;
+        }
+
+        if (family == AF_INET) {
+            in_addr a;
+            if (!get_value(a)) {
+                return false;
+            }
+            addr = addr_storage(a);
+        } else if (family == AF_INET6) {
+            in6_addr a;
+            if (!get_value(a)) {
+                return false;
+            }
+            addr = addr_storage(a);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool get_msec(std::chrono::milliseconds& msec) {
+        int64_t count;
+        if (!get_value(count)) {
+            return false;
+        }
+        msec = std::chrono::milliseconds(count);
+        return true;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+};
+
+//------------------------------------------------------------------------
+snapshot::snapshot()
+    : m_time_stamp(std::chrono::system_clock::now())
+{
+    HC_LOG_TRACE("");
+}
+
+void snapshot::add_instance(snapshot_instance&& instance)
+{
+    HC_LOG_TRACE("");
+    m_instances.push_back(std::move(instance));
+}
+
+const std::list<snapshot_instance>& snapshot::get_instances() const
+{
+    HC_LOG_TRACE("");
+    return m_instances;
+}
+
+bool snapshot::save(const std::string& path) const
+{
+    HC_LOG_TRACE("");
+    using namespace std::chrono;
+
+    std::string buf;
+    buf.append(SNAPSHOT_MAGIC);
+    put_value<uint32_t>(buf, SNAPSHOT_VERSION);
+    put_msec(buf, duration_cast<milliseconds>(m_time_stamp.time_since_epoch()));
+
+    put_value<uint32_t>(buf, m_instances.size());
+    for (auto & inst : m_instances) {
+        put_string(buf, inst.instance_name);
+        put_value<uint32_t>(buf, inst.downstreams.size());
+
+        for (auto & d : inst.downstreams) {
+            put_string(buf, d.if_name);
+            put_value<uint32_t>(buf, d.groups.size());
+
+            for (auto & g : d.groups) {
+                put_addr(buf, g.gaddr);
+                put_value<uint8_t>(buf, g.filter_mode);
+                put_msec(buf, g.filter_timer);
+
+                put_value<uint32_t>(buf, g.include_requested_list.size());
+                for (auto & s : g.include_requested_list) {
+                    put_addr(buf, s.saddr);
+                    put_msec(buf, s.source_timer);
+                }
+
+                put_value<uint32_t>(buf, g.exclude_list.size());
+                for (auto & s : g.exclude_list) {
+                    put_addr(buf, s);
+                }
+            }
+        }
+    }
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file) {
+        HC_LOG_ERROR("failed to open snapshot file: " << tmp_path);
+        return false;
+    }
+
+    file.write(buf.data(), buf.size());
+    file.close();
+    if (!file) {
+        HC_LOG_ERROR("failed to write snapshot file: " << tmp_path);
+        return false;
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        HC_LOG_ERROR("failed to rename snapshot file " << tmp_path << " to " << path << "! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool snapshot::load(const std::string& path)
+{
+    HC_LOG_TRACE("");
+    using namespace std::chrono;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        HC_LOG_DEBUG("failed to open snapshot file: " << path << "! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        HC_LOG_ERROR("failed to get the size of snapshot file: " << path);
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        HC_LOG_ERROR("failed to map snapshot file: " << path << "! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    snapshot_reader r(static_cast<const char*>(data), st.st_size);
+    std::list<snapshot_instance> instances;
+    milliseconds time_stamp;
+    bool rc = [&]() {
+        char magic[sizeof(SNAPSHOT_MAGIC) - 1];
+        uint32_t version;
+        if (!r.get_value(magic) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || !r.get_value(version) || version != SNAPSHOT_VERSION) {
+            HC_LOG_ERROR("unknown snapshot format");
+            return false;
+        }
+
+        uint32_t instance_count;
+        if (!r.get_msec(time_stamp) || !r.get_value(instance_count)) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < instance_count; ++i) {
+            snapshot_instance inst;
+            uint32_t downstream_count;
+            if (!r.get_string(inst.instance_name) || !r.get_value(downstream_count)) {
+                return false;
+            }
+
+            for (uint32_t j = 0; j < downstream_count; ++j) {
+                snapshot_interface d;
+                uint32_t group_count;
+                if (!r.get_string(d.if_name) || !r.get_value(group_count)) {
+                    return false;
+                }
+
+                for (uint32_t k = 0; k < group_count; ++k) {
+                    snapshot_group g;
+                    uint8_t filter_mode;
+                    uint32_t source_count;
+                    if (!r.get_addr(g.gaddr) || !r.get_value(filter_mode) || !r.get_msec(g.filter_timer) || !r.get_value(source_count)) {
+                        return false;
+                    }
+                    if (filter_mode != INCLUDE_MODE && filter_mode != EXCLUDE_MODE) {
+                        return false;
+                    }
+                    g.filter_mode = static_cast<mc_filter>(filter_mode);
+
+                    for (uint32_t l = 0; l < source_count; ++l) {
+                        snapshot_source s;
+                        if (!r.get_addr(s.saddr) || !r.get_msec(s.source_timer)) {
+                            return false;
+                        }
+                        g.include_requested_list.push_back(s);
+                    }
+
+                    if (!r.get_value(source_count)) {
+                        return false;
+                    }
+
+                    for (uint32_t l = 0; l < source_count; ++l) {
+                        addr_storage saddr;
+                        if (!r.get_addr(saddr)) {
+                            return false;
+                        }
+                        g.exclude_list.push_back(saddr);
+                    }
+
+                    d.groups.push_back(std::move(g));
+                }
+                inst.downstreams.push_back(std::move(d));
+            }
+            instances.push_back(std::move(inst));
+        }
+        return true;
+    }();
+
+    munmap(data, st.st_size);
+
+    if (!rc) {
+        HC_LOG_ERROR("failed to decode snapshot file: " << path);
+        return false;
+    }
+
+    m_instances = std::move(instances);
+    m_time_stamp = system_clock::time_point(duration_cast<system_clock::duration>(time_stamp));
+
+    auto elapsed = duration_cast<milliseconds>(system_clock::now() - m_time_stamp);
+    age(elapsed.count() > 0 ? elapsed : milliseconds(0));
+    return true;
+}
+
+void snapshot::age(std::chrono::milliseconds elapsed)
+{
+    HC_LOG_TRACE("");
+
+    for (auto & inst : m_instances) {
+        for (auto & d : inst.downstreams) {
+            for (auto g = d.groups.begin(); g != d.groups.end();) {
+
+                for (auto s = g->include_requested_list.begin(); s != g->include_requested_list.end();) {
+                    s->source_timer -= elapsed;
+                    if (s->source_timer.count() <= 0) {
+                        s = g->include_requested_list.erase(s);
+                    } else {
+                        ++s;
+                    }
+                }
+
+                if (g->filter_mode == EXCLUDE_MODE) {
+                    g->filter_timer -= elapsed;
+                    if (g->filter_timer.count() <= 0) {
+                        //filter timer expired, no more listeners in EXCLUDE mode
+                        g->filter_mode = INCLUDE_MODE;
+                        g->filter_timer = std::chrono::milliseconds(0);
+                        g->exclude_list.clear();
+                    }
+                }
+
+                if (g->filter_mode == INCLUDE_MODE && g->include_requested_list.empty()) {
+                    g = d.groups.erase(g);
+                } else {
+                    ++g;
+                }
+            }
+        }
+    }
+}
+
+std::string snapshot::to_string() const
+{
+    HC_LOG_TRACE("");
+    std::ostringstream s;
+    s << "##-- snapshot --##" << std::endl;
+    for (auto & inst : m_instances) {
+        s << "pinstance " << inst.instance_name << std::endl;
+        for (auto & d : inst.downstreams) {
+            s << "\tdownstream " << d.if_name << ": " << d.groups.size() << " group(s)" << std::endl;
+            for (auto & g : d.groups) {
+                s << "\t\t" << g.gaddr << " " << get_mc_filter_name(g.filter_mode) << " requested:" << g.include_requested_list.size() << " excluded:" << g.exclude_list.size() << std::endl;
+            }
+        }
+    }
+    return s.str();
+}
+
+std::ostream& operator<<(std::ostream& stream, const snapshot& s)
+{
+    return stream << s.to_string();
+}
@@ -0,0 +1,181 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/thread_settings.hpp"
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+std::mutex thread_settings::m_lock;
+std::map<thread_class, cpu_set_t> thread_settings::m_affinity;
+int thread_settings::m_realtime_priority = 0;
+bool thread_settings::m_memory_locked = false;
+
+std::string get_thread_class_name(thread_class tc)
+{
+    HC_LOG_TRACE("");
+
+    switch (tc) {
+    case TC_RECEIVER:
+        return "receiver";
+    case TC_WORKER:
+        return "worker";
+    case TC_TIMING:
+        return "timing";
+    default:
+        return "unknown";
+    }
+}
+
+bool thread_settings::set_affinity(thread_class tc, const std::string& cpu_list)
+{
+    HC_LOG_TRACE("");
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    std::istringstream is(cpu_list);
+    std::string range;
+    while (std::getline(is, range, ',')) {
+        std::istringstream rs(range);
+        int first;
+        int last;
+        if (!(rs >> first)) {
+            return false;
+        }
+        last = first;
+
+        if (rs.peek() == '-') {
+            rs.ignore();
+            if (!(rs >> last)) {
+                return false;
+            }
+        }
+
+        if (!rs.eof() || first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+
+        for (int i = first; i <= last; ++i) {
+            CPU_SET(i, &cpus);
+        }
+    }
+
+    if (CPU_COUNT(&cpus) == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_affinity[tc] = cpus;
+    return true;
+}
+
+bool thread_settings::set_realtime_priority(int priority)
+{
+    HC_LOG_TRACE("");
+
+    if (priority < 0 || priority > sched_get_priority_max(SCHED_FIFO)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_realtime_priority = priority;
+    return true;
+}
+
+bool thread_settings::lock_memory()
+{
+    HC_LOG_TRACE("");
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        HC_LOG_ERROR("failed to lock the memory! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_memory_locked = true;
+    return true;
+}
+
+void thread_settings::apply(thread_class tc)
+{
+    HC_LOG_TRACE("thread class: " << get_thread_class_name(tc));
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    auto it = m_affinity.find(tc);
+    if (it != m_affinity.end()) {
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &it->second);
+        if (rc != 0) {
+            HC_LOG_ERROR("failed to set the cpu affinity of a " << get_thread_class_name(tc) << " thread! Error: " << strerror(rc) << " errno: " << rc);
+        }
+    }
+
+    //the receivers only pass the packets on, the deadlines are kept by the workers and the timing
+    if (m_realtime_priority > 0 && (tc == TC_WORKER || tc == TC_TIMING)) {
+        struct sched_param param;
+        param.sched_priority = m_realtime_priority;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            HC_LOG_ERROR("failed to set the real-time priority of a " << get_thread_class_name(tc) << " thread! Error: " << strerror(rc) << " errno: " << rc);
+        }
+    }
+}
+
+std::string thread_settings::to_string()
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::ostringstream s;
+
+    for (auto tc : {TC_RECEIVER, TC_WORKER, TC_TIMING}) {
+        s << get_thread_class_name(tc) << " cpus: ";
+        auto it = m_affinity.find(tc);
+        if (it == m_affinity.end()) {
+            s << "all";
+        } else {
+            std::string separator;
+            for (int i = 0; i < CPU_SETSIZE; ++i) {
+                if (CPU_ISSET(i, &it->second)) {
+                    s << separator << i;
+                    separator = ",";
+                }
+            }
+        }
+        s << "; ";
+    }
+
+    s << "real-time priority: ";
+    if (m_realtime_priority > 0) {
+        s << m_realtime_priority << " (SCHED_FIFO)";
+    } else {
+        s << "-";
+    }
+    s << "; memory locked: " << m_memory_locked;
+
+    return s.str();
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/timer_clock.hpp"
+
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+//the clock is read by each timer, so the steady clock is used without indirection as long as no clock is set
+std::atomic<const timer_clock*> process_clock(nullptr);
+std::shared_ptr<const timer_clock> process_clock_owner;
+std::mutex process_clock_lock;
+}
+
+timer_clock::time_point timer_clock::now()
+{
+    const timer_clock* c = process_clock.load(std::memory_order_acquire);
+    return c == nullptr ? std::chrono::steady_clock::now() : c->get_time();
+}
+
+void timer_clock::set_clock(const std::shared_ptr<const timer_clock>& clock)
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(process_clock_lock);
+    process_clock.store(clock.get(), std::memory_order_release);
+    process_clock_owner = clock;
+}
+
+timer_clock::time_point timer_clock::not_running()
+{
+    return time_point::max();
+}
+
+std::chrono::milliseconds timer_clock::get_remaining_duration(const time_point& deadline)
+{
+    auto time_span = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now());
+    return time_span.count() > 0 ? time_span : std::chrono::milliseconds(0);
+}
+
+std::string timer_clock::get_remaining_time(const time_point& deadline)
+{
+    std::ostringstream s;
+    if (deadline == not_running()) {
+        s << "-";
+    } else {
+        auto time_span = std::chrono::duration_cast<std::chrono::seconds>(deadline - now());
+        s << (time_span.count() >= 0 ? time_span.count() : 0) << "sec";
+    }
+    return s.str();
+}
+
+virtual_clock::virtual_clock(const time_point& start)
+    : m_time(start.time_since_epoch().count())
+{
+    HC_LOG_TRACE("");
+}
+
+timer_clock::time_point virtual_clock::get_time() const
+{
+    return time_point(time_point::duration(m_time.load()));
+}
+
+void virtual_clock::advance_to(const time_point& time)
+{
+    HC_LOG_TRACE("");
+
+    auto t = time.time_since_epoch().count();
+    auto current = m_time.load();
+    while (current < t && !m_time.compare_exchange_weak(current, t)) {
+    }
+}
@@ -23,67 +23,150 @@
 #include "include/hamcast_logging.h"
 #include "include/proxy/timing.hpp"
 #include "include/proxy/worker.hpp"
+#include "include/proxy/thread_settings.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <unistd.h>
 
+timer_lag::timer_lag()
+    : m_count(0)
+    , m_sum(0)
+    , m_max(0)
+{
+    m_buckets.fill(0);
+}
+
+void timer_lag::add(const timer_clock::time_point& deadline)
+{
+    auto lag = std::chrono::duration_cast<std::chrono::nanoseconds>(timer_clock::now() - deadline);
+    if (lag.count() < 0) {
+        lag = std::chrono::nanoseconds(0);
+    }
+
+    m_count++;
+    m_sum += lag;
+    m_max = std::max(m_max, lag);
+
+    //each bucket is ten times wider than the previous one
+    auto bound = std::chrono::microseconds(100);
+    unsigned int i = 0;
+    while (i < TIMER_LAG_BUCKETS - 1 && lag >= bound) {
+        bound *= 10;
+        i++;
+    }
+    m_buckets[i]++;
+}
+
+std::string timer_lag::to_string() const
+{
+    std::ostringstream s;
+    auto usec = [](const std::chrono::nanoseconds & ns) {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(ns).count();
+    };
+
+    s << std::fixed << std::setprecision(1);
+    s << "expired: " << m_count << ", mean: " << (m_count > 0 ? usec(m_sum) / m_count : 0) << "usec, max: " << usec(m_max) << "usec";
+    s << ", <0.1ms: " << m_buckets[0] << ", <1ms: " << m_buckets[1] << ", <10ms: " << m_buckets[2] << ", <100ms: " << m_buckets[3] << ", >=100ms: " << m_buckets[4];
+    return s.str();
+}
+
 timing::timing():
-    m_running(false), m_thread(nullptr)
+    m_virtual_clock(nullptr), m_running(false), m_thread(nullptr)
 {
     HC_LOG_TRACE("");
     start();
 }
 
+timing::timing(const std::shared_ptr<virtual_clock>& vclock):
+    m_virtual_clock(vclock), m_running(false), m_thread(nullptr)
+{
+    HC_LOG_TRACE("");
+
+    if (m_virtual_clock == nullptr) {
+        throw "missing virtual clock";
+    }
+
+    timer_clock::set_clock(m_virtual_clock);
+}
+
 timing::~timing()
 {
     HC_LOG_TRACE("");
-    stop();
-    join();
+    if (m_virtual_clock != nullptr) {
+        timer_clock::set_clock(nullptr);
+    } else {
+        stop();
+        join();
+    }
 }
 
-void timing::worker_thread()
+void timing::dispatch(const timing_db_key& until)
 {
     HC_LOG_TRACE("");
 
-    while (m_running) {
+    for (auto it = begin(m_db); it != end(m_db) && it->first <= until;) {
+        timing_db_value& db_value = it->second;
+        if (m_virtual_clock == nullptr) {
+            m_dispatch_lag.add(it->first);
+        }
+        (*std::get<1>(db_value).get())();
+        if (std::get<0>(db_value) != nullptr) {
+            std::get<0>(db_value)->add_msg(std::get<1>(db_value));
+        }
 
-        std::mutex lokal_lock;
-        std::unique_lock<std::mutex> ull(lokal_lock);
+        it = m_db.erase(it);
+    }
+}
 
-        if (m_db.empty()) {
-            sleep(TIMING_IDLE_POLLING_INTERVAL);
-        } else {
-            m_con_var.wait_until(ull, m_db.begin()->first);
-        }
+bool timing::run_next_deadline(const timing_db_key& until)
+{
+    HC_LOG_TRACE("");
+
+    if (m_virtual_clock == nullptr) {
+        HC_LOG_ERROR("timing is not in simulation mode");
+        return false;
+    }
 
-        std::lock_guard<std::mutex> lock(m_global_lock);
+    std::lock_guard<std::mutex> lock(m_global_lock);
 
-        timing_db_key now = std::chrono::steady_clock::now();
+    if (m_db.empty() || m_db.begin()->first > until) {
+        m_virtual_clock->advance_to(until);
+        return false;
+    }
 
-        for (auto it = begin(m_db); it != end(m_db);) {
-            if (it->first <= now) {
-                timing_db_value& db_value = it->second;
-                (*std::get<1>(db_value).get())();
-                if (std::get<0>(db_value) != nullptr) {
-                    std::get<0>(db_value)->add_msg(std::get<1>(db_value));
-                }
+    timing_db_key next_deadline = m_db.begin()->first;
+    m_virtual_clock->advance_to(next_deadline);
+    dispatch(next_deadline);
+    return true;
+}
 
-                it = m_db.erase(it);
-                continue;
+void timing::worker_thread()
+{
+    HC_LOG_TRACE("");
+    thread_settings::apply(TC_TIMING);
 
-            } else {
-                break;
-            }
+    while (m_running) {
+        //the wait releases the global lock, so a reminder added meanwhile wakes the thread (add_time)
+        std::unique_lock<std::mutex> lock(m_global_lock);
 
-            ++it;
+        if (m_db.empty()) {
+            m_con_var.wait_for(lock, std::chrono::seconds(TIMING_IDLE_POLLING_INTERVAL));
+        } else {
+            //copy the next deadline, the reminder can be deleted meanwhile (stop_all_time)
+            timing_db_key next_deadline = m_db.begin()->first;
+            m_con_var.wait_until(lock, next_deadline);
         }
+
+        dispatch(timer_clock::now());
     }
 }
 
 void timing::add_time(std::chrono::milliseconds delay, const worker* msg_worker, const std::shared_ptr<proxy_msg>& pr_msg)
 {
     HC_LOG_TRACE("");
-    timing_db_key until = std::chrono::steady_clock::now() + delay;
+    timing_db_key until = timer_clock::now() + delay;
 
     std::lock_guard<std::mutex> lock(m_global_lock);
 
@@ -107,6 +190,14 @@ void timing::stop_all_time(const worker* msg_worker)
 
 }
 
+timer_lag timing::get_dispatch_lag()
+{
+    HC_LOG_TRACE("");
+
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    return m_dispatch_lag;
+}
+
 void timing::start()
 {
     HC_LOG_TRACE("");
@@ -157,6 +248,28 @@ void timing::test_timing()
     sleep(10);
     cout << "finished" << endl;
 }
+
+void timing::test_timing_simulation()
+{
+    using namespace std;
+    HC_LOG_TRACE("");
+    cout << "##-- test timing simulation --##" << endl;
+    auto vclock = make_shared<virtual_clock>();
+    timing t(vclock);
+
+    cout << "add test message 1 (2h) " << endl;
+    t.add_time(std::chrono::hours(2), nullptr, std::make_shared<test_msg>(test_msg(1, proxy_msg::SYSTEMIC)));
+    cout << "add test message 2 (1sec) " << endl;
+    t.add_time(std::chrono::seconds(1), nullptr, std::make_shared<test_msg>(test_msg(2, proxy_msg::SYSTEMIC)));
+    cout << "add test message 3 (1sec) " << endl;
+    t.add_time(std::chrono::seconds(1), nullptr, std::make_shared<test_msg>(test_msg(3, proxy_msg::SYSTEMIC)));
+
+    auto until = vclock->get_time() + std::chrono::hours(3);
+    while (t.run_next_deadline(until)) {
+        cout << "virtual time: " << std::chrono::duration_cast<std::chrono::seconds>(vclock->get_time().time_since_epoch()).count() << "sec" << endl;
+    }
+    cout << "finished at " << std::chrono::duration_cast<std::chrono::seconds>(vclock->get_time().time_since_epoch()).count() << "sec" << endl;
+}
 #endif /* DEBUG_MODE */
 
 
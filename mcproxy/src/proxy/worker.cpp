@@ -23,6 +23,8 @@
 
 #include "include/hamcast_logging.h"
 #include "include/proxy/worker.hpp"
+#include "include/proxy/worker_pool.hpp"
+#include "include/proxy/thread_settings.hpp"
 
 #include "unistd.h"
 
@@ -33,7 +35,16 @@ worker::worker()
 }
 
 worker::worker(int queue_size)
-    : m_thread(nullptr)
+    : worker(queue_size, nullptr)
+{
+    HC_LOG_TRACE("");
+}
+
+worker::worker(int queue_size, const std::shared_ptr<worker_pool>& shared_worker_pool)
+    : m_worker_pool(shared_worker_pool)
+    , m_scheduled(false)
+    , m_released(false)
+    , m_thread(nullptr)
     , m_running(false)
     , m_job_queue(queue_size)
 {
@@ -47,12 +58,56 @@ worker::~worker()
     join();
 }
 
+void worker::worker_thread()
+{
+    HC_LOG_TRACE("");
+    thread_settings::apply(TC_WORKER);
+    while (m_running) {
+        process_msg(m_job_queue.dequeue());
+    }
+    HC_LOG_DEBUG("worker thread end");
+}
+
+bool worker::process_pending_msgs(unsigned int max_msg)
+{
+    HC_LOG_TRACE("");
+    std::shared_ptr<proxy_msg> msg;
+
+    for (unsigned int i = 0; i < max_msg && m_running; ++i) {
+        if (!m_job_queue.try_dequeue(msg)) {
+            break;
+        }
+        process_msg(msg);
+    }
+
+    return m_running && !m_job_queue.is_empty();
+}
+
+void worker::schedule()
+{
+    HC_LOG_TRACE("");
+    //the running check is repeated by the worker_pool under its lock
+    if (m_running && !m_scheduled.exchange(true)) {
+        if (!m_worker_pool->schedule(this)) {
+            m_scheduled = false;
+        }
+    }
+}
 
 void worker::start()
 {
     HC_LOG_TRACE("");
 
-    if (m_thread.get() == nullptr) {
+    if (m_worker_pool != nullptr) {
+        if (!m_running) {
+            m_running = true;
+            if (!m_job_queue.is_empty()) {
+                schedule();
+            }
+        } else {
+            HC_LOG_WARN("worker is already running");
+        }
+    } else if (m_thread.get() == nullptr) {
         m_running =  true;
         m_thread.reset(new std::thread(&worker::worker_thread, this));
     } else {
@@ -71,6 +126,10 @@ void worker::add_msg(const std::shared_ptr<proxy_msg>& msg) const
     } else {
         m_job_queue.enqueue(msg);
     }
+
+    if (m_worker_pool != nullptr) {
+        const_cast<worker*>(this)->schedule();
+    }
 }
 
 bool worker::is_running() const
@@ -82,14 +141,24 @@ bool worker::is_running() const
 void worker::stop()
 {
     HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_state_lock);
     m_running = false;
+    m_cond_stopped.notify_all();
 }
 
 void worker::join() const
 {
     HC_LOG_TRACE("");
 
-    if (m_thread.get() != nullptr) {
+    if (m_worker_pool != nullptr) {
+        {
+            std::unique_lock<std::mutex> lock(m_state_lock);
+            m_cond_stopped.wait(lock, [&]() {
+                return !m_running;
+            });
+        }
+        m_worker_pool->release(this);
+    } else if (m_thread.get() != nullptr && m_thread->joinable()) {
         m_thread->join();
     }
 }
@@ -102,54 +171,56 @@ void worker::test_worker()
     class my_worker: public worker
     {
     public:
-        my_worker(int queue_size): worker(queue_size) {
+        my_worker(int queue_size, const std::shared_ptr<worker_pool>& pool = nullptr): worker(queue_size, pool) {
             HC_LOG_TRACE("");
+        }
+
+        void run() {
             start();
         }
     private:
-        void worker_thread() override {
+        void process_msg(const std::shared_ptr<proxy_msg>& m) override {
             HC_LOG_TRACE("");
-            sleep(1);
-            while (m_running) {
-                HC_LOG_DEBUG("in while(m_running)");
-                auto m = m_job_queue.dequeue();
-                switch (m->get_type()) {
-                case proxy_msg::TEST_MSG:
-                    HC_LOG_DEBUG("dequeued a test_msg");
-                    (*m)();
-                    break;
-                case proxy_msg::EXIT_MSG:
-                    HC_LOG_DEBUG("dequeued a exit_msg");
-                    std::cout << "exit msg" << std::endl;
-                    stop();
-                    break;
-                default:
-                    HC_LOG_DEBUG("dequeued an other message");
-                    std::cout << "an other unknown message" << std::endl;
-                    break;
-                }
+            switch (m->get_type()) {
+            case proxy_msg::TEST_MSG:
+                HC_LOG_DEBUG("dequeued a test_msg");
+                (*m)();
+                break;
+            case proxy_msg::EXIT_MSG:
+                HC_LOG_DEBUG("dequeued a exit_msg");
+                std::cout << "exit msg" << std::endl;
+                stop();
+                break;
+            default:
+                HC_LOG_DEBUG("dequeued an other message");
+                std::cout << "an other unknown message" << std::endl;
+                break;
             }
-            HC_LOG_DEBUG("after while(m_running)");
         };
     };
 
+    auto test = [](const std::shared_ptr<worker_pool>& pool) {
+        std::unique_ptr<my_worker> m(new my_worker(4, pool));
+        //[4 6] 5  [1 2 3 ] without 7
+
+        m->add_msg(std::make_shared<test_msg>(test_msg(1, proxy_msg::LOSEABLE)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(2, proxy_msg::LOSEABLE)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(3, proxy_msg::LOSEABLE)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(4, proxy_msg::USER_INPUT)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(5, proxy_msg::SYSTEMIC)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(6, proxy_msg::USER_INPUT)));
+        m->add_msg(std::make_shared<test_msg>(test_msg(7, proxy_msg::LOSEABLE)));
+        m->run();
+        sleep(3);
+        m->add_msg(std::make_shared<exit_cmd>(exit_cmd()));
+    };
 
-    //};
-
-    std::unique_ptr<worker> m(new my_worker(4));
-    //[4 6] 5  [1 2 3 ] without 7
+    std::cout << "-- own thread --" << std::endl;
+    test(nullptr);
 
-    m->add_msg(std::make_shared<test_msg>(test_msg(1, proxy_msg::LOSEABLE)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(2, proxy_msg::LOSEABLE)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(3, proxy_msg::LOSEABLE)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(4, proxy_msg::USER_INPUT)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(5, proxy_msg::SYSTEMIC)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(6, proxy_msg::USER_INPUT)));
-    m->add_msg(std::make_shared<test_msg>(test_msg(7, proxy_msg::LOSEABLE)));
-    sleep(3);
-    m->add_msg(std::make_shared<exit_cmd>(exit_cmd()));
+    std::cout << "-- worker pool --" << std::endl;
+    test(std::make_shared<worker_pool>(2));
 
     std::cout << "##-- end of test worker --##" << std::endl;
-    sleep(4);
 }
 #endif /* DEBUG_MODE */
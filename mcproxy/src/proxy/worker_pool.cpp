@@ -0,0 +1,201 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+
+#include "include/hamcast_logging.h"
+#include "include/proxy/worker_pool.hpp"
+#include "include/proxy/worker.hpp"
+#include "include/proxy/thread_settings.hpp"
+
+#include <algorithm>
+
+namespace
+{
+//executor id of the current thread, used to keep a rescheduled worker on the same executor
+thread_local int tl_executor_id = -1;
+}
+
+worker_pool::worker_pool(unsigned int size)
+    : m_running(true)
+    , m_executors(size == 0 ? 1 : size)
+    , m_next_executor(0)
+{
+    HC_LOG_TRACE("");
+
+    for (unsigned int i = 0; i < m_executors.size(); ++i) {
+        m_threads.push_back(std::unique_ptr<std::thread>(new std::thread(&worker_pool::executor_thread, this, i)));
+    }
+}
+
+worker_pool::~worker_pool()
+{
+    HC_LOG_TRACE("");
+    stop();
+    join();
+}
+
+void worker_pool::executor_thread(unsigned int executor_id)
+{
+    HC_LOG_TRACE("");
+    tl_executor_id = executor_id;
+    thread_settings::apply(TC_WORKER);
+
+    while (true) {
+        worker* w;
+        {
+            std::unique_lock<std::mutex> lock(m_global_lock);
+            m_cond_work.wait(lock, [&]() {
+                return !m_running || (w = next_worker(executor_id)) != nullptr;
+            });
+
+            if (!m_running) {
+                break;
+            }
+
+            m_executors[executor_id].m_current = w;
+        }
+
+        if (w->process_pending_msgs(WORKER_POOL_SLICE_SIZE)) {
+            if (!schedule(w)) {
+                w->m_scheduled = false;
+            }
+        } else {
+            //a job enqueued after the last dequeue could not reschedule the worker
+            w->m_scheduled = false;
+            if (w->m_running && !w->m_job_queue.is_empty()) {
+                w->schedule();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_global_lock);
+            m_executors[executor_id].m_current = nullptr;
+        }
+        m_cond_idle.notify_all();
+    }
+
+    HC_LOG_DEBUG("executor thread " << executor_id << " end");
+}
+
+worker* worker_pool::next_worker(unsigned int executor_id)
+{
+    HC_LOG_TRACE("");
+
+    auto& own = m_executors[executor_id].m_run_queue;
+    if (!own.empty()) {
+        worker* w = own.front();
+        own.pop_front();
+        return w;
+    }
+
+    //steal from the tail of the other run queues
+    for (unsigned int i = 1; i < m_executors.size(); ++i) {
+        auto& other = m_executors[(executor_id + i) % m_executors.size()].m_run_queue;
+        if (!other.empty()) {
+            worker* w = other.back();
+            other.pop_back();
+            return w;
+        }
+    }
+
+    return nullptr;
+}
+
+bool worker_pool::schedule(worker* w)
+{
+    HC_LOG_TRACE("");
+
+    {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+
+        //release() purges the run queues under this lock, a released worker must not be queued afterwards
+        if (w->m_released || !w->m_running) {
+            return false;
+        }
+
+        if (tl_executor_id >= 0 && static_cast<unsigned int>(tl_executor_id) < m_executors.size()) {
+            m_executors[tl_executor_id].m_run_queue.push_back(w);
+        } else {
+            m_executors[m_next_executor].m_run_queue.push_back(w);
+            m_next_executor = (m_next_executor + 1) % m_executors.size();
+        }
+    }
+    m_cond_work.notify_one();
+    return true;
+}
+
+void worker_pool::release(const worker* w)
+{
+    HC_LOG_TRACE("");
+
+    std::unique_lock<std::mutex> lock(m_global_lock);
+    w->m_released = true;
+    m_cond_idle.wait(lock, [&]() {
+        bool in_use = false;
+        for (unsigned int i = 0; i < m_executors.size(); ++i) {
+            auto& e = m_executors[i];
+            e.m_run_queue.erase(std::remove(e.m_run_queue.begin(), e.m_run_queue.end(), w), e.m_run_queue.end());
+
+            //a worker released by its own executor is not waited for
+            if (e.m_current == w && static_cast<int>(i) != tl_executor_id) {
+                in_use = true;
+            }
+        }
+        return !in_use;
+    });
+}
+
+unsigned int worker_pool::size() const
+{
+    HC_LOG_TRACE("");
+    return m_executors.size();
+}
+
+unsigned int worker_pool::get_default_pool_size(unsigned int worker_count)
+{
+    HC_LOG_TRACE("");
+    unsigned int hw = std::thread::hardware_concurrency();
+    if (hw == 0) {
+        hw = 1;
+    }
+    return std::max(1u, std::min(hw, worker_count));
+}
+
+void worker_pool::stop()
+{
+    HC_LOG_TRACE("");
+    {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+        m_running = false;
+    }
+    m_cond_work.notify_all();
+}
+
+void worker_pool::join()
+{
+    HC_LOG_TRACE("");
+    for (auto & t : m_threads) {
+        if (t->joinable()) {
+            t->join();
+        }
+    }
+}
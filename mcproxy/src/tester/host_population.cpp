@@ -0,0 +1,760 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/tester/host_population.hpp"
+#include "include/proxy/interfaces.hpp"
+#include "include/proxy/timers_values.hpp"
+#include "include/utils/mc_socket.hpp"
+#include "include/utils/extended_igmp_defines.hpp"
+#include "include/utils/extended_mld_defines.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <unistd.h>
+#include <poll.h>
+#include <net/ethernet.h>
+#include <netinet/ip.h>
+#include <netpacket/packet.h>
+#include <arpa/inet.h>
+
+//one's complement sum of buf (without folding)
+static uint32_t checksum_add(const uint8_t* buf, unsigned int size, uint32_t sum)
+{
+    for (unsigned int i = 0; i + 1 < size; i += 2) {
+        sum += (buf[i] << 8) | buf[i + 1];
+    }
+
+    if (size & 1) {
+        sum += buf[size - 1] << 8;
+    }
+
+    return sum;
+}
+
+//internet checksum in network byte order
+static uint16_t checksum_fold(uint32_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return htons(~sum & 0xFFFF);
+}
+
+host_population::host_population(group_mem_protocol group_mem_protocol, const std::string& if_name, const addr_storage& host_addr, unsigned int host_count, const addr_storage& gaddr, unsigned int channel_count, const std::list<addr_storage>& sources, double zipf_exponent, const std::chrono::milliseconds& mean_dwell_time, unsigned int off_ratio, const std::chrono::milliseconds& mean_off_time, const std::chrono::milliseconds& ramp_time, unsigned int robustness, bool leave_on_exit, int seed)
+    : m_group_mem_protocol(group_mem_protocol)
+    , m_addr_family(get_addr_family(group_mem_protocol))
+    , m_if_index(interfaces::get_if_index(if_name))
+    , m_sources(sources)
+    , m_mean_dwell_time(mean_dwell_time)
+    , m_off_ratio(std::min(off_ratio, 100U))
+    , m_mean_off_time(mean_off_time)
+    , m_ramp_time(ramp_time)
+    , m_robustness(std::max(robustness, 1U))
+    , m_leave_on_exit(leave_on_exit)
+    , m_rng(seed)
+    , m_sock(-1)
+    , m_query_count(0)
+    , m_changes(0)
+    , m_joins(0)
+    , m_leaves(0)
+    , m_zaps(0)
+    , m_retransmissions(0)
+    , m_general_queries(0)
+    , m_specific_queries(0)
+    , m_responses(0)
+    , m_suppressed(0)
+    , m_packets_sent(0)
+    , m_send_errors(0)
+{
+    HC_LOG_TRACE("");
+
+    if (group_mem_protocol != IGMPv2 && group_mem_protocol != IGMPv3 && group_mem_protocol != MLDv1 && group_mem_protocol != MLDv2) {
+        throw "group membership protocol not supported";
+    }
+
+    if (m_if_index == 0) {
+        throw "unknown interface";
+    }
+
+    if (host_addr.get_addr_family() != m_addr_family || gaddr.get_addr_family() != m_addr_family || !gaddr.is_multicast_addr()) {
+        throw "host or group address has the wrong ip version";
+    }
+
+    if (is_v2() && !m_sources.empty()) {
+        throw "source specific channels need IGMPv3 or MLDv2";
+    }
+
+    addr_storage group = gaddr;
+    for (unsigned int i = 0; i < std::max(channel_count, 1U); ++i) {
+        m_channel_index[group] = i;
+        m_channels.push_back(group);
+        ++group;
+    }
+
+    //the channel of rank k (starting at 1) is watched with a probability proportional to 1/k^s
+    double sum = 0;
+    for (unsigned int i = 0; i < m_channels.size(); ++i) {
+        sum += 1 / std::pow(i + 1, zipf_exponent);
+        m_zipf_cdf.push_back(sum);
+    }
+    for (auto & e : m_zipf_cdf) {
+        e /= sum;
+    }
+
+    m_last_answered_query.resize(m_channels.size(), 0);
+    m_viewers.resize(m_channels.size(), 0);
+
+    //packets are sent below the ip layer to use the addresses of the virtual hosts
+    m_sock = socket(AF_PACKET, SOCK_DGRAM, htons(m_addr_family == AF_INET ? ETH_P_IP : ETH_P_IPV6));
+    if (m_sock < 0) {
+        HC_LOG_ERROR("failed to create packet socket! Error: " << strerror(errno) << " errno: " << errno);
+        throw "failed to create packet socket";
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(m_addr_family == AF_INET ? ETH_P_IP : ETH_P_IPV6);
+    sll.sll_ifindex = m_if_index;
+    if (bind(m_sock, reinterpret_cast<struct sockaddr*>(&sll), sizeof(sll)) < 0) {
+        HC_LOG_ERROR("failed to bind packet socket! Error: " << strerror(errno) << " errno: " << errno);
+        close(m_sock);
+        throw "failed to bind packet socket";
+    }
+
+    //the hosts switch on within the ramp time
+    auto now = clock::now();
+    addr_storage addr = host_addr;
+    m_hosts.resize(host_count);
+    for (unsigned int i = 0; i < host_count; ++i) {
+        m_hosts[i].m_addr = addr;
+        ++addr;
+        m_events.push(event{now + random_delay(m_ramp_time), ET_CHANGE, i, 0});
+    }
+}
+
+host_population::~host_population()
+{
+    HC_LOG_TRACE("");
+
+    if (m_sock >= 0) {
+        close(m_sock);
+    }
+}
+
+bool host_population::is_v2() const
+{
+    return m_group_mem_protocol == IGMPv2 || m_group_mem_protocol == MLDv1;
+}
+
+unsigned int host_population::sample_channel()
+{
+    double r = std::uniform_real_distribution<double>(0, 1)(m_rng);
+    auto it = std::upper_bound(m_zipf_cdf.begin(), m_zipf_cdf.end(), r);
+    return std::min<unsigned int>(it - m_zipf_cdf.begin(), m_channels.size() - 1);
+}
+
+host_population::clock::duration host_population::random_delay(const std::chrono::milliseconds& max_delay)
+{
+    auto max_us = std::chrono::duration_cast<std::chrono::microseconds>(max_delay).count();
+    return std::chrono::microseconds(std::uniform_int_distribution<long long>(0, std::max<long long>(max_us, 0))(m_rng));
+}
+
+host_population::clock::duration host_population::exponential_delay(const std::chrono::milliseconds& mean)
+{
+    if (mean.count() <= 0) {
+        return clock::duration::zero();
+    }
+
+    double us = std::exponential_distribution<double>(1.0 / (mean.count() * 1000.0))(m_rng);
+    return std::chrono::microseconds(static_cast<long long>(us));
+}
+
+void host_population::change_state(unsigned int host_index)
+{
+    HC_LOG_TRACE("");
+
+    host& h = m_hosts[host_index];
+    h.m_old_channel = h.m_channel;
+    clock::duration next;
+
+    if (h.m_channel < 0) {
+        h.m_channel = sample_channel();
+        next = exponential_delay(m_mean_dwell_time);
+        ++m_joins;
+    } else if (std::uniform_int_distribution<unsigned int>(0, 99)(m_rng) < m_off_ratio) {
+        h.m_channel = -1;
+        next = exponential_delay(m_mean_off_time);
+        ++m_leaves;
+    } else {
+        if (m_channels.size() > 1) {
+            while (h.m_channel == h.m_old_channel) {
+                h.m_channel = sample_channel();
+            }
+        }
+        next = exponential_delay(m_mean_dwell_time);
+        ++m_zaps;
+    }
+
+    if (h.m_old_channel >= 0) {
+        --m_viewers[h.m_old_channel];
+    }
+    if (h.m_channel >= 0) {
+        ++m_viewers[h.m_channel];
+    }
+
+    ++h.m_generation;
+    ++m_changes;
+    send_state_change(host_index, false);
+
+    //retransmissions of the state change report
+    auto now = clock::now();
+    auto t = now;
+    std::chrono::milliseconds uri(is_v2() ? HOST_POPULATION_UNSOLICITED_REPORT_INTERVAL_V2 : HOST_POPULATION_UNSOLICITED_REPORT_INTERVAL_V3);
+    for (unsigned int i = 1; i < m_robustness; ++i) {
+        t += random_delay(uri);
+        m_events.push(event{t, ET_RETRANSMISSION, host_index, h.m_generation});
+    }
+
+    m_events.push(event{now + next, ET_CHANGE, host_index, 0});
+}
+
+void host_population::send_state_change(unsigned int host_index, bool retransmission)
+{
+    HC_LOG_TRACE("");
+
+    const host& h = m_hosts[host_index];
+    if (h.m_old_channel == h.m_channel) {
+        return;
+    }
+
+    if (is_v2()) {
+        //a leave is sent only once
+        if (h.m_old_channel >= 0 && !retransmission) {
+            send_v2_message(h.m_addr, false, h.m_old_channel);
+        }
+
+        if (h.m_channel >= 0) {
+            send_v2_message(h.m_addr, true, h.m_channel);
+        }
+    } else {
+        std::list<std::tuple<mcast_addr_record_type, unsigned int, std::list<addr_storage>>> records;
+        if (h.m_old_channel >= 0) {
+            if (m_sources.empty()) {
+                records.emplace_back(CHANGE_TO_INCLUDE_MODE, h.m_old_channel, std::list<addr_storage>());
+            } else {
+                records.emplace_back(BLOCK_OLD_SOURCES, h.m_old_channel, m_sources);
+            }
+        }
+
+        if (h.m_channel >= 0) {
+            if (m_sources.empty()) {
+                records.emplace_back(CHANGE_TO_EXCLUDE_MODE, h.m_channel, std::list<addr_storage>());
+            } else {
+                records.emplace_back(ALLOW_NEW_SOURCES, h.m_channel, m_sources);
+            }
+        }
+
+        send_report(h.m_addr, records);
+    }
+}
+
+void host_population::send_response(unsigned int host_index)
+{
+    HC_LOG_TRACE("");
+
+    host& h = m_hosts[host_index];
+    if (is_v2()) {
+        send_v2_message(h.m_addr, true, h.m_channel);
+        return;
+    }
+
+    std::list<std::tuple<mcast_addr_record_type, unsigned int, std::list<addr_storage>>> records;
+    if (h.m_response_sources.empty()) {
+        //current state
+        if (m_sources.empty()) {
+            records.emplace_back(MODE_IS_EXCLUDE, h.m_channel, std::list<addr_storage>());
+        } else {
+            records.emplace_back(MODE_IS_INCLUDE, h.m_channel, m_sources);
+        }
+    } else {
+        //the queried sources the host listens to
+        std::list<addr_storage> slist;
+        for (auto & e : h.m_response_sources) {
+            if (m_sources.empty() || std::find(m_sources.begin(), m_sources.end(), e) != m_sources.end()) {
+                slist.push_back(e);
+            }
+        }
+
+        if (slist.empty()) {
+            return;
+        }
+
+        records.emplace_back(MODE_IS_INCLUDE, h.m_channel, std::move(slist));
+    }
+
+    send_report(h.m_addr, records);
+}
+
+void host_population::process_event(const event& e)
+{
+    HC_LOG_TRACE("");
+
+    host& h = m_hosts[e.m_host];
+    switch (e.m_type) {
+    case ET_CHANGE:
+        change_state(e.m_host);
+        break;
+    case ET_RETRANSMISSION:
+        if (e.m_id == h.m_generation) {
+            ++m_retransmissions;
+            send_state_change(e.m_host, true);
+        }
+        break;
+    case ET_RESPONSE:
+        if (e.m_time != h.m_response_time) {
+            //replaced by an earlier response
+            return;
+        }
+        h.m_response_time = clock::time_point();
+
+        if (h.m_channel < 0) {
+            h.m_response_sources.clear();
+            return;
+        }
+
+        //another host answered the query already (IGMPv2, MLDv1)
+        if (is_v2() && m_last_answered_query[h.m_channel] >= e.m_id) {
+            ++m_suppressed;
+            return;
+        }
+
+        ++m_responses;
+        send_response(e.m_host);
+        h.m_response_sources.clear();
+        break;
+    default:
+        HC_LOG_ERROR("unknown event type");
+    }
+}
+
+void host_population::process_query(const addr_storage& gaddr, const std::chrono::milliseconds& max_resp_delay, std::list<addr_storage>&& qslist)
+{
+    HC_LOG_TRACE("");
+
+    ++m_query_count;
+
+    int channel = -1;
+    if (gaddr == addr_storage(m_addr_family)) {
+        ++m_general_queries;
+    } else {
+        ++m_specific_queries;
+        auto it = m_channel_index.find(gaddr);
+        if (it == std::end(m_channel_index)) {
+            return;
+        }
+        channel = it->second;
+    }
+
+    auto now = clock::now();
+    for (unsigned int i = 0; i < m_hosts.size(); ++i) {
+        host& h = m_hosts[i];
+        if (h.m_channel < 0 || (channel >= 0 && h.m_channel != channel)) {
+            continue;
+        }
+
+        auto t = now + random_delay(max_resp_delay);
+        bool pending = h.m_response_time != clock::time_point();
+
+        //merge with a pending response, the full state is reported if one of the queries is not source specific
+        if (pending && !h.m_response_sources.empty() && !qslist.empty()) {
+            for (auto & e : qslist) {
+                if (std::find(h.m_response_sources.begin(), h.m_response_sources.end(), e) == h.m_response_sources.end()) {
+                    h.m_response_sources.push_back(e);
+                }
+            }
+        } else if (pending) {
+            h.m_response_sources.clear();
+        } else {
+            h.m_response_sources = qslist;
+        }
+
+        if (!pending || t < h.m_response_time) {
+            h.m_response_time = t;
+            m_events.push(event{t, ET_RESPONSE, i, m_query_count});
+        }
+    }
+}
+
+void host_population::process_report(const addr_storage& gaddr)
+{
+    HC_LOG_TRACE("");
+
+    //a report of another host suppresses the pending responses (IGMPv2, MLDv1)
+    auto it = m_channel_index.find(gaddr);
+    if (it != std::end(m_channel_index)) {
+        m_last_answered_query[it->second] = m_query_count;
+    }
+}
+
+void host_population::process_packet(const uint8_t* buf, unsigned int size)
+{
+    HC_LOG_TRACE("");
+
+    timers_values tv;
+
+    if (m_addr_family == AF_INET) {
+        if (size < sizeof(ip)) {
+            return;
+        }
+
+        const ip* ip_hdr = reinterpret_cast<const ip*>(buf);
+        unsigned int ip_hdr_size = ip_hdr->ip_hl * 4;
+        if (ip_hdr->ip_v != 4 || ip_hdr->ip_p != IPPROTO_IGMP || size < ip_hdr_size + sizeof(igmp)) {
+            return;
+        }
+
+        unsigned int igmp_size = std::min<unsigned int>(ntohs(ip_hdr->ip_len), size) - ip_hdr_size;
+        const igmp* igmp_hdr = reinterpret_cast<const igmp*>(buf + ip_hdr_size);
+
+        if (igmp_hdr->igmp_type == IGMP_MEMBERSHIP_QUERY) {
+            std::list<addr_storage> qslist;
+            std::chrono::milliseconds max_resp_delay;
+            if (igmp_size >= sizeof(igmpv3_query)) {
+                const igmpv3_query* query = reinterpret_cast<const igmpv3_query*>(igmp_hdr);
+                max_resp_delay = tv.maxrespc_igmpv3_to_maxrespi(query->igmp_code);
+
+                unsigned int nos = std::min<unsigned int>(ntohs(query->num_of_srcs), (igmp_size - sizeof(igmpv3_query)) / sizeof(in_addr));
+                const in_addr* src = reinterpret_cast<const in_addr*>(buf + ip_hdr_size + sizeof(igmpv3_query));
+                for (unsigned int i = 0; i < nos; ++i) {
+                    qslist.push_back(addr_storage(src[i]));
+                }
+            } else {
+                //IGMPv1 queries have no max response time
+                max_resp_delay = std::chrono::milliseconds(igmp_hdr->igmp_code == 0 ? 10000 : igmp_hdr->igmp_code * 100);
+            }
+
+            process_query(addr_storage(igmp_hdr->igmp_group), max_resp_delay, std::move(qslist));
+        } else if (igmp_hdr->igmp_type == IGMP_V1_MEMBERSHIP_REPORT || igmp_hdr->igmp_type == IGMP_V2_MEMBERSHIP_REPORT) {
+            process_report(addr_storage(igmp_hdr->igmp_group));
+        }
+    } else {
+        if (size < sizeof(ip6_hdr)) {
+            return;
+        }
+
+        //skip the hop-by-hop options header with the router alert option
+        const ip6_hdr* ip_hdr = reinterpret_cast<const ip6_hdr*>(buf);
+        unsigned int offset = sizeof(ip6_hdr);
+        uint8_t next_header = ip_hdr->ip6_nxt;
+        while (next_header == IPPROTO_HOPOPTS && offset + 8 <= size) {
+            next_header = buf[offset];
+            offset += (buf[offset + 1] + 1) * 8;
+        }
+
+        if (next_header != IPPROTO_ICMPV6 || size < offset + sizeof(mldv1)) {
+            return;
+        }
+
+        unsigned int mld_size = size - offset;
+        const mldv1* mld_hdr = reinterpret_cast<const mldv1*>(buf + offset);
+
+        if (mld_hdr->type == MLD_LISTENER_QUERY) {
+            std::list<addr_storage> qslist;
+            std::chrono::milliseconds max_resp_delay;
+            if (mld_size >= sizeof(mldv2_query)) {
+                const mldv2_query* query = reinterpret_cast<const mldv2_query*>(mld_hdr);
+                max_resp_delay = tv.maxrespc_mldv2_to_maxrespi(ntohs(query->max_resp_delay));
+
+                unsigned int nos = std::min<unsigned int>(ntohs(query->num_of_srcs), (mld_size - sizeof(mldv2_query)) / sizeof(in6_addr));
+                const in6_addr* src = reinterpret_cast<const in6_addr*>(buf + offset + sizeof(mldv2_query));
+                for (unsigned int i = 0; i < nos; ++i) {
+                    qslist.push_back(addr_storage(src[i]));
+                }
+            } else {
+                max_resp_delay = std::chrono::milliseconds(ntohs(mld_hdr->max_resp_delay));
+            }
+
+            process_query(addr_storage(mld_hdr->gaddr), max_resp_delay, std::move(qslist));
+        } else if (mld_hdr->type == MLD_LISTENER_REPORT) {
+            process_report(addr_storage(mld_hdr->gaddr));
+        }
+    }
+}
+
+bool host_population::send_v2_message(const addr_storage& saddr, bool join, unsigned int channel)
+{
+    HC_LOG_TRACE("");
+
+    const addr_storage& gaddr = m_channels[channel];
+    std::vector<uint8_t> payload;
+    addr_storage daddr;
+
+    if (m_addr_family == AF_INET) {
+        payload.resize(sizeof(igmp), 0);
+        igmp* igmp_hdr = reinterpret_cast<igmp*>(payload.data());
+        igmp_hdr->igmp_type = join ? IGMP_V2_MEMBERSHIP_REPORT : IGMP_V2_LEAVE_GROUP;
+        igmp_hdr->igmp_group = gaddr.get_in_addr();
+        daddr = join ? gaddr : addr_storage(IPV4_ALL_IGMP_ROUTERS_ADDR);
+    } else {
+        payload.resize(sizeof(mldv1), 0);
+        mldv1* mld_hdr = reinterpret_cast<mldv1*>(payload.data());
+        mld_hdr->type = join ? MLD_LISTENER_REPORT : MLD_LISTENER_REDUCTION;
+        mld_hdr->gaddr = gaddr.get_in6_addr();
+        daddr = join ? gaddr : addr_storage(IPV6_ALL_LINK_LOCAL_ROUTER);
+    }
+
+    //the report is heard by the other hosts of the group
+    if (join) {
+        m_last_answered_query[channel] = m_query_count;
+    }
+
+    return send_packet(saddr, daddr, payload);
+}
+
+bool host_population::send_report(const addr_storage& saddr, const std::list<std::tuple<mcast_addr_record_type, unsigned int, std::list<addr_storage>>>& records)
+{
+    HC_LOG_TRACE("");
+
+    std::vector<uint8_t> payload;
+
+    if (m_addr_family == AF_INET) {
+        payload.resize(sizeof(igmpv3_mc_report), 0);
+        for (auto & e : records) {
+            unsigned int offset = payload.size();
+            payload.resize(offset + sizeof(igmpv3_mc_record) + std::get<2>(e).size() * sizeof(in_addr), 0);
+
+            igmpv3_mc_record* rec = reinterpret_cast<igmpv3_mc_record*>(payload.data() + offset);
+            rec->type = std::get<0>(e);
+            rec->num_of_srcs = htons(std::get<2>(e).size());
+            rec->gaddr = m_channels[std::get<1>(e)].get_in_addr();
+
+            in_addr* src = reinterpret_cast<in_addr*>(payload.data() + offset + sizeof(igmpv3_mc_record));
+            for (auto & s : std::get<2>(e)) {
+                *src++ = s.get_in_addr();
+            }
+        }
+
+        igmpv3_mc_report* report = reinterpret_cast<igmpv3_mc_report*>(payload.data());
+        report->type = IGMP_V3_MEMBERSHIP_REPORT;
+        report->num_of_mc_records = htons(records.size());
+
+        return send_packet(saddr, addr_storage(IPV4_IGMPV3_ADDR), payload);
+    } else {
+        payload.resize(sizeof(mldv2_mc_report), 0);
+        for (auto & e : records) {
+            unsigned int offset = payload.size();
+            payload.resize(offset + sizeof(mldv2_mc_record) + std::get<2>(e).size() * sizeof(in6_addr), 0);
+
+            mldv2_mc_record* rec = reinterpret_cast<mldv2_mc_record*>(payload.data() + offset);
+            rec->type = std::get<0>(e);
+            rec->num_of_srcs = htons(std::get<2>(e).size());
+            rec->gaddr = m_channels[std::get<1>(e)].get_in6_addr();
+
+            in6_addr* src = reinterpret_cast<in6_addr*>(payload.data() + offset + sizeof(mldv2_mc_record));
+            for (auto & s : std::get<2>(e)) {
+                *src++ = s.get_in6_addr();
+            }
+        }
+
+        mldv2_mc_report* report = reinterpret_cast<mldv2_mc_report*>(payload.data());
+        report->type = MLD_V2_LISTENER_REPORT;
+        report->num_of_mc_records = htons(records.size());
+
+        return send_packet(saddr, addr_storage(IPV6_ALL_MLDv2_CAPABLE_ROUTERS), payload);
+    }
+}
+
+bool host_population::send_packet(const addr_storage& saddr, const addr_storage& daddr, std::vector<uint8_t>& payload)
+{
+    HC_LOG_TRACE("");
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_ifindex = m_if_index;
+    sll.sll_halen = ETH_ALEN;
+
+    //the IGMP and ICMPv6 checksum follows the type and code
+    uint16_t* checksum = reinterpret_cast<uint16_t*>(payload.data() + 2);
+    *checksum = 0;
+
+    if (m_addr_family == AF_INET) {
+        const unsigned int ip_hdr_size = sizeof(ip) + sizeof(router_alert_option);
+        m_packet_buf.assign(ip_hdr_size, 0);
+
+        ip* ip_hdr = reinterpret_cast<ip*>(m_packet_buf.data());
+        ip_hdr->ip_v = 4;
+        ip_hdr->ip_hl = ip_hdr_size / 4;
+        ip_hdr->ip_len = htons(ip_hdr_size + payload.size());
+        ip_hdr->ip_off = htons(IP_DF);
+        ip_hdr->ip_ttl = 1;
+        ip_hdr->ip_p = IPPROTO_IGMP;
+        ip_hdr->ip_src = saddr.get_in_addr();
+        ip_hdr->ip_dst = daddr.get_in_addr();
+        *reinterpret_cast<router_alert_option*>(m_packet_buf.data() + sizeof(ip)) = router_alert_option();
+        ip_hdr->ip_sum = checksum_fold(checksum_add(m_packet_buf.data(), ip_hdr_size, 0));
+
+        *checksum = checksum_fold(checksum_add(payload.data(), payload.size(), 0));
+
+        //01:00:5e and the lower 23 bits of the group address
+        const uint8_t* g = reinterpret_cast<const uint8_t*>(&ip_hdr->ip_dst);
+        uint8_t mac[ETH_ALEN] = {0x01, 0x00, 0x5e, static_cast<uint8_t>(g[1] & 0x7f), g[2], g[3]};
+        memcpy(sll.sll_addr, mac, ETH_ALEN);
+        sll.sll_protocol = htons(ETH_P_IP);
+    } else {
+        //hop-by-hop options header: next header ICMPv6, router alert (MLD), PadN
+        const uint8_t hop_by_hop[8] = {IPPROTO_ICMPV6, 0, 5, 2, 0, 0, 1, 0};
+        const unsigned int ip_hdr_size = sizeof(ip6_hdr) + sizeof(hop_by_hop);
+        m_packet_buf.assign(ip_hdr_size, 0);
+
+        ip6_hdr* ip_hdr = reinterpret_cast<ip6_hdr*>(m_packet_buf.data());
+        ip_hdr->ip6_flow = htonl(6 << 28);
+        ip_hdr->ip6_plen = htons(sizeof(hop_by_hop) + payload.size());
+        ip_hdr->ip6_nxt = IPPROTO_HOPOPTS;
+        ip_hdr->ip6_hlim = 1;
+        ip_hdr->ip6_src = saddr.get_in6_addr();
+        ip_hdr->ip6_dst = daddr.get_in6_addr();
+        memcpy(m_packet_buf.data() + sizeof(ip6_hdr), hop_by_hop, sizeof(hop_by_hop));
+
+        //pseudo header: source, destination, upper-layer length and next header
+        uint32_t sum = checksum_add(reinterpret_cast<const uint8_t*>(&ip_hdr->ip6_src), 2 * sizeof(in6_addr), 0);
+        sum += payload.size() + IPPROTO_ICMPV6;
+        *checksum = checksum_fold(checksum_add(payload.data(), payload.size(), sum));
+
+        //33:33 and the lower 32 bits of the group address
+        const uint8_t* g = reinterpret_cast<const uint8_t*>(&ip_hdr->ip6_dst);
+        uint8_t mac[ETH_ALEN] = {0x33, 0x33, g[12], g[13], g[14], g[15]};
+        memcpy(sll.sll_addr, mac, ETH_ALEN);
+        sll.sll_protocol = htons(ETH_P_IPV6);
+    }
+
+    m_packet_buf.insert(m_packet_buf.end(), payload.begin(), payload.end());
+    if (m_packet_buf.size() > HOST_POPULATION_MAX_PACKET_SIZE) {
+        HC_LOG_ERROR("packet too large: " << m_packet_buf.size() << " bytes");
+        ++m_send_errors;
+        return false;
+    }
+
+    if (sendto(m_sock, m_packet_buf.data(), m_packet_buf.size(), 0, reinterpret_cast<struct sockaddr*>(&sll), sizeof(sll)) < 0) {
+        HC_LOG_ERROR("failed to send packet! Error: " << strerror(errno) << " errno: " << errno);
+        ++m_send_errors;
+        return false;
+    }
+
+    ++m_packets_sent;
+    return true;
+}
+
+void host_population::run(const bool& running, unsigned long max_count, bool print_status_msg)
+{
+    HC_LOG_TRACE("");
+
+    std::vector<uint8_t> buf(65536);
+    auto status_time = clock::now();
+
+    while (running && (max_count == 0 || m_changes < max_count)) {
+        auto now = clock::now();
+        while (!m_events.empty() && m_events.top().m_time <= now) {
+            event e = m_events.top();
+            m_events.pop();
+            process_event(e);
+        }
+
+        //wait for the next event or a query, rounded up to the next millisecond
+        int timeout = 100;
+        if (!m_events.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(m_events.top().m_time - clock::now()).count();
+            timeout = std::min<long long>(std::max<long long>((wait + 999) / 1000, 0), timeout);
+        }
+
+        struct pollfd pfd;
+        pfd.fd = m_sock;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, timeout) > 0) {
+            while (true) {
+                struct sockaddr_ll sll;
+                socklen_t sll_len = sizeof(sll);
+                ssize_t size = recvfrom(m_sock, buf.data(), buf.size(), MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&sll), &sll_len);
+                if (size < 0) {
+                    break;
+                }
+
+                if (sll.sll_pkttype != PACKET_OUTGOING) {
+                    process_packet(buf.data(), size);
+                }
+            }
+        }
+
+        if (print_status_msg && clock::now() - status_time >= std::chrono::seconds(1)) {
+            status_time = clock::now();
+            unsigned int on = std::count_if(m_hosts.begin(), m_hosts.end(), [](const host & h) {
+                return h.m_channel >= 0;
+            });
+            std::cout << "\rhosts on: " << on << "; changes: " << m_changes << "; queries: " << m_general_queries + m_specific_queries << "; responses: " << m_responses << "; packets: " << m_packets_sent;
+            std::flush(std::cout);
+        }
+    }
+
+    if (print_status_msg) {
+        std::cout << std::endl;
+    }
+
+    if (m_leave_on_exit) {
+        for (unsigned int i = 0; i < m_hosts.size(); ++i) {
+            host& h = m_hosts[i];
+            if (h.m_channel >= 0) {
+                --m_viewers[h.m_channel];
+                h.m_old_channel = h.m_channel;
+                h.m_channel = -1;
+                ++m_leaves;
+                send_state_change(i, false);
+            }
+        }
+    }
+}
+
+std::string host_population::to_string() const
+{
+    HC_LOG_TRACE("");
+
+    std::ostringstream s;
+    unsigned int on = std::count_if(m_hosts.begin(), m_hosts.end(), [](const host & h) {
+        return h.m_channel >= 0;
+    });
+    unsigned int watched = std::count_if(m_viewers.begin(), m_viewers.end(), [](unsigned int v) {
+        return v > 0;
+    });
+
+    s << "summary==> protocol: " << get_group_mem_protocol_name(m_group_mem_protocol) << "; hosts(#): " << m_hosts.size() << "; hosts on(#): " << on << "; channels(#): " << m_channels.size() << "; channels watched(#): " << watched << std::endl;
+    s << "state changes(#): " << m_changes << "; joins(#): " << m_joins << "; zaps(#): " << m_zaps << "; leaves(#): " << m_leaves << "; retransmissions(#): " << m_retransmissions << std::endl;
+    s << "general queries(#): " << m_general_queries << "; specific queries(#): " << m_specific_queries << "; responses(#): " << m_responses << "; suppressed responses(#): " << m_suppressed << std::endl;
+    s << "packets sent(#): " << m_packets_sent << "; send errors(#): " << m_send_errors << std::endl;
+
+    return s.str();
+}
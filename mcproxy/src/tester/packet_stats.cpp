@@ -0,0 +1,245 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/tester/packet_stats.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <limits>
+
+packet_window::packet_window(uint64_t window_size)
+    : m_started(false)
+    , m_highest(0)
+    , m_received(0)
+    , m_lost(0)
+    , m_duplicates(0)
+    , m_reordered(0)
+    , m_late(0)
+{
+    HC_LOG_TRACE("");
+
+    uint64_t size = 64;
+    while (size < window_size) {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+
+    //the packets before the first received packet are not expected
+    m_bitmap.resize(size / 64, std::numeric_limits<uint64_t>::max());
+}
+
+bool packet_window::test(uint64_t seq) const
+{
+    uint64_t slot = seq & m_mask;
+    return (m_bitmap[slot >> 6] >> (slot & 63)) & 1;
+}
+
+void packet_window::set(uint64_t seq)
+{
+    uint64_t slot = seq & m_mask;
+    m_bitmap[slot >> 6] |= 1ULL << (slot & 63);
+}
+
+void packet_window::clear(uint64_t seq)
+{
+    uint64_t slot = seq & m_mask;
+    m_bitmap[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+bool packet_window::add(uint64_t seq)
+{
+    if (!m_started) {
+        m_started = true;
+        m_highest = seq;
+        set(seq);
+        ++m_received;
+        return true;
+    }
+
+    uint64_t window_size = m_mask + 1;
+    if (seq > m_highest) {
+        uint64_t gap = seq - m_highest;
+        if (gap >= window_size) {
+            //the whole window slides out
+            for (auto & e : m_bitmap) {
+                m_lost += 64 - __builtin_popcountll(e);
+                e = 0;
+            }
+            m_lost += gap - window_size;
+        } else {
+            for (uint64_t s = m_highest + 1; s <= seq; ++s) {
+                if (!test(s)) {
+                    ++m_lost; //the slot of packet s - window_size was not received
+                }
+                clear(s);
+            }
+        }
+
+        m_highest = seq;
+        set(seq);
+        ++m_received;
+        return true;
+    }
+
+    if (m_highest - seq >= window_size) {
+        ++m_late;
+        return false;
+    }
+
+    if (test(seq)) {
+        ++m_duplicates;
+        return false;
+    }
+
+    set(seq);
+    ++m_received;
+    ++m_reordered;
+    return true;
+}
+
+uint64_t packet_window::get_received() const
+{
+    return m_received;
+}
+
+uint64_t packet_window::get_lost() const
+{
+    uint64_t missing = 0;
+    if (m_started) {
+        for (auto & e : m_bitmap) {
+            missing += 64 - __builtin_popcountll(e);
+        }
+    }
+    return m_lost + missing;
+}
+
+uint64_t packet_window::get_duplicates() const
+{
+    return m_duplicates;
+}
+
+uint64_t packet_window::get_reordered() const
+{
+    return m_reordered;
+}
+
+uint64_t packet_window::get_late() const
+{
+    return m_late;
+}
+//-----------------------------------------------------
+latency_histogram::latency_histogram()
+    : m_counts(PACKET_STATS_SUB_BUCKETS + (64 - PACKET_STATS_SUB_BUCKET_BITS) * (PACKET_STATS_SUB_BUCKETS / 2), 0)
+    , m_total_count(0)
+    , m_min(std::numeric_limits<uint64_t>::max())
+    , m_max(0)
+    , m_sum(0)
+{
+    HC_LOG_TRACE("");
+}
+
+unsigned int latency_histogram::get_index(uint64_t value)
+{
+    if (value < PACKET_STATS_SUB_BUCKETS) {
+        return value;
+    }
+
+    //the highest PACKET_STATS_SUB_BUCKET_BITS bits select the sub-bucket of the magnitude
+    unsigned int magnitude = 63 - __builtin_clzll(value);
+    unsigned int shift = magnitude - PACKET_STATS_SUB_BUCKET_BITS + 1;
+    unsigned int sub_bucket = value >> shift;
+    return PACKET_STATS_SUB_BUCKETS + (shift - 1) * (PACKET_STATS_SUB_BUCKETS / 2) + (sub_bucket - PACKET_STATS_SUB_BUCKETS / 2);
+}
+
+uint64_t latency_histogram::get_value(unsigned int index)
+{
+    if (index < PACKET_STATS_SUB_BUCKETS) {
+        return index;
+    }
+
+    unsigned int k = index - PACKET_STATS_SUB_BUCKETS;
+    unsigned int shift = k / (PACKET_STATS_SUB_BUCKETS / 2) + 1;
+    uint64_t sub_bucket = k % (PACKET_STATS_SUB_BUCKETS / 2) + PACKET_STATS_SUB_BUCKETS / 2;
+    return (sub_bucket << shift) + ((1ULL << shift) >> 1);
+}
+
+void latency_histogram::add(uint64_t value)
+{
+    ++m_counts[get_index(value)];
+    ++m_total_count;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_sum += value;
+}
+
+uint64_t latency_histogram::get_count() const
+{
+    return m_total_count;
+}
+
+uint64_t latency_histogram::get_min() const
+{
+    return m_total_count > 0 ? m_min : 0;
+}
+
+uint64_t latency_histogram::get_max() const
+{
+    return m_max;
+}
+
+double latency_histogram::get_mean() const
+{
+    return m_total_count > 0 ? static_cast<double>(m_sum / m_total_count) : 0;
+}
+
+uint64_t latency_histogram::get_percentile(double percentile) const
+{
+    if (m_total_count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100 * m_total_count));
+    uint64_t count = 0;
+    for (unsigned int i = 0; i < m_counts.size(); ++i) {
+        count += m_counts[i];
+        if (count >= rank) {
+            return std::min(std::max(get_value(i), get_min()), m_max);
+        }
+    }
+    return m_max;
+}
+
+std::string latency_histogram::to_string() const
+{
+    HC_LOG_TRACE("");
+    std::ostringstream s;
+
+    uint64_t count = 0;
+    for (unsigned int i = 0; i < m_counts.size(); ++i) {
+        if (m_counts[i] > 0) {
+            count += m_counts[i];
+            s << get_value(i) << " " << m_counts[i] << " " << 100.0 * count / m_total_count << std::endl;
+        }
+    }
+    return s.str();
+}
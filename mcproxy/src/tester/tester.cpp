@@ -34,9 +34,17 @@
 #include <thread>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <random>
 
 #include <unistd.h> //for getopt
 #include<sys/time.h>
+#include <poll.h>
+#include <endian.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
 
 bool tester::m_running = true;
 volatile int busy_waiting;
@@ -613,6 +621,486 @@ void tester::receive_data(const std::unique_ptr<const mc_socket>& ms, int port,
     }
 }
 
+//header of a high rate packet, in network byte order
+struct high_rate_header {
+    uint64_t seq;
+    uint64_t send_time_stamp; //nanoseconds, realtime clock
+};
+
+static uint64_t get_realtime_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void tester::send_data_high_rate(const std::unique_ptr<const mc_socket>& ms, const addr_storage& gaddr, int port, int ttl, unsigned long max_count, unsigned long send_rate, unsigned int batch_size, unsigned int packet_size, bool print_status_msg)
+{
+    HC_LOG_TRACE("");
+
+    std::cout << "set ttl to " << ttl << std::endl;
+    if (!ms->set_ttl(ttl)) {
+        std::cout << "failed to set ttl" << std::endl;
+        exit(0);
+    }
+
+    batch_size = std::max(batch_size, 1U);
+    packet_size = std::max<unsigned int>(packet_size, sizeof(high_rate_header));
+
+    addr_storage dst = gaddr;
+    dst.set_port(port);
+    socklen_t dst_len = dst.get_addr_family() == AF_INET ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
+
+    std::vector<std::vector<char>> bufs(batch_size, std::vector<char>(packet_size, 0));
+    std::vector<struct iovec> iovs(batch_size);
+    std::vector<struct mmsghdr> msgs(batch_size);
+    for (unsigned int i = 0; i < batch_size; ++i) {
+        iovs[i].iov_base = bufs[i].data();
+        iovs[i].iov_len = packet_size;
+        memset(&msgs[i], 0, sizeof(struct mmsghdr));
+        msgs[i].msg_hdr.msg_name = const_cast<sockaddr_storage*>(&dst.get_sockaddr_storage());
+        msgs[i].msg_hdr.msg_namelen = dst_len;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    //a batch is sent per timer expiration
+    int tfd = -1;
+    if (send_rate > 0) {
+        tfd = timerfd_create(CLOCK_MONOTONIC, 0);
+        if (tfd < 0) {
+            std::cout << "failed to create timerfd: " << strerror(errno) << std::endl;
+            exit(0);
+        }
+
+        uint64_t interval = 1000000000ULL * batch_size / send_rate;
+        struct itimerspec its;
+        its.it_interval.tv_sec = interval / 1000000000ULL;
+        its.it_interval.tv_nsec = interval % 1000000000ULL;
+        its.it_value = its.it_interval;
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
+            its.it_value.tv_nsec = its.it_interval.tv_nsec = 1;
+        }
+        if (timerfd_settime(tfd, 0, &its, nullptr) < 0) {
+            std::cout << "failed to set timerfd: " << strerror(errno) << std::endl;
+            exit(0);
+        }
+    }
+
+    std::cout << "send " << packet_size << "byte packets in batches of " << batch_size << " to " << dst << " port " << port;
+    if (send_rate > 0) {
+        std::cout << " with " << send_rate << " packets per sec" << std::endl;
+    } else {
+        std::cout << " unpaced" << std::endl;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    auto status_time = start_time;
+    uint64_t seq = 0;
+    uint64_t send_errors = 0;
+    while (m_running && (max_count == 0 || seq < max_count)) {
+        uint64_t batches = 1;
+        if (tfd >= 0) {
+            if (read(tfd, &batches, sizeof(batches)) != sizeof(batches)) {
+                continue;
+            }
+        }
+
+        //a delayed wake-up sends the missed batches to keep the rate
+        for (uint64_t b = 0; b < batches && m_running && (max_count == 0 || seq < max_count); ++b) {
+            unsigned int count = batch_size;
+            if (max_count != 0) {
+                count = std::min<uint64_t>(count, max_count - seq);
+            }
+
+            uint64_t send_time_stamp = htobe64(get_realtime_ns());
+            for (unsigned int i = 0; i < count; ++i) {
+                high_rate_header* header = reinterpret_cast<high_rate_header*>(bufs[i].data());
+                header->seq = htobe64(seq + i + 1);
+                header->send_time_stamp = send_time_stamp;
+            }
+
+            int sent = sendmmsg(ms->get_socket(), msgs.data(), count, 0);
+            if (sent < 0) {
+                if (errno != EINTR && errno != ENOBUFS && errno != EAGAIN) {
+                    std::cout << "failed to send packets: " << strerror(errno) << std::endl;
+                    exit(0);
+                }
+                ++send_errors;
+                continue;
+            }
+            seq += sent;
+        }
+
+        if (print_status_msg && std::chrono::steady_clock::now() - status_time >= std::chrono::seconds(1)) {
+            status_time = std::chrono::steady_clock::now();
+            std::cout << "\rsend: " << seq;
+            std::flush(std::cout);
+        }
+    }
+
+    if (tfd >= 0) {
+        close(tfd);
+    }
+
+    double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    double packets_per_sec = duration > 0 ? seq / duration : 0;
+
+    if (print_status_msg) {
+        std::cout << std::endl;
+    }
+
+    std::cout << "summary==> packet_count(#): " << seq << "; packet size(byte): " << packet_size << "; send duration(ms): " << static_cast<long long>(duration * 1000) << "; packets per sec: " << static_cast<long long>(packets_per_sec) << "; throughput(MBit/s): " << packets_per_sec * packet_size * 8 / 1000000 << "; send errors: " << send_errors << std::endl;
+}
+
+void tester::receive_data_high_rate(const std::unique_ptr<const mc_socket>& ms, int port, const addr_storage& gaddr, unsigned long max_count, unsigned int batch_size, unsigned long window_size, bool print_status_msg, bool save_to_file, const std::string& file_name, const std::string& file_operation_mode)
+{
+    HC_LOG_TRACE("");
+
+    const unsigned int size = 65536;
+    batch_size = std::max(batch_size, 1U);
+
+    std::ofstream file;
+    if (save_to_file) {
+        if (file_operation_mode.compare("override") == 0) {
+            file.open(file_name, std::ios::trunc);
+        } else if (file_operation_mode.compare("append") == 0) {
+            file.open(file_name, std::ios::app);
+        }
+
+        if (!file.is_open()) {
+            std::cout << "failed to open file: " << file_name << std::endl;
+            exit(0);
+        }
+    }
+
+    if (!ms->set_reuse_port(true)) {
+        std::cout << "failed to set socket option reuse port" << std::endl;
+        exit(0);
+    }
+
+    if (!ms->set_multicast_all(false)) {
+        std::cout << "failed to set socket option multicast all" << std::endl;
+        exit(0);
+    }
+
+    if (!ms->bind_udp_socket(addr_storage(gaddr.get_addr_family()), port)) { //bind to any address
+        std::cout << "failed to bind port " << port << " and address "<< gaddr << " to socket" << std::endl;
+        exit(0);
+    }
+
+    if (!ms->set_receive_timeout(100)) {
+        std::cout << "failed to set receive timeout" << std::endl;
+        exit(0);
+    }
+
+    //kernel receive time stamps, the latency does not include the batching delay
+    int sock = ms->get_socket();
+    int on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0) {
+        std::cout << "failed to set socket option timestamp, the receive time is taken after each batch" << std::endl;
+    }
+
+    //a large receive buffer absorbs the bursts (limited by net.core.rmem_max)
+    int rcvbuf = 16 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    const unsigned int control_size = CMSG_SPACE(sizeof(struct timespec));
+    std::vector<std::vector<char>> bufs(batch_size, std::vector<char>(size, 0));
+    std::vector<std::vector<char>> controls(batch_size, std::vector<char>(control_size, 0));
+    std::vector<struct iovec> iovs(batch_size);
+    std::vector<struct mmsghdr> msgs(batch_size);
+    for (unsigned int i = 0; i < batch_size; ++i) {
+        iovs[i].iov_base = bufs[i].data();
+        iovs[i].iov_len = size;
+    }
+
+    packet_window window(window_size);
+    latency_histogram histogram;
+    uint64_t data_total_size = 0;
+    uint64_t invalid_packets = 0;
+    std::chrono::steady_clock::time_point first_time;
+    std::chrono::steady_clock::time_point last_time;
+    auto status_time = std::chrono::steady_clock::now();
+
+    while (m_running && (max_count == 0 || window.get_received() < max_count)) {
+        for (unsigned int i = 0; i < batch_size; ++i) {
+            memset(&msgs[i], 0, sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = controls[i].data();
+            msgs[i].msg_hdr.msg_controllen = control_size;
+        }
+
+        int n = recvmmsg(sock, msgs.data(), batch_size, MSG_WAITFORONE, nullptr);
+        if (n <= 0) {
+            //timeout or interrupt (SIGINT)
+            continue;
+        }
+
+        uint64_t batch_time = get_realtime_ns();
+        last_time = std::chrono::steady_clock::now();
+        if (window.get_received() == 0 && invalid_packets == 0) {
+            first_time = last_time;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            data_total_size += msgs[i].msg_len;
+            if (msgs[i].msg_len < sizeof(high_rate_header)) {
+                ++invalid_packets;
+                continue;
+            }
+
+            uint64_t receive_time = batch_time;
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    struct timespec ts;
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    receive_time = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+                }
+            }
+
+            const high_rate_header* header = reinterpret_cast<const high_rate_header*>(bufs[i].data());
+            uint64_t send_time = be64toh(header->send_time_stamp);
+            if (window.add(be64toh(header->seq))) {
+                histogram.add(receive_time > send_time ? receive_time - send_time : 0);
+            }
+        }
+
+        if (print_status_msg && last_time - status_time >= std::chrono::seconds(1)) {
+            status_time = last_time;
+            std::cout << "\rreceived: " << window.get_received() << "; lost: " << window.get_lost() << "; duplicates: " << window.get_duplicates() << "; p99 latency: " << histogram.get_percentile(99) / 1000.0 << "us";
+            std::flush(std::cout);
+        }
+    }
+
+    //calculate summary
+    double duration = std::chrono::duration<double>(last_time - first_time).count();
+    double packets_per_sec = duration > 0 ? window.get_received() / duration : 0;
+    uint64_t expected = window.get_received() + window.get_lost();
+    double loss = expected > 0 ? 100.0 * window.get_lost() / expected : 0;
+
+    std::ostringstream oss_summary;
+    oss_summary << "--- summary==> packet_count(#): " << window.get_received() << "; lost(#): " << window.get_lost() << "; loss(%): " << loss << "; duplicates(#): " << window.get_duplicates() << "; reordered(#): " << window.get_reordered() << "; late(#): " << window.get_late() << "; invalid(#): " << invalid_packets << "; total data size(byte): " << data_total_size << "; receive duration(ms): " << static_cast<long long>(duration * 1000) << "; packets per sec: " << static_cast<long long>(packets_per_sec) << "; throughput(MBit/s): " << (duration > 0 ? data_total_size * 8 / duration / 1000000 : 0) << std::endl;
+    oss_summary << "--- latency(us)==> min: " << histogram.get_min() / 1000.0 << "; mean: " << histogram.get_mean() / 1000.0 << "; p50: " << histogram.get_percentile(50) / 1000.0 << "; p90: " << histogram.get_percentile(90) / 1000.0 << "; p99: " << histogram.get_percentile(99) / 1000.0 << "; p999: " << histogram.get_percentile(99.9) / 1000.0 << "; max: " << histogram.get_max() / 1000.0 << std::endl;
+
+    if (print_status_msg) {
+        std::cout << std::endl;
+    }
+
+    std::cout << oss_summary.str();
+
+    if (save_to_file) {
+        file << oss_summary.str();
+        file << "latency(ns) count(#) percentile(%)" << std::endl;
+        file << histogram.to_string();
+        file.close();
+    }
+}
+
+void tester::zap_data(const std::unique_ptr<const mc_socket>& ms, const std::string& if_name, const addr_storage& gaddr, unsigned int group_count, unsigned long max_count, bool zapping, const std::chrono::milliseconds& dwell_time, const std::chrono::milliseconds& leave_wait, const std::chrono::milliseconds& timeout, int seed, bool save_to_file, const std::string& file_name, const std::string& file_operation_mode)
+{
+    HC_LOG_TRACE("");
+    using clock = std::chrono::steady_clock;
+
+    unsigned int if_index = interfaces::get_if_index(if_name);
+
+    std::vector<addr_storage> groups;
+    addr_storage group = gaddr;
+    for (unsigned int i = 0; i < std::max(group_count, 1U); ++i) {
+        groups.push_back(group);
+        ++group;
+    }
+
+    std::ofstream file;
+    if (save_to_file) {
+        if (file_operation_mode.compare("override") == 0) {
+            file.open(file_name, std::ios::trunc);
+        } else if (file_operation_mode.compare("append") == 0) {
+            file.open(file_name, std::ios::app);
+        }
+
+        if (!file.is_open()) {
+            std::cout << "failed to open file: " << file_name << std::endl;
+            exit(0);
+        }
+    }
+
+    //the traffic is observed below the IP layer, so the packets of a left group are still seen
+    int packet_sock = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_ALL));
+    if (packet_sock < 0) {
+        std::cout << "failed to create packet socket: " << strerror(errno) << std::endl;
+        exit(0);
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = if_index;
+    if (bind(packet_sock, reinterpret_cast<struct sockaddr*>(&sll), sizeof(sll)) < 0) {
+        std::cout << "failed to bind packet socket to interface " << if_name << ": " << strerror(errno) << std::endl;
+        close(packet_sock);
+        exit(0);
+    }
+
+    //result line: <join|zap|leave> <group> <latency in microseconds|timeout>
+    auto print_result = [&](const std::string & kind, const addr_storage & g, long long latency) {
+        std::ostringstream oss;
+        oss << kind << " " << g << " ";
+        if (latency < 0) {
+            oss << "timeout";
+        } else {
+            oss << latency;
+        }
+        std::cout << oss.str() << std::endl;
+        if (save_to_file) {
+            file << oss.str() << std::endl;
+        }
+    };
+
+    struct left_group {
+        clock::time_point leave_time;
+        clock::time_point last_packet;
+    };
+
+    //group address ==> leave time and last packet of a left group
+    std::map<addr_storage, left_group> left_groups;
+
+    auto finish_left_group = [&](std::map<addr_storage, left_group>::iterator it, const clock::time_point & now) {
+        if (now - it->second.last_packet < std::chrono::milliseconds(TESTER_ZAP_QUIET_TIME)) {
+            print_result("leave", it->first, -1);
+        } else {
+            print_result("leave", it->first, std::chrono::duration_cast<std::chrono::microseconds>(it->second.last_packet - it->second.leave_time).count());
+        }
+        return left_groups.erase(it);
+    };
+
+    //receive until the deadline or the first packet of the group wait_for (if set), return true if it arrived
+    std::vector<unsigned char> buf(2048);
+    auto receive_until = [&](const clock::time_point & deadline, const addr_storage * wait_for) {
+        while (m_running) {
+            auto now = clock::now();
+            auto next_event = deadline;
+            for (auto it = left_groups.begin(); it != left_groups.end();) {
+                if (now >= it->second.leave_time + leave_wait) {
+                    it = finish_left_group(it, now);
+                } else {
+                    next_event = std::min(next_event, it->second.leave_time + leave_wait);
+                    ++it;
+                }
+            }
+
+            if (now >= deadline) {
+                return false;
+            }
+
+            struct pollfd pfd = {packet_sock, POLLIN, 0};
+            int poll_timeout = std::chrono::duration_cast<std::chrono::milliseconds>(next_event - now).count() + 1;
+            if (poll(&pfd, 1, poll_timeout) <= 0) {
+                continue;
+            }
+
+            struct sockaddr_ll from;
+            socklen_t from_len = sizeof(from);
+            int len = recvfrom(packet_sock, buf.data(), buf.size(), 0, reinterpret_cast<struct sockaddr*>(&from), &from_len);
+            if (len <= 0 || from.sll_pkttype == PACKET_OUTGOING) {
+                continue;
+            }
+            auto receive_time = clock::now();
+
+            //only UDP packets, the reports and queries of a group are sent to the group address too
+            addr_storage dst;
+            if ((buf[0] >> 4) == 4 && len >= 20 && buf[9] == IPPROTO_UDP) {
+                in_addr addr;
+                memcpy(&addr, &buf[16], sizeof(addr));
+                dst = addr;
+            } else if ((buf[0] >> 4) == 6 && len >= 40 && buf[6] == IPPROTO_UDP) {
+                in6_addr addr;
+                memcpy(&addr, &buf[24], sizeof(addr));
+                dst = addr;
+            } else {
+                continue;
+            }
+
+            auto left_it = left_groups.find(dst);
+            if (left_it != left_groups.end()) {
+                left_it->second.last_packet = receive_time;
+            }
+
+            if (wait_for != nullptr && dst == *wait_for) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::default_random_engine random_engine(seed);
+    std::uniform_int_distribution<unsigned int> group_distribution(0, groups.size() - 1);
+
+    const addr_storage* current = nullptr;
+    for (unsigned long i = 0; m_running && (max_count == 0 || i < max_count); ++i) {
+        const addr_storage* next = &groups[group_distribution(random_engine)];
+        while (groups.size() > 1 && next == current) {
+            next = &groups[group_distribution(random_engine)];
+        }
+
+        auto change_time = clock::now();
+        bool zap = current != nullptr;
+        if (current != nullptr) {
+            if (!ms->leave_group(*current, if_index)) {
+                std::cout << "failed to leave group " << *current << std::endl;
+                exit(0);
+            }
+            left_groups[*current] = {change_time, change_time};
+        }
+
+        //the leave of the group is not measured if it is joined again before its traffic stopped
+        left_groups.erase(*next);
+
+        if (!ms->join_group(*next, if_index)) {
+            std::cout << "failed to join group " << *next << std::endl;
+            exit(0);
+        }
+
+        if (receive_until(change_time + timeout, next)) {
+            print_result(zap ? "zap" : "join", *next, std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - change_time).count());
+        } else if (m_running) {
+            print_result(zap ? "zap" : "join", *next, -1);
+        }
+
+        receive_until(clock::now() + dwell_time, nullptr);
+
+        if (zapping) {
+            current = next;
+        } else {
+            auto leave_time = clock::now();
+            if (!ms->leave_group(*next, if_index)) {
+                std::cout << "failed to leave group " << *next << std::endl;
+                exit(0);
+            }
+            left_groups[*next] = {leave_time, leave_time};
+            receive_until(leave_time + leave_wait, nullptr);
+        }
+    }
+
+    //wait for the traffic of the last groups to stop
+    if (current != nullptr) {
+        auto leave_time = clock::now();
+        ms->leave_group(*current, if_index);
+        left_groups[*current] = {leave_time, leave_time};
+    }
+
+    while (m_running && !left_groups.empty()) {
+        receive_until(clock::now() + leave_wait, nullptr);
+    }
+
+    close(packet_sock);
+    if (save_to_file) {
+        file.close();
+    }
+}
+
 void tester::send_data(const std::unique_ptr<const mc_socket>& ms, addr_storage& gaddr, int port, int ttl, unsigned long max_count, unsigned int& current_packet_number, bool include_time_stamp, const std::chrono::milliseconds& interval, int busy_waiting_counter,  const std::string& msg, bool print_status_msg)
 {
     HC_LOG_TRACE("");
@@ -760,6 +1248,21 @@ void tester::run(const std::string& to_do, const std::string& output_file, unsig
     std::string to_do_next = get_to_do_next(to_do);
     HC_LOG_DEBUG("to_do_next: " << to_do_next);
 
+    bool high_rate = get_boolean(to_do, "high_rate", false);
+    HC_LOG_DEBUG("high_rate: " << high_rate);
+
+    unsigned int batch_size = get_int(to_do, "batch_size", 32);
+    HC_LOG_DEBUG("batch_size: " << batch_size);
+
+    unsigned long send_rate = get_int(to_do, "send_rate", 0);
+    HC_LOG_DEBUG("send_rate: " << send_rate);
+
+    unsigned int packet_size = get_int(to_do, "packet_size", 1000);
+    HC_LOG_DEBUG("packet_size: " << packet_size);
+
+    unsigned long window_size = get_int(to_do, "window_size", PACKET_STATS_DEFAULT_WINDOW_SIZE);
+    HC_LOG_DEBUG("window_size: " << window_size);
+
     if (lifetime.count() > 0) {
         std::thread t([&]() {
             HC_LOG_TRACE("");
@@ -786,7 +1289,11 @@ void tester::run(const std::string& to_do, const std::string& output_file, unsig
             }
         }
 
-        receive_data(ms, port, gaddr, max_count, parse_time_stamp, print_status_msg, save_to_file, file_name, include_file_header, include_data, include_summary, ignore_duplicated_packets, pmanager, file_operation_mode);
+        if (high_rate) {
+            receive_data_high_rate(ms, port, gaddr, max_count, batch_size, window_size, print_status_msg, save_to_file, file_name, file_operation_mode);
+        } else {
+            receive_data(ms, port, gaddr, max_count, parse_time_stamp, print_status_msg, save_to_file, file_name, include_file_header, include_data, include_summary, ignore_duplicated_packets, pmanager, file_operation_mode);
+        }
         ms->close_socket();
         if (to_do_next.compare("null") != 0) {
             run(to_do_next, output_file, current_packet_number, pmanager, send_msg);
@@ -800,12 +1307,108 @@ void tester::run(const std::string& to_do, const std::string& output_file, unsig
             exit(0);
         }
 
-        send_data(ms, gaddr, port, ttl, max_count, current_packet_number, include_time_stamp, interval, busy_waiting_counter, msg, print_status_msg);
+        if (high_rate) {
+            send_data_high_rate(ms, gaddr, port, ttl, max_count, send_rate, batch_size, packet_size, print_status_msg);
+        } else {
+            send_data(ms, gaddr, port, ttl, max_count, current_packet_number, include_time_stamp, interval, busy_waiting_counter, msg, print_status_msg);
+        }
         ms->close_socket();
         if (to_do_next.compare("null") != 0) {
             run(to_do_next, output_file, current_packet_number, pmanager, send_msg);
         }
 
+        return;
+    } else if (action.compare("zap") == 0) {
+        if (!gaddr.is_multicast_addr()) {
+            std::cout << "group " << gaddr << " is not a multicast address" << std::endl;
+            exit(0);
+        }
+
+        std::string zap_mode = m_config_map.get(to_do, "zap_mode");
+        if (zap_mode.empty()) {
+            zap_mode = "zap";
+        } else if (zap_mode.compare("zap") != 0 && zap_mode.compare("join_leave") != 0) {
+            std::cout << "failed to parse zap_mode" << std::endl;
+            exit(0);
+        }
+
+        unsigned int group_count = get_int(to_do, "group_count", 1);
+        std::chrono::milliseconds dwell_time(get_int(to_do, "dwell_time", 1000));
+        std::chrono::milliseconds leave_wait(get_int(to_do, "leave_wait", 5000));
+        std::chrono::milliseconds timeout(get_int(to_do, "timeout", 5000));
+        int seed = get_int(to_do, "seed", 1);
+        HC_LOG_DEBUG("zap_mode: " << zap_mode << "; group_count: " << group_count << "; dwell_time: " << dwell_time.count() << "; leave_wait: " << leave_wait.count() << "; timeout: " << timeout.count() << "; seed: " << seed);
+
+        zap_data(ms, if_name, gaddr, group_count, max_count, zap_mode.compare("zap") == 0, dwell_time, leave_wait, timeout, seed, save_to_file, file_name, file_operation_mode);
+        ms->close_socket();
+        if (to_do_next.compare("null") != 0) {
+            run(to_do_next, output_file, current_packet_number, pmanager, send_msg);
+        }
+
+        return;
+    } else if (action.compare("population") == 0) {
+        if (!gaddr.is_multicast_addr()) {
+            std::cout << "group " << gaddr << " is not a multicast address" << std::endl;
+            exit(0);
+        }
+
+        int version = get_int(to_do, "version", gaddr.get_addr_family() == AF_INET ? 3 : 2);
+        group_mem_protocol gmp;
+        if (gaddr.get_addr_family() == AF_INET && (version == 2 || version == 3)) {
+            gmp = version == 2 ? IGMPv2 : IGMPv3;
+        } else if (gaddr.get_addr_family() == AF_INET6 && (version == 1 || version == 2)) {
+            gmp = version == 1 ? MLDv1 : MLDv2;
+        } else {
+            std::cout << "version " << version << " not supported (IGMPv2, IGMPv3, MLDv1 or MLDv2)" << std::endl;
+            exit(0);
+        }
+
+        addr_storage host_addr(m_config_map.get(to_do, "host_address"));
+        if (host_addr.get_addr_family() != gaddr.get_addr_family()) {
+            std::cout << "host_address is missing or has the wrong ip version" << std::endl;
+            exit(0);
+        }
+
+        double zipf_exponent;
+        try {
+            std::string str_zipf = m_config_map.get(to_do, "zipf_exponent");
+            zipf_exponent = str_zipf.empty() ? 1.0 : std::stod(str_zipf);
+        } catch (std::logic_error& e) {
+            std::cout << "failed to parse zipf_exponent" << std::endl;
+            exit(0);
+        }
+
+        unsigned int host_count = get_int(to_do, "host_count", 1000);
+        unsigned int group_count = get_int(to_do, "group_count", 100);
+        std::chrono::milliseconds dwell_time(get_int(to_do, "dwell_time", 60000));
+        unsigned int off_ratio = get_int(to_do, "off_ratio", 10);
+        std::chrono::milliseconds off_time(get_int(to_do, "off_time", 300000));
+        std::chrono::milliseconds ramp_time(get_int(to_do, "ramp_time", 10000));
+        unsigned int robustness = get_int(to_do, "robustness", HOST_POPULATION_ROBUSTNESS_DEFAULT);
+        bool leave_on_exit = get_boolean(to_do, "leave_on_exit", true);
+        int seed = get_int(to_do, "seed", 1);
+        HC_LOG_DEBUG("protocol: " << get_group_mem_protocol_name(gmp) << "; host_address: " << host_addr << "; host_count: " << host_count << "; group_count: " << group_count << "; zipf_exponent: " << zipf_exponent << "; dwell_time: " << dwell_time.count() << "; off_ratio: " << off_ratio << "; off_time: " << off_time.count() << "; ramp_time: " << ramp_time.count() << "; robustness: " << robustness << "; seed: " << seed);
+
+        ms->close_socket();
+        try {
+            std::cout << "simulate " << host_count << " " << get_group_mem_protocol_name(gmp) << " hosts from " << host_addr << " on interface " << if_name << std::endl;
+            host_population population(gmp, if_name, host_addr, host_count, gaddr, group_count, slist, zipf_exponent, dwell_time, off_ratio, off_time, ramp_time, robustness, leave_on_exit, seed);
+            population.run(m_running, max_count, print_status_msg);
+
+            std::cout << population.to_string();
+            if (save_to_file) {
+                std::ofstream file(file_name, file_operation_mode.compare("append") == 0 ? std::ios::app : std::ios::trunc);
+                file << population.to_string();
+            }
+        } catch (const char* e) {
+            std::cout << "failed to simulate the hosts: " << e << std::endl;
+            exit(0);
+        }
+
+        if (to_do_next.compare("null") != 0) {
+            run(to_do_next, output_file, current_packet_number, pmanager, send_msg);
+        }
+
         return;
     } else {
         std::cout << "action " << action << " not available" << std::endl;
@@ -152,6 +152,11 @@ int mc_socket::get_addr_family() const
     return m_addrFamily;
 }
 
+int mc_socket::get_socket() const
+{
+    return m_sock;
+}
+
 bool mc_socket::bind_udp_socket(const addr_storage& addr, in_port_t port) const
 {
     HC_LOG_TRACE("");
@@ -319,6 +324,63 @@ bool mc_socket::send_packet(const addr_storage& addr, const unsigned char* data,
     }
 }
 
+bool mc_socket::send_packet(const addr_storage& addr, const unsigned char* data, unsigned int data_size, uint32_t if_index) const
+{
+    HC_LOG_TRACE("addr: " << addr << " data_size: " << data_size << " if_index: " << if_index);
+
+    if (!is_udp_valid()) {
+        HC_LOG_ERROR("udp_socket invalid");
+        return false;
+    }
+
+    struct iovec iov;
+    iov.iov_base = const_cast<unsigned char*>(data);
+    iov.iov_len = data_size;
+
+    union {
+        struct cmsghdr align;
+        unsigned char buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = const_cast<sockaddr*>(&addr.get_sockaddr());
+    msg.msg_namelen = addr.get_addr_len();
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+
+    struct cmsghdr* cmsg;
+    if (m_addrFamily == AF_INET) {
+        msg.msg_controllen = CMSG_SPACE(sizeof(struct in_pktinfo));
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type = IP_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
+        reinterpret_cast<struct in_pktinfo*>(CMSG_DATA(cmsg))->ipi_ifindex = if_index;
+    } else if (m_addrFamily == AF_INET6) {
+        msg.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = IPPROTO_IPV6;
+        cmsg->cmsg_type = IPV6_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+        reinterpret_cast<struct in6_pktinfo*>(CMSG_DATA(cmsg))->ipi6_ifindex = if_index;
+    } else {
+        HC_LOG_ERROR("wrong address family");
+        return false;
+    }
+
+    int rc = sendmsg(m_sock, &msg, 0);
+
+    if (rc == -1) {
+        HC_LOG_ERROR("failed to send! Error: " << strerror(errno)  << " errno: " << errno);
+        return false; //failed to send
+    } else {
+        return true;
+    }
+}
+
 bool mc_socket::receive_packet(unsigned char* buf, int sizeOfBuf, int& sizeOfInfo) const
 {
     HC_LOG_TRACE("");
@@ -0,0 +1,403 @@
+/*
+ * This file is part of mcproxy.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * written by Sebastian Woelke, in cooperation with:
+ * INET group, Hamburg University of Applied Sciences,
+ * Website: http://mcproxy.realmv6.org/
+ */
+
+#include "include/hamcast_logging.h"
+#include "include/utils/mfc_simulator.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+mfc_simulator::mfc_simulator(int addr_family, int max_vifs)
+    : m_addr_family(addr_family)
+    , m_max_vifs(max_vifs > 0 ? max_vifs : (addr_family == AF_INET ? MAXVIFS : MAXMIFS))
+    , m_upcall_count(0)
+{
+    HC_LOG_TRACE("");
+
+    if (m_addr_family != AF_INET && m_addr_family != AF_INET6) {
+        throw "wrong address family";
+    }
+}
+
+void mfc_simulator::set_upcall_callback(callback_upcall cb_upcall)
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    m_cb_upcall = cb_upcall;
+}
+
+int mfc_simulator::get_vif(uint32_t if_index) const
+{
+    HC_LOG_TRACE("");
+
+    for (auto & e : m_vifs) {
+        if (e.second.if_index == if_index) {
+            return e.first;
+        }
+    }
+
+    return -1;
+}
+
+unsigned int mfc_simulator::forward(int vif_index, unsigned int size, mfc_entry& e) const
+{
+    HC_LOG_TRACE("");
+
+    //like the kernel the packet is counted before the input interface is checked
+    e.pktcnt++;
+    e.bytecnt += size;
+
+    if (e.input_vif != vif_index) {
+        e.wrong_if++;
+        return 0;
+    }
+
+    auto vif_it = m_vifs.find(vif_index);
+    if (vif_it != m_vifs.end()) {
+        vif_it->second.pkt_in++;
+        vif_it->second.bytes_in += size;
+    }
+
+    unsigned int copies = 0;
+    for (auto oif : e.output_vif) {
+        auto oif_it = m_vifs.find(oif);
+        if (oif != vif_index && oif_it != m_vifs.end()) {
+            oif_it->second.pkt_out++;
+            oif_it->second.bytes_out += size;
+            copies++;
+        }
+    }
+
+    return copies;
+}
+
+unsigned int mfc_simulator::receive_packet(uint32_t if_index, const addr_storage& source_addr, const addr_storage& group_addr, unsigned int size) const
+{
+    HC_LOG_TRACE("");
+
+    callback_upcall cb_upcall;
+    int vif_index;
+
+    {
+        std::lock_guard<std::mutex> lock(m_global_lock);
+
+        vif_index = get_vif(if_index);
+        if (vif_index < 0) {
+            HC_LOG_DEBUG("interface " << if_index << " is not a virtual interface, packet dropped");
+            return 0;
+        }
+
+        auto mfc_key_value = mfc_key(source_addr, group_addr);
+
+        auto mfc_it = m_mfc.find(mfc_key_value);
+        if (mfc_it != m_mfc.end()) {
+            return forward(vif_index, size, mfc_it->second);
+        }
+
+        auto unres_it = m_unresolved.find(mfc_key_value);
+        if (unres_it != m_unresolved.end()) {
+            if (unres_it->second.size() < MFC_SIMULATOR_MAX_UNRESOLVED_PACKETS) {
+                unres_it->second.push_back(std::make_pair(vif_index, size));
+            }
+            return 0;
+        }
+
+        if (m_unresolved.size() >= MFC_SIMULATOR_MAX_UNRESOLVED) {
+            HC_LOG_DEBUG("unresolved queue full, packet dropped");
+            return 0;
+        }
+
+        m_unresolved.insert(std::make_pair(mfc_key_value, unresolved_entry {std::make_pair(vif_index, size)}));
+        m_upcall_count++;
+        cb_upcall = m_cb_upcall;
+    }
+
+    //the callback is called without lock, it may add the forwarding rule immediately
+    if (cb_upcall) {
+        cb_upcall(vif_index, group_addr, source_addr);
+    }
+
+    return 0;
+}
+
+void mfc_simulator::expire_unresolved() const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    m_unresolved.clear();
+}
+
+bool mfc_simulator::add_vif(int vif_index, uint32_t if_index, const addr_storage& ip_tunnel_remote_addr) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if (vif_index < 0 || vif_index >= m_max_vifs) {
+        errno = ENFILE;
+        HC_LOG_ERROR("failed to add VIF! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    if (m_vifs.find(vif_index) != m_vifs.end()) {
+        errno = EADDRINUSE;
+        HC_LOG_ERROR("failed to add VIF! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    m_vifs.insert(std::make_pair(vif_index, vif_entry {if_index, ip_tunnel_remote_addr, 0, 0, 0, 0}));
+    return true;
+}
+
+bool mfc_simulator::del_vif(int vif_index) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if (m_vifs.erase(vif_index) == 0) {
+        errno = EADDRNOTAVAIL;
+        HC_LOG_ERROR("failed to del VIF! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool mfc_simulator::bind_vif_to_table(uint32_t, int) const
+{
+    HC_LOG_TRACE("");
+
+    //the simulator has only one table
+    return true;
+}
+
+bool mfc_simulator::unbind_vif_form_table(uint32_t, int) const
+{
+    HC_LOG_TRACE("");
+    return true;
+}
+
+bool mfc_simulator::add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const pooled_list<int>& output_vif) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if (vif_index < 0 || vif_index >= m_max_vifs) {
+        errno = ENFILE;
+        HC_LOG_ERROR("failed to add multicast route! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    auto mfc_key_value = mfc_key(source_addr, group_addr);
+    auto mfc_it = m_mfc.find(mfc_key_value);
+    if (mfc_it != m_mfc.end()) { //replace the interfaces and keep the counters
+        mfc_it->second.input_vif = vif_index;
+        mfc_it->second.output_vif = output_vif;
+        return true;
+    }
+
+    mfc_it = m_mfc.insert(std::make_pair(mfc_key_value, mfc_entry {vif_index, output_vif, 0, 0, 0})).first;
+
+    //forward the queued packets of the resolved rule
+    auto unres_it = m_unresolved.find(mfc_key_value);
+    if (unres_it != m_unresolved.end()) {
+        for (auto & p : unres_it->second) {
+            forward(p.first, p.second, mfc_it->second);
+        }
+        m_unresolved.erase(unres_it);
+    }
+
+    return true;
+}
+
+bool mfc_simulator::del_mroute(int, const addr_storage& source_addr, const addr_storage& group_addr) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if (m_mfc.erase(mfc_key(source_addr, group_addr)) == 0) {
+        errno = ENOENT;
+        HC_LOG_ERROR("failed to delete multicast route! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool mfc_simulator::flush_mroutes() const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    m_mfc.clear();
+    m_unresolved.clear();
+    return true;
+}
+
+bool mfc_simulator::get_mroute_stats(const addr_storage& source_addr, const addr_storage& group_addr, struct sioc_sg_req* sgreq_v4, struct sioc_sg_req6* sgreq_v6) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if ((m_addr_family == AF_INET && sgreq_v4 == nullptr) || (m_addr_family == AF_INET6 && sgreq_v6 == nullptr)) {
+        HC_LOG_ERROR("failed to get multicast route stats! Error: claimed parameter is null");
+        return false;
+    }
+
+    auto mfc_it = m_mfc.find(mfc_key(source_addr, group_addr));
+    if (mfc_it == m_mfc.end()) {
+        errno = EADDRNOTAVAIL;
+        HC_LOG_ERROR("failed to get multicast route stats! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    if (m_addr_family == AF_INET) {
+        memset(sgreq_v4, 0, sizeof(struct sioc_sg_req));
+        sgreq_v4->src = source_addr.get_in_addr();
+        sgreq_v4->grp = group_addr.get_in_addr();
+        sgreq_v4->pktcnt = mfc_it->second.pktcnt;
+        sgreq_v4->bytecnt = mfc_it->second.bytecnt;
+        sgreq_v4->wrong_if = mfc_it->second.wrong_if;
+    } else {
+        memset(sgreq_v6, 0, sizeof(struct sioc_sg_req6));
+        sgreq_v6->src.sin6_addr = source_addr.get_in6_addr();
+        sgreq_v6->grp.sin6_addr = group_addr.get_in6_addr();
+        sgreq_v6->pktcnt = mfc_it->second.pktcnt;
+        sgreq_v6->bytecnt = mfc_it->second.bytecnt;
+        sgreq_v6->wrong_if = mfc_it->second.wrong_if;
+    }
+
+    return true;
+}
+
+bool mfc_simulator::get_vif_stats(int vif_index, struct sioc_vif_req* req_v4, struct sioc_mif_req6* req_v6) const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+
+    if ((m_addr_family == AF_INET && req_v4 == nullptr) || (m_addr_family == AF_INET6 && req_v6 == nullptr)) {
+        HC_LOG_ERROR("failed to get vif stats! Error: claimed parameter is null");
+        return false;
+    }
+
+    auto vif_it = m_vifs.find(vif_index);
+    if (vif_it == m_vifs.end()) {
+        errno = EADDRNOTAVAIL;
+        HC_LOG_ERROR("failed to get vif stats! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    }
+
+    if (m_addr_family == AF_INET) {
+        memset(req_v4, 0, sizeof(struct sioc_vif_req));
+        req_v4->vifi = vif_index;
+        req_v4->icount = vif_it->second.pkt_in;
+        req_v4->ocount = vif_it->second.pkt_out;
+        req_v4->ibytes = vif_it->second.bytes_in;
+        req_v4->obytes = vif_it->second.bytes_out;
+    } else {
+        memset(req_v6, 0, sizeof(struct sioc_mif_req6));
+        req_v6->mifi = vif_index;
+        req_v6->icount = vif_it->second.pkt_in;
+        req_v6->ocount = vif_it->second.pkt_out;
+        req_v6->ibytes = vif_it->second.bytes_in;
+        req_v6->obytes = vif_it->second.bytes_out;
+    }
+
+    return true;
+}
+
+unsigned int mfc_simulator::get_mroute_count() const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    return m_mfc.size();
+}
+
+unsigned long mfc_simulator::get_upcall_count() const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    return m_upcall_count;
+}
+
+std::string mfc_simulator::to_string() const
+{
+    HC_LOG_TRACE("");
+    std::lock_guard<std::mutex> lock(m_global_lock);
+    std::ostringstream s;
+
+    s << "##-- simulated virtual interfaces (max " << m_max_vifs << ") --##" << std::endl;
+    for (auto & e : m_vifs) {
+        s << "vif:" << e.first << " if_index:" << e.second.if_index;
+        s << " in:" << e.second.pkt_in << "pkt/" << e.second.bytes_in << "B";
+        s << " out:" << e.second.pkt_out << "pkt/" << e.second.bytes_out << "B" << std::endl;
+    }
+
+    s << "##-- simulated forwarding rules --##" << std::endl;
+    for (auto & e : m_mfc) {
+        s << "(" << e.first.first << ", " << e.first.second << ") iif:" << e.second.input_vif << " oifs:";
+        for (auto oif : e.second.output_vif) {
+            s << " " << oif;
+        }
+        s << " pkt:" << e.second.pktcnt << " bytes:" << e.second.bytecnt << " wrong_if:" << e.second.wrong_if << std::endl;
+    }
+
+    s << "unresolved: " << m_unresolved.size() << ", upcalls: " << m_upcall_count;
+    return s.str();
+}
+
+std::ostream& operator<<(std::ostream& stream, const mfc_simulator& ms)
+{
+    return stream << ms.to_string();
+}
+
+#ifdef DEBUG_MODE
+void mfc_simulator::test_mfc_simulator()
+{
+    using namespace std;
+    cout << "##-- test mfc simulator --##" << endl;
+
+    mfc_simulator ms(AF_INET, 2);
+    addr_storage saddr("10.1.1.1");
+    addr_storage gaddr("239.1.1.1");
+
+    ms.set_upcall_callback([&](int vif, const addr_storage & g, const addr_storage & s) {
+        cout << "upcall vif:" << vif << " gaddr:" << g << " saddr:" << s << endl;
+        ms.add_mroute(vif, s, g, {1});
+    });
+
+    cout << "add vif 0: " << ms.add_vif(0, 1, addr_storage()) << endl;
+    cout << "add vif 1: " << ms.add_vif(1, 2, addr_storage()) << endl;
+    cout << "add vif 2 (limit): " << ms.add_vif(2, 3, addr_storage()) << endl;
+
+    cout << "receive packet (upcall): " << ms.receive_packet(1, saddr, gaddr, 100) << endl;
+    cout << "receive packet: " << ms.receive_packet(1, saddr, gaddr, 100) << endl;
+    cout << "receive packet (wrong if): " << ms.receive_packet(2, saddr, gaddr, 100) << endl;
+
+    struct sioc_sg_req stat;
+    if (ms.get_mroute_stats(saddr, gaddr, &stat, nullptr)) {
+        cout << "pktcnt: " << stat.pktcnt << " bytecnt: " << stat.bytecnt << " wrong_if: " << stat.wrong_if << endl;
+    }
+
+    cout << ms << endl;
+}
+#endif /* DEBUG_MODE */
@@ -177,6 +177,30 @@ u_int16_t mroute_socket::calc_checksum(const unsigned char* buf, int buf_size) c
     return ~sum;
 }
 
+u_int16_t mroute_socket::update_checksum(u_int16_t cksum, const unsigned char* old_data, const unsigned char* new_data, int size) const
+{
+    HC_LOG_TRACE("");
+
+    const u_int16_t* o = reinterpret_cast<const u_int16_t*>(old_data);
+    const u_int16_t* n = reinterpret_cast<const u_int16_t*>(new_data);
+
+    //HC' = ~(~HC + ~m + m')
+    u_int32_t sum = static_cast<u_int16_t>(~cksum);
+    for (int i = 0; i < size / 2; i++) {
+        if (o != nullptr) {
+            sum += static_cast<u_int16_t>(~o[i]);
+        }
+        sum += n[i];
+    }
+
+    // fold checksum
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return ~sum;
+}
+
 bool mroute_socket::set_ipv6_auto_icmp6_checksum_calc(bool enable) const
 {
     HC_LOG_TRACE("");
@@ -593,7 +617,7 @@ bool mroute_socket::unbind_vif_form_table(uint32_t if_index, int table) const
 
 //source_addr is the source address of the received multicast packet
 //group_addr group address of the received multicast packet
-bool mroute_socket::add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const std::list<int>& output_vif) const
+bool mroute_socket::add_mroute(int vif_index, const addr_storage& source_addr, const addr_storage& group_addr, const pooled_list<int>& output_vif) const
 {
 
 //unsigned int* output_vifTTL, unsigned int output_vifTTL_Ncount){
@@ -710,6 +734,37 @@ bool mroute_socket::del_mroute(int vif_index, const addr_storage& source_addr, c
     return false;
 }
 
+bool mroute_socket::flush_mroutes() const
+{
+    HC_LOG_TRACE("");
+
+    if (!is_udp_valid()) {
+        HC_LOG_ERROR("raw_socket invalid");
+        return false;
+    }
+
+    int rc;
+    int flags;
+
+    if (m_addrFamily == AF_INET) {
+        flags = MRT_FLUSH_MFC | MRT_FLUSH_MFC_STATIC;
+        rc = setsockopt(m_sock, IPPROTO_IP, MRT_FLUSH, (void*)&flags, sizeof(flags));
+    } else if (m_addrFamily == AF_INET6) {
+        flags = MRT6_FLUSH_MFC | MRT6_FLUSH_MFC_STATIC;
+        rc = setsockopt(m_sock, IPPROTO_IPV6, MRT6_FLUSH, (void*)&flags, sizeof(flags));
+    } else {
+        HC_LOG_ERROR("wrong address family");
+        return false;
+    }
+
+    if (rc == -1) {
+        HC_LOG_ERROR("failed to flush multicast routes! Error: " << strerror(errno) << " errno: " << errno);
+        return false;
+    } else {
+        return true;
+    }
+}
+
 bool mroute_socket::get_vif_stats(int vif_index, struct sioc_vif_req* req_v4, struct sioc_mif_req6* req_v6) const
 {
     HC_LOG_TRACE("");
@@ -1129,7 +1184,7 @@ void mroute_socket::test_add_route(mroute_socket* m)
 
     cout << "-- addRoute test --" << endl;
     //unsigned int output_vifs[]={[>if_three,<] if_two}; //if_two
-    list<int> output_vifs = { if_two };
+    pooled_list<int> output_vifs = { if_two };
     if (m->add_mroute(if_one, src_addr, g_addr , output_vifs)) {
         cout << "addRoute (" << str_if_one << " ==> " << str_if_two << ") OK!" << endl;
     } else {